@@ -0,0 +1,135 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// Benchmark of request-scoped objects built on the libc allocator and
+// destroyed one at a time, against the same objects built on an arena_t
+// and released all at once with reset().
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime()
+
+#include "arena.h"
+#include "chain.h"
+#include "bytes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+//------------------------------------------------------------------------|
+#define BENCH_REQUESTS  2000
+#define BENCH_OBJECTS   32
+#define BENCH_LINKS     64
+#define BENCH_PASSES    3
+
+//------------------------------------------------------------------------|
+static inline double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1000.0 + (double) ts.tv_nsec / 1000000.0;
+}
+
+//------------------------------------------------------------------------|
+// Build one request's worth of chains and bytes on 'allocator'
+static void bench_build(const allocator_t * allocator, chain_t ** chains,
+                        bytes_t ** strings)
+{
+    size_t i, j;
+
+    for (i = 0; i < BENCH_OBJECTS; i++)
+    {
+        chains[i] = chain_pub.create_with(NULL, allocator);
+        strings[i] = bytes_create_with("request", 7, allocator);
+
+        for (j = 1; j <= BENCH_LINKS; j++)
+        {
+            chains[i]->insert(chains[i], (void *) (uintptr_t) j);
+        }
+
+        strings[i]->append(strings[i], " header value", 13);
+    }
+}
+
+//------------------------------------------------------------------------|
+int main(void)
+{
+    chain_t * chains[BENCH_OBJECTS];
+    bytes_t * strings[BENCH_OBJECTS];
+    double build[2] = { 1e30, 1e30 };
+    double teardown[2] = { 1e30, 1e30 };
+    double start, elapsed[2];
+    size_t request, i;
+    int pass;
+
+    arena_t * arena = arena_pub.create(0);
+
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        elapsed[0] = elapsed[1] = 0.0;
+        for (request = 0; request < BENCH_REQUESTS; request++)
+        {
+            start = now_ms();
+            bench_build(&allocator_libc, chains, strings);
+            elapsed[0] += now_ms() - start;
+
+            start = now_ms();
+            for (i = 0; i < BENCH_OBJECTS; i++)
+            {
+                chains[i]->destroy(chains[i]);
+                strings[i]->destroy(strings[i]);
+            }
+            elapsed[1] += now_ms() - start;
+        }
+        build[0] = elapsed[0] < build[0] ? elapsed[0] : build[0];
+        teardown[0] = elapsed[1] < teardown[0] ? elapsed[1] : teardown[0];
+
+        elapsed[0] = elapsed[1] = 0.0;
+        for (request = 0; request < BENCH_REQUESTS; request++)
+        {
+            start = now_ms();
+            bench_build(arena->allocator(arena), chains, strings);
+            elapsed[0] += now_ms() - start;
+
+            start = now_ms();
+            arena->reset(arena);
+            elapsed[1] += now_ms() - start;
+        }
+        build[1] = elapsed[0] < build[1] ? elapsed[0] : build[1];
+        teardown[1] = elapsed[1] < teardown[1] ? elapsed[1] : teardown[1];
+    }
+
+    arena->destroy(arena);
+
+    printf("arena_t vs libc, %d requests of %d chains (%d links) and "
+           "%d bytes, best of %d passes\n", BENCH_REQUESTS, BENCH_OBJECTS,
+           BENCH_LINKS, BENCH_OBJECTS, BENCH_PASSES);
+    printf("%-22s %12s %12s %9s\n", "operation", "libc ms", "arena ms",
+           "speedup");
+    printf("%-22s %12.3f %12.3f %8.1fx\n", "build", build[0], build[1],
+           build[0] / build[1]);
+    printf("%-22s %12.3f %12.3f %8.1fx\n", "teardown", teardown[0],
+           teardown[1], teardown[0] / teardown[1]);
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// Benchmark of hex and Base64 encoding and decoding at each SIMD level
+// the CPU supports, against the scalar code.
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime()
+
+#include "codec.h"
+#include "prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+//------------------------------------------------------------------------|
+#define BENCH_SIZE      (4 * 1024 * 1024)
+#define BENCH_PASSES    5
+
+//------------------------------------------------------------------------|
+static inline double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1000.0 + (double) ts.tv_nsec / 1000000.0;
+}
+
+// Keep the best (lowest) time seen for an operation
+static inline void bench_result(double * result, double start)
+{
+    double elapsed = now_ms() - start;
+
+    if (elapsed < *result)
+    {
+        *result = elapsed;
+    }
+}
+
+//------------------------------------------------------------------------|
+int main(void)
+{
+    const char * ops[] = {
+        "hex encode",
+        "hex decode",
+        "base64 encode",
+        "base64 decode",
+    };
+    const char * levels[] = { "scalar", "ssse3", "avx2" };
+
+    uint8_t * data = (uint8_t *) malloc(BENCH_SIZE);
+    uint8_t * back = (uint8_t *) malloc(BENCH_SIZE);
+    char * hex = (char *) malloc(CODEC_HEX_ENCODED(BENCH_SIZE));
+    char * base64 = (char *) malloc(CODEC_BASE64_ENCODED(BENCH_SIZE));
+    codec_simd_t best = codec_simd(), level;
+    double times[3][4], start;
+    size_t hexsize, base64size;
+    int pass, op;
+
+    prng_seed(0xDEADBEEFCAFEBABEULL);
+    prng_fill(data, BENCH_SIZE);
+
+    for (level = CODEC_SCALAR; level <= best; level++)
+    {
+        codec_simd_limit(level);
+        for (op = 0; op < 4; op++)
+        {
+            times[level][op] = 1e30;
+        }
+
+        for (pass = 0; pass < BENCH_PASSES; pass++)
+        {
+            start = now_ms();
+            hexsize = codec_hex_encode(hex, data, BENCH_SIZE);
+            bench_result(&times[level][0], start);
+
+            start = now_ms();
+            if (codec_hex_decode(back, hex, hexsize) != BENCH_SIZE)
+            {
+                printf("hex decode failed\n");
+                return 1;
+            }
+            bench_result(&times[level][1], start);
+
+            start = now_ms();
+            base64size = codec_base64_encode(base64, data, BENCH_SIZE,
+                                             CODEC_BASE64);
+            bench_result(&times[level][2], start);
+
+            start = now_ms();
+            if (codec_base64_decode(back, base64, base64size,
+                                    CODEC_BASE64) != BENCH_SIZE)
+            {
+                printf("base64 decode failed\n");
+                return 1;
+            }
+            bench_result(&times[level][3], start);
+        }
+    }
+
+    printf("codec throughput in MB/s of binary data, %d MiB, best of %d "
+           "passes\n", BENCH_SIZE / (1024 * 1024), BENCH_PASSES);
+    printf("%-16s", "operation");
+    for (level = CODEC_SCALAR; level <= best; level++)
+    {
+        printf(" %10s", levels[level]);
+    }
+    printf(" %9s\n", "speedup");
+
+    for (op = 0; op < 4; op++)
+    {
+        printf("%-16s", ops[op]);
+        for (level = CODEC_SCALAR; level <= best; level++)
+        {
+            printf(" %10.0f", BENCH_SIZE / 1000.0 / times[level][op]);
+        }
+        printf(" %8.1fx\n", times[CODEC_SCALAR][op] / times[best][op]);
+    }
+
+    codec_simd_limit(best);
+    free(data);
+    free(back);
+    free(hex);
+    free(base64);
+    return 0;
+}
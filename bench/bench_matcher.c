@@ -0,0 +1,155 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// Benchmark of matcher_t against looping bytes_t find() over each
+// keyword, for a small keyword set that compiles to a dense DFA and a
+// large one that compiles sparse.
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime()
+
+#include "matcher.h"
+#include "chain.h"
+#include "bytes.h"
+#include "prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+//------------------------------------------------------------------------|
+#define BENCH_SIZE      (256 * 1024)
+#define BENCH_PASSES    3
+
+//------------------------------------------------------------------------|
+static inline double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1000.0 + (double) ts.tv_nsec / 1000000.0;
+}
+
+// Keep the best (lowest) time seen for an operation
+static inline void bench_result(double * result, double start)
+{
+    double elapsed = now_ms() - start;
+
+    if (elapsed < *result)
+    {
+        *result = elapsed;
+    }
+}
+
+// A random lower case word of 4 to 11 letters
+static size_t random_word(char * word)
+{
+    size_t length = 4 + prng_next() % 8, i;
+
+    for (i = 0; i < length; i++)
+    {
+        word[i] = (char) ('a' + prng_next() % 26);
+    }
+
+    return length;
+}
+
+//------------------------------------------------------------------------|
+int main(void)
+{
+    const size_t sets[] = { 50, 5000 };
+    bytes_t * text = bytes_pub.create(NULL, 0);
+    chain_t * keywords = NULL;
+    matcher_t * matcher = NULL;
+    bytes_t * keyword = NULL;
+    double fast, slow, start;
+    size_t set, i, n, offset, loops = 0, found = 0;
+    char word[16];
+    int pass;
+
+    // text of random words, which some short keywords will turn up in
+    prng_seed(0xDEADBEEFCAFEBABEULL);
+    while (text->size(text) < BENCH_SIZE)
+    {
+        text->append(text, word, random_word(word));
+        text->append(text, " ", 1);
+    }
+
+    printf("matcher_t scan vs find() per keyword, %d KiB, best of %d "
+           "passes\n", BENCH_SIZE / 1024, BENCH_PASSES);
+    printf("%-10s %8s %-7s %12s %12s %9s\n", "keywords", "states", "form",
+           "find ms", "matcher ms", "speedup");
+
+    for (set = 0; set < 2; set++)
+    {
+        keywords = chain_pub.create(bytes_pub.destroy);
+        for (i = 0; i < sets[set]; i++)
+        {
+            keywords->insert(keywords,
+                             bytes_pub.create(word, random_word(word)));
+        }
+
+        matcher = matcher_pub.create(keywords);
+        fast = slow = 1e30;
+
+        for (pass = 0; pass < BENCH_PASSES; pass++)
+        {
+            start = now_ms();
+            loops = 0;
+            keywords->reset(keywords);
+            for (i = 0; i < sets[set]; i++, keywords->spin(keywords, 1))
+            {
+                keyword = (bytes_t *) keywords->data(keywords);
+                for (offset = 0;
+                     (n = bytes_find(text, offset, keyword->data(keyword),
+                                     keyword->size(keyword))) != SEARCH_NONE;
+                     offset = n + 1)
+                {
+                    loops++;
+                }
+            }
+            bench_result(&slow, start);
+
+            start = now_ms();
+            found = matcher->scan(matcher, text, NULL, NULL);
+            bench_result(&fast, start);
+        }
+
+        if (found != loops)
+        {
+            printf("match counts differ: %zu vs %zu\n", found, loops);
+            return 1;
+        }
+
+        printf("%-10zu %8zu %-7s %12.3f %12.3f %8.1fx\n", sets[set],
+               matcher->states(matcher),
+               matcher->dense(matcher) ? "dense" : "sparse", slow, fast,
+               slow / fast);
+
+        matcher->destroy(matcher);
+        keywords->destroy(keywords);
+    }
+
+    text->destroy(text);
+    return 0;
+}
@@ -0,0 +1,213 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// Benchmark of the bytes_t number append and parse operations against
+// appendf() and the C library conversions they replace.
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime()
+
+#include "bytes.h"
+#include "prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+//------------------------------------------------------------------------|
+#define BENCH_COUNT     1000000
+#define BENCH_PASSES    3
+
+//------------------------------------------------------------------------|
+static inline double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1000.0 + (double) ts.tv_nsec / 1000000.0;
+}
+
+// Keep the best (lowest) time seen for an operation
+static inline void bench_result(double * result, double start)
+{
+    double elapsed = now_ms() - start;
+
+    if (elapsed < *result)
+    {
+        *result = elapsed;
+    }
+}
+
+//------------------------------------------------------------------------|
+int main(void)
+{
+    const char * ops[] = {
+        "append u64",
+        "append i64",
+        "append double",
+        "parse u64",
+        "parse double",
+    };
+
+    uint64_t * integers = (uint64_t *) malloc(BENCH_COUNT * sizeof(uint64_t));
+    double * reals = (double *) malloc(BENCH_COUNT * sizeof(double));
+    bytes_t * ours = bytes_pub.create(NULL, 0);
+    bytes_t * libc = bytes_pub.create(NULL, 0);
+    double fast[5], slow[5], start;
+    volatile double dsum = 0.0;
+    volatile uint64_t usum = 0;
+    uint64_t uvalue;
+    double dvalue;
+    size_t i, offset, used;
+    int pass, op;
+    char * end;
+
+    prng_seed(0xDEADBEEFCAFEBABEULL);
+    for (i = 0; i < BENCH_COUNT; i++)
+    {
+        integers[i] = prng_next() >> (prng_next() % 64);
+        reals[i] = (double) (prng_next() % 100000000) /
+                   (double) (1 + prng_next() % 10000);
+    }
+
+    for (op = 0; op < 5; op++)
+    {
+        fast[op] = slow[op] = 1e30;
+    }
+
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        // formatting, each separated by a space for parsing later
+        ours->resize(ours, 0);
+        start = now_ms();
+        for (i = 0; i < BENCH_COUNT; i++)
+        {
+            bytes_append_u64(ours, integers[i]);
+            ours->append(ours, " ", 1);
+        }
+        bench_result(&fast[0], start);
+
+        libc->resize(libc, 0);
+        start = now_ms();
+        for (i = 0; i < BENCH_COUNT; i++)
+        {
+            bytes_appendf(libc, "%llu ", (unsigned long long) integers[i]);
+        }
+        bench_result(&slow[0], start);
+
+        ours->resize(ours, 0);
+        start = now_ms();
+        for (i = 0; i < BENCH_COUNT; i++)
+        {
+            bytes_append_i64(ours, (int64_t) integers[i]);
+        }
+        bench_result(&fast[1], start);
+
+        libc->resize(libc, 0);
+        start = now_ms();
+        for (i = 0; i < BENCH_COUNT; i++)
+        {
+            bytes_appendf(libc, "%lld", (long long) integers[i]);
+        }
+        bench_result(&slow[1], start);
+
+        // %.17g is what it takes for printf to round-trip
+        libc->resize(libc, 0);
+        start = now_ms();
+        for (i = 0; i < BENCH_COUNT; i++)
+        {
+            bytes_appendf(libc, "%.17g ", reals[i]);
+        }
+        bench_result(&slow[2], start);
+
+        ours->resize(ours, 0);
+        start = now_ms();
+        for (i = 0; i < BENCH_COUNT; i++)
+        {
+            bytes_append_double(ours, reals[i]);
+            ours->append(ours, " ", 1);
+        }
+        bench_result(&fast[2], start);
+
+        // parse back the doubles just written, then the integers
+        start = now_ms();
+        for (i = 0, offset = 0; i < BENCH_COUNT; i++)
+        {
+            used = bytes_parse_double(ours, offset, &dvalue);
+            dsum += dvalue;
+            offset += used + 1;
+        }
+        bench_result(&fast[4], start);
+
+        start = now_ms();
+        for (i = 0, offset = 0; i < BENCH_COUNT; i++)
+        {
+            dsum += strtod(ours->cstr(ours) + offset, &end);
+            offset = (size_t) (end - ours->cstr(ours)) + 1;
+        }
+        bench_result(&slow[4], start);
+
+        ours->resize(ours, 0);
+        for (i = 0; i < BENCH_COUNT; i++)
+        {
+            bytes_append_u64(ours, integers[i]);
+            ours->append(ours, " ", 1);
+        }
+
+        start = now_ms();
+        for (i = 0, offset = 0; i < BENCH_COUNT; i++)
+        {
+            used = bytes_parse_u64(ours, offset, &uvalue);
+            usum += uvalue;
+            offset += used + 1;
+        }
+        bench_result(&fast[3], start);
+
+        start = now_ms();
+        for (i = 0, offset = 0; i < BENCH_COUNT; i++)
+        {
+            usum += strtoull(ours->cstr(ours) + offset, &end, 10);
+            offset = (size_t) (end - ours->cstr(ours)) + 1;
+        }
+        bench_result(&slow[3], start);
+    }
+
+    printf("bytes_t number conversion vs libc, %d values, best of %d "
+           "passes\n", BENCH_COUNT, BENCH_PASSES);
+    printf("%-22s %12s %12s %9s\n", "operation", "libc ms", "bytes ms",
+           "speedup");
+
+    for (op = 0; op < 5; op++)
+    {
+        printf("%-22s %12.3f %12.3f %8.1fx\n", ops[op], slow[op], fast[op],
+               slow[op] / fast[op]);
+    }
+
+    ours->destroy(ours);
+    libc->destroy(libc);
+    free(integers);
+    free(reals);
+    (void) usum;
+    (void) dsum;
+    return 0;
+}
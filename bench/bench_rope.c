@@ -0,0 +1,166 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// Benchmark of editing in the middle of a document-sized buffer: a flat
+// buffer moving its tail on every insert and erase, as bytes_t would,
+// against rope_t, and the cost of flattening the rope back afterwards.
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime()
+
+#include "rope.h"
+#include "prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+//------------------------------------------------------------------------|
+#define BENCH_SIZE      (8 * 1024 * 1024)
+#define BENCH_EDITS     20000
+#define BENCH_PASSES    3
+
+//------------------------------------------------------------------------|
+static inline double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1000.0 + (double) ts.tv_nsec / 1000000.0;
+}
+
+// Keep the best (lowest) time seen for an operation
+static inline void bench_result(double * result, double start)
+{
+    double elapsed = now_ms() - start;
+
+    if (elapsed < *result)
+    {
+        *result = elapsed;
+    }
+}
+
+// The same edits for both: offsets in the current size, typing-sized
+typedef struct
+{
+    size_t offset;
+    size_t count;
+    bool insert;
+}
+edit_t;
+
+//------------------------------------------------------------------------|
+int main(void)
+{
+    edit_t * edits = (edit_t *) malloc(BENCH_EDITS * sizeof(edit_t));
+    uint8_t * text = (uint8_t *) malloc(BENCH_SIZE);
+    uint8_t * flat = NULL;
+    const uint8_t * data = NULL;
+    double moving, rope_ms, flatten, start;
+    volatile size_t total = 0;
+    size_t size = BENCH_SIZE, i;
+    rope_t * rope;
+    int pass;
+
+    prng_seed(0xDEADBEEFCAFEBABEULL);
+    prng_fill(text, BENCH_SIZE);
+    for (i = 0; i < BENCH_EDITS; i++)
+    {
+        edits[i].insert = prng_next() % 2;
+        edits[i].count = 1 + prng_next() % 16;
+        edits[i].offset = prng_next() % (size - edits[i].count);
+        size += edits[i].insert ? edits[i].count : -edits[i].count;
+    }
+
+    moving = rope_ms = flatten = 1e30;
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        size = BENCH_SIZE;
+        flat = (uint8_t *) malloc(size);
+        memcpy(flat, text, size);
+
+        start = now_ms();
+        for (i = 0; i < BENCH_EDITS; i++)
+        {
+            if (edits[i].insert)
+            {
+                flat = (uint8_t *) realloc(flat, size + edits[i].count);
+                memmove(flat + edits[i].offset + edits[i].count,
+                        flat + edits[i].offset, size - edits[i].offset);
+                memcpy(flat + edits[i].offset, text, edits[i].count);
+                size += edits[i].count;
+            }
+            else
+            {
+                size -= edits[i].count;
+                memmove(flat + edits[i].offset,
+                        flat + edits[i].offset + edits[i].count,
+                        size - edits[i].offset);
+            }
+        }
+        bench_result(&moving, start);
+
+        rope = rope_pub.create(text, BENCH_SIZE);
+        start = now_ms();
+        for (i = 0; i < BENCH_EDITS; i++)
+        {
+            if (edits[i].insert)
+            {
+                rope->insert(rope, edits[i].offset, text, edits[i].count);
+            }
+            else
+            {
+                rope->erase(rope, edits[i].offset, edits[i].count);
+            }
+        }
+        bench_result(&rope_ms, start);
+
+        start = now_ms();
+        data = rope->data(rope);
+        bench_result(&flatten, start);
+
+        if (rope->size(rope) != size || memcmp(data, flat, size) != 0)
+        {
+            printf("rope and flat buffer disagree\n");
+            return 1;
+        }
+
+        total += rope->chunks(rope) + size;
+        rope->destroy(rope);
+        free(flat);
+    }
+
+    printf("%d edits of 1 to 16 bytes in %d MiB, best of %d passes\n",
+           BENCH_EDITS, BENCH_SIZE / (1024 * 1024), BENCH_PASSES);
+    printf("%-28s %10s %9s\n", "method", "ms", "speedup");
+    printf("%-28s %10.3f %8.1fx\n", "flat buffer moving its tail", moving,
+           1.0);
+    printf("%-28s %10.3f %8.1fx\n", "rope_t insert/erase", rope_ms,
+           moving / rope_ms);
+    printf("%-28s %10.3f\n", "rope_t data() flatten once", flatten);
+
+    free(edits);
+    free(text);
+    (void) total;
+    return 0;
+}
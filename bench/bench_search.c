@@ -0,0 +1,115 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// Benchmark of bytes_t substring search against strstr() on cstr(), for
+// needles of increasing length placed at the end of the data.
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime()
+
+#include "bytes.h"
+#include "prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+//------------------------------------------------------------------------|
+#define BENCH_SIZE      (4 * 1024 * 1024)
+#define BENCH_PASSES    5
+
+//------------------------------------------------------------------------|
+static inline double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1000.0 + (double) ts.tv_nsec / 1000000.0;
+}
+
+// Keep the best (lowest) time seen for an operation
+static inline void bench_result(double * result, double start)
+{
+    double elapsed = now_ms() - start;
+
+    if (elapsed < *result)
+    {
+        *result = elapsed;
+    }
+}
+
+//------------------------------------------------------------------------|
+int main(void)
+{
+    const size_t lengths[] = { 2, 4, 16, 64, 256 };
+    const size_t count = sizeof(lengths) / sizeof(lengths[0]);
+
+    char * text = (char *) malloc(BENCH_SIZE + 1);
+    bytes_t * bytes;
+    const char * needle;
+    double fast, slow, start;
+    volatile size_t found = 0;
+    size_t i, n;
+    int pass;
+
+    // lower case text over a small alphabet, so partial matches are
+    // common, ending in a byte that makes every needle occur only there
+    prng_seed(0xDEADBEEFCAFEBABEULL);
+    for (i = 0; i < BENCH_SIZE; i++)
+    {
+        text[i] = (char) ('a' + prng_next() % 8);
+    }
+    text[BENCH_SIZE - 1] = 'Z';
+    text[BENCH_SIZE] = '\0';
+    bytes = bytes_pub.create(text, BENCH_SIZE);
+
+    printf("bytes_t find() vs strstr(), %d MiB, best of %d passes\n",
+           BENCH_SIZE / (1024 * 1024), BENCH_PASSES);
+    printf("%-16s %12s %12s %9s\n", "needle length", "strstr ms",
+           "find ms", "speedup");
+
+    for (n = 0; n < count; n++)
+    {
+        needle = text + BENCH_SIZE - lengths[n];
+        fast = slow = 1e30;
+
+        for (pass = 0; pass < BENCH_PASSES; pass++)
+        {
+            start = now_ms();
+            found += (size_t) (strstr(bytes->cstr(bytes), needle) - text);
+            bench_result(&slow, start);
+
+            start = now_ms();
+            found += bytes_find(bytes, 0, needle, lengths[n]);
+            bench_result(&fast, start);
+        }
+
+        printf("%-16zu %12.3f %12.3f %8.1fx\n", lengths[n], slow, fast,
+               slow / fast);
+    }
+
+    bytes->destroy(bytes);
+    free(text);
+    (void) found;
+    return 0;
+}
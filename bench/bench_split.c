@@ -0,0 +1,145 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// Benchmark of splitting comma-separated text: copying each token into
+// its own bytes_t in a chain, against tokenize() collecting views into a
+// chain, against iterating views with split_next() and no allocation.
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime()
+
+#include "bytes.h"
+#include "split.h"
+#include "chain.h"
+#include "prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+//------------------------------------------------------------------------|
+#define BENCH_SIZE      (4 * 1024 * 1024)
+#define BENCH_PASSES    5
+
+//------------------------------------------------------------------------|
+static inline double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1000.0 + (double) ts.tv_nsec / 1000000.0;
+}
+
+// Keep the best (lowest) time seen for an operation
+static inline void bench_result(double * result, double start)
+{
+    double elapsed = now_ms() - start;
+
+    if (elapsed < *result)
+    {
+        *result = elapsed;
+    }
+}
+
+// The per-token copying this replaces
+static chain_t * copy_tokens(bytes_t * bytes)
+{
+    chain_t * chain = chain_pub.create(bytes_pub.destroy);
+    const uint8_t * data = bytes->data(bytes);
+    size_t size = bytes->size(bytes);
+    size_t begin = 0, at;
+
+    while (true)
+    {
+        at = bytes_find_byte(bytes, begin, ',');
+        at = at == SEARCH_NONE ? size : at;
+        chain->insert(chain, bytes_pub.create(data + begin, at - begin));
+        if (at == size)
+        {
+            return chain;
+        }
+
+        begin = at + 1;
+    }
+}
+
+//------------------------------------------------------------------------|
+int main(void)
+{
+    split_spec_t spec = { SPLIT_BYTE, ",", 1, 0, 0, false };
+    char * text = (char *) malloc(BENCH_SIZE);
+    double copy, views, lazy, start;
+    volatile size_t total = 0;
+    bytes_t * bytes;
+    chain_t * chain;
+    split_t split;
+    view_t token;
+    size_t i;
+    int pass;
+
+    // fields of 1 to 16 letters
+    prng_seed(0xDEADBEEFCAFEBABEULL);
+    for (i = 0; i < BENCH_SIZE; i++)
+    {
+        text[i] = prng_next() % 9 ? (char) ('a' + prng_next() % 26) : ',';
+    }
+    bytes = bytes_pub.create(text, BENCH_SIZE);
+
+    copy = views = lazy = 1e30;
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        start = now_ms();
+        chain = copy_tokens(bytes);
+        total += chain->length(chain);
+        chain->destroy(chain);
+        bench_result(&copy, start);
+
+        start = now_ms();
+        chain = bytes_tokenize(bytes, &spec);
+        total += chain->length(chain);
+        chain->destroy(chain);
+        bench_result(&views, start);
+
+        start = now_ms();
+        split_begin(&split, view_bytes(bytes), &spec);
+        while (split_next(&split, &token))
+        {
+            total += token.size;
+        }
+        bench_result(&lazy, start);
+    }
+
+    printf("splitting %d MiB of comma-separated text, best of %d passes\n",
+           BENCH_SIZE / (1024 * 1024), BENCH_PASSES);
+    printf("%-28s %10s %9s\n", "method", "ms", "speedup");
+    printf("%-28s %10.3f %8.1fx\n", "bytes_t copy per token", copy, 1.0);
+    printf("%-28s %10.3f %8.1fx\n", "tokenize() chain of views", views,
+           copy / views);
+    printf("%-28s %10.3f %8.1fx\n", "split_next() iteration", lazy,
+           copy / lazy);
+
+    bytes->destroy(bytes);
+    free(text);
+    (void) total;
+    return 0;
+}
@@ -0,0 +1,181 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// Benchmark of the vector chain against the linked chain across the
+// chain_t operation set.  Because both are chain_t vtables, the very same
+// code runs for each, handed one pub or the other.
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime()
+
+#include "chain.h"
+#include "prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+//------------------------------------------------------------------------|
+#define BENCH_LENGTH    1000000
+#define BENCH_PASSES    3
+
+//------------------------------------------------------------------------|
+static inline double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1000.0 + (double) ts.tv_nsec / 1000000.0;
+}
+
+static int compare(const void * a, const void * b)
+{
+    uintptr_t aval = (uintptr_t) *(void **) a;
+    uintptr_t bval = (uintptr_t) *(void **) b;
+    return (aval > bval) - (aval < bval);
+}
+
+//------------------------------------------------------------------------|
+// Keep the best (lowest) time seen for an operation
+static inline void bench_result(double * result, double start)
+{
+    double elapsed = now_ms() - start;
+
+    if (elapsed < *result)
+    {
+        *result = elapsed;
+    }
+}
+
+//------------------------------------------------------------------------|
+// Times each operation, keeping the best of several passes.
+static void bench_container(const chain_t * pub, double * results)
+{
+    volatile uintptr_t sum = 0;
+    double start;
+    size_t i;
+    int pass, op;
+
+    for (op = 0; op < 8; op++)
+    {
+        results[op] = 1e30;
+    }
+
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        chain_t * c = pub->create(NULL);
+        op = 0;
+
+        start = now_ms();
+        for (i = 0; i < BENCH_LENGTH; i++)
+        {
+            c->insert(c, (void *) (uintptr_t) (prng_next() | 1));
+        }
+        bench_result(&results[op++], start);
+
+        start = now_ms();
+        c->reset(c);
+        do
+        {
+            sum += (uintptr_t) c->data(c);
+        }
+        while (c->spin(c, 1));
+        bench_result(&results[op++], start);
+
+        start = now_ms();
+        c->sort(c, compare);
+        bench_result(&results[op++], start);
+
+        start = now_ms();
+        chain_t * d = c->copy(c, NULL);
+        bench_result(&results[op++], start);
+
+        start = now_ms();
+        chain_t * s = c->split(c, BENCH_LENGTH / 4, BENCH_LENGTH / 2);
+        c->join(c, s);
+        bench_result(&results[op++], start);
+
+        chain_t * t = pub->create(NULL);
+        for (i = 0; i < BENCH_LENGTH; i++)
+        {
+            t->insert(t, (i & 1) ? NULL : (void *) (uintptr_t) (i + 1));
+        }
+        start = now_ms();
+        t->trim(t);
+        bench_result(&results[op++], start);
+        t->destroy(t);
+
+        start = now_ms();
+        c->reset(c);
+        c->spin(c, -1);
+        while (!c->empty(c))
+        {
+            c->remove(c);
+        }
+        bench_result(&results[op++], start);
+
+        start = now_ms();
+        d->destroy(d);
+        s->destroy(s);
+        c->destroy(c);
+        bench_result(&results[op++], start);
+    }
+
+    (void) sum;
+}
+
+//------------------------------------------------------------------------|
+int main(void)
+{
+    const char * ops[] = {
+        "insert (append)",
+        "iterate (spin/data)",
+        "sort",
+        "copy",
+        "split/join",
+        "trim (50% NULL)",
+        "remove (from end)",
+        "destroy",
+    };
+
+    double chain_ms[8];
+    double vector_ms[8];
+    int op;
+
+    prng_seed(0xDEADBEEFCAFEBABEULL);
+    bench_container(&chain_pub, chain_ms);
+    prng_seed(0xDEADBEEFCAFEBABEULL);
+    bench_container(&chain_vector_pub, vector_ms);
+
+    printf("chain_vector_pub vs chain_pub, %d elements, best of %d passes\n",
+           BENCH_LENGTH, BENCH_PASSES);
+    printf("%-22s %12s %12s %9s\n", "operation", "chain ms", "vector ms",
+           "speedup");
+
+    for (op = 0; op < 8; op++)
+    {
+        printf("%-22s %12.3f %12.3f %8.1fx\n", ops[op], chain_ms[op],
+               vector_ms[op], chain_ms[op] / vector_ms[op]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "allocator.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//------------------------------------------------------------------------|
+static void * libc_alloc(void * context, size_t size)
+{
+    return malloc(size);
+}
+
+//------------------------------------------------------------------------|
+static void * libc_realloc(void * context, void * ptr, size_t old_size,
+                           size_t size)
+{
+    return realloc(ptr, size);
+}
+
+//------------------------------------------------------------------------|
+static void libc_free(void * context, void * ptr, size_t size)
+{
+    free(ptr);
+}
+
+//------------------------------------------------------------------------|
+const allocator_t allocator_libc = {
+    &libc_alloc,
+    &libc_realloc,
+    &libc_free,
+    NULL
+};
+
+// The current library default
+static allocator_t allocator_current = {
+    &libc_alloc,
+    &libc_realloc,
+    &libc_free,
+    NULL
+};
+
+//------------------------------------------------------------------------|
+const allocator_t * allocator_default(void)
+{
+    return &allocator_current;
+}
+
+//------------------------------------------------------------------------|
+void allocator_set_default(const allocator_t * allocator)
+{
+    memcpy(&allocator_current, allocator ? allocator : &allocator_libc,
+           sizeof(allocator_t));
+}
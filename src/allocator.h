@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A pluggable memory allocator.  Objects that accept one make all of their
+// allocations through it: the public object, its private data, and any
+// links or buffers it owns.  Short-lived scratch space internal to a
+// single call (such as the pointer array used by sort) still comes from
+// malloc().
+//
+// Every call passes the allocator's context along with the size of the
+// block concerned, so that allocators which do not keep per-block headers
+// (arenas, pools) have what they need.  'realloc' receives the old size,
+// which is 0 when 'ptr' is NULL, and 'free' receives the size that was
+// allocated.  The libc allocator ignores sizes and context.
+typedef struct allocator_t
+{
+    // Allocate 'size' bytes, or return NULL on failure
+    void * (*alloc)(void * context, size_t size);
+
+    // Resize a block from 'old_size' to 'size' bytes, keeping contents
+    void * (*realloc)(void * context, void * ptr, size_t old_size,
+                      size_t size);
+
+    // Release a block of 'size' bytes
+    void (*free)(void * context, void * ptr, size_t size);
+
+    // Passed to every call above
+    void * context;
+}
+allocator_t;
+
+//------------------------------------------------------------------------|
+static inline void * allocator_alloc(const allocator_t * allocator,
+                                     size_t size)
+{
+    return allocator->alloc(allocator->context, size);
+}
+
+static inline void * allocator_realloc(const allocator_t * allocator,
+                                       void * ptr, size_t old_size,
+                                       size_t size)
+{
+    return allocator->realloc(allocator->context, ptr, old_size, size);
+}
+
+static inline void allocator_free(const allocator_t * allocator,
+                                  void * ptr, size_t size)
+{
+    if (NULL != ptr)
+    {
+        allocator->free(allocator->context, ptr, size);
+    }
+}
+
+// Returns true if memory from one allocator may be released by the other
+static inline bool allocator_same(const allocator_t * a, const allocator_t * b)
+{
+    return (a->alloc == b->alloc) && (a->realloc == b->realloc) &&
+           (a->free == b->free) && (a->context == b->context);
+}
+
+//------------------------------------------------------------------------|
+// Get the library default allocator.  Objects created without an explicit
+// allocator take a copy of whichever default is current at the time.
+const allocator_t * allocator_default(void);
+
+// Replace the library default allocator, or restore libc with NULL.  The
+// allocator is copied.  Objects that already exist keep their own.
+void allocator_set_default(const allocator_t * allocator);
+
+//------------------------------------------------------------------------|
+// The standard malloc(), realloc() and free() as an allocator
+extern const allocator_t allocator_libc;
@@ -0,0 +1,588 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#define _POSIX_C_SOURCE 200809L  // mmap(), fstat()
+
+#include "archive.h"
+#include "blammo.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//------------------------------------------------------------------------|
+#define ARCHIVE_VERSION     1
+
+// Records per block.  Every block but the last is full.
+#define ARCHIVE_PER_BLOCK   64
+
+#define HEADER_SIZE         20
+#define TRAILER_SIZE        16
+#define BLOCK_HEADER_SIZE   8
+
+static const uint8_t header_magic[4] = { 'R', 'T', 'L', 'A' };
+static const uint8_t trailer_magic[4] = { 'A', 'L', 'T', 'R' };
+
+//------------------------------------------------------------------------|
+// archive private implementation data
+typedef struct
+{
+    // The whole archive, and its size in bytes
+    const uint8_t * base;
+    size_t size;
+
+    // Number of records, records per block, and number of blocks
+    size_t count;
+    size_t per_block;
+    size_t blocks;
+
+    // Where the block index starts
+    size_t index;
+
+    // True if 'base' is our own mapping of a file
+    bool mapped;
+}
+archive_priv_t;
+
+// Where an archive is being written to
+typedef struct
+{
+    bytes_t * bytes;
+    int fd;
+    uint64_t offset;
+}
+sink_t;
+
+//------------------------------------------------------------------------|
+static inline uint32_t get_u32(const uint8_t * p)
+{
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) |
+           ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline uint64_t get_u64(const uint8_t * p)
+{
+    return (uint64_t) get_u32(p) | ((uint64_t) get_u32(p + 4) << 32);
+}
+
+static inline void put_u32(uint8_t * p, uint32_t value)
+{
+    p[0] = (uint8_t) value;
+    p[1] = (uint8_t) (value >> 8);
+    p[2] = (uint8_t) (value >> 16);
+    p[3] = (uint8_t) (value >> 24);
+}
+
+static inline void put_u64(uint8_t * p, uint64_t value)
+{
+    put_u32(p, (uint32_t) value);
+    put_u32(p + 4, (uint32_t) (value >> 32));
+}
+
+//------------------------------------------------------------------------|
+// Send bytes to the sink, retrying short writes to a descriptor
+static bool sink_write(sink_t * sink, const void * data, size_t size)
+{
+    const uint8_t * ptr = (const uint8_t *) data;
+    ssize_t written;
+
+    if (size == 0)
+    {
+        return true;
+    }
+
+    sink->offset += size;
+
+    if (NULL != sink->bytes)
+    {
+        sink->bytes->append(sink->bytes, data, size);
+        return true;
+    }
+
+    while (size > 0)
+    {
+        written = write(sink->fd, ptr, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            BLAMMO(ERROR, "write(%d) failed: %s\n", sink->fd, strerror(errno));
+            return false;
+        }
+
+        ptr += written;
+        size -= (size_t) written;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// Emit one block: its header, the table of record ends, then the data
+static bool sink_block(sink_t * sink, uint32_t * ends, size_t records,
+                       bytes_t * data)
+{
+    uint8_t header[BLOCK_HEADER_SIZE];
+    uint8_t table[ARCHIVE_PER_BLOCK * sizeof(uint32_t)];
+    size_t index;
+
+    put_u32(header, (uint32_t) records);
+    put_u32(header + 4, (uint32_t) data->size(data));
+
+    for (index = 0; index < records; index++)
+    {
+        put_u32(table + index * sizeof(uint32_t), ends[index]);
+    }
+
+    return sink_write(sink, header, sizeof(header)) &&
+           sink_write(sink, table, records * sizeof(uint32_t)) &&
+           sink_write(sink, data->data(data), data->size(data));
+}
+
+//------------------------------------------------------------------------|
+static bool archive_write(chain_t * chain, data_encode_f encode, sink_t * sink)
+{
+    size_t count = chain->length(chain);
+    size_t blocks = (count + ARCHIVE_PER_BLOCK - 1) / ARCHIVE_PER_BLOCK;
+    uint32_t ends[ARCHIVE_PER_BLOCK];
+    uint8_t header[HEADER_SIZE];
+    uint8_t trailer[TRAILER_SIZE];
+    uint8_t * index = NULL;
+    bytes_t * data = NULL;
+    size_t block = 0;
+    size_t records = 0;
+    size_t n;
+    bool result = false;
+
+    if (NULL == encode)
+    {
+        BLAMMO(ERROR, "archive requires a payload encoder\n");
+        return false;
+    }
+
+    index = (uint8_t *) malloc(blocks * sizeof(uint64_t) + 1);
+    data = bytes_pub.create("", 0);
+    if ((NULL == index) || (NULL == data))
+    {
+        BLAMMO(ERROR, "archive buffer allocation failed\n");
+        goto cleanup;
+    }
+
+    memcpy(header, header_magic, sizeof(header_magic));
+    put_u32(header + 4, ARCHIVE_VERSION);
+    put_u32(header + 8, ARCHIVE_PER_BLOCK);
+    put_u64(header + 12, (uint64_t) count);
+
+    if (!sink_write(sink, header, sizeof(header)))
+    {
+        goto cleanup;
+    }
+
+    chain->reset(chain);
+    for (n = 0; n < count; n++)
+    {
+        if (!encode(chain->data(chain), data))
+        {
+            BLAMMO(ERROR, "archive payload %zu failed to encode\n", n);
+            goto cleanup;
+        }
+
+        if (data->size(data) > UINT32_MAX)
+        {
+            BLAMMO(ERROR, "archive block %zu exceeds 4GB\n", block);
+            goto cleanup;
+        }
+
+        ends[records++] = (uint32_t) data->size(data);
+        chain->spin(chain, 1);
+
+        if ((records == ARCHIVE_PER_BLOCK) || (n + 1 == count))
+        {
+            put_u64(index + block * sizeof(uint64_t), sink->offset);
+            if (!sink_block(sink, ends, records, data))
+            {
+                goto cleanup;
+            }
+
+            // keep the buffer's memory for the next block
+            data->resize(data, 0);
+            records = 0;
+            block++;
+        }
+    }
+
+    put_u64(trailer, sink->offset);
+    put_u32(trailer + 8, (uint32_t) blocks);
+    memcpy(trailer + 12, trailer_magic, sizeof(trailer_magic));
+
+    result = sink_write(sink, index, blocks * sizeof(uint64_t)) &&
+             sink_write(sink, trailer, sizeof(trailer));
+
+cleanup:
+    if (NULL != data)
+    {
+        data->destroy(data);
+    }
+
+    free(index);
+    return result;
+}
+
+//------------------------------------------------------------------------|
+bool archive_write_bytes(chain_t * chain, data_encode_f encode, bytes_t * out)
+{
+    sink_t sink = { out, -1, 0 };
+    return archive_write(chain, encode, &sink);
+}
+
+//------------------------------------------------------------------------|
+bool archive_write_fd(chain_t * chain, data_encode_f encode, int fd)
+{
+    sink_t sink = { NULL, fd, 0 };
+    return archive_write(chain, encode, &sink);
+}
+
+//------------------------------------------------------------------------|
+bool archive_encode_bytes(const void * data, bytes_t * out)
+{
+    bytes_t * bytes = (bytes_t *) data;
+
+    if ((NULL != bytes) && (bytes->size(bytes) > 0))
+    {
+        out->append(out, bytes->data(bytes), bytes->size(bytes));
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+void * archive_decode_bytes(const void * data, size_t size)
+{
+    return bytes_pub.create(size ? data : "", size);
+}
+
+//------------------------------------------------------------------------|
+// Find a block and check that it lies within the archive.  Returns the
+// block header, or NULL if the block is damaged.
+static const uint8_t * archive_block(archive_priv_t * priv, size_t block,
+                                     size_t * records, size_t * size)
+{
+    uint64_t offset = get_u64(priv->base + priv->index +
+                              block * sizeof(uint64_t));
+    const uint8_t * header = NULL;
+    size_t expected = ((block + 1 < priv->blocks) ||
+                       (priv->count % priv->per_block == 0)) ?
+                      priv->per_block : priv->count % priv->per_block;
+
+    if ((offset < HEADER_SIZE) ||
+        (offset > priv->index - BLOCK_HEADER_SIZE))
+    {
+        BLAMMO(ERROR, "archive block %zu offset out of range\n", block);
+        return NULL;
+    }
+
+    header = priv->base + offset;
+    *records = get_u32(header);
+    *size = get_u32(header + 4);
+
+    if ((*records != expected) ||
+        (*records * sizeof(uint32_t) + *size >
+         priv->index - offset - BLOCK_HEADER_SIZE))
+    {
+        BLAMMO(ERROR, "archive block %zu is damaged\n", block);
+        return NULL;
+    }
+
+    return header;
+}
+
+//------------------------------------------------------------------------|
+// Locate record 'slot' within a block found by archive_block()
+static inline const uint8_t * archive_slot(const uint8_t * header,
+                                           size_t records, size_t size,
+                                           size_t slot, size_t * length)
+{
+    const uint8_t * ends = header + BLOCK_HEADER_SIZE;
+    size_t begin = slot ? get_u32(ends + (slot - 1) * sizeof(uint32_t)) : 0;
+    size_t end = get_u32(ends + slot * sizeof(uint32_t));
+
+    if ((begin > end) || (end > size))
+    {
+        BLAMMO(ERROR, "archive record has bad bounds %zu-%zu\n", begin, end);
+        return NULL;
+    }
+
+    *length = end - begin;
+    return ends + records * sizeof(uint32_t) + begin;
+}
+
+//------------------------------------------------------------------------|
+// Validate the fixed parts of an archive and fill in priv
+static bool archive_parse(archive_priv_t * priv, const uint8_t * base,
+                          size_t size)
+{
+    const uint8_t * trailer = base + size - TRAILER_SIZE;
+    uint64_t count, index;
+    size_t blocks;
+
+    if ((size < HEADER_SIZE + TRAILER_SIZE) ||
+        memcmp(base, header_magic, sizeof(header_magic)) ||
+        memcmp(trailer + 12, trailer_magic, sizeof(trailer_magic)))
+    {
+        BLAMMO(ERROR, "archive has no header or trailer\n");
+        return false;
+    }
+
+    if (get_u32(base + 4) != ARCHIVE_VERSION)
+    {
+        BLAMMO(ERROR, "archive version %u is not supported\n",
+               get_u32(base + 4));
+        return false;
+    }
+
+    priv->per_block = get_u32(base + 8);
+    count = get_u64(base + 12);
+    index = get_u64(trailer);
+    blocks = get_u32(trailer + 8);
+
+    if ((priv->per_block == 0) || (priv->per_block > ARCHIVE_PER_BLOCK) ||
+        (count > SIZE_MAX - priv->per_block) ||
+        (blocks != (count + priv->per_block - 1) / priv->per_block) ||
+        (blocks > (size - HEADER_SIZE - TRAILER_SIZE) / sizeof(uint64_t)) ||
+        (index < HEADER_SIZE) ||
+        (index != size - TRAILER_SIZE - blocks * sizeof(uint64_t)))
+    {
+        BLAMMO(ERROR, "archive header and trailer do not agree\n");
+        return false;
+    }
+
+    priv->base = base;
+    priv->size = size;
+    priv->count = (size_t) count;
+    priv->blocks = blocks;
+    priv->index = (size_t) index;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static archive_t * archive_create(const void * data, size_t size)
+{
+    archive_priv_t priv;
+
+    memset(&priv, 0, sizeof(archive_priv_t));
+    if ((NULL == data) || !archive_parse(&priv, (const uint8_t *) data, size))
+    {
+        return NULL;
+    }
+
+    // Allocate and initialize public interface
+    archive_t * archive = (archive_t *) malloc(sizeof(archive_t));
+    if (!archive)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(archive_t)) failed");
+        return NULL;
+    }
+
+    // bulk copy all function pointers and init opaque ptr
+    memcpy(archive, &archive_pub, sizeof(archive_t));
+
+    // Allocate and initialize private implementation
+    archive->priv = malloc(sizeof(archive_priv_t));
+    if (!archive->priv)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(archive_priv_t)) failed");
+        free(archive);
+        return NULL;
+    }
+
+    memcpy(archive->priv, &priv, sizeof(archive_priv_t));
+    return archive;
+}
+
+//------------------------------------------------------------------------|
+static archive_t * archive_map(int fd)
+{
+    archive_t * archive = NULL;
+    struct stat st;
+    void * base = NULL;
+
+    if (fstat(fd, &st) < 0)
+    {
+        BLAMMO(ERROR, "fstat(%d) failed: %s\n", fd, strerror(errno));
+        return NULL;
+    }
+
+    if (st.st_size < HEADER_SIZE + TRAILER_SIZE)
+    {
+        BLAMMO(ERROR, "archive file is too small\n");
+        return NULL;
+    }
+
+    base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == base)
+    {
+        BLAMMO(ERROR, "mmap(%d) failed: %s\n", fd, strerror(errno));
+        return NULL;
+    }
+
+    archive = archive_create(base, (size_t) st.st_size);
+    if (NULL == archive)
+    {
+        munmap(base, (size_t) st.st_size);
+        return NULL;
+    }
+
+    ((archive_priv_t *) archive->priv)->mapped = true;
+    return archive;
+}
+
+//------------------------------------------------------------------------|
+static void archive_destroy(void * archive_ptr)
+{
+    archive_t * archive = (archive_t *) archive_ptr;
+    archive_priv_t * priv = NULL;
+
+    // guard against accidental double-destroy or early-destroy
+    if (!archive || !archive->priv)
+    {
+        BLAMMO(WARNING, "attempt to early or double-destroy\n");
+        return;
+    }
+
+    priv = (archive_priv_t *) archive->priv;
+    if (priv->mapped)
+    {
+        munmap((void *) priv->base, priv->size);
+    }
+
+    // zero out and destroy the private data
+    memset(archive->priv, 0, sizeof(archive_priv_t));
+    free(archive->priv);
+
+    // zero out and destroy the public interface
+    memset(archive, 0, sizeof(archive_t));
+    free(archive);
+}
+
+//------------------------------------------------------------------------|
+static inline size_t archive_length(archive_t * archive)
+{
+    return ((archive_priv_t *) archive->priv)->count;
+}
+
+//------------------------------------------------------------------------|
+static const void * archive_record(archive_t * archive, size_t index,
+                                   size_t * size)
+{
+    archive_priv_t * priv = (archive_priv_t *) archive->priv;
+    const uint8_t * header = NULL;
+    size_t records, bytes, length;
+    const uint8_t * record = NULL;
+
+    if (index >= priv->count)
+    {
+        return NULL;
+    }
+
+    header = archive_block(priv, index / priv->per_block, &records, &bytes);
+    if (NULL == header)
+    {
+        return NULL;
+    }
+
+    record = archive_slot(header, records, bytes, index % priv->per_block,
+                          &length);
+    if ((NULL != record) && (NULL != size))
+    {
+        *size = length;
+    }
+
+    return record;
+}
+
+//------------------------------------------------------------------------|
+static bool archive_load(archive_t * archive, chain_t * chain,
+                         data_decode_f decode)
+{
+    archive_priv_t * priv = (archive_priv_t *) archive->priv;
+    const uint8_t * header = NULL;
+    const uint8_t * record = NULL;
+    void * payload = NULL;
+    size_t block, slot, records, size, length;
+
+    if (!chain->reserve(chain, priv->count))
+    {
+        return false;
+    }
+
+    // walk block by block rather than looking up each record afresh
+    for (block = 0; block < priv->blocks; block++)
+    {
+        header = archive_block(priv, block, &records, &size);
+        if (NULL == header)
+        {
+            return false;
+        }
+
+        for (slot = 0; slot < records; slot++)
+        {
+            record = archive_slot(header, records, size, slot, &length);
+            if (NULL == record)
+            {
+                return false;
+            }
+
+            payload = decode ? decode(record, length) : (void *) record;
+            if (NULL == payload)
+            {
+                BLAMMO(ERROR, "archive record %zu of block %zu failed to "
+                    "decode\n", slot, block);
+                return false;
+            }
+
+            chain->insert(chain, payload);
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+const archive_t archive_pub = {
+    &archive_create,
+    &archive_map,
+    &archive_destroy,
+    &archive_length,
+    &archive_record,
+    &archive_load,
+    NULL
+};
@@ -0,0 +1,115 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include "chain.h"
+#include "bytes.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A compact binary form for the payloads of a chain, and a reader for it
+// that works in place over a buffer or a memory-mapped file.
+//
+// Each payload is turned into bytes by an encoder callback and stored as
+// one record.  Records are grouped into blocks of a fixed number of
+// records, each block prefixed by a table of where its records end, and
+// an index of block offsets at the end allows any record to be found in
+// constant time:
+//
+//     header   "RTLA"  u32 version  u32 per_block  u64 count
+//     block    u32 records  u32 size  u32 end[records]  size bytes
+//     ...
+//     index    u64 block offset[blocks]
+//     trailer  u64 index offset  u32 blocks  "ALTR"
+//
+// All integers are little-endian.  Because the reader only needs the
+// header, trailer and index up front, a mapped archive costs almost
+// nothing to open, and records are only touched as they are asked for.
+
+// Function pointer type for a payload encoder.  It appends the encoding
+// of 'data' to 'out', and returns false on failure.
+typedef bool (*data_encode_f) (const void * data, struct bytes_t * out);
+
+// Function pointer type for a payload decoder.  It returns a new payload
+// built from the encoded record, which is only valid during the call, or
+// NULL on failure.
+typedef void * (*data_decode_f) (const void * data, size_t size);
+
+//------------------------------------------------------------------------|
+typedef struct archive_t
+{
+    // Factory function that opens an archive over a buffer in memory.
+    // The buffer is not copied, and must outlive the archive.  Returns
+    // NULL if the buffer does not hold a well-formed archive.
+    struct archive_t * (*create)(const void * data, size_t size);
+
+    // Factory function that opens an archive by mapping a whole file
+    // read-only, given a descriptor open for reading.  The descriptor may
+    // be closed afterward.  Returns NULL on failure.
+    struct archive_t * (*map)(int fd);
+
+    // Archive destructor function.  Unmaps the file, if mapped.
+    void (*destroy)(void * archive);
+
+    // Get the number of records in the archive
+    size_t (*length)(struct archive_t * archive);
+
+    // Get a record in place, and its size, or NULL if 'index' is out of
+    // range or the record is damaged.
+    const void * (*record)(struct archive_t * archive, size_t index,
+                           size_t * size);
+
+    // Decode every record and insert the payloads after the current link
+    // of 'chain', reserving room for all of them first.  With a compact
+    // chain this is one arena allocation.  If 'decode' is NULL the chain
+    // gets pointers to the records themselves, which stay valid only as
+    // long as the archive.  Returns false on failure, having inserted
+    // whatever was decoded before it.
+    bool (*load)(struct archive_t * archive, struct chain_t * chain,
+                 data_decode_f decode);
+
+    // Private data
+    void * priv;
+}
+archive_t;
+
+//------------------------------------------------------------------------|
+// Write every payload of 'chain' as an archive, in order from its origin,
+// either appended to a bytes object or to a file descriptor.  Returns
+// false if encoding or writing fails.
+bool archive_write_bytes(struct chain_t * chain, data_encode_f encode,
+                         struct bytes_t * out);
+bool archive_write_fd(struct chain_t * chain, data_encode_f encode, int fd);
+
+// Encoder and decoder for chains of bytes_t payloads
+bool archive_encode_bytes(const void * data, struct bytes_t * out);
+void * archive_decode_bytes(const void * data, size_t size);
+
+//------------------------------------------------------------------------|
+// Public archive interface
+extern const archive_t archive_pub;
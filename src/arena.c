@@ -0,0 +1,462 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "arena.h"
+#include "blammo.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------|
+// A chunk of arena memory.  The usable bytes follow the header.  Chunks
+// form a list in the order they are filled, and those after the current
+// chunk are spares left over from before a rewind or reset.
+typedef struct chunk_t
+{
+    struct chunk_t * next;
+
+    // Usable bytes in this chunk, and how many are handed out
+    size_t size;
+    size_t used;
+}
+chunk_t;
+
+// arena private implementation data
+typedef struct
+{
+    // First chunk and the one being allocated from, or NULL for none
+    chunk_t * head;
+    chunk_t * current;
+
+    // Minimum size of new chunks
+    size_t chunk_size;
+
+    // Running totals
+    size_t chunks;
+    size_t capacity;
+    size_t used;
+    size_t peak;
+    uint64_t allocations;
+    uint64_t resets;
+
+    // The arena as an allocator, with itself as context
+    allocator_t allocator;
+}
+arena_priv_t;
+
+//------------------------------------------------------------------------|
+static inline uint8_t * chunk_data(chunk_t * chunk)
+{
+    return (uint8_t *) (chunk + 1);
+}
+
+// Padding needed before the next allocation in a chunk to reach 'align'
+static inline size_t chunk_pad(chunk_t * chunk, size_t align)
+{
+    uintptr_t top = (uintptr_t) (chunk_data(chunk) + chunk->used);
+    return (size_t) (-top & (align - 1));
+}
+
+// Returns true if 'size' bytes at 'align' fit in what is left of a chunk
+static inline bool chunk_fits(chunk_t * chunk, size_t size, size_t align)
+{
+    size_t pad = chunk_pad(chunk, align);
+    return (pad <= chunk->size - chunk->used) &&
+           (size <= chunk->size - chunk->used - pad);
+}
+
+// Hand out the next 'size' bytes at 'align' from a chunk known to fit them
+static inline void * arena_take(arena_priv_t * priv, chunk_t * chunk,
+                                size_t size, size_t align)
+{
+    size_t bump = chunk_pad(chunk, align) + size;
+    uint8_t * ptr = chunk_data(chunk) + chunk->used + bump - size;
+
+    chunk->used += bump;
+    priv->used += bump;
+    priv->allocations++;
+
+    if (priv->used > priv->peak)
+    {
+        priv->peak = priv->used;
+    }
+
+    return ptr;
+}
+
+//------------------------------------------------------------------------|
+// Slow path: move on to the next spare chunk if it fits, or else allocate
+// a new one after the current chunk.  The tail of the current chunk is
+// abandoned until the next rewind or reset.
+static void * arena_grow(arena_priv_t * priv, size_t size, size_t align)
+{
+    chunk_t * next = priv->current ? priv->current->next : priv->head;
+    chunk_t * chunk = NULL;
+    size_t need;
+
+    if (next)
+    {
+        next->used = 0;
+        if (chunk_fits(next, size, align))
+        {
+            priv->current = next;
+            return arena_take(priv, next, size, align);
+        }
+    }
+
+    if (size > SIZE_MAX - sizeof(chunk_t) - align)
+    {
+        BLAMMO(ERROR, "arena allocation of %zu bytes too large\n", size);
+        return NULL;
+    }
+
+    need = size + align - 1;
+    if (need < priv->chunk_size)
+    {
+        need = priv->chunk_size;
+    }
+
+    chunk = (chunk_t *) malloc(sizeof(chunk_t) + need);
+    if (!chunk)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(chunk_t) + %zu) failed\n", need);
+        return NULL;
+    }
+
+    chunk->size = need;
+    chunk->used = 0;
+    chunk->next = next;
+
+    if (priv->current)
+    {
+        priv->current->next = chunk;
+    }
+    else
+    {
+        priv->head = chunk;
+    }
+
+    priv->current = chunk;
+    priv->chunks++;
+    priv->capacity += need;
+    return arena_take(priv, chunk, size, align);
+}
+
+//------------------------------------------------------------------------|
+static void * arena_alloc_aligned(arena_t * arena, size_t size,
+                                  size_t align)
+{
+    arena_priv_t * priv = (arena_priv_t *) arena->priv;
+
+    if (align == 0 || (align & (align - 1)) != 0)
+    {
+        BLAMMO(ERROR, "arena alignment %zu is not a power of two\n", align);
+        return NULL;
+    }
+
+    if (priv->current && chunk_fits(priv->current, size, align))
+    {
+        return arena_take(priv, priv->current, size, align);
+    }
+
+    return arena_grow(priv, size, align);
+}
+
+//------------------------------------------------------------------------|
+static void * arena_alloc(arena_t * arena, size_t size)
+{
+    return arena_alloc_aligned(arena, size, ARENA_ALIGN);
+}
+
+//------------------------------------------------------------------------|
+static void * arena_dup(arena_t * arena, const void * data, size_t size)
+{
+    void * ptr = arena_alloc(arena, size);
+
+    if (ptr && size > 0)
+    {
+        memcpy(ptr, data, size);
+    }
+
+    return ptr;
+}
+
+//------------------------------------------------------------------------|
+static arena_marker_t arena_mark(arena_t * arena)
+{
+    arena_priv_t * priv = (arena_priv_t *) arena->priv;
+    arena_marker_t marker = { priv->current, 0 };
+
+    if (priv->current)
+    {
+        marker.used = priv->current->used;
+    }
+
+    return marker;
+}
+
+//------------------------------------------------------------------------|
+static void arena_rewind(arena_t * arena, arena_marker_t marker)
+{
+    arena_priv_t * priv = (arena_priv_t *) arena->priv;
+    chunk_t * chunk = priv->head;
+
+    if (!marker.chunk)
+    {
+        arena->reset(arena);
+        return;
+    }
+
+    // recount what is still in use up to the marked chunk
+    priv->used = 0;
+    while (chunk != (chunk_t *) marker.chunk)
+    {
+        priv->used += chunk->used;
+        chunk = chunk->next;
+    }
+
+    chunk->used = marker.used;
+    priv->used += marker.used;
+    priv->current = chunk;
+}
+
+//------------------------------------------------------------------------|
+static void arena_reset(arena_t * arena)
+{
+    arena_priv_t * priv = (arena_priv_t *) arena->priv;
+
+    priv->current = priv->head;
+    if (priv->head)
+    {
+        priv->head->used = 0;
+    }
+
+    priv->used = 0;
+    priv->resets++;
+}
+
+//------------------------------------------------------------------------|
+// Free a list of chunks, updating the totals
+static void arena_free_chunks(arena_priv_t * priv, chunk_t * chunk)
+{
+    chunk_t * next = NULL;
+
+    while (chunk)
+    {
+        next = chunk->next;
+        priv->chunks--;
+        priv->capacity -= chunk->size;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+//------------------------------------------------------------------------|
+static void arena_trim(arena_t * arena)
+{
+    arena_priv_t * priv = (arena_priv_t *) arena->priv;
+
+    // an empty arena has no current chunk worth keeping
+    if (priv->current == priv->head && priv->used == 0)
+    {
+        arena_free_chunks(priv, priv->head);
+        priv->head = NULL;
+        priv->current = NULL;
+        return;
+    }
+
+    arena_free_chunks(priv, priv->current->next);
+    priv->current->next = NULL;
+}
+
+//------------------------------------------------------------------------|
+static void arena_stats(arena_t * arena, arena_stats_t * stats)
+{
+    arena_priv_t * priv = (arena_priv_t *) arena->priv;
+
+    stats->chunks = priv->chunks;
+    stats->capacity = priv->capacity;
+    stats->used = priv->used;
+    stats->peak = priv->peak;
+    stats->allocations = priv->allocations;
+    stats->resets = priv->resets;
+}
+
+//------------------------------------------------------------------------|
+static const allocator_t * arena_allocator(arena_t * arena)
+{
+    return &((arena_priv_t *) arena->priv)->allocator;
+}
+
+//------------------------------------------------------------------------|
+// Returns true if 'ptr' of 'size' bytes is the most recent allocation
+static inline bool arena_is_top(arena_priv_t * priv, void * ptr,
+                                size_t size)
+{
+    chunk_t * chunk = priv->current;
+    return chunk && ((uint8_t *) ptr + size ==
+                     chunk_data(chunk) + chunk->used);
+}
+
+//------------------------------------------------------------------------|
+static void * arena_allocator_alloc(void * context, size_t size)
+{
+    return arena_alloc((arena_t *) context, size);
+}
+
+//------------------------------------------------------------------------|
+// The most recent allocation grows or shrinks in place while it fits.
+// Anything else moves, leaving the old block behind.
+static void * arena_allocator_realloc(void * context, void * ptr,
+                                      size_t old_size, size_t size)
+{
+    arena_t * arena = (arena_t *) context;
+    arena_priv_t * priv = (arena_priv_t *) arena->priv;
+    chunk_t * chunk = priv->current;
+    void * result = NULL;
+
+    if (!ptr)
+    {
+        return arena_alloc(arena, size);
+    }
+
+    if (arena_is_top(priv, ptr, old_size) &&
+        (uint8_t *) ptr + size <= chunk_data(chunk) + chunk->size)
+    {
+        chunk->used = chunk->used - old_size + size;
+        priv->used = priv->used - old_size + size;
+
+        if (priv->used > priv->peak)
+        {
+            priv->peak = priv->used;
+        }
+
+        return ptr;
+    }
+
+    if (size <= old_size)
+    {
+        return ptr;
+    }
+
+    result = arena_alloc(arena, size);
+    if (result)
+    {
+        memcpy(result, ptr, old_size);
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------|
+// Only the most recent allocation can be given back
+static void arena_allocator_free(void * context, void * ptr, size_t size)
+{
+    arena_priv_t * priv = (arena_priv_t *) ((arena_t *) context)->priv;
+
+    if (arena_is_top(priv, ptr, size))
+    {
+        priv->current->used -= size;
+        priv->used -= size;
+    }
+}
+
+//------------------------------------------------------------------------|
+static arena_t * arena_create(size_t chunk_size)
+{
+    arena_priv_t * priv = NULL;
+
+    // Allocate and initialize public interface
+    arena_t * arena = (arena_t *) malloc(sizeof(arena_t));
+    if (!arena)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(arena_t)) failed");
+        return NULL;
+    }
+
+    // bulk copy all function pointers and init opaque ptr
+    memcpy(arena, &arena_pub, sizeof(arena_t));
+
+    // Allocate and initialize private implementation
+    arena->priv = malloc(sizeof(arena_priv_t));
+    if (!arena->priv)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(arena_priv_t)) failed");
+        free(arena);
+        return NULL;
+    }
+
+    priv = (arena_priv_t *) arena->priv;
+    memset(priv, 0, sizeof(arena_priv_t));
+
+    priv->chunk_size = chunk_size ? chunk_size : ARENA_CHUNK;
+    priv->allocator.alloc = &arena_allocator_alloc;
+    priv->allocator.realloc = &arena_allocator_realloc;
+    priv->allocator.free = &arena_allocator_free;
+    priv->allocator.context = arena;
+
+    return arena;
+}
+
+//------------------------------------------------------------------------|
+static void arena_destroy(void * arena_ptr)
+{
+    arena_t * arena = (arena_t *) arena_ptr;
+
+    // guard against accidental double-destroy or early-destroy
+    if (!arena || !arena->priv)
+    {
+        BLAMMO(WARNING, "attempt to early or double-destroy\n");
+        return;
+    }
+
+    arena_free_chunks((arena_priv_t *) arena->priv,
+                      ((arena_priv_t *) arena->priv)->head);
+
+    // zero out and destroy the private data
+    memset(arena->priv, 0, sizeof(arena_priv_t));
+    free(arena->priv);
+
+    // zero out and destroy the public interface
+    memset(arena, 0, sizeof(arena_t));
+    free(arena);
+}
+
+//------------------------------------------------------------------------|
+const arena_t arena_pub = {
+    &arena_create,
+    &arena_destroy,
+    &arena_alloc,
+    &arena_alloc_aligned,
+    &arena_dup,
+    &arena_mark,
+    &arena_rewind,
+    &arena_reset,
+    &arena_trim,
+    &arena_stats,
+    &arena_allocator,
+    NULL
+};
@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include "allocator.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A bump-pointer region allocator.  Memory is handed out sequentially from
+// large chunks, so an allocation is an alignment round-up and an add, and
+// nothing is ever freed individually.  Everything allocated since a marker
+// is released at once by rewinding to it, and everything at all by reset.
+//
+// Chunks are kept across rewind and reset for reuse, so an arena that is
+// reset at the end of every request settles into making no calls to
+// malloc() at all.  trim() returns the spare chunks.
+//
+// The arena also presents itself as an allocator_t, so that chains and
+// bytes can be created on it with create_with() and bytes_create_with().
+// Such objects need not be destroyed: a reset reclaims them along with
+// everything else, but does not run their payload destructors, and they
+// must not be used, or destroyed, afterwards.  Freeing through the
+// allocator only reclaims the block if it is the most recent allocation.
+//
+// Arenas are not thread-safe.
+
+// Default alignment, suitable for any standard type
+#define ARENA_ALIGN     (2 * sizeof(void *))
+
+// Default chunk size, used when create() is given 0
+#define ARENA_CHUNK     (64 * 1024)
+
+// A position in the arena to rewind to, from mark()
+typedef struct
+{
+    void * chunk;
+    size_t used;
+}
+arena_marker_t;
+
+// Current totals.  'used' counts bytes handed out, including alignment
+// padding, and 'peak' its high-water mark since creation.  'capacity' is
+// the size of all chunks, in use or spare.
+typedef struct
+{
+    size_t chunks;
+    size_t capacity;
+    size_t used;
+    size_t peak;
+    uint64_t allocations;
+    uint64_t resets;
+}
+arena_stats_t;
+
+typedef struct arena_t
+{
+    // Factory function that creates an arena.  Chunks will be at least
+    // 'chunk_size' bytes, or ARENA_CHUNK if 0.  Larger allocations get a
+    // chunk of their own.  No memory is allocated until first use.
+    struct arena_t * (*create)(size_t chunk_size);
+
+    // Arena destructor function, releasing all chunks
+    void (*destroy)(void * arena);
+
+    // Allocate 'size' bytes at ARENA_ALIGN, or NULL on failure
+    void * (*alloc)(struct arena_t * arena, size_t size);
+
+    // Allocate 'size' bytes at 'align', which must be a power of two
+    void * (*alloc_aligned)(struct arena_t * arena, size_t size,
+                            size_t align);
+
+    // Copy a block into the arena
+    void * (*dup)(struct arena_t * arena, const void * data, size_t size);
+
+    // Get the current position, to rewind to later
+    arena_marker_t (*mark)(struct arena_t * arena);
+
+    // Release everything allocated since 'marker' was taken.  Markers
+    // taken after it become invalid.
+    void (*rewind)(struct arena_t * arena, arena_marker_t marker);
+
+    // Release everything, keeping the chunks for reuse
+    void (*reset)(struct arena_t * arena);
+
+    // Free the chunks not currently in use
+    void (*trim)(struct arena_t * arena);
+
+    // Get the current totals
+    void (*stats)(struct arena_t * arena, arena_stats_t * stats);
+
+    // Get an allocator that allocates from this arena, valid for the
+    // lifetime of the arena
+    const allocator_t * (*allocator)(struct arena_t * arena);
+
+    // Private data
+    void * priv;
+}
+arena_t;
+
+//------------------------------------------------------------------------|
+// Public arena interface
+extern const arena_t arena_pub;
@@ -0,0 +1,943 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "btree.h"
+#include "blammo.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+//------------------------------------------------------------------------|
+// Maximum payloads per leaf, and separator keys per internal node.  Nodes
+// other than the root never hold fewer than half this many.
+#define BTREE_MAX       32
+#define BTREE_MIN       (BTREE_MAX / 2)
+
+//------------------------------------------------------------------------|
+// Common node header.  Leaf keys are the payloads themselves.  Internal
+// node keys are separators: keys[i] is the least payload in the subtree
+// under children[i + 1], so every separator is a live payload pointer.
+// Each array has room for one extra entry so that a node can overflow
+// briefly before it is split.
+typedef struct node_t
+{
+    bool leaf;
+    size_t count;
+    void * keys[BTREE_MAX + 1];
+}
+node_t;
+
+typedef struct leaf_t
+{
+    node_t node;
+    struct leaf_t * next;
+    struct leaf_t * prev;
+}
+leaf_t;
+
+typedef struct
+{
+    node_t node;
+    node_t * children[BTREE_MAX + 2];
+}
+inner_t;
+
+// B+tree private implementation data
+typedef struct
+{
+    // Root node, or NULL if empty
+    node_t * root;
+
+    // Number of payloads
+    size_t length;
+
+    // Cursor leaf and index within it.  NULL leaf means invalid.
+    leaf_t * leaf;
+    size_t index;
+
+    // The payload comparator and destructor
+    data_compare_f data_compare;
+    data_destroy_f data_destroy;
+}
+btree_priv_t;
+
+// Outcome of a recursive insert
+typedef enum
+{
+    INSERT_FAILED,
+    INSERT_ADDED,
+    INSERT_REPLACED,
+    INSERT_SPLIT
+}
+insert_t;
+
+//------------------------------------------------------------------------|
+static inline int btree_cmp(btree_priv_t * priv, const void * a, const void * b)
+{
+    return priv->data_compare(&a, &b);
+}
+
+#define INNER(n)    ((inner_t *) (n))
+#define LEAF(n)     ((leaf_t *) (n))
+
+//------------------------------------------------------------------------|
+static node_t * node_create(bool leaf)
+{
+    node_t * node = (node_t *) calloc(1, leaf ? sizeof(leaf_t) : sizeof(inner_t));
+    if (NULL == node)
+    {
+        BLAMMO(ERROR, "calloc() node failed\n");
+        return NULL;
+    }
+
+    node->leaf = leaf;
+    return node;
+}
+
+//------------------------------------------------------------------------|
+// Free a subtree, destroying payloads if a destructor is given
+static void node_destroy(node_t * node, data_destroy_f data_destroy)
+{
+    size_t index;
+
+    if (node->leaf)
+    {
+        for (index = 0; data_destroy && (index < node->count); index++)
+        {
+            if (NULL != node->keys[index])
+            {
+                data_destroy(node->keys[index]);
+            }
+        }
+    }
+    else
+    {
+        for (index = 0; index <= node->count; index++)
+        {
+            node_destroy(INNER(node)->children[index], data_destroy);
+        }
+    }
+
+    free(node);
+}
+
+//------------------------------------------------------------------------|
+static inline void * node_min(node_t * node)
+{
+    while (!node->leaf)
+    {
+        node = INNER(node)->children[0];
+    }
+
+    return node->keys[0];
+}
+
+//------------------------------------------------------------------------|
+// Index of the first key not less than 'key' (lower bound) or greater
+// than 'key' (upper bound) within one node.
+static size_t node_search(btree_priv_t * priv, node_t * node,
+                          const void * key, bool upper)
+{
+    size_t lo = 0, hi = node->count, mid;
+    int cmp;
+
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        cmp = btree_cmp(priv, node->keys[mid], key);
+
+        if ((cmp < 0) || (upper && (cmp == 0)))
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+//------------------------------------------------------------------------|
+// Descend to the leaf whose range covers 'key'
+static leaf_t * node_descend(btree_priv_t * priv, const void * key)
+{
+    node_t * node = priv->root;
+
+    while (node && !node->leaf)
+    {
+        node = INNER(node)->children[node_search(priv, node, key, true)];
+    }
+
+    return LEAF(node);
+}
+
+//------------------------------------------------------------------------|
+static inline void array_insert(void ** array, size_t count, size_t at,
+                                void * item)
+{
+    memmove(&array[at + 1], &array[at], (count - at) * sizeof(void *));
+    array[at] = item;
+}
+
+static inline void array_remove(void ** array, size_t count, size_t at)
+{
+    memmove(&array[at], &array[at + 1], (count - at - 1) * sizeof(void *));
+}
+
+//------------------------------------------------------------------------|
+// Split an overflowing node in two.  Returns the new right-hand node and
+// the separator to insert into the parent, or NULL on failure.
+static node_t * node_split(node_t * node, void ** separator)
+{
+    node_t * right = node_create(node->leaf);
+    size_t half = node->count / 2;
+
+    if (NULL == right)
+    {
+        return NULL;
+    }
+
+    if (node->leaf)
+    {
+        // The right leaf takes the upper half, and its least payload
+        // becomes the separator, while also staying in the leaf.
+        right->count = node->count - half;
+        memcpy(right->keys, &node->keys[half], right->count * sizeof(void *));
+        node->count = half;
+        *separator = right->keys[0];
+
+        LEAF(right)->next = LEAF(node)->next;
+        LEAF(right)->prev = LEAF(node);
+        if (LEAF(node)->next)
+        {
+            LEAF(node)->next->prev = LEAF(right);
+        }
+        LEAF(node)->next = LEAF(right);
+    }
+    else
+    {
+        // The middle separator moves up and out of both halves
+        *separator = node->keys[half];
+        right->count = node->count - half - 1;
+        memcpy(right->keys, &node->keys[half + 1],
+               right->count * sizeof(void *));
+        memcpy(INNER(right)->children, &INNER(node)->children[half + 1],
+               (right->count + 1) * sizeof(node_t *));
+        node->count = half;
+    }
+
+    return right;
+}
+
+//------------------------------------------------------------------------|
+// Recursive insert.  On a split, the new right sibling and its separator
+// are passed back for the parent to take in.  On a replace, the old
+// payload is passed back through 'old' so that a separator referring to
+// it can be updated on the way back up.
+static insert_t node_insert(btree_priv_t * priv, node_t * node, void * data,
+                            void ** old, void ** separator, node_t ** right)
+{
+    size_t index = node_search(priv, node, data, !node->leaf);
+    insert_t result;
+
+    if (node->leaf)
+    {
+        if ((index < node->count) &&
+            (btree_cmp(priv, node->keys[index], data) == 0))
+        {
+            *old = node->keys[index];
+            node->keys[index] = data;
+            return INSERT_REPLACED;
+        }
+
+        array_insert(node->keys, node->count++, index, data);
+    }
+    else
+    {
+        result = node_insert(priv, INNER(node)->children[index], data,
+                             old, separator, right);
+
+        if (result == INSERT_REPLACED)
+        {
+            if ((index > 0) && (node->keys[index - 1] == *old))
+            {
+                node->keys[index - 1] = data;
+            }
+
+            return result;
+        }
+
+        if (result != INSERT_SPLIT)
+        {
+            return result;
+        }
+
+        array_insert(node->keys, node->count, index, *separator);
+        array_insert((void **) INNER(node)->children, node->count + 1,
+                     index + 1, *right);
+        node->count++;
+    }
+
+    if (node->count <= BTREE_MAX)
+    {
+        return INSERT_ADDED;
+    }
+
+    *right = node_split(node, separator);
+    return *right ? INSERT_SPLIT : INSERT_FAILED;
+}
+
+//------------------------------------------------------------------------|
+// Fix up children[index] of an internal node after it fell below the
+// minimum, by borrowing from a sibling or merging with one.
+static void node_rebalance(inner_t * parent, size_t index)
+{
+    node_t * child = parent->children[index];
+    node_t * left = (index > 0) ? parent->children[index - 1] : NULL;
+    node_t * right = (index < parent->node.count) ?
+                     parent->children[index + 1] : NULL;
+    node_t * merged = NULL;
+    size_t sep;
+
+    if (left && (left->count > BTREE_MIN))
+    {
+        if (child->leaf)
+        {
+            array_insert(child->keys, child->count, 0,
+                         left->keys[left->count - 1]);
+            parent->node.keys[index - 1] = child->keys[0];
+        }
+        else
+        {
+            array_insert(child->keys, child->count, 0,
+                         parent->node.keys[index - 1]);
+            array_insert((void **) INNER(child)->children, child->count + 1,
+                         0, INNER(left)->children[left->count]);
+            parent->node.keys[index - 1] = left->keys[left->count - 1];
+        }
+
+        child->count++;
+        left->count--;
+        return;
+    }
+
+    if (right && (right->count > BTREE_MIN))
+    {
+        if (child->leaf)
+        {
+            child->keys[child->count] = right->keys[0];
+            array_remove(right->keys, right->count, 0);
+            parent->node.keys[index] = right->keys[0];
+        }
+        else
+        {
+            child->keys[child->count] = parent->node.keys[index];
+            INNER(child)->children[child->count + 1] = INNER(right)->children[0];
+            parent->node.keys[index] = right->keys[0];
+            array_remove(right->keys, right->count, 0);
+            array_remove((void **) INNER(right)->children, right->count + 1, 0);
+        }
+
+        child->count++;
+        right->count--;
+        return;
+    }
+
+    // Neither sibling can spare anything, so merge with one of them.
+    // Afterwards 'left' absorbs 'merged' which sits at children[sep + 1].
+    if (left)
+    {
+        merged = child;
+        sep = index - 1;
+    }
+    else
+    {
+        left = child;
+        merged = right;
+        sep = index;
+    }
+
+    if (left->leaf)
+    {
+        memcpy(&left->keys[left->count], merged->keys,
+               merged->count * sizeof(void *));
+        left->count += merged->count;
+
+        LEAF(left)->next = LEAF(merged)->next;
+        if (LEAF(merged)->next)
+        {
+            LEAF(merged)->next->prev = LEAF(left);
+        }
+    }
+    else
+    {
+        left->keys[left->count] = parent->node.keys[sep];
+        memcpy(&left->keys[left->count + 1], merged->keys,
+               merged->count * sizeof(void *));
+        memcpy(&INNER(left)->children[left->count + 1],
+               INNER(merged)->children,
+               (merged->count + 1) * sizeof(node_t *));
+        left->count += merged->count + 1;
+    }
+
+    array_remove(parent->node.keys, parent->node.count, sep);
+    array_remove((void **) parent->children, parent->node.count + 1, sep + 1);
+    parent->node.count--;
+    free(merged);
+}
+
+//------------------------------------------------------------------------|
+// Recursive erase.  The removed payload is passed back through 'old', not
+// yet destroyed, so that a separator referring to it can be replaced on
+// the way back up before anything dereferences it.
+static bool node_erase(btree_priv_t * priv, node_t * node, const void * key,
+                       void ** old)
+{
+    size_t index = node_search(priv, node, key, !node->leaf);
+    node_t * child = NULL;
+
+    if (node->leaf)
+    {
+        if ((index >= node->count) ||
+            (btree_cmp(priv, node->keys[index], key) != 0))
+        {
+            return false;
+        }
+
+        *old = node->keys[index];
+        array_remove(node->keys, node->count--, index);
+        return true;
+    }
+
+    child = INNER(node)->children[index];
+    if (!node_erase(priv, child, key, old))
+    {
+        return false;
+    }
+
+    if ((index > 0) && (node->keys[index - 1] == *old))
+    {
+        node->keys[index - 1] = node_min(child);
+    }
+
+    if (child->count < BTREE_MIN)
+    {
+        node_rebalance(INNER(node), index);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static btree_t * btree_create(data_destroy_f data_destroy,
+                              data_compare_f data_compare)
+{
+    if (NULL == data_compare)
+    {
+        BLAMMO(ERROR, "btree requires a data comparator\n");
+        return NULL;
+    }
+
+    // Allocate and initialize public interface
+    btree_t * tree = (btree_t *) malloc(sizeof(btree_t));
+    if (!tree)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(btree_t)) failed");
+        return NULL;
+    }
+
+    // bulk copy all function pointers and init opaque ptr
+    memcpy(tree, &btree_pub, sizeof(btree_t));
+
+    // Allocate and initialize private implementation
+    tree->priv = malloc(sizeof(btree_priv_t));
+    if (!tree->priv)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(btree_priv_t)) failed");
+        free(tree);
+        return NULL;
+    }
+
+    memset(tree->priv, 0, sizeof(btree_priv_t));
+    ((btree_priv_t *) tree->priv)->data_destroy = data_destroy;
+    ((btree_priv_t *) tree->priv)->data_compare = data_compare;
+
+    return tree;
+}
+
+//------------------------------------------------------------------------|
+static void btree_destroy(void * tree_ptr)
+{
+    btree_t * tree = (btree_t *) tree_ptr;
+
+    // guard against accidental double-destroy or early-destroy
+    if (!tree || !tree->priv)
+    {
+        BLAMMO(WARNING, "attempt to early or double-destroy\n");
+        return;
+    }
+
+    tree->clear(tree);
+
+    // zero out and destroy the private data
+    memset(tree->priv, 0, sizeof(btree_priv_t));
+    free(tree->priv);
+
+    // zero out and destroy the public interface
+    memset(tree, 0, sizeof(btree_t));
+    free(tree);
+}
+
+//------------------------------------------------------------------------|
+static inline size_t btree_length(btree_t * tree)
+{
+    return ((btree_priv_t *) tree->priv)->length;
+}
+
+//------------------------------------------------------------------------|
+static inline bool btree_empty(btree_t * tree)
+{
+    return (0 == ((btree_priv_t *) tree->priv)->length);
+}
+
+//------------------------------------------------------------------------|
+static void btree_clear(btree_t * tree)
+{
+    btree_priv_t * priv = (btree_priv_t *) tree->priv;
+
+    if (NULL != priv->root)
+    {
+        node_destroy(priv->root, priv->data_destroy);
+    }
+
+    priv->root = NULL;
+    priv->length = 0;
+    priv->leaf = NULL;
+    priv->index = 0;
+}
+
+//------------------------------------------------------------------------|
+static bool btree_insert(btree_t * tree, void * data)
+{
+    btree_priv_t * priv = (btree_priv_t *) tree->priv;
+    void * old = NULL;
+    void * separator = NULL;
+    node_t * right = NULL;
+    node_t * root = NULL;
+
+    priv->leaf = NULL;
+
+    if (NULL == priv->root)
+    {
+        priv->root = node_create(true);
+        if (NULL == priv->root)
+        {
+            return false;
+        }
+    }
+
+    switch (node_insert(priv, priv->root, data, &old, &separator, &right))
+    {
+        case INSERT_FAILED:
+            return false;
+
+        case INSERT_REPLACED:
+            if ((NULL != old) && (old != data) && (NULL != priv->data_destroy))
+            {
+                priv->data_destroy(old);
+            }
+            return true;
+
+        case INSERT_SPLIT:
+            // grow a new root above the two halves
+            root = node_create(false);
+            if (NULL == root)
+            {
+                node_destroy(right, NULL);
+                return false;
+            }
+
+            root->count = 1;
+            root->keys[0] = separator;
+            INNER(root)->children[0] = priv->root;
+            INNER(root)->children[1] = right;
+            priv->root = root;
+            break;
+
+        default:
+            break;
+    }
+
+    priv->length++;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool btree_erase(btree_t * tree, const void * key)
+{
+    btree_priv_t * priv = (btree_priv_t *) tree->priv;
+    node_t * root = priv->root;
+    void * old = NULL;
+
+    priv->leaf = NULL;
+
+    if ((NULL == root) || !node_erase(priv, root, key, &old))
+    {
+        return false;
+    }
+
+    // shrink the tree from the top when the root runs out of separators
+    if (!root->leaf && (root->count == 0))
+    {
+        priv->root = INNER(root)->children[0];
+        free(root);
+    }
+    else if (root->leaf && (root->count == 0))
+    {
+        priv->root = NULL;
+        free(root);
+    }
+
+    if ((NULL != old) && (NULL != priv->data_destroy))
+    {
+        priv->data_destroy(old);
+    }
+
+    priv->length--;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static void * btree_find(btree_t * tree, const void * key)
+{
+    btree_priv_t * priv = (btree_priv_t *) tree->priv;
+    leaf_t * leaf = node_descend(priv, key);
+    size_t index;
+
+    if (NULL == leaf)
+    {
+        return NULL;
+    }
+
+    index = node_search(priv, &leaf->node, key, false);
+    if ((index < leaf->node.count) &&
+        (btree_cmp(priv, leaf->node.keys[index], key) == 0))
+    {
+        return leaf->node.keys[index];
+    }
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------|
+// Settle the cursor onto a valid position, stepping to the next leaf if
+// it sits one past the end of the current leaf.
+static bool btree_settle(btree_priv_t * priv)
+{
+    while (priv->leaf && (priv->index >= priv->leaf->node.count))
+    {
+        priv->leaf = priv->leaf->next;
+        priv->index = 0;
+    }
+
+    return (NULL != priv->leaf);
+}
+
+//------------------------------------------------------------------------|
+static bool btree_reset(btree_t * tree)
+{
+    btree_priv_t * priv = (btree_priv_t *) tree->priv;
+    node_t * node = priv->root;
+
+    while (node && !node->leaf)
+    {
+        node = INNER(node)->children[0];
+    }
+
+    priv->leaf = LEAF(node);
+    priv->index = 0;
+    return btree_settle(priv);
+}
+
+//------------------------------------------------------------------------|
+static bool btree_bound(btree_t * tree, const void * key, bool upper)
+{
+    btree_priv_t * priv = (btree_priv_t *) tree->priv;
+
+    priv->leaf = node_descend(priv, key);
+    priv->index = priv->leaf ?
+                  node_search(priv, &priv->leaf->node, key, upper) : 0;
+    return btree_settle(priv);
+}
+
+//------------------------------------------------------------------------|
+static bool btree_lower(btree_t * tree, const void * key)
+{
+    return btree_bound(tree, key, false);
+}
+
+//------------------------------------------------------------------------|
+static bool btree_upper(btree_t * tree, const void * key)
+{
+    return btree_bound(tree, key, true);
+}
+
+//------------------------------------------------------------------------|
+static bool btree_next(btree_t * tree)
+{
+    btree_priv_t * priv = (btree_priv_t *) tree->priv;
+
+    if (NULL == priv->leaf)
+    {
+        return false;
+    }
+
+    priv->index++;
+    return btree_settle(priv);
+}
+
+//------------------------------------------------------------------------|
+static bool btree_prev(btree_t * tree)
+{
+    btree_priv_t * priv = (btree_priv_t *) tree->priv;
+
+    if (NULL == priv->leaf)
+    {
+        return false;
+    }
+
+    if (priv->index > 0)
+    {
+        priv->index--;
+        return true;
+    }
+
+    priv->leaf = priv->leaf->prev;
+    priv->index = priv->leaf ? priv->leaf->node.count - 1 : 0;
+    return (NULL != priv->leaf);
+}
+
+//------------------------------------------------------------------------|
+static void * btree_data(btree_t * tree)
+{
+    btree_priv_t * priv = (btree_priv_t *) tree->priv;
+
+    if (NULL == priv->leaf)
+    {
+        return NULL;
+    }
+
+    return priv->leaf->node.keys[priv->index];
+}
+
+//------------------------------------------------------------------------|
+// Build one level of the tree above 'nodes', in place.  The 'count' nodes
+// are split as evenly as possible among the fewest parents that can hold
+// them, so every parent ends up at least half full.  Returns the number
+// of parents, or 0 on failure in which case 'nodes' is left untouched.
+static size_t btree_build_level(node_t ** nodes, size_t count)
+{
+    size_t fanout = BTREE_MAX + 1;
+    size_t parents = (count + fanout - 1) / fanout;
+    size_t base = count / parents;
+    size_t extra = count % parents;
+    size_t next = 0;
+    size_t p, c, take;
+    node_t ** level = NULL;
+    node_t * parent;
+
+    level = (node_t **) malloc(parents * sizeof(node_t *));
+    if (NULL == level)
+    {
+        BLAMMO(ERROR, "malloc(%zu) failed\n", parents * sizeof(node_t *));
+        return 0;
+    }
+
+    for (p = 0; p < parents; p++)
+    {
+        level[p] = node_create(false);
+        if (NULL == level[p])
+        {
+            while (p-- > 0)
+            {
+                free(level[p]);
+            }
+
+            free(level);
+            return 0;
+        }
+    }
+
+    for (p = 0; p < parents; p++)
+    {
+        parent = level[p];
+        take = base + ((p < extra) ? 1 : 0);
+
+        for (c = 0; c < take; c++)
+        {
+            INNER(parent)->children[c] = nodes[next + c];
+            if (c > 0)
+            {
+                parent->keys[c - 1] = node_min(nodes[next + c]);
+            }
+        }
+
+        parent->count = take - 1;
+        next += take;
+    }
+
+    memcpy(nodes, level, parents * sizeof(node_t *));
+    free(level);
+    return parents;
+}
+
+//------------------------------------------------------------------------|
+static bool btree_load(btree_t * tree, chain_t * chain, data_copy_f data_copy)
+{
+    btree_priv_t * priv = (btree_priv_t *) tree->priv;
+    size_t count = chain->length(chain);
+    size_t leaves, parents, base, extra, l, i, take;
+    node_t ** nodes = NULL;
+    node_t * node = NULL;
+    leaf_t * prev = NULL;
+    void * last = NULL;
+    void * data = NULL;
+
+    if (NULL != priv->root)
+    {
+        BLAMMO(ERROR, "btree_load() requires an empty tree\n");
+        return false;
+    }
+
+    if (count == 0)
+    {
+        return true;
+    }
+
+    // verify strictly increasing order before taking anything
+    chain->reset(chain);
+    last = chain->data(chain);
+    while (chain->spin(chain, 1))
+    {
+        data = chain->data(chain);
+        if (btree_cmp(priv, last, data) >= 0)
+        {
+            BLAMMO(ERROR, "btree_load() chain is not strictly sorted\n");
+            return false;
+        }
+
+        last = data;
+    }
+
+    leaves = (count + BTREE_MAX - 1) / BTREE_MAX;
+    nodes = (node_t **) malloc(leaves * sizeof(node_t *));
+    if (NULL == nodes)
+    {
+        BLAMMO(ERROR, "malloc(%zu) failed\n", leaves * sizeof(node_t *));
+        return false;
+    }
+
+    // Fill the leaves as evenly as possible.  The chain is already back
+    // at its origin after the full revolution above.
+    base = count / leaves;
+    extra = count % leaves;
+    for (l = 0; l < leaves; l++)
+    {
+        node = node_create(true);
+        if (NULL == node)
+        {
+            break;
+        }
+
+        take = base + ((l < extra) ? 1 : 0);
+        for (i = 0; i < take; i++)
+        {
+            data = chain->data(chain);
+            node->keys[i] = data_copy ? data_copy(data) : data;
+            chain->spin(chain, 1);
+        }
+
+        node->count = take;
+        LEAF(node)->prev = prev;
+        if (prev)
+        {
+            prev->next = LEAF(node);
+        }
+
+        prev = LEAF(node);
+        nodes[l] = node;
+    }
+
+    // build internal levels until a single root remains
+    count = l;
+    parents = (l == leaves) ? count : 0;
+    while (parents > 1)
+    {
+        parents = btree_build_level(nodes, count);
+        count = parents ? parents : count;
+    }
+
+    if (parents == 0)
+    {
+        // Tear down whatever was built.  Only copies made here belong to
+        // the tree, so shared payloads are left alone.
+        BLAMMO(ERROR, "btree_load() node allocation failed\n");
+        for (i = 0; i < count; i++)
+        {
+            node_destroy(nodes[i], data_copy ? priv->data_destroy : NULL);
+        }
+
+        free(nodes);
+        return false;
+    }
+
+    priv->root = nodes[0];
+    priv->length = chain->length(chain);
+    priv->leaf = NULL;
+    free(nodes);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+const btree_t btree_pub = {
+    &btree_create,
+    &btree_destroy,
+    &btree_length,
+    &btree_empty,
+    &btree_clear,
+    &btree_insert,
+    &btree_erase,
+    &btree_find,
+    &btree_reset,
+    &btree_lower,
+    &btree_upper,
+    &btree_next,
+    &btree_prev,
+    &btree_data,
+    &btree_load,
+    NULL
+};
@@ -0,0 +1,116 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include "chain.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// An ordered container of data payloads, kept as a B+tree: payloads live
+// in wide leaf nodes that are linked together in order, so range scans
+// walk contiguous arrays instead of chasing a pointer per element.
+// Insert, erase and find are O(log n) with a small constant.
+//
+// As with chain_t sort(), payloads carry their own keys and are ordered
+// by a comparator of the form:
+//
+//     int compare(const void * a, const void * b)
+//     {
+//         mytype_t * aptr = (mytype_t *) *(void **) a;
+//         mytype_t * bptr = (mytype_t *) *(void **) b;
+//
+// Lookups take a 'key' argument which is a probe payload handed to the
+// same comparator.  No two payloads in the tree compare equal.
+//
+// The tree has an internal cursor for in-order iteration, positioned by
+// reset(), lower() or upper() and moved with next() and prev().  Any
+// insert or erase invalidates the cursor.
+typedef struct btree_t
+{
+    // Factory function that creates a B+tree.  The destructor callback
+    // follows the same rules as for chain_t create().  A comparator is
+    // required.
+    struct btree_t * (*create)(data_destroy_f data_destroy,
+                               data_compare_f data_compare);
+
+    // B+tree destructor function
+    void (*destroy)(void * tree);
+
+    // Get the number of payloads in the tree
+    size_t (*length)(struct btree_t * tree);
+
+    // Returns true if the tree is empty and false otherwise
+    bool (*empty)(struct btree_t * tree);
+
+    // Removes all payloads, destroying them, and releases all nodes
+    void (*clear)(struct btree_t * tree);
+
+    // Insert a payload.  If an equal payload is already present it is
+    // destroyed and replaced.  Returns false on allocation failure.
+    bool (*insert)(struct btree_t * tree, void * data);
+
+    // Remove the payload equal to 'key' and destroy it.  Returns false
+    // if there is no such payload.
+    bool (*erase)(struct btree_t * tree, const void * key);
+
+    // Get the payload equal to 'key', or NULL if there is none
+    void * (*find)(struct btree_t * tree, const void * key);
+
+    // Position the cursor at the first payload, returning false if empty
+    bool (*reset)(struct btree_t * tree);
+
+    // Position the cursor at the first payload not less than 'key', or
+    // greater than 'key' for upper().  Returns false if there is none.
+    bool (*lower)(struct btree_t * tree, const void * key);
+    bool (*upper)(struct btree_t * tree, const void * key);
+
+    // Move the cursor to the next or previous payload in order.  Returns
+    // false, leaving the cursor invalid, when moving past either end.
+    bool (*next)(struct btree_t * tree);
+    bool (*prev)(struct btree_t * tree);
+
+    // Get the payload at the cursor, or NULL if the cursor is invalid
+    void * (*data)(struct btree_t * tree);
+
+    // Bulk load an empty tree from a chain whose payloads are already in
+    // strictly increasing order, in O(n) and with densely packed nodes.
+    // The data_copy function (if not NULL) is called for each payload,
+    // otherwise the tree and chain share the payload pointers just as
+    // with chain_t copy().  Returns false if the tree is not empty or the
+    // chain is not sorted.
+    bool (*load)(struct btree_t * tree, struct chain_t * chain,
+                 data_copy_f data_copy);
+
+    // Private data
+    void * priv;
+}
+btree_t;
+
+//------------------------------------------------------------------------|
+// Public B+tree interface
+extern const btree_t btree_pub;
@@ -22,6 +22,12 @@
 //------------------------------------------------------------------------|
 
 #include "bytes.h"
+#include "numconv.h"
+#include "codec.h"
+#include "search.h"
+#include "hexdump.h"
+#include "view.h"
+#include "split.h"
 #include "blammo.h"
 
 #include <stdio.h>
@@ -33,51 +39,169 @@
 #include <stddef.h>
 
 //------------------------------------------------------------------------|
+// Contents up to this size are kept inside the private data, and only
+// longer contents are allocated separately.
+#define BYTES_INLINE    31
+
+// Separately allocated storage, shared by copies and splits of an object
+// until one of them writes to it, at which point that one takes its own.
+// The data is never written while more than one object refers to it.
+typedef struct
+{
+    // The number of objects referring to the storage, changed atomically
+    // so that objects sharing it can be used and destroyed from different
+    // threads
+    size_t refs;
+
+    // The number of bytes the data array holds, not counting terminator
+    size_t capacity;
+
+    uint8_t data[];
+}
+bytes_shared_t;
+
+// The largest capacity whose storage size can be represented
+#define BYTES_MAX_CAP   (SIZE_MAX - sizeof(bytes_shared_t) - 1)
+
+// Size of the storage for 'capacity' bytes plus terminator, or 0 if that
+// cannot be represented
+static inline size_t bytes_shared_size(size_t capacity)
+{
+    return capacity > BYTES_MAX_CAP ? 0 :
+           sizeof(bytes_shared_t) + capacity + 1;
+}
+
 // bytes private implementation data
 typedef struct
 {
-    // The total number of bytes allocated
+    // The number of bytes in use
     size_t size;
 
-    // The raw data array
+    // The number of bytes the data array holds, not counting the
+    // terminator.  Always at least 'size'.
+    size_t capacity;
+
+    // The raw data array, either 'small' or within the shared storage.  A
+    // split of another object may start part way into the storage, and
+    // is not necessarily terminated.
     uint8_t * data;
 
+    // The storage holding the data, or NULL if it is inline
+    bytes_shared_t * shared;
+
+    // Inline storage for short contents, plus terminator
+    uint8_t small[BYTES_INLINE + 1];
+
     // A report buffer used for hexdump, debugging, tokens? etc...
     // This is only used for certain calls, but otherwise left NULL.
     // it will be re-purposed as necessary and destroyed when the main
     // object is destroyed.
     bytes_t * buffer;
+
+    // Where all of this object's memory comes from
+    allocator_t allocator;
 }
 bytes_priv_t;
 
+// The public interface and private data share one allocation, and with
+// short contents inline that is the only one.  The interface is a full
+// copy of bytes_pub rather than a pointer to it, so that callers can
+// still call through the object itself.
+typedef struct
+{
+    bytes_t pub;
+    bytes_priv_t priv;
+}
+bytes_block_t;
+
 //------------------------------------------------------------------------|
-bytes_t * bytes_create(const void * data, size_t size)
+// Returns true if the data is held in the inline buffer
+static inline bool bytes_inline(bytes_priv_t * priv)
+{
+    return priv->data == priv->small;
+}
+
+// Point an empty object at its inline buffer
+static inline void bytes_init(bytes_priv_t * priv)
+{
+    priv->data = priv->small;
+    priv->capacity = BYTES_INLINE;
+    priv->shared = NULL;
+    priv->small[0] = 0;
+}
+
+// Returns true if the data may be written in place: it is inline, or this
+// is the only object referring to the storage and it starts at the data.
+// Once it is down to one reference, nobody else can add one.
+static inline bool bytes_unique(bytes_priv_t * priv)
+{
+    return NULL == priv->shared ||
+           (priv->data == priv->shared->data &&
+            1 == __atomic_load_n(&priv->shared->refs, __ATOMIC_ACQUIRE));
+}
+
+// Drop this object's reference to its storage, freeing it if that was
+// the last one
+static inline void bytes_release(bytes_priv_t * priv)
 {
-    // Allocate and initialize public interface
-    bytes_t * bytes = (bytes_t *) malloc(sizeof(bytes_t));
-    if (!bytes)
+    bytes_shared_t * shared = priv->shared;
+
+    if (NULL != shared &&
+        0 == __atomic_sub_fetch(&shared->refs, 1, __ATOMIC_ACQ_REL))
     {
-        BLAMMO(ERROR, "malloc(sizeof(bytes_t)) failed\n");
-        return NULL;
+        allocator_free(&priv->allocator, shared,
+                       bytes_shared_size(shared->capacity));
     }
 
-    // bulk copy all function pointers and init opaque ptr
-    memcpy(bytes, &bytes_pub, sizeof(bytes_t));
+    priv->shared = NULL;
+}
+
+static bool bytes_realloc(bytes_priv_t * priv, size_t capacity);
 
-    // Allocate and initialize private implementation
-    bytes->priv = malloc(sizeof(bytes_priv_t));
-    if (!bytes->priv)
+// Add a reference to another object's storage, for a copy or split
+static inline void bytes_share(bytes_priv_t * priv, bytes_priv_t * from,
+                               size_t offset, size_t size)
+{
+    __atomic_add_fetch(&from->shared->refs, 1, __ATOMIC_RELAXED);
+    priv->shared = from->shared;
+    priv->data = from->data + offset;
+    priv->size = size;
+    priv->capacity = from->capacity - offset;
+}
+
+//------------------------------------------------------------------------|
+bytes_t * bytes_create_with(const void * data, size_t size,
+                            const allocator_t * allocator)
+{
+    allocator = allocator ? allocator : allocator_default();
+
+    // Allocate public interface and private implementation together
+    bytes_block_t * block = (bytes_block_t *) allocator_alloc(
+                                allocator, sizeof(bytes_block_t));
+    if (!block)
     {
-        BLAMMO(ERROR, "malloc(sizeof(bytes_priv_t)) failed\n");
-        free(bytes);
+        BLAMMO(ERROR, "malloc(sizeof(bytes_block_t)) failed\n");
         return NULL;
     }
 
+    // bulk copy all function pointers and init opaque ptr
+    bytes_t * bytes = &block->pub;
+    memcpy(bytes, &bytes_pub, sizeof(bytes_t));
+    bytes->priv = &block->priv;
+
     memset(bytes->priv, 0, sizeof(bytes_priv_t));
+    ((bytes_priv_t *) bytes->priv)->allocator = *allocator;
+    bytes_init((bytes_priv_t *) bytes->priv);
     bytes->assign(bytes, data, size);
     return bytes;
 }
 
+//------------------------------------------------------------------------|
+bytes_t * bytes_create(const void * data, size_t size)
+{
+    return bytes_create_with(data, size, NULL);
+}
+
 //------------------------------------------------------------------------|
 void bytes_destroy(void * bytes_ptr)
 {
@@ -85,17 +209,12 @@ void bytes_destroy(void * bytes_ptr)
 
     bytes->clear(bytes);
 
-    if (NULL != bytes->priv)
-    {
-        free(bytes->priv);
-    }
+    // the allocator is about to be wiped along with everything else
+    allocator_t allocator = ((bytes_priv_t *) bytes->priv)->allocator;
 
-    if (NULL != bytes)
-    {
-        // TODO: Deal with compiler optimization problem
-        memset(bytes, 0, sizeof(bytes_t));
-        free(bytes);
-    }
+    // TODO: Deal with compiler optimization problem
+    memset(bytes, 0, sizeof(bytes_block_t));
+    allocator_free(&allocator, bytes, sizeof(bytes_block_t));
 }
 
 //------------------------------------------------------------------------|
@@ -107,7 +226,16 @@ static inline const uint8_t * bytes_data(bytes_t * bytes)
 //------------------------------------------------------------------------|
 static inline const char * bytes_cstr(bytes_t * bytes)
 {
-    return (const char *) ((bytes_priv_t *) bytes->priv)->data;
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+
+    // a split sharing storage may run on into the rest of it, and takes
+    // its own terminated copy when one is needed
+    if (0 != priv->data[priv->size] && !bytes_realloc(priv, priv->size))
+    {
+        return NULL;
+    }
+
+    return (const char *) priv->data;
 }
 
 //------------------------------------------------------------------------|
@@ -119,7 +247,7 @@ static inline size_t bytes_size(bytes_t * bytes)
 //------------------------------------------------------------------------|
 static inline bool bytes_empty(bytes_t * bytes)
 {
-    return (NULL == ((bytes_priv_t *) bytes->priv)->data);
+    return (0 == ((bytes_priv_t *) bytes->priv)->size);
 }
 
 //------------------------------------------------------------------------|
@@ -134,14 +262,105 @@ static void bytes_clear(bytes_t * bytes)
         priv->buffer = NULL;
     }
 
-    if (NULL != priv->data)
+    // TODO: Deal with compiler optimization problem
+    // Storage still shared with other objects is theirs to wipe
+    if (bytes_unique(priv))
     {
-        // TODO: Deal with compiler optimization problem
-        memset(priv->data, 0, priv->size);
-        free(priv->data);
+        memset(priv->data, 0, priv->capacity);
     }
+    bytes_release(priv);
 
+    // everything goes back to factory condition except the allocator
+    allocator_t allocator = priv->allocator;
     memset(bytes->priv, 0, sizeof(bytes_priv_t));
+    priv->allocator = allocator;
+    bytes_init(priv);
+}
+
+//------------------------------------------------------------------------|
+// Reallocate the buffer to hold exactly 'capacity' bytes plus terminator,
+// or move the data back inline if it fits there.  'capacity' is never
+// less than the size.  Storage that is shared is copied rather than
+// resized, leaving the other objects' data as it was.
+static bool bytes_realloc(bytes_priv_t * priv, size_t capacity)
+{
+    bytes_shared_t * shared = NULL;
+    size_t size = bytes_shared_size(capacity);
+    bool resized = false;
+
+    if (capacity <= BYTES_INLINE)
+    {
+        if (!bytes_inline(priv))
+        {
+            memcpy(priv->small, priv->data, priv->size);
+            priv->small[priv->size] = 0;
+            bytes_release(priv);
+            priv->data = priv->small;
+            priv->capacity = BYTES_INLINE;
+        }
+
+        return true;
+    }
+
+    if (0 == size)
+    {
+        BLAMMO(ERROR, "bytes capacity %zu is too large\n", capacity);
+        return false;
+    }
+
+    if (!bytes_inline(priv) && bytes_unique(priv))
+    {
+        shared = (bytes_shared_t *) allocator_realloc(
+                     &priv->allocator, priv->shared,
+                     bytes_shared_size(priv->shared->capacity), size);
+        resized = true;
+    }
+    else
+    {
+        shared = (bytes_shared_t *) allocator_alloc(&priv->allocator,
+                                                    size);
+    }
+
+    if (NULL == shared)
+    {
+        BLAMMO(ERROR, "malloc(%zu) failed\n", size);
+        return false;
+    }
+
+    // spilling over from the inline buffer, or taking a private copy
+    if (!resized)
+    {
+        memcpy(shared->data, priv->data, priv->size);
+        shared->refs = 1;
+        bytes_release(priv);
+    }
+
+    shared->capacity = capacity;
+    priv->shared = shared;
+    priv->data = shared->data;
+    priv->capacity = capacity;
+
+    // a split that has outlived the rest may not have been terminated
+    priv->data[priv->size] = 0;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// Make sure there is capacity for 'size' bytes, and that the data can be
+// written, at least doubling the capacity if not so that repeated growth
+// is amortized O(1).  This is where shared storage is copied on write.
+static inline bool bytes_grow(bytes_priv_t * priv, size_t size)
+{
+    size_t capacity = priv->capacity > BYTES_MAX_CAP / 2 ?
+                      BYTES_MAX_CAP : priv->capacity * 2;
+
+    if (size <= priv->capacity)
+    {
+        return bytes_unique(priv) ||
+               bytes_realloc(priv, size > priv->size ? size : priv->size);
+    }
+
+    return bytes_realloc(priv, capacity < size ? size : capacity);
 }
 
 //------------------------------------------------------------------------|
@@ -155,11 +374,8 @@ static void bytes_resize(bytes_t * bytes, size_t size)
         return;
     }
 
-    // Use realloc to resize byte array
-    priv->data = (uint8_t *) realloc(priv->data, size + 1);
-    if (NULL == priv->data)
+    if (!bytes_grow(priv, size))
     {
-        BLAMMO(ERROR, "malloc(%zu) failed\n", size + 1);
         return;
     }
 
@@ -176,12 +392,56 @@ static void bytes_resize(bytes_t * bytes, size_t size)
 }
 
 //------------------------------------------------------------------------|
-static ssize_t bytes_format(bytes_t * bytes, const char * format, ...)
+bool bytes_reserve(bytes_t * bytes, size_t capacity)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+
+    // reserving is for writing, so shared storage is copied here too
+    if (capacity <= priv->capacity && bytes_unique(priv))
+    {
+        return true;
+    }
+
+    capacity = capacity > priv->size ? capacity : priv->size;
+    if (!bytes_realloc(priv, capacity))
+    {
+        return false;
+    }
+
+    priv->data[priv->size] = 0;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+size_t bytes_capacity(bytes_t * bytes)
+{
+    return ((bytes_priv_t *) bytes->priv)->capacity;
+}
+
+//------------------------------------------------------------------------|
+void bytes_shrink_to_fit(bytes_t * bytes)
 {
     bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+
+    // shared storage cannot be shrunk, and copying it would not save any
+    if (!bytes_inline(priv) && priv->capacity > priv->size &&
+        bytes_unique(priv))
+    {
+        bytes_realloc(priv, priv->size);
+    }
+}
+
+//------------------------------------------------------------------------|
+// Format into the buffer starting at 'offset', which is at most the
+// size, leaving the size at the end of the formatted text.  The first pass
+// goes straight into whatever capacity is spare, and only if that is too
+// small is there a second pass, after growing the buffer.
+static ssize_t bytes_vformat(bytes_priv_t * priv, size_t offset,
+                             const char * format, va_list args)
+{
+    size_t room = 0;
     ssize_t nchars = 0;
-    bool redo = false;
-    va_list args;
+    va_list retry;
 
     if (NULL == format)
     {
@@ -189,36 +449,378 @@ static ssize_t bytes_format(bytes_t * bytes, const char * format, ...)
         return -1;
     }
 
-    // First try should be successful if there is enough room
-    va_start (args, format);
-    nchars = vsnprintf((char *) priv->data, priv->size, format, args);
-    va_end (args);
+    // the first pass writes in place
+    if (!bytes_grow(priv, offset))
+    {
+        return -1;
+    }
+
+    room = priv->capacity + 1 - offset;
+
+    va_copy(retry, args);
+    nchars = vsnprintf((char *) priv->data + offset, room, format, args);
 
     // Return early if error occurred
     if (nchars < 0)
     {
         BLAMMO(ERROR, "vsnprintf(%p, %zu, %s, ...) returned %d",
-            priv->data, priv->size, format, nchars);
+            priv->data + offset, room, format, nchars);
+        priv->data[priv->size] = 0;
+        va_end(retry);
         return nchars;
     }
 
-    // If vsnprintf returns larger than existing size, then another pass
-    // is necessary.  Either way, we'll resize to either shrink down or
-    // grow to fit.  If the two are the same then resize checks for that.
-    redo = (nchars > priv->size); 
-    bytes->resize(bytes, (size_t) nchars);
-
-    if (redo)
+    if ((size_t) nchars >= room)
     {
-        // Second pass will pick up the full formatted buffer
-        va_start (args, format);
-        nchars = vsnprintf((char *) priv->data, priv->size, format, args);
-        va_end (args);
-    }    
+        if (!bytes_grow(priv, offset + (size_t) nchars))
+        {
+            priv->data[priv->size] = 0;
+            va_end(retry);
+            return -1;
+        }
+
+        nchars = vsnprintf((char *) priv->data + offset,
+                           priv->capacity + 1 - offset, format, retry);
+    }
 
+    va_end(retry);
+
+    // vsnprintf() has already terminated the buffer
+    priv->size = offset + (size_t) nchars;
     return nchars;
 }
 
+//------------------------------------------------------------------------|
+static ssize_t bytes_format(bytes_t * bytes, const char * format, ...)
+{
+    ssize_t nchars = 0;
+    va_list args;
+
+    va_start(args, format);
+    nchars = bytes_vformat((bytes_priv_t *) bytes->priv, 0, format, args);
+    va_end(args);
+
+    return nchars;
+}
+
+//------------------------------------------------------------------------|
+ssize_t bytes_appendf(bytes_t * bytes, const char * format, ...)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+    ssize_t nchars = 0;
+    va_list args;
+
+    va_start(args, format);
+    nchars = bytes_vformat(priv, priv->size, format, args);
+    va_end(args);
+
+    return nchars;
+}
+
+//------------------------------------------------------------------------|
+// Get room for up to 'max' more bytes at the end of the data, to be
+// written directly and then accounted for by bytes_commit()
+static inline char * bytes_spare(bytes_priv_t * priv, size_t max)
+{
+    if (max > BYTES_MAX_CAP - priv->size ||
+        !bytes_grow(priv, priv->size + max))
+    {
+        return NULL;
+    }
+
+    return (char *) priv->data + priv->size;
+}
+
+static inline void bytes_commit(bytes_priv_t * priv, size_t length)
+{
+    priv->size += length;
+    priv->data[priv->size] = 0;
+}
+
+//------------------------------------------------------------------------|
+void bytes_append_u64(bytes_t * bytes, uint64_t value)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+    char * out = bytes_spare(priv, NUMCONV_U64_MAX);
+
+    if (out)
+    {
+        bytes_commit(priv, numconv_u64(out, value));
+    }
+}
+
+//------------------------------------------------------------------------|
+void bytes_append_i64(bytes_t * bytes, int64_t value)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+    char * out = bytes_spare(priv, NUMCONV_I64_MAX);
+
+    if (out)
+    {
+        bytes_commit(priv, numconv_i64(out, value));
+    }
+}
+
+//------------------------------------------------------------------------|
+void bytes_append_hex(bytes_t * bytes, uint64_t value, size_t width)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+    char * out = bytes_spare(priv, NUMCONV_HEX_MAX);
+
+    if (out)
+    {
+        bytes_commit(priv, numconv_hex(out, value, width));
+    }
+}
+
+//------------------------------------------------------------------------|
+void bytes_append_double(bytes_t * bytes, double value)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+    char * out = bytes_spare(priv, NUMCONV_DOUBLE_MAX);
+
+    if (out)
+    {
+        bytes_commit(priv, numconv_double(out, value));
+    }
+}
+
+//------------------------------------------------------------------------|
+size_t bytes_parse_u64(bytes_t * bytes, size_t offset,
+                       uint64_t * value)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+
+    if (offset >= priv->size)
+    {
+        return 0;
+    }
+
+    return numconv_parse_u64((const char *) priv->data + offset,
+                             priv->size - offset, value);
+}
+
+//------------------------------------------------------------------------|
+size_t bytes_parse_double(bytes_t * bytes, size_t offset,
+                          double * value)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+
+    if (offset >= priv->size)
+    {
+        return 0;
+    }
+
+    return numconv_parse_double((const char *) priv->data + offset,
+                                priv->size - offset, value);
+}
+
+//------------------------------------------------------------------------|
+bool bytes_to_hex(bytes_t * bytes, bytes_t * out)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+    bytes_priv_t * outpriv = (bytes_priv_t *) out->priv;
+    char * text;
+
+    if (out == bytes)
+    {
+        BLAMMO(ERROR, "Cannot encode a bytes object into itself");
+        return false;
+    }
+
+    text = bytes_spare(outpriv, CODEC_HEX_ENCODED(priv->size));
+    if (!text)
+    {
+        return false;
+    }
+
+    bytes_commit(outpriv, codec_hex_encode(text, priv->data, priv->size));
+    return true;
+}
+
+//------------------------------------------------------------------------|
+bool bytes_from_hex(bytes_t * bytes, bytes_t * out)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+    bytes_priv_t * outpriv = (bytes_priv_t *) out->priv;
+    uint8_t * data;
+    ssize_t length;
+
+    if (out == bytes)
+    {
+        BLAMMO(ERROR, "Cannot decode a bytes object into itself");
+        return false;
+    }
+
+    data = (uint8_t *) bytes_spare(outpriv, CODEC_HEX_DECODED(priv->size));
+    if (!data)
+    {
+        return false;
+    }
+
+    length = codec_hex_decode(data, (const char *) priv->data, priv->size);
+    if (length < 0)
+    {
+        // the terminator may have been overwritten
+        outpriv->data[outpriv->size] = 0;
+        return false;
+    }
+
+    bytes_commit(outpriv, (size_t) length);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+bool bytes_to_base64(bytes_t * bytes, bytes_t * out,
+                     codec_base64_t alphabet)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+    bytes_priv_t * outpriv = (bytes_priv_t *) out->priv;
+    char * text;
+
+    if (out == bytes)
+    {
+        BLAMMO(ERROR, "Cannot encode a bytes object into itself");
+        return false;
+    }
+
+    text = bytes_spare(outpriv, CODEC_BASE64_ENCODED(priv->size));
+    if (!text)
+    {
+        return false;
+    }
+
+    bytes_commit(outpriv, codec_base64_encode(text, priv->data, priv->size,
+                                              alphabet));
+    return true;
+}
+
+//------------------------------------------------------------------------|
+bool bytes_from_base64(bytes_t * bytes, bytes_t * out,
+                       codec_base64_t alphabet)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+    bytes_priv_t * outpriv = (bytes_priv_t *) out->priv;
+    uint8_t * data;
+    ssize_t length;
+
+    if (out == bytes)
+    {
+        BLAMMO(ERROR, "Cannot decode a bytes object into itself");
+        return false;
+    }
+
+    data = (uint8_t *) bytes_spare(outpriv,
+                                   CODEC_BASE64_DECODED(priv->size));
+    if (!data)
+    {
+        return false;
+    }
+
+    length = codec_base64_decode(data, (const char *) priv->data,
+                                 priv->size, alphabet);
+    if (length < 0)
+    {
+        outpriv->data[outpriv->size] = 0;
+        return false;
+    }
+
+    bytes_commit(outpriv, (size_t) length);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// Offset of a search result within the whole data
+static inline size_t bytes_found(size_t offset, size_t found)
+{
+    return found == SEARCH_NONE ? found : offset + found;
+}
+
+//------------------------------------------------------------------------|
+size_t bytes_find_byte(bytes_t * bytes, size_t offset, uint8_t byte)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+
+    if (offset >= priv->size)
+    {
+        return SEARCH_NONE;
+    }
+
+    return bytes_found(offset, search_byte(priv->data + offset,
+                                           priv->size - offset, byte));
+}
+
+//------------------------------------------------------------------------|
+size_t bytes_find_any_of(bytes_t * bytes, size_t offset,
+                         const void * set, size_t count)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+
+    if (offset >= priv->size)
+    {
+        return SEARCH_NONE;
+    }
+
+    return bytes_found(offset, search_any_of(priv->data + offset,
+                                             priv->size - offset,
+                                             set, count));
+}
+
+//------------------------------------------------------------------------|
+size_t bytes_find(bytes_t * bytes, size_t offset, const void * needle,
+                  size_t size)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+
+    if (offset > priv->size)
+    {
+        return SEARCH_NONE;
+    }
+
+    return bytes_found(offset, search_find(priv->data + offset,
+                                           priv->size - offset,
+                                           needle, size));
+}
+
+//------------------------------------------------------------------------|
+size_t bytes_rfind(bytes_t * bytes, size_t offset, const void * needle,
+                   size_t size)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+    size_t end = priv->size;
+
+    // only matches starting at or before 'offset' fit in the window
+    if (offset < priv->size && priv->size - offset > size)
+    {
+        end = offset + size;
+    }
+
+    return search_rfind(priv->data, end, needle, size);
+}
+
+//------------------------------------------------------------------------|
+size_t bytes_count(bytes_t * bytes, size_t offset, const void * needle,
+                   size_t size)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+
+    if (offset > priv->size)
+    {
+        return 0;
+    }
+
+    return search_count(priv->data + offset, priv->size - offset,
+                        needle, size);
+}
+
+//------------------------------------------------------------------------|
+chain_t * bytes_tokenize(bytes_t * bytes, const split_spec_t * spec)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+
+    return split_chain(view_of(priv->data, priv->size), spec);
+}
+
 //------------------------------------------------------------------------|
 static void bytes_assign(bytes_t * bytes, const void * data, size_t size)
 {
@@ -226,6 +828,13 @@ static void bytes_assign(bytes_t * bytes, const void * data, size_t size)
 
     // TODO: Impose some reasonable size checks here?  get available free
     // memory?  Return bool failure/success?
+    // Growing first also takes a private copy of shared storage, which
+    // resize() alone would not if the size is unchanged
+    if (!bytes_grow(priv, size))
+    {
+        return;
+    }
+
     bytes->resize(bytes, size);
 
     // buffer was already terminated in resize
@@ -239,14 +848,29 @@ static void bytes_assign(bytes_t * bytes, const void * data, size_t size)
 static void bytes_append(bytes_t * bytes, const void * data, size_t size)
 {
     bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
-    size_t prev_size = priv->size;
 
     // TODO: Impose some reasonable size checks here?  get available free
     // memory?  Return bool failure/success?
-    bytes->resize(bytes, priv->size + size);
+    if (0 == size)
+    {
+        return;
+    }
 
-    // buffer was already terminated in resize
-    memcpy(priv->data + prev_size, data, size);
+    if (size > BYTES_MAX_CAP - priv->size)
+    {
+        BLAMMO(ERROR, "bytes append of %zu would overflow\n", size);
+        return;
+    }
+
+    if (!bytes_grow(priv, priv->size + size))
+    {
+        return;
+    }
+
+    // copy straight into the spare capacity, without zeroing it first
+    memcpy(priv->data + priv->size, data, size);
+    priv->size += size;
+    priv->data[priv->size] = 0;
 }
 
 //------------------------------------------------------------------------|
@@ -272,16 +896,50 @@ static size_t bytes_trim(bytes_t * bytes)
 //------------------------------------------------------------------------|
 static bytes_t * bytes_copy(bytes_t * bytes)
 {
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
     bytes_t * copy = NULL;
 
+    // inline contents are just copied, and anything else shared
+    if (bytes_inline(priv))
+    {
+        return bytes_create_with(priv->data, priv->size, &priv->allocator);
+    }
+
+    copy = bytes_create_with(NULL, 0, &priv->allocator);
+    if (NULL != copy)
+    {
+        bytes_share((bytes_priv_t *) copy->priv, priv, 0, priv->size);
+    }
+
     return copy;
 }
 
 //------------------------------------------------------------------------|
 static bytes_t * bytes_split(bytes_t * bytes, size_t begin, size_t end)
 {
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
     bytes_t * seg = NULL;
 
+    end = end < priv->size ? end : priv->size;
+    if (begin > end)
+    {
+        BLAMMO(ERROR, "split begin %zu is past end %zu\n", begin, end);
+        return NULL;
+    }
+
+    // short segments are copied inline, and anything else shared
+    if (bytes_inline(priv) || end - begin <= BYTES_INLINE)
+    {
+        return bytes_create_with(priv->data + begin, end - begin,
+                                 &priv->allocator);
+    }
+
+    seg = bytes_create_with(NULL, 0, &priv->allocator);
+    if (NULL != seg)
+    {
+        bytes_share((bytes_priv_t *) seg->priv, priv, begin, end - begin);
+    }
+
     return seg;
 }
 
@@ -293,121 +951,87 @@ static bool bytes_join(bytes_t * head, bytes_t * tail)
 }
 
 //------------------------------------------------------------------------|
-// hexstr char buffer is expected to be minimum size 2
-static inline void hexdigit(char * hexstr, uint8_t byte)
+// Clamp a range to the data.  Returns false if it is empty.
+static inline bool bytes_clamp(bytes_priv_t * priv, size_t * begin,
+                               size_t * end)
 {
-    uint8_t nibble = byte >> 4;
-    hexstr[0] = nibble < 0x0A ? nibble + 0x30 : nibble + 0x37;
-    nibble = byte & 0x0F;
-    hexstr[1] = nibble < 0x0A ? nibble + 0x30 : nibble + 0x37;
+    *end = *end < priv->size ? *end : priv->size;
+    return *begin < *end;
 }
 
 //------------------------------------------------------------------------|
-// hexstr char buffer is expected to be minimum size 16.
-// This routine is hard-coded to represent the address with a minimum
-// of 4 hex digits (minbytes is 2).  Values larger than that will add
-// significant figures to the left, whereas values less that 0xFFFF will
-// have leading zeroes.
-static inline size_t hexaddr(char * hexaddr, size_t addr)
+const char * bytes_hexdump_range(bytes_t * bytes, size_t begin,
+                                 size_t end)
 {
-    const size_t minbytes = 2;
-    size_t remain = sizeof(size_t);
-    size_t mask = (size_t) 0x00FF << ((remain * 8) - 8);
-    size_t posn = 0;
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
+    bytes_priv_t * out = NULL;
+    size_t length;
+    char * text;
+
+    // Allocate a working buffer for the hexdump
+    if (NULL == priv->buffer)
+    {
+        priv->buffer = bytes_create_with("", 0, &priv->allocator);
+        if (NULL == priv->buffer)
+        {
+            return NULL;
+        }
+    }
+
+    // Empty the working buffer, keeping its capacity, then make it exactly
+    // big enough for the whole dump and format straight into it
+    out = (bytes_priv_t *) priv->buffer->priv;
+    out->size = 0;
+    out->data[0] = 0;
 
-    // Fast-forward to either where significant bits are, or
-    // else stop where we still have minimum bytes left.
-    while (((addr & mask) == 0) && (remain > minbytes))
+    if (!bytes_clamp(priv, &begin, &end))
     {
-        mask >>= 8;
-        remain--;
+        return (const char *) out->data;
     }
 
-    // start converting address data into hex representation
-    while (remain > 0)
+    length = hexdump_length(begin, end);
+    text = bytes_spare(out, length);
+    if (NULL == text)
     {
-        hexdigit(hexaddr + posn, (addr >> ((remain * 8) - 8)) & 0xFF);
-        posn += 2;
-        remain--;
+        return NULL;
     }
 
-    // Add some spacing and terminate
-    hexaddr[posn++] = ' ';
-    hexaddr[posn++] = ' ';
-    hexaddr[posn] = '\0';
-    return posn;
+    bytes_commit(out, hexdump_format(text, priv->data, begin, end));
+    return (const char *) out->data;
 }
 
+//------------------------------------------------------------------------|
 static const char * const bytes_hexdump(bytes_t * bytes)
+{
+    return bytes_hexdump_range(bytes, 0, SIZE_MAX);
+}
+
+//------------------------------------------------------------------------|
+ssize_t bytes_hexdump_fd(bytes_t * bytes, size_t begin, size_t end,
+                         int fd)
 {
     bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
-    char hexoffs[18] = { 0x00 };
-    char hexchar[4] = { 0x20, 0x20, 0x20, 0x00 };
-    char ascii[17] = { 0x00 };
-    size_t i, j;
-
-    // Allocate a working buffer for the hexdump.  The size calculation
-    // is an approximation here, and really only serves to ensure that
-    // we can allocate enough contiguous memory early.  Consider
-    if (NULL == priv->buffer)
-    {
-        priv->buffer = bytes_create("", 0); //6 + bytes->size(bytes) * 4);
-    }
 
-    // Clear working buffer and iterate through all data bytes
-    priv->buffer->clear(priv->buffer);
-    for (i = 0; i < priv->size; i++)
+    if (!bytes_clamp(priv, &begin, &end))
     {
-        // Address prefix
-        if ((i % 16) == 0)
-        {
-            j = hexaddr(hexoffs, i);
-            priv->buffer->append(priv->buffer, hexoffs, j);
-        }
+        return 0;
+    }
 
-        // Intentionally avoiding expensive realloc()/vsnprintf() here
-        hexdigit(hexchar, priv->data[i]);
-        priv->buffer->append(priv->buffer, hexchar, 3);
+    return hexdump_stream(priv->data, begin, end, fd, NULL);
+}
 
-        // Intentionally avoiding isprint() here
-        if ((priv->data[i] >= ' ') && (priv->data[i] <= '~'))
-        {
-            ascii[i % 16] = priv->data[i];
-        }
-        else
-        {
-            ascii[i % 16] = '.';
-        }
+//------------------------------------------------------------------------|
+ssize_t bytes_hexdump_file(bytes_t * bytes, size_t begin, size_t end,
+                           FILE * stream)
+{
+    bytes_priv_t * priv = (bytes_priv_t *) bytes->priv;
 
-        if ((i + 1) % 8 == 0 || i + 1 == priv->size)
-        {
-            priv->buffer->append(priv->buffer, " ", 1);
-            if ((i + 1) % 16 == 0)
-            {
-                priv->buffer->append(priv->buffer, ascii, sizeof(ascii) - 1);
-                priv->buffer->append(priv->buffer, "\n", 1);
-            }
-            else if (i + 1 == priv->size)
-            {
-                ascii[(i + 1) % 16] = '\0';
-
-                if ((i + 1) % 16 <= 8)
-                {
-                    priv->buffer->append(priv->buffer, " ", 1);
-                }
-
-                for (j = (i + 1) % 16; j < 16; j++)
-                {
-                    priv->buffer->append(priv->buffer, "   ", 3);
-                }
-
-                priv->buffer->append(priv->buffer, ascii, sizeof(ascii) - 1);
-                priv->buffer->append(priv->buffer, "\n", 1);
-            }
-        }
+    if (!bytes_clamp(priv, &begin, &end))
+    {
+        return 0;
     }
 
-    return priv->buffer->cstr(priv->buffer);
+    return hexdump_stream(priv->data, begin, end, -1, stream);
 }
 
 //------------------------------------------------------------------------|
@@ -425,9 +1049,9 @@ const bytes_t bytes_pub = {
     &bytes_append,
     &bytes_read,
     &bytes_write,
-    &bytes_trim,
     &bytes_copy,
     &bytes_split,
+    &bytes_trim,
     &bytes_join,
     &bytes_hexdump,
     NULL
@@ -23,13 +23,29 @@
 
 #pragma once
 
+#include "allocator.h"
+#include "codec.h"
+#include "search.h"
+#include "split.h"
+
 #include <sys/types.h>
+#include <stdio.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
 
 //------------------------------------------------------------------------|
+// A managed byte array or C string.  Each object is a single allocation:
+// its own copy of bytes_pub's function pointers, then the private data,
+// which holds contents of up to 31 bytes inline.  Longer contents get a
+// buffer of their own, shared by copies until one of them is written.
+//
+// The copied function pointers are what let every call read
+// bytes->method(bytes, ...), as with every other object in the library,
+// and they are most of the object's size.  So the struct keeps only the
+// core operations, and the rest are plain bytes_*() functions declared
+// after it, which cost nothing per object.
 typedef struct bytes_t
 {
     // Factory function that creates a 'bytes' object.
@@ -53,10 +69,13 @@ typedef struct bytes_t
     // Effectively brings the bytes back to factory condition.
     void (*clear)(struct bytes_t * bytes);
 
-    // Resize the buffer, keeping existing data intact
+    // Resize the buffer, keeping existing data intact.  New bytes are
+    // zeroed.  Growing past the capacity at least doubles it, so that
+    // repeated appends are amortized O(1), and shrinking keeps it.
     void (*resize)(struct bytes_t * bytes, size_t size);
 
-    // Printf-style string formatter
+    // Printf-style string formatter, replacing any existing data.
+    // Returns the number of characters written, or negative on error.
     ssize_t (*format)(struct bytes_t * bytes, const char * format, ...);
 
     // Assign data directly to buffer, replacing any existing data,
@@ -88,13 +107,30 @@ typedef struct bytes_t
     const char * (*hexdump)(struct bytes_t * bytes)
     */
 
-    // TODO: Stubbed Functions
-    size_t (*trim)(struct bytes_t * bytes);
+    // A new object with the same contents, or NULL on failure.  Anything
+    // longer than the inline contents is not copied but shared, with a
+    // reference count, until either object writes to it, at which point
+    // the writer takes its own copy.  This is O(1) whatever the size.
+    // Objects sharing storage may be used and destroyed from different
+    // threads, but must have been created with the same allocator.
     struct bytes_t * (*copy)(struct bytes_t * bytes);
+
+    // A new object with the bytes in [begin, end), shared the same way as
+    // copy().  'end' may be SIZE_MAX.  A shared segment takes its own copy
+    // the first time cstr() is called, if the data does not end there.
+    // Returns NULL if 'begin' is past the end or on failure.
     struct bytes_t * (*split)(struct bytes_t * bytes, size_t begin, size_t end);
+
+    // TODO: Stubbed Functions
+    size_t (*trim)(struct bytes_t * bytes);
     bool (*join)(struct bytes_t * head, struct bytes_t * tail);
 
     // debug, serialization, etc... reorganize later
+    // Get a hex and ASCII dump of the data, 16 bytes to a line.  The text
+    // lives in a working buffer owned by the object, and is only valid
+    // until the next hexdump call or until the object is destroyed.
+    // Every line, including a short last one, ends with '\n', and empty
+    // data gives "".  Returns NULL only if the buffer cannot be allocated.
     const char * const (*hexdump)(struct bytes_t * bytes);
 
     // Private data
@@ -104,4 +140,96 @@ bytes_t;
 
 //------------------------------------------------------------------------|
 // Public 'bytes' interface
-const bytes_t bytes_pub;
+extern const bytes_t bytes_pub;
+
+//------------------------------------------------------------------------|
+// Further operations, as plain functions rather than members, so that
+// they add nothing to the size of every object
+
+// Same as create(), but all of the object's memory, including its data
+// buffer, comes from the given allocator.  NULL means the library default.
+bytes_t * bytes_create_with(const void * data, size_t size,
+                            const allocator_t * allocator);
+
+// Make room for at least 'capacity' bytes without changing the size.
+// Returns false on allocation failure.
+bool bytes_reserve(bytes_t * bytes, size_t capacity);
+
+// Get the number of bytes the buffer can hold without reallocating
+size_t bytes_capacity(bytes_t * bytes);
+
+// Release any capacity beyond the current size
+void bytes_shrink_to_fit(bytes_t * bytes);
+
+// Same as format(), but appending to the existing data.  Formatting goes
+// straight into the spare capacity, and is only repeated if it did not
+// fit.  Neither call ever shrinks the buffer.
+ssize_t bytes_appendf(bytes_t * bytes, const char * format, ...);
+
+// Append numbers in text form, without the cost of bytes_appendf().  See
+// numconv.h for the formats.  bytes_append_hex() zero-pads to at least
+// 'width' digits.
+void bytes_append_u64(bytes_t * bytes, uint64_t value);
+void bytes_append_i64(bytes_t * bytes, int64_t value);
+void bytes_append_hex(bytes_t * bytes, uint64_t value, size_t width);
+void bytes_append_double(bytes_t * bytes, double value);
+
+// Parse a number from the data starting at 'offset'.  Returns the number
+// of bytes consumed, or 0 if there is no number there or it does not fit,
+// in which case 'value' is untouched.
+size_t bytes_parse_u64(bytes_t * bytes, size_t offset, uint64_t * value);
+size_t bytes_parse_double(bytes_t * bytes, size_t offset, double * value);
+
+// Encode the data as hex or Base64 text and append it to 'out', which must
+// be a different object.  The text is written straight into capacity
+// reserved for its exact size.  See codec.h for the formats.  Returns
+// false if memory could not be allocated.
+bool bytes_to_hex(bytes_t * bytes, bytes_t * out);
+
+// Decode hex text held in the data and append the result to 'out'.
+// Returns false, leaving 'out' as it was, if the text is not well formed
+// or memory could not be allocated.
+bool bytes_from_hex(bytes_t * bytes, bytes_t * out);
+
+// Same as bytes_to_hex() and bytes_from_hex(), for Base64 in the given
+// alphabet
+bool bytes_to_base64(bytes_t * bytes, bytes_t * out,
+                     codec_base64_t alphabet);
+bool bytes_from_base64(bytes_t * bytes, bytes_t * out,
+                       codec_base64_t alphabet);
+
+// Search the whole of the data, NULs included, from 'offset' onward.  Each
+// returns the offset of what it found from the start of the data, or
+// SEARCH_NONE.  See search.h.
+size_t bytes_find_byte(bytes_t * bytes, size_t offset, uint8_t byte);
+size_t bytes_find_any_of(bytes_t * bytes, size_t offset, const void * set,
+                         size_t count);
+size_t bytes_find(bytes_t * bytes, size_t offset, const void * needle,
+                  size_t size);
+
+// Find the last occurrence that starts at or before 'offset', which may be
+// SIZE_MAX to search everything
+size_t bytes_rfind(bytes_t * bytes, size_t offset, const void * needle,
+                   size_t size);
+
+// Count the non-overlapping occurrences from 'offset' onward
+size_t bytes_count(bytes_t * bytes, size_t offset, const void * needle,
+                   size_t size);
+
+// Split the data into tokens, collected as views into it in a new chain.
+// See split.h; split_begin() on view_bytes() iterates the same tokens
+// without allocating.  The views are only valid until the object is next
+// modified or destroyed.  Returns NULL on failure.
+chain_t * bytes_tokenize(bytes_t * bytes, const split_spec_t * spec);
+
+// Same as hexdump(), for the bytes in [begin, end) only.  Offsets are
+// shown relative to the start of the data.  'end' may be SIZE_MAX.  An
+// empty range gives "", and NULL means the buffer could not be allocated.
+const char * bytes_hexdump_range(bytes_t * bytes, size_t begin, size_t end);
+
+// Write the dump of [begin, end) straight to a file descriptor or stream,
+// a few lines at a time, without holding it all in memory.  Returns the
+// number of characters written, or -1 on error.
+ssize_t bytes_hexdump_fd(bytes_t * bytes, size_t begin, size_t end, int fd);
+ssize_t bytes_hexdump_file(bytes_t * bytes, size_t begin, size_t end,
+                           FILE * stream);
@@ -0,0 +1,679 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "cache.h"
+#include "hashmap.h"
+#include "blammo.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------|
+// Entry index meaning 'none'.  The largest usable index is one less.
+#define ENTRY_NIL       UINT32_MAX
+
+// Arena capacity of the first allocation, in entries
+#define ENTRY_MIN_CAP   16
+
+// Keys up to this size are stored inline in the entry
+#define KEY_INLINE      sizeof(uint64_t)
+
+//------------------------------------------------------------------------|
+// A cache entry within the arena.  The list runs from newest (head) to
+// oldest (tail) along 'next'.  Free entries are kept on a singly-linked
+// free list threaded through 'next'.
+typedef struct
+{
+    // Index of next (older) entry
+    uint32_t next;
+
+    // Index of previous (newer) entry
+    uint32_t prev;
+
+    // Used since the eviction scan last passed over it (CLOCK and SIEVE)
+    bool visited;
+
+    // A copy of the key, needed to remove it from the map on eviction
+    union
+    {
+        uint8_t bytes[KEY_INLINE];
+        uint8_t * ptr;
+    }
+    key;
+
+    // Key size in bytes
+    size_t size;
+
+    // The payload and its weight
+    void * data;
+    size_t weight;
+}
+entry_t;
+
+// cache private implementation data
+typedef struct
+{
+    // Maps keys to entry index + 1, so that no entry maps to NULL
+    hashmap_t * map;
+
+    // The contiguous entry arena
+    entry_t * arena;
+
+    // Number of entries allocated in the arena
+    uint32_t capacity;
+
+    // Number of entries that have ever been handed out
+    uint32_t used;
+
+    // Head of the free entry list
+    uint32_t free;
+
+    // Newest and oldest entries in the list
+    uint32_t head;
+    uint32_t tail;
+
+    // Where the SIEVE scan resumes, or ENTRY_NIL to start at the tail
+    uint32_t hand;
+
+    // Number of entries, their total weight, and the limit for it
+    size_t length;
+    size_t weight;
+    size_t limit;
+
+    cache_policy_t policy;
+    cache_weigh_f weigh;
+    cache_stats_t stats;
+
+    // The payload destructor function for all entries.
+    // This can be NULL for static or unmanaged data
+    data_destroy_f data_destroy;
+}
+cache_priv_t;
+
+//------------------------------------------------------------------------|
+static inline const uint8_t * entry_key(const entry_t * entry)
+{
+    return (entry->size <= KEY_INLINE) ? entry->key.bytes : entry->key.ptr;
+}
+
+//------------------------------------------------------------------------|
+// Take an entry from the free list, or else from the never-used region at
+// the end of the arena, growing the arena geometrically as needed.
+static uint32_t entry_alloc(cache_priv_t * priv)
+{
+    uint32_t index = priv->free;
+    size_t capacity = priv->capacity;
+    entry_t * arena = NULL;
+
+    if (ENTRY_NIL != index)
+    {
+        priv->free = priv->arena[index].next;
+        return index;
+    }
+
+    if (priv->used >= priv->capacity)
+    {
+        if (capacity >= (size_t) ENTRY_NIL / 2)
+        {
+            BLAMMO(ERROR, "cache cannot exceed %u entries\n", ENTRY_NIL / 2);
+            return ENTRY_NIL;
+        }
+
+        capacity = capacity ? capacity * 2 : ENTRY_MIN_CAP;
+        arena = (entry_t *) realloc(priv->arena, capacity * sizeof(entry_t));
+        if (NULL == arena)
+        {
+            BLAMMO(ERROR, "realloc(%zu) failed\n", capacity * sizeof(entry_t));
+            return ENTRY_NIL;
+        }
+
+        priv->arena = arena;
+        priv->capacity = (uint32_t) capacity;
+    }
+
+    return priv->used++;
+}
+
+//------------------------------------------------------------------------|
+static inline void entry_free(cache_priv_t * priv, uint32_t index)
+{
+    entry_t * entry = &priv->arena[index];
+
+    if (entry->size > KEY_INLINE)
+    {
+        free(entry->key.ptr);
+    }
+
+    memset(entry, 0, sizeof(entry_t));
+    entry->next = priv->free;
+    priv->free = index;
+}
+
+//------------------------------------------------------------------------|
+// Link an entry in at the head of the list
+static void entry_link(cache_priv_t * priv, uint32_t index)
+{
+    entry_t * arena = priv->arena;
+
+    arena[index].prev = ENTRY_NIL;
+    arena[index].next = priv->head;
+
+    if (ENTRY_NIL != priv->head)
+    {
+        arena[priv->head].prev = index;
+    }
+    else
+    {
+        priv->tail = index;
+    }
+
+    priv->head = index;
+}
+
+//------------------------------------------------------------------------|
+// Unlink an entry from the list, keeping the SIEVE hand off of it
+static void entry_unlink(cache_priv_t * priv, uint32_t index)
+{
+    entry_t * arena = priv->arena;
+    uint32_t next = arena[index].next;
+    uint32_t prev = arena[index].prev;
+
+    if (priv->hand == index)
+    {
+        priv->hand = prev;
+    }
+
+    if (ENTRY_NIL != prev)
+    {
+        arena[prev].next = next;
+    }
+    else
+    {
+        priv->head = next;
+    }
+
+    if (ENTRY_NIL != next)
+    {
+        arena[next].prev = prev;
+    }
+    else
+    {
+        priv->tail = prev;
+    }
+}
+
+//------------------------------------------------------------------------|
+// Look up a key, returning its entry index or ENTRY_NIL
+static inline uint32_t cache_lookup(cache_priv_t * priv, const void * key,
+                                    size_t size)
+{
+    uintptr_t found = (uintptr_t) priv->map->find(priv->map, key, size);
+    return found ? (uint32_t) (found - 1) : ENTRY_NIL;
+}
+
+//------------------------------------------------------------------------|
+// Remove an entry completely, destroying its payload
+static void cache_remove(cache_priv_t * priv, uint32_t index)
+{
+    entry_t * entry = &priv->arena[index];
+
+    priv->map->erase(priv->map, entry_key(entry), entry->size);
+    entry_unlink(priv, index);
+
+    priv->length--;
+    priv->weight -= entry->weight;
+
+    if ((NULL != entry->data) && (NULL != priv->data_destroy))
+    {
+        priv->data_destroy(entry->data);
+    }
+
+    entry_free(priv, index);
+}
+
+//------------------------------------------------------------------------|
+// Choose the entry to evict next according to policy.  The 'keep' entry
+// is never chosen, it is treated as though it had just been used.
+static uint32_t cache_victim(cache_priv_t * priv, uint32_t keep)
+{
+    entry_t * arena = priv->arena;
+    uint32_t index;
+
+    switch (priv->policy)
+    {
+        case CACHE_CLOCK:
+            // give used entries a second chance at the front of the list
+            index = priv->tail;
+            while (arena[index].visited || (index == keep))
+            {
+                arena[index].visited = false;
+                entry_unlink(priv, index);
+                entry_link(priv, index);
+                index = priv->tail;
+            }
+            return index;
+
+        case CACHE_SIEVE:
+            // survivors stay put while the hand sweeps toward the head
+            index = (ENTRY_NIL != priv->hand) ? priv->hand : priv->tail;
+            while (arena[index].visited || (index == keep))
+            {
+                arena[index].visited = false;
+                index = arena[index].prev;
+                index = (ENTRY_NIL != index) ? index : priv->tail;
+            }
+            priv->hand = arena[index].prev;
+            return index;
+
+        case CACHE_LRU:
+        default:
+            index = priv->tail;
+            return (index != keep) ? index : arena[index].prev;
+    }
+}
+
+//------------------------------------------------------------------------|
+// Evict entries, except 'keep', until 'extra' more weight would fit.
+// The caller makes sure that this is possible.
+static size_t cache_evict(cache_priv_t * priv, size_t extra, uint32_t keep)
+{
+    size_t evicted = 0;
+
+    while ((priv->length > 0) && (priv->weight + extra > priv->limit))
+    {
+        cache_remove(priv, cache_victim(priv, keep));
+        priv->stats.evictions++;
+        evicted++;
+    }
+
+    return evicted;
+}
+
+//------------------------------------------------------------------------|
+static cache_t * cache_create(data_destroy_f data_destroy,
+                              cache_policy_t policy, size_t capacity,
+                              cache_weigh_f weigh)
+{
+    cache_priv_t * priv = NULL;
+
+    if (capacity == 0)
+    {
+        BLAMMO(ERROR, "cache capacity must be nonzero\n");
+        return NULL;
+    }
+
+    // Allocate and initialize public interface
+    cache_t * cache = (cache_t *) malloc(sizeof(cache_t));
+    if (!cache)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(cache_t)) failed");
+        return NULL;
+    }
+
+    // bulk copy all function pointers and init opaque ptr
+    memcpy(cache, &cache_pub, sizeof(cache_t));
+
+    // Allocate and initialize private implementation
+    cache->priv = malloc(sizeof(cache_priv_t));
+    if (!cache->priv)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(cache_priv_t)) failed");
+        free(cache);
+        return NULL;
+    }
+
+    priv = (cache_priv_t *) cache->priv;
+    memset(priv, 0, sizeof(cache_priv_t));
+
+    // the map holds indices rather than payloads, so has no destructor
+    priv->map = hashmap_pub.create(NULL);
+    if (!priv->map)
+    {
+        free(priv);
+        free(cache);
+        return NULL;
+    }
+
+    priv->free = ENTRY_NIL;
+    priv->head = ENTRY_NIL;
+    priv->tail = ENTRY_NIL;
+    priv->hand = ENTRY_NIL;
+    priv->limit = capacity;
+    priv->policy = policy;
+    priv->weigh = weigh;
+    priv->data_destroy = data_destroy;
+
+    return cache;
+}
+
+//------------------------------------------------------------------------|
+static void cache_destroy(void * cache_ptr)
+{
+    cache_t * cache = (cache_t *) cache_ptr;
+
+    // guard against accidental double-destroy or early-destroy
+    if (!cache || !cache->priv)
+    {
+        BLAMMO(WARNING, "attempt to early or double-destroy\n");
+        return;
+    }
+
+    cache->clear(cache);
+    ((cache_priv_t *) cache->priv)->map->destroy(
+        ((cache_priv_t *) cache->priv)->map);
+
+    // zero out and destroy the private data
+    memset(cache->priv, 0, sizeof(cache_priv_t));
+    free(cache->priv);
+
+    // zero out and destroy the public interface
+    memset(cache, 0, sizeof(cache_t));
+    free(cache);
+}
+
+//------------------------------------------------------------------------|
+static inline size_t cache_length(cache_t * cache)
+{
+    return ((cache_priv_t *) cache->priv)->length;
+}
+
+//------------------------------------------------------------------------|
+static inline size_t cache_weight(cache_t * cache)
+{
+    return ((cache_priv_t *) cache->priv)->weight;
+}
+
+//------------------------------------------------------------------------|
+static inline size_t cache_capacity(cache_t * cache)
+{
+    return ((cache_priv_t *) cache->priv)->limit;
+}
+
+//------------------------------------------------------------------------|
+static inline bool cache_empty(cache_t * cache)
+{
+    return (0 == ((cache_priv_t *) cache->priv)->length);
+}
+
+//------------------------------------------------------------------------|
+static void cache_clear(cache_t * cache)
+{
+    cache_priv_t * priv = (cache_priv_t *) cache->priv;
+    uint32_t index;
+    entry_t * entry;
+
+    for (index = priv->head; ENTRY_NIL != index; index = entry->next)
+    {
+        entry = &priv->arena[index];
+
+        if ((NULL != entry->data) && (NULL != priv->data_destroy))
+        {
+            priv->data_destroy(entry->data);
+        }
+
+        if (entry->size > KEY_INLINE)
+        {
+            free(entry->key.ptr);
+        }
+    }
+
+    priv->map->clear(priv->map);
+    free(priv->arena);
+
+    priv->arena = NULL;
+    priv->capacity = 0;
+    priv->used = 0;
+    priv->free = ENTRY_NIL;
+    priv->head = ENTRY_NIL;
+    priv->tail = ENTRY_NIL;
+    priv->hand = ENTRY_NIL;
+    priv->length = 0;
+    priv->weight = 0;
+}
+
+//------------------------------------------------------------------------|
+static bool cache_put(cache_t * cache, const void * key, size_t size,
+                      void * data)
+{
+    cache_priv_t * priv = (cache_priv_t *) cache->priv;
+    size_t weight = priv->weigh ? priv->weigh(data) : 1;
+    uint32_t index = ENTRY_NIL;
+    entry_t * entry = NULL;
+
+    if (weight > priv->limit)
+    {
+        BLAMMO(WARNING, "payload weight %zu exceeds cache capacity %zu\n",
+               weight, priv->limit);
+        return false;
+    }
+
+    // Replace in place, keeping the entry but treating it as just used
+    index = cache_lookup(priv, key, size);
+    if (ENTRY_NIL != index)
+    {
+        entry = &priv->arena[index];
+
+        if ((NULL != entry->data) && (entry->data != data) &&
+            (NULL != priv->data_destroy))
+        {
+            priv->data_destroy(entry->data);
+        }
+
+        priv->weight -= entry->weight;
+        entry->data = data;
+        entry->weight = 0;
+
+        if (priv->policy == CACHE_LRU)
+        {
+            entry_unlink(priv, index);
+            entry_link(priv, index);
+        }
+        else
+        {
+            entry->visited = true;
+        }
+
+        cache_evict(priv, weight, index);
+        priv->arena[index].weight = weight;
+        priv->weight += weight;
+        priv->stats.inserts++;
+        return true;
+    }
+
+    cache_evict(priv, weight, ENTRY_NIL);
+
+    index = entry_alloc(priv);
+    if (ENTRY_NIL == index)
+    {
+        return false;
+    }
+
+    entry = &priv->arena[index];
+    memset(entry, 0, sizeof(entry_t));
+    entry->size = size;
+
+    if (size <= KEY_INLINE)
+    {
+        memcpy(entry->key.bytes, key, size);
+    }
+    else
+    {
+        entry->key.ptr = (uint8_t *) malloc(size);
+        if (NULL == entry->key.ptr)
+        {
+            BLAMMO(ERROR, "malloc(%zu) failed\n", size);
+            entry->size = 0;
+            entry_free(priv, index);
+            return false;
+        }
+
+        memcpy(entry->key.ptr, key, size);
+    }
+
+    if (!priv->map->insert(priv->map, entry_key(entry), size,
+                           (void *) (uintptr_t) (index + 1)))
+    {
+        entry_free(priv, index);
+        return false;
+    }
+
+    entry->data = data;
+    entry->weight = weight;
+    entry_link(priv, index);
+
+    priv->length++;
+    priv->weight += weight;
+    priv->stats.inserts++;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static void * cache_get(cache_t * cache, const void * key, size_t size)
+{
+    cache_priv_t * priv = (cache_priv_t *) cache->priv;
+    uint32_t index = cache_lookup(priv, key, size);
+
+    if (ENTRY_NIL == index)
+    {
+        priv->stats.misses++;
+        return NULL;
+    }
+
+    priv->stats.hits++;
+
+    if (priv->policy == CACHE_LRU)
+    {
+        if (priv->head != index)
+        {
+            entry_unlink(priv, index);
+            entry_link(priv, index);
+        }
+    }
+    else
+    {
+        priv->arena[index].visited = true;
+    }
+
+    return priv->arena[index].data;
+}
+
+//------------------------------------------------------------------------|
+static void * cache_peek(cache_t * cache, const void * key, size_t size)
+{
+    cache_priv_t * priv = (cache_priv_t *) cache->priv;
+    uint32_t index = cache_lookup(priv, key, size);
+
+    return (ENTRY_NIL != index) ? priv->arena[index].data : NULL;
+}
+
+//------------------------------------------------------------------------|
+static bool cache_erase(cache_t * cache, const void * key, size_t size)
+{
+    cache_priv_t * priv = (cache_priv_t *) cache->priv;
+    uint32_t index = cache_lookup(priv, key, size);
+
+    if (ENTRY_NIL == index)
+    {
+        return false;
+    }
+
+    cache_remove(priv, index);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool cache_put_u64(cache_t * cache, uint64_t key, void * data)
+{
+    return cache_put(cache, &key, sizeof(key), data);
+}
+
+//------------------------------------------------------------------------|
+static void * cache_get_u64(cache_t * cache, uint64_t key)
+{
+    return cache_get(cache, &key, sizeof(key));
+}
+
+//------------------------------------------------------------------------|
+static bool cache_erase_u64(cache_t * cache, uint64_t key)
+{
+    return cache_erase(cache, &key, sizeof(key));
+}
+
+//------------------------------------------------------------------------|
+static size_t cache_resize(cache_t * cache, size_t capacity)
+{
+    cache_priv_t * priv = (cache_priv_t *) cache->priv;
+
+    if (capacity == 0)
+    {
+        BLAMMO(ERROR, "cache capacity must be nonzero\n");
+        return 0;
+    }
+
+    priv->limit = capacity;
+    return cache_evict(priv, 0, ENTRY_NIL);
+}
+
+//------------------------------------------------------------------------|
+static void cache_stats(cache_t * cache, cache_stats_t * stats)
+{
+    memcpy(stats, &((cache_priv_t *) cache->priv)->stats, sizeof(cache_stats_t));
+}
+
+//------------------------------------------------------------------------|
+static void cache_reset_stats(cache_t * cache)
+{
+    memset(&((cache_priv_t *) cache->priv)->stats, 0, sizeof(cache_stats_t));
+}
+
+//------------------------------------------------------------------------|
+size_t cache_weigh_bytes(const void * data)
+{
+    bytes_t * bytes = (bytes_t *) data;
+    return bytes ? bytes->size(bytes) : 0;
+}
+
+//------------------------------------------------------------------------|
+const cache_t cache_pub = {
+    &cache_create,
+    &cache_destroy,
+    &cache_length,
+    &cache_weight,
+    &cache_capacity,
+    &cache_empty,
+    &cache_clear,
+    &cache_put,
+    &cache_get,
+    &cache_peek,
+    &cache_erase,
+    &cache_put_u64,
+    &cache_get_u64,
+    &cache_erase_u64,
+    &cache_resize,
+    &cache_stats,
+    &cache_reset_stats,
+    NULL
+};
@@ -0,0 +1,144 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include "chain.h"
+#include "bytes.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A bounded key/value cache.  Lookup goes through a hashmap_t, and the
+// entries are kept in a recency list whose links live in one contiguous
+// arena and refer to each other by index, so a hit never allocates and
+// get, put and evict are all O(1).
+//
+// The eviction policy is chosen at creation:
+//
+//   CACHE_LRU     Evict the least recently used entry.  Every hit moves
+//                 the entry to the front of the list.
+//   CACHE_CLOCK   Evict the oldest entry not used since it was last
+//                 passed over.  A hit only sets a flag, so reads never
+//                 touch the list.
+//   CACHE_SIEVE   Like CLOCK, but survivors stay in place rather than
+//                 being moved to the front, and the scan resumes where it
+//                 left off.  This tends to evict one-hit wonders quickly.
+//
+// Capacity is counted in entries, or in any other unit if a weigh
+// function is given, for example the size of bytes_t payloads with
+// cache_weigh_bytes().  Payloads are owned by the cache once put, and
+// destroyed by data_destroy when evicted, replaced, erased, or cleared,
+// so data_destroy doubles as the eviction callback.
+typedef enum
+{
+    CACHE_LRU,
+    CACHE_CLOCK,
+    CACHE_SIEVE
+}
+cache_policy_t;
+
+// Returns the weight of a payload, counted against the cache capacity
+typedef size_t (*cache_weigh_f)(const void * data);
+
+// Running totals, kept since creation or the last reset_stats()
+typedef struct
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t inserts;
+    uint64_t evictions;
+}
+cache_stats_t;
+
+typedef struct cache_t
+{
+    // Factory function that creates a cache.  The destructor callback
+    // follows the same rules as for chain_t create().  If 'weigh' is NULL
+    // each entry weighs 1, making 'capacity' a count of entries.
+    struct cache_t * (*create)(data_destroy_f data_destroy,
+                               cache_policy_t policy, size_t capacity,
+                               cache_weigh_f weigh);
+
+    // Cache destructor function
+    void (*destroy)(void * cache);
+
+    // Get the number of entries in the cache
+    size_t (*length)(struct cache_t * cache);
+
+    // Get the total weight of all entries in the cache
+    size_t (*weight)(struct cache_t * cache);
+
+    // Get the capacity in units of weight
+    size_t (*capacity)(struct cache_t * cache);
+
+    // Returns true if the cache is empty and false otherwise
+    bool (*empty)(struct cache_t * cache);
+
+    // Removes all entries, destroying their payloads
+    void (*clear)(struct cache_t * cache);
+
+    // Insert or replace the payload for a key, first evicting as many
+    // entries as needed to make room.  A replaced payload is destroyed.
+    // Returns false, leaving the payload with the caller, if it weighs
+    // more than the whole capacity or on allocation failure.
+    bool (*put)(struct cache_t * cache, const void * key, size_t size,
+                void * data);
+
+    // Get the payload for a key and mark it as used, or NULL on a miss
+    void * (*get)(struct cache_t * cache, const void * key, size_t size);
+
+    // Same as get() but without marking it used or counting a hit/miss
+    void * (*peek)(struct cache_t * cache, const void * key, size_t size);
+
+    // Remove a key and destroy its payload.  Returns false if not present.
+    bool (*erase)(struct cache_t * cache, const void * key, size_t size);
+
+    // Same as the above, for integer keys
+    bool (*put_u64)(struct cache_t * cache, uint64_t key, void * data);
+    void * (*get_u64)(struct cache_t * cache, uint64_t key);
+    bool (*erase_u64)(struct cache_t * cache, uint64_t key);
+
+    // Change the capacity, evicting entries until the cache fits.
+    // Returns the number of entries evicted.
+    size_t (*resize)(struct cache_t * cache, size_t capacity);
+
+    // Get the running totals, and clear them
+    void (*stats)(struct cache_t * cache, cache_stats_t * stats);
+    void (*reset_stats)(struct cache_t * cache);
+
+    // Private data
+    void * priv;
+}
+cache_t;
+
+//------------------------------------------------------------------------|
+// Weigh function for caches of bytes_t payloads, by size in bytes
+size_t cache_weigh_bytes(const void * data);
+
+//------------------------------------------------------------------------|
+// Public cache interface
+extern const cache_t cache_pub;
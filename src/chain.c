@@ -22,6 +22,7 @@
 //------------------------------------------------------------------------|
 
 #include "chain.h"
+#include "chain_stats.h"
 #include "blammo.h"
 
 #include <stdlib.h>
@@ -60,14 +61,25 @@ typedef struct
     // The link data destructor function for all links.
     // This can be NULL for static or unmanaged data
     data_destroy_f data_destroy;
+
+    // Where all of this chain's memory comes from
+    allocator_t allocator;
+
+#ifdef CHAIN_STATS_ENABLE
+    // Memory and activity counters for this chain
+    chain_stats_t stats;
+#endif
 }
 chain_priv_t;
 
 //------------------------------------------------------------------------|
-static chain_t * chain_create(data_destroy_f data_destroy)
+static chain_t * chain_create_with(data_destroy_f data_destroy,
+                                   const allocator_t * allocator)
 {
+    allocator = allocator ? allocator : allocator_default();
+
     // Allocate and initialize public interface
-    chain_t * chain = (chain_t *) malloc(sizeof(chain_t));
+    chain_t * chain = (chain_t *) allocator_alloc(allocator, sizeof(chain_t));
     if (!chain)
     {
         BLAMMO(ERROR, "malloc(sizeof(chain_t)) failed");
@@ -78,20 +90,27 @@ static chain_t * chain_create(data_destroy_f data_destroy)
     memcpy(chain, &chain_pub, sizeof(chain_t));
 
     // Allocate and initialize private implementation
-    chain->priv = malloc(sizeof(chain_priv_t));
+    chain->priv = allocator_alloc(allocator, sizeof(chain_priv_t));
     if (!chain->priv)
     {
         BLAMMO(ERROR, "malloc(sizeof(chain_priv_t)) failed");
-        free(chain);
+        allocator_free(allocator, chain, sizeof(chain_t));
         return NULL;
     }
 
     memset(chain->priv, 0, sizeof(chain_priv_t));
     ((chain_priv_t *) chain->priv)->data_destroy = data_destroy;
+    ((chain_priv_t *) chain->priv)->allocator = *allocator;
 
     return chain;
 }
 
+//------------------------------------------------------------------------|
+static chain_t * chain_create(data_destroy_f data_destroy)
+{
+    return chain_create_with(data_destroy, NULL);
+}
+
 //------------------------------------------------------------------------|
 static void chain_destroy(void * chain_ptr)
 {
@@ -107,13 +126,16 @@ static void chain_destroy(void * chain_ptr)
     // remove all links and destroy their data
     chain->clear(chain);
 
+    // the allocator is about to be wiped along with everything else
+    allocator_t allocator = ((chain_priv_t *) chain->priv)->allocator;
+
     // zero out and destroy the private data
     memset(chain->priv, 0, sizeof(chain_priv_t));
-    free(chain->priv);
+    allocator_free(&allocator, chain->priv, sizeof(chain_priv_t));
 
     // zero out and destroy the public interface
     memset(chain, 0, sizeof(chain_t));
-    free(chain);
+    allocator_free(&allocator, chain, sizeof(chain_t));
 }
 
 //------------------------------------------------------------------------|
@@ -166,7 +188,8 @@ static void chain_clear(chain_t * chain)
 static void chain_insert(chain_t * chain, void * data)
 {
     chain_priv_t * priv = (chain_priv_t *) chain->priv;
-    link_t * link = (link_t *) malloc(sizeof(link_t));
+    link_t * link = (link_t *) allocator_alloc(&priv->allocator,
+                                               sizeof(link_t));
 
     if (NULL == link)
     {
@@ -174,6 +197,8 @@ static void chain_insert(chain_t * chain, void * data)
         return;
     }
 
+    CHAIN_STATS_ALLOC(&priv->stats, 1, sizeof(link_t), 1);
+
     // check if linking in the origin
     if (chain->empty(chain))
     {
@@ -198,6 +223,7 @@ static void chain_insert(chain_t * chain, void * data)
     chain->spin(chain, 1);
     priv->link->data = data;
     priv->length ++;
+    CHAIN_STATS_LENGTH(&priv->stats, priv->length);
 }
 
 //------------------------------------------------------------------------|
@@ -237,7 +263,8 @@ static void chain_remove(chain_t * chain)
     priv->link->next->prev = priv->link->prev;
 
     // free the current link
-    free(priv->link);
+    allocator_free(&priv->allocator, priv->link, sizeof(link_t));
+    CHAIN_STATS_FREE(&priv->stats, 1, sizeof(link_t), 1);
 
     // make current link old previous link
     if (priv->length > 1)
@@ -271,6 +298,7 @@ static bool chain_spin(chain_t * chain, int64_t index)
     }
 
     chain_priv_t * priv = (chain_priv_t *) chain->priv;
+    CHAIN_STATS_SPIN(&priv->stats, index);
 
     while (index > 0)
     {
@@ -349,7 +377,9 @@ static void chain_sort(chain_t * chain, data_compare_f data_compare)
     while (chain->spin(chain, 1));
 
     // call quicksort on the array of data pointers
+    CHAIN_STATS_SORT_BEGIN(start);
     qsort(data_ptrs, priv->length, sizeof(void *), data_compare);
+    CHAIN_STATS_SORT_END(&priv->stats, start);
 
     // now directly re-arrange all of the data pointers
     // the chain reset may not technically be necessary
@@ -370,7 +400,7 @@ static chain_t * chain_copy(chain_t * chain, data_copy_f data_copy)
 {
     void * data = NULL;
     chain_priv_t * priv = (chain_priv_t *) chain->priv;
-    chain_t * copy = chain_create(priv->data_destroy);
+    chain_t * copy = chain_create_with(priv->data_destroy, &priv->allocator);
 
     if (NULL == copy)
     {
@@ -397,7 +427,7 @@ static chain_t * chain_split(chain_t * chain, size_t begin, size_t end)
 {
     link_t * link = NULL;
     chain_priv_t * priv = (chain_priv_t *) chain->priv;
-    chain_t * seg = chain_create(priv->data_destroy);
+    chain_t * seg = chain_create_with(priv->data_destroy, &priv->allocator);
 
     if (NULL == seg)
     {
@@ -428,6 +458,15 @@ static chain_t * chain_split(chain_t * chain, size_t begin, size_t end)
     priv->link->prev = link;
     priv->length -= seg_priv->length;
 
+    // if the origin went with the segment, the link after it takes over
+    if (priv->orig == seg_priv->orig)
+    {
+        priv->orig = priv->link;
+    }
+
+    CHAIN_STATS_MOVE(&priv->stats, &seg_priv->stats,
+                     seg_priv->length * sizeof(link_t), seg_priv->length);
+    CHAIN_STATS_LENGTH(&seg_priv->stats, seg_priv->length);
     return seg;
 }
 
@@ -436,8 +475,18 @@ static bool chain_join(chain_t * head, chain_t * tail)
 {
     link_t * link = NULL;
     chain_priv_t * head_priv = (chain_priv_t *) head->priv;
-    chain_priv_t * tail_priv = (chain_priv_t *) tail->priv;
-    
+    chain_priv_t * tail_priv = NULL;
+
+    // The tail must also be a linked chain, such as not a compact chain
+    if (tail->join != head->join)
+    {
+        BLAMMO(ERROR, "chain_join() cannot join chains with different "
+            "link representations\n");
+        return false;
+    }
+
+    tail_priv = (chain_priv_t *) tail->priv;
+
     // Cannot join chains of dissimilar data types
     if (head_priv->data_destroy != tail_priv->data_destroy)
     {
@@ -448,6 +497,14 @@ static bool chain_join(chain_t * head, chain_t * tail)
         return false;
     }
 
+    // Links change hands, so must be freed by the allocator they came from
+    if (!allocator_same(&head_priv->allocator, &tail_priv->allocator))
+    {
+        BLAMMO(ERROR, "chain_join() cannot join chains with different "
+            "allocators\n");
+        return false;
+    }
+
     // One or the other chain may be empty.  If the achain is empty, then
     // simply take all the contents from the bchain as the final result.
     // if the bchain itself is also empty, this still validly returns
@@ -458,6 +515,10 @@ static bool chain_join(chain_t * head, chain_t * tail)
         head_priv->link = tail_priv->link;
         head_priv->orig = tail_priv->orig;
         head_priv->length = tail_priv->length;
+        CHAIN_STATS_MOVE(&tail_priv->stats, &head_priv->stats,
+                         tail_priv->length * sizeof(link_t),
+                         tail_priv->length);
+        CHAIN_STATS_LENGTH(&head_priv->stats, head_priv->length);
         tail_priv->link = NULL;
         tail_priv->orig = NULL;
         tail_priv->length = 0;
@@ -485,14 +546,36 @@ static bool chain_join(chain_t * head, chain_t * tail)
     // the tail container is now empty, and the head chain has assumed
     // ownership of all it's links.
     head_priv->length += tail_priv->length;
+    CHAIN_STATS_MOVE(&tail_priv->stats, &head_priv->stats,
+                     tail_priv->length * sizeof(link_t), tail_priv->length);
+    CHAIN_STATS_LENGTH(&head_priv->stats, head_priv->length);
+    tail_priv->link = NULL;
+    tail_priv->orig = NULL;
     tail_priv->length = 0;
 
     return true;
 }
 
+//------------------------------------------------------------------------|
+static bool chain_reserve(chain_t * chain, size_t count)
+{
+    // links are allocated one at a time, so there is nothing to do
+    return true;
+}
+
+#ifdef CHAIN_STATS_ENABLE
+//------------------------------------------------------------------------|
+static void chain_stats(chain_t * chain, chain_stats_t * stats)
+{
+    memcpy(stats, &((chain_priv_t *) chain->priv)->stats,
+           sizeof(chain_stats_t));
+}
+#endif
+
 //------------------------------------------------------------------------|
 const chain_t chain_pub = {
     &chain_create,
+    &chain_create_with,
     &chain_destroy,
     &chain_data,
     &chain_length,
@@ -508,6 +591,10 @@ const chain_t chain_pub = {
     &chain_copy,
     &chain_split,
     &chain_join,
+    &chain_reserve,
+#ifdef CHAIN_STATS_ENABLE
+    &chain_stats,
+#endif
     NULL
 };
 
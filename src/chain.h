@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include "allocator.h"
+
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -40,6 +42,37 @@ typedef void * (*data_copy_f) (const void *);
 // Effectively this designates the data type of the chain.
 typedef void (*data_destroy_f) (void *);
 
+//------------------------------------------------------------------------|
+// Memory and activity counters are only kept if the preprocessor directive
+// CHAIN_STATS_ENABLE is defined on the command line during build, in the
+// same way as BLAMMO_ENABLE.  Otherwise they are compiled out entirely,
+// along with the functions below that report them.  The library and its
+// users must agree on this, since it changes the layout of chain_t.
+#ifdef CHAIN_STATS_ENABLE
+typedef struct
+{
+    // Links ever allocated and freed
+    uint64_t links_allocated;
+    uint64_t links_freed;
+
+    // Bytes currently held for links, and how many heap blocks they are
+    // spread across.  Each block costs some allocator overhead on top.
+    uint64_t link_bytes;
+    uint64_t allocations;
+
+    // Highest length reached.  Globally, the most links alive at once.
+    uint64_t peak_length;
+
+    // Links stepped over by spin(), including within other operations
+    uint64_t spins;
+
+    // Number of sort() calls, and total time spent in them
+    uint64_t sorts;
+    uint64_t sort_nsec;
+}
+chain_stats_t;
+#endif
+
 //------------------------------------------------------------------------|
 typedef struct chain_t
 {
@@ -51,6 +84,12 @@ typedef struct chain_t
     // was allocated by a simple 'malloc' call.
     struct chain_t * (*create)(data_destroy_f data_destroy);
 
+    // Same as create(), but all of the chain's memory, including each
+    // link, comes from the given allocator.  NULL means the library
+    // default.  Chains made from this one by copy() or split() share it.
+    struct chain_t * (*create_with)(data_destroy_f data_destroy,
+                                    const allocator_t * allocator);
+
     // Chain destructor function
     void (*destroy)(void * chain);
 
@@ -121,6 +160,20 @@ typedef struct chain_t
     // to it's factory state.  Returns true on success or false on failure.
     bool (*join)(struct chain_t * head, struct chain_t * tail);
 
+    // Make room for at least 'count' more links, so that many inserts can
+    // follow without further allocation where the implementation allows.
+    // The compact and vector chains grow their arrays once.  chain_pub
+    // allocates each link individually, so this does nothing there.
+    // Returns false on allocation failure.
+    bool (*reserve)(struct chain_t * chain, size_t count);
+
+#ifdef CHAIN_STATS_ENABLE
+    // Get the counters for this chain.  Links moved in from another chain
+    // by join() or split() count toward the bytes held, but not toward
+    // links allocated.
+    void (*stats)(struct chain_t * chain, chain_stats_t * stats);
+#endif
+
     // Private data
     void * priv;
 }
@@ -128,4 +181,35 @@ chain_t;
 
 //------------------------------------------------------------------------|
 // Public chain interface
-const chain_t chain_pub;
+extern const chain_t chain_pub;
+
+// Public compact chain interface.  This has the same interface and
+// semantics as chain_pub, but its links are kept in one contiguous arena
+// and refer to each other by 32-bit index instead of by pointer, roughly
+// halving per-link memory.  A compact chain holds at most UINT32_MAX - 1
+// links: use chain_pub for anything larger.  Compact chains can only be
+// joined with other compact chains, and split() moves payloads into a new
+// arena rather than re-linking them in place.
+extern const chain_t chain_compact_pub;
+
+// Public vector chain interface.  Again the same interface and cursor
+// semantics as chain_pub, but the payload pointers are kept in one
+// contiguous, geometrically-growing array indexed from the origin.
+// Appending and iterating are much faster, and chain_vector_at() gives
+// random access, but inserting or removing in the middle is O(n).  Vector
+// chains can only be joined with other vector chains.
+extern const chain_t chain_vector_pub;
+
+// Get the data payload at an index from the origin of a vector chain, or
+// NULL if out of range or if the chain is not a vector chain.  Does not
+// change the current position.
+void * chain_vector_at(chain_t * chain, size_t index);
+
+#ifdef CHAIN_STATS_ENABLE
+// Get the counters summed over all chains of every kind since startup.
+// Chains may be used from any number of threads: the totals are updated
+// atomically.  Each counter is read atomically too, but they are not all
+// read at the same instant, so while other threads are using chains they
+// may not agree with each other exactly.
+void chain_stats_global(chain_stats_t * stats);
+#endif
@@ -0,0 +1,749 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// Compact chain: Same interface and semantics as chain_pub, but the links
+// live in a single contiguous arena and refer to each other by 32-bit slot
+// index rather than by pointer.  On 64-bit targets this makes each link
+// 16 bytes with no per-link malloc header, and because nothing inside the
+// arena is an absolute address it can be realloc'd (or written out and
+// read back) as one block.
+
+#include "chain.h"
+#include "chain_stats.h"
+#include "blammo.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------|
+// Slot index meaning 'no link'.  The largest usable index is one less.
+#define SLOT_NIL        UINT32_MAX
+
+// Arena capacity of the first allocation, in slots
+#define SLOT_MIN_CAP    16
+
+//------------------------------------------------------------------------|
+// A link within the arena.  Free slots are kept on a singly-linked free
+// list threaded through 'next'.
+typedef struct
+{
+    // Index of next link
+    uint32_t next;
+
+    // Index of previous link
+    uint32_t prev;
+
+    // Pointer to link's contents
+    void * data;
+}
+slot_t;
+
+// compact chain private implementation data
+typedef struct
+{
+    // The contiguous link arena
+    slot_t * arena;
+
+    // Number of slots allocated in the arena
+    uint32_t capacity;
+
+    // Number of slots that have ever been handed out.  Slots at or beyond
+    // this index have never been used and are not on the free list.
+    uint32_t used;
+
+    // Head of the free slot list
+    uint32_t free;
+
+    // Current link in the chain
+    uint32_t link;
+
+    // The 'origin' link of the chain
+    uint32_t orig;
+
+    // The chain length, number of links
+    size_t length;
+
+    // The link data destructor function for all links.
+    // This can be NULL for static or unmanaged data
+    data_destroy_f data_destroy;
+
+    // Where all of this chain's memory comes from
+    allocator_t allocator;
+
+#ifdef CHAIN_STATS_ENABLE
+    // Memory and activity counters for this chain
+    chain_stats_t stats;
+#endif
+}
+chain_compact_priv_t;
+
+//------------------------------------------------------------------------|
+static inline void slot_reset(chain_compact_priv_t * priv)
+{
+    priv->arena = NULL;
+    priv->capacity = 0;
+    priv->used = 0;
+    priv->free = SLOT_NIL;
+    priv->link = SLOT_NIL;
+    priv->orig = SLOT_NIL;
+    priv->length = 0;
+}
+
+//------------------------------------------------------------------------|
+// Free the whole arena without touching any payloads, and reset.  Only
+// 'freed' of the links it held count as freed: the rest have moved on.
+static inline void slot_release(chain_compact_priv_t * priv, size_t freed)
+{
+    CHAIN_STATS_FREE(&priv->stats, freed,
+                     priv->capacity * sizeof(slot_t), priv->arena ? 1 : 0);
+    allocator_free(&priv->allocator, priv->arena,
+                   priv->capacity * sizeof(slot_t));
+    slot_reset(priv);
+}
+
+//------------------------------------------------------------------------|
+// Make sure the arena can hold at least 'count' more links without
+// needing to grow again.  Growth is geometric.
+static bool slot_reserve(chain_compact_priv_t * priv, size_t count)
+{
+    size_t capacity = priv->capacity;
+    size_t needed = 0;
+    slot_t * arena = NULL;
+
+    if (count > (size_t) SLOT_NIL - priv->length)
+    {
+        BLAMMO(ERROR, "compact chain cannot exceed %u links\n", SLOT_NIL);
+        return false;
+    }
+
+    needed = priv->length + count;
+    if (needed <= capacity)
+    {
+        return true;
+    }
+
+    // doubling is clamped, so that it cannot wrap where size_t is narrow
+    capacity = capacity ? capacity : SLOT_MIN_CAP;
+    while (capacity < needed)
+    {
+        capacity = (capacity > (size_t) SLOT_NIL / 2) ? (size_t) SLOT_NIL :
+                   capacity * 2;
+    }
+
+    if (capacity > SIZE_MAX / sizeof(slot_t))
+    {
+        BLAMMO(ERROR, "compact chain arena of %zu links is too large\n",
+               capacity);
+        return false;
+    }
+
+    arena = (slot_t *) allocator_realloc(&priv->allocator, priv->arena,
+                                         priv->capacity * sizeof(slot_t),
+                                         capacity * sizeof(slot_t));
+    if (NULL == arena)
+    {
+        BLAMMO(ERROR, "realloc(%zu) failed\n", capacity * sizeof(slot_t));
+        return false;
+    }
+
+    CHAIN_STATS_ALLOC(&priv->stats, 0,
+                      (capacity - priv->capacity) * sizeof(slot_t),
+                      priv->arena ? 0 : 1);
+
+    priv->arena = arena;
+    priv->capacity = (uint32_t) capacity;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// Take a slot from the free list, or else from the never-used region at
+// the end of the arena, growing the arena as needed.
+static uint32_t slot_alloc(chain_compact_priv_t * priv)
+{
+    uint32_t slot = priv->free;
+
+    if (SLOT_NIL != slot)
+    {
+        priv->free = priv->arena[slot].next;
+        return slot;
+    }
+
+    if ((priv->used >= priv->capacity) && !slot_reserve(priv, 1))
+    {
+        return SLOT_NIL;
+    }
+
+    return priv->used++;
+}
+
+//------------------------------------------------------------------------|
+static inline void slot_free(chain_compact_priv_t * priv, uint32_t slot)
+{
+    priv->arena[slot].data = NULL;
+    priv->arena[slot].next = priv->free;
+    priv->free = slot;
+}
+
+//------------------------------------------------------------------------|
+// Link a slot in after the current link and make it current.  Callers
+// count the link as allocated unless it was moved from another chain.
+static void slot_link(chain_compact_priv_t * priv, uint32_t slot, void * data)
+{
+    slot_t * arena = priv->arena;
+
+    if (SLOT_NIL == priv->link)
+    {
+        arena[slot].next = slot;
+        arena[slot].prev = slot;
+        priv->orig = slot;
+    }
+    else
+    {
+        arena[slot].next = arena[priv->link].next;
+        arena[slot].prev = priv->link;
+        arena[arena[priv->link].next].prev = slot;
+        arena[priv->link].next = slot;
+    }
+
+    arena[slot].data = data;
+    priv->link = slot;
+    priv->length++;
+    CHAIN_STATS_LENGTH(&priv->stats, priv->length);
+}
+
+//------------------------------------------------------------------------|
+// Unlink the current link without touching its data, return its slot to
+// the free list, and move to the previous link.  Callers count the link
+// as freed unless it is moving to another chain.
+static void slot_unlink(chain_compact_priv_t * priv)
+{
+    slot_t * arena = priv->arena;
+    uint32_t slot = priv->link;
+    uint32_t prev = arena[slot].prev;
+
+    if (priv->length == 1)
+    {
+        priv->link = SLOT_NIL;
+        priv->orig = SLOT_NIL;
+    }
+    else
+    {
+        if (priv->orig == slot)
+        {
+            priv->orig = arena[slot].next;
+        }
+
+        arena[prev].next = arena[slot].next;
+        arena[arena[slot].next].prev = prev;
+        priv->link = prev;
+    }
+
+    slot_free(priv, slot);
+    priv->length--;
+}
+
+//------------------------------------------------------------------------|
+static chain_t * chain_compact_create_with(data_destroy_f data_destroy,
+                                           const allocator_t * allocator)
+{
+    allocator = allocator ? allocator : allocator_default();
+
+    // Allocate and initialize public interface
+    chain_t * chain = (chain_t *) allocator_alloc(allocator, sizeof(chain_t));
+    if (!chain)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(chain_t)) failed");
+        return NULL;
+    }
+
+    // bulk copy all function pointers and init opaque ptr
+    memcpy(chain, &chain_compact_pub, sizeof(chain_t));
+
+    // Allocate and initialize private implementation
+    chain->priv = allocator_alloc(allocator, sizeof(chain_compact_priv_t));
+    if (!chain->priv)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(chain_compact_priv_t)) failed");
+        allocator_free(allocator, chain, sizeof(chain_t));
+        return NULL;
+    }
+
+    memset(chain->priv, 0, sizeof(chain_compact_priv_t));
+    slot_reset((chain_compact_priv_t *) chain->priv);
+    ((chain_compact_priv_t *) chain->priv)->data_destroy = data_destroy;
+    ((chain_compact_priv_t *) chain->priv)->allocator = *allocator;
+
+    return chain;
+}
+
+//------------------------------------------------------------------------|
+static chain_t * chain_compact_create(data_destroy_f data_destroy)
+{
+    return chain_compact_create_with(data_destroy, NULL);
+}
+
+//------------------------------------------------------------------------|
+static void chain_compact_destroy(void * chain_ptr)
+{
+    chain_t * chain = (chain_t *) chain_ptr;
+
+    // guard against accidental double-destroy or early-destroy
+    if (!chain || !chain->priv)
+    {
+        BLAMMO(WARNING, "attempt to early or double-destroy\n");
+        return;
+    }
+
+    // remove all links and destroy their data
+    chain->clear(chain);
+
+    // the allocator is about to be wiped along with everything else
+    allocator_t allocator = ((chain_compact_priv_t *) chain->priv)->allocator;
+
+    // zero out and destroy the private data
+    memset(chain->priv, 0, sizeof(chain_compact_priv_t));
+    allocator_free(&allocator, chain->priv, sizeof(chain_compact_priv_t));
+
+    // zero out and destroy the public interface
+    memset(chain, 0, sizeof(chain_t));
+    allocator_free(&allocator, chain, sizeof(chain_t));
+}
+
+//------------------------------------------------------------------------|
+static void * chain_compact_data(chain_t * chain)
+{
+    chain_compact_priv_t * priv = (chain_compact_priv_t *) chain->priv;
+
+    if (SLOT_NIL == priv->link)
+    {
+        return NULL;
+    }
+
+    return priv->arena[priv->link].data;
+}
+
+//------------------------------------------------------------------------|
+static inline size_t chain_compact_length(chain_t * chain)
+{
+    return ((chain_compact_priv_t *) chain->priv)->length;
+}
+
+//------------------------------------------------------------------------|
+static inline bool chain_compact_empty(chain_t * chain)
+{
+    return (SLOT_NIL == ((chain_compact_priv_t *) chain->priv)->link);
+}
+
+//------------------------------------------------------------------------|
+static inline bool chain_compact_origin(chain_t * chain)
+{
+    chain_compact_priv_t * priv = (chain_compact_priv_t *) chain->priv;
+    return (priv->orig == priv->link);
+}
+
+//------------------------------------------------------------------------|
+static void chain_compact_clear(chain_t * chain)
+{
+    chain_compact_priv_t * priv = (chain_compact_priv_t *) chain->priv;
+    uint32_t slot = priv->orig;
+    size_t index;
+
+    // No need to unlink one at a time: destroy the payloads in order and
+    // then release the whole arena in one go.
+    if (NULL != priv->data_destroy)
+    {
+        for (index = 0; index < priv->length; index++)
+        {
+            if (NULL != priv->arena[slot].data)
+            {
+                priv->data_destroy(priv->arena[slot].data);
+            }
+
+            slot = priv->arena[slot].next;
+        }
+    }
+
+    slot_release(priv, priv->length);
+}
+
+//------------------------------------------------------------------------|
+static void chain_compact_insert(chain_t * chain, void * data)
+{
+    chain_compact_priv_t * priv = (chain_compact_priv_t *) chain->priv;
+    uint32_t slot = slot_alloc(priv);
+
+    if (SLOT_NIL == slot)
+    {
+        BLAMMO(ERROR, "slot_alloc() failed\n");
+        return;
+    }
+
+    slot_link(priv, slot, data);
+    CHAIN_STATS_ALLOC(&priv->stats, 1, 0, 0);
+}
+
+//------------------------------------------------------------------------|
+static void chain_compact_remove(chain_t * chain)
+{
+    chain_compact_priv_t * priv = (chain_compact_priv_t *) chain->priv;
+
+    if (SLOT_NIL == priv->link)
+    {
+        return;
+    }
+
+    // free link's data contents
+    if ((NULL != priv->arena[priv->link].data) &&
+        (NULL != priv->data_destroy))
+    {
+        priv->data_destroy(priv->arena[priv->link].data);
+    }
+
+    slot_unlink(priv);
+    CHAIN_STATS_FREE(&priv->stats, 1, 0, 0);
+}
+
+//------------------------------------------------------------------------|
+static inline void chain_compact_reset(chain_t * chain)
+{
+    chain_compact_priv_t * priv = (chain_compact_priv_t *) chain->priv;
+    priv->link = priv->orig;
+}
+
+//------------------------------------------------------------------------|
+static bool chain_compact_spin(chain_t * chain, int64_t index)
+{
+    chain_compact_priv_t * priv = (chain_compact_priv_t *) chain->priv;
+
+    if (SLOT_NIL == priv->link)
+    {
+        return false;
+    }
+
+    // The chain is circular, so whole revolutions can be skipped
+    index %= (int64_t) priv->length;
+    CHAIN_STATS_SPIN(&priv->stats, index);
+
+    while (index > 0)
+    {
+        priv->link = priv->arena[priv->link].next;
+        index--;
+    }
+
+    while (index < 0)
+    {
+        priv->link = priv->arena[priv->link].prev;
+        index++;
+    }
+
+    return (priv->link != priv->orig);
+}
+
+//------------------------------------------------------------------------|
+static size_t chain_compact_trim(chain_t * chain)
+{
+    chain_compact_priv_t * priv = (chain_compact_priv_t *) chain->priv;
+    size_t count = priv->length;
+    size_t trimmed = 0;
+    uint32_t slot = priv->orig;
+    uint32_t next;
+    size_t index;
+
+    // Visit every link exactly once, starting from the origin.  The next
+    // index is taken first because unlinking reuses the slot's 'next'.
+    for (index = 0; index < count; index++)
+    {
+        next = priv->arena[slot].next;
+
+        if (NULL == priv->arena[slot].data)
+        {
+            priv->link = slot;
+            slot_unlink(priv);
+            CHAIN_STATS_FREE(&priv->stats, 1, 0, 0);
+            trimmed++;
+        }
+
+        slot = next;
+    }
+
+    priv->link = priv->orig;
+    return trimmed;
+}
+
+//------------------------------------------------------------------------|
+static void chain_compact_sort(chain_t * chain, data_compare_f data_compare)
+{
+    chain_compact_priv_t * priv = (chain_compact_priv_t *) chain->priv;
+    void ** data_ptrs = NULL;
+    uint32_t slot = priv->orig;
+    size_t index;
+
+    // cannot sort lists of length 0 or 1
+    if ((priv->length < 2) || (data_compare == NULL))
+    {
+        return;
+    }
+
+    data_ptrs = (void **) malloc(sizeof(void *) * priv->length);
+    if (!data_ptrs)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(void *) * %zu) failed\n", priv->length);
+        return;
+    }
+
+    for (index = 0; index < priv->length; index++)
+    {
+        data_ptrs[index] = priv->arena[slot].data;
+        slot = priv->arena[slot].next;
+    }
+
+    CHAIN_STATS_SORT_BEGIN(start);
+    qsort(data_ptrs, priv->length, sizeof(void *), data_compare);
+    CHAIN_STATS_SORT_END(&priv->stats, start);
+
+    // slot is back at the origin after a full revolution
+    for (index = 0; index < priv->length; index++)
+    {
+        priv->arena[slot].data = data_ptrs[index];
+        slot = priv->arena[slot].next;
+    }
+
+    priv->link = priv->orig;
+    free(data_ptrs);
+}
+
+//------------------------------------------------------------------------|
+static chain_t * chain_compact_copy(chain_t * chain, data_copy_f data_copy)
+{
+    chain_compact_priv_t * priv = (chain_compact_priv_t *) chain->priv;
+    chain_t * copy = chain_compact_create_with(priv->data_destroy,
+                                               &priv->allocator);
+    chain_compact_priv_t * copy_priv = NULL;
+    uint32_t slot = priv->orig;
+    size_t index;
+    void * data;
+
+    if (NULL == copy)
+    {
+        BLAMMO(ERROR, "chain_compact_create() copy failed\n");
+        return NULL;
+    }
+
+    // one allocation up front for the entire copy
+    copy_priv = (chain_compact_priv_t *) copy->priv;
+    if (!slot_reserve(copy_priv, priv->length))
+    {
+        copy->destroy(copy);
+        return NULL;
+    }
+
+    for (index = 0; index < priv->length; index++)
+    {
+        data = priv->arena[slot].data;
+        slot_link(copy_priv, slot_alloc(copy_priv),
+                  data_copy ? data_copy(data) : data);
+        slot = priv->arena[slot].next;
+    }
+
+    CHAIN_STATS_ALLOC(&copy_priv->stats, priv->length, 0, 0);
+
+    return copy;
+}
+
+//------------------------------------------------------------------------|
+// Because the arena belongs to one chain, links cannot simply be respliced
+// into another chain as chain_split() does.  Instead the segment's payloads
+// are moved over into a fresh arena, which is still a single allocation.
+static chain_t * chain_compact_split(chain_t * chain, size_t begin, size_t end)
+{
+    chain_compact_priv_t * priv = (chain_compact_priv_t *) chain->priv;
+    chain_t * seg = NULL;
+    chain_compact_priv_t * seg_priv = NULL;
+    size_t index;
+
+    if ((begin > end) || (end > priv->length))
+    {
+        BLAMMO(ERROR, "invalid segment [%zu, %zu) of length %zu\n",
+               begin, end, priv->length);
+        return NULL;
+    }
+
+    seg = chain_compact_create_with(priv->data_destroy, &priv->allocator);
+    if (NULL == seg)
+    {
+        BLAMMO(ERROR, "chain_compact_create() seg failed\n");
+        return NULL;
+    }
+
+    seg_priv = (chain_compact_priv_t *) seg->priv;
+    if (!slot_reserve(seg_priv, end - begin))
+    {
+        seg->destroy(seg);
+        return NULL;
+    }
+
+    // advance the chain to the first link to cut
+    chain->reset(chain);
+    chain->spin(chain, begin);
+
+    // move each payload over, then step forward past the unlinked slot
+    for (index = begin; index < end; index++)
+    {
+        slot_link(seg_priv, slot_alloc(seg_priv),
+                  priv->arena[priv->link].data);
+        slot_unlink(priv);
+
+        if (SLOT_NIL != priv->link)
+        {
+            priv->link = priv->arena[priv->link].next;
+        }
+    }
+
+    seg->reset(seg);
+    return seg;
+}
+
+//------------------------------------------------------------------------|
+static bool chain_compact_join(chain_t * head, chain_t * tail)
+{
+    chain_compact_priv_t * head_priv = (chain_compact_priv_t *) head->priv;
+    chain_compact_priv_t * tail_priv = (chain_compact_priv_t *) tail->priv;
+    uint32_t slot;
+    size_t index;
+
+    // The tail must also be a compact chain
+    if (tail->join != head->join)
+    {
+        BLAMMO(ERROR, "chain_compact_join() cannot join chains with "
+            "different link representations\n");
+        return false;
+    }
+
+    // Cannot join chains of dissimilar data types
+    if (head_priv->data_destroy != tail_priv->data_destroy)
+    {
+        BLAMMO(ERROR, "chain_compact_join() cannot join chains with "
+            "dissimilar data destructors %p and %p\n",
+            head_priv->data_destroy,
+            tail_priv->data_destroy);
+        return false;
+    }
+
+    // An arena may change hands, so must be freed by its own allocator
+    if (!allocator_same(&head_priv->allocator, &tail_priv->allocator))
+    {
+        BLAMMO(ERROR, "chain_compact_join() cannot join chains with "
+            "different allocators\n");
+        return false;
+    }
+
+    // An empty head can just take over the tail's arena wholesale
+    if (SLOT_NIL == head_priv->link)
+    {
+        slot_release(head_priv, 0);
+        head_priv->arena = tail_priv->arena;
+        head_priv->capacity = tail_priv->capacity;
+        head_priv->used = tail_priv->used;
+        head_priv->free = tail_priv->free;
+        head_priv->orig = tail_priv->orig;
+        head_priv->length = tail_priv->length;
+        CHAIN_STATS_MOVE(&tail_priv->stats, &head_priv->stats,
+                         tail_priv->capacity * sizeof(slot_t),
+                         tail_priv->arena ? 1 : 0);
+        CHAIN_STATS_LENGTH(&head_priv->stats, head_priv->length);
+        slot_reset(tail_priv);
+        head->reset(head);
+        return true;
+    }
+
+    if (SLOT_NIL == tail_priv->link)
+    {
+        return true;
+    }
+
+    if (!slot_reserve(head_priv, tail_priv->length))
+    {
+        return false;
+    }
+
+    // append after the head's last link, which is the origin's previous
+    head_priv->link = head_priv->arena[head_priv->orig].prev;
+    slot = tail_priv->orig;
+    for (index = 0; index < tail_priv->length; index++)
+    {
+        slot_link(head_priv, slot_alloc(head_priv),
+                  tail_priv->arena[slot].data);
+        slot = tail_priv->arena[slot].next;
+    }
+
+    // the head now owns all payloads, so release the tail's arena without
+    // destroying any of them.
+    slot_release(tail_priv, 0);
+
+    head->reset(head);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool chain_compact_reserve(chain_t * chain, size_t count)
+{
+    return slot_reserve((chain_compact_priv_t *) chain->priv, count);
+}
+
+#ifdef CHAIN_STATS_ENABLE
+//------------------------------------------------------------------------|
+static void chain_compact_stats(chain_t * chain, chain_stats_t * stats)
+{
+    memcpy(stats, &((chain_compact_priv_t *) chain->priv)->stats,
+           sizeof(chain_stats_t));
+}
+#endif
+
+//------------------------------------------------------------------------|
+const chain_t chain_compact_pub = {
+    &chain_compact_create,
+    &chain_compact_create_with,
+    &chain_compact_destroy,
+    &chain_compact_data,
+    &chain_compact_length,
+    &chain_compact_empty,
+    &chain_compact_origin,
+    &chain_compact_clear,
+    &chain_compact_insert,
+    &chain_compact_remove,
+    &chain_compact_reset,
+    &chain_compact_spin,
+    &chain_compact_trim,
+    &chain_compact_sort,
+    &chain_compact_copy,
+    &chain_compact_split,
+    &chain_compact_join,
+    &chain_compact_reserve,
+#ifdef CHAIN_STATS_ENABLE
+    &chain_compact_stats,
+#endif
+    NULL
+};
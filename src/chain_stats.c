@@ -0,0 +1,145 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime()
+
+#include "chain_stats.h"
+
+#ifdef CHAIN_STATS_ENABLE
+
+#include <time.h>
+
+//------------------------------------------------------------------------|
+// Totals over all chains.  peak_length here is the most links alive at
+// once, which is tracked as allocations less frees.  Chains in different
+// threads update these concurrently, so every access is atomic.
+static chain_stats_t global;
+
+#define GLOBAL_ADD(field, n) \
+        __atomic_add_fetch(&global.field, (n), __ATOMIC_RELAXED)
+#define GLOBAL_SUB(field, n) \
+        __atomic_sub_fetch(&global.field, (n), __ATOMIC_RELAXED)
+#define GLOBAL_LOAD(field) \
+        __atomic_load_n(&global.field, __ATOMIC_RELAXED)
+
+//------------------------------------------------------------------------|
+void chain_stats_alloc(chain_stats_t * stats, size_t links, size_t bytes,
+                       size_t blocks)
+{
+    uint64_t alive, peak;
+
+    stats->links_allocated += links;
+    stats->link_bytes += bytes;
+    stats->allocations += blocks;
+
+    alive = GLOBAL_ADD(links_allocated, links) - GLOBAL_LOAD(links_freed);
+    GLOBAL_ADD(link_bytes, bytes);
+    GLOBAL_ADD(allocations, blocks);
+
+    // raise the peak unless another thread has already raised it further
+    peak = GLOBAL_LOAD(peak_length);
+    while (alive > peak &&
+           !__atomic_compare_exchange_n(&global.peak_length, &peak, alive,
+                                        true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED))
+    {
+        // 'peak' now holds what the other thread stored
+    }
+}
+
+//------------------------------------------------------------------------|
+void chain_stats_free(chain_stats_t * stats, size_t links, size_t bytes,
+                      size_t blocks)
+{
+    stats->links_freed += links;
+    stats->link_bytes -= bytes;
+    stats->allocations -= blocks;
+
+    GLOBAL_ADD(links_freed, links);
+    GLOBAL_SUB(link_bytes, bytes);
+    GLOBAL_SUB(allocations, blocks);
+}
+
+//------------------------------------------------------------------------|
+// Memory changing hands between chains makes no global difference
+void chain_stats_move(chain_stats_t * from, chain_stats_t * to,
+                      size_t bytes, size_t blocks)
+{
+    from->link_bytes -= bytes;
+    from->allocations -= blocks;
+    to->link_bytes += bytes;
+    to->allocations += blocks;
+}
+
+//------------------------------------------------------------------------|
+void chain_stats_length(chain_stats_t * stats, size_t length)
+{
+    if (length > stats->peak_length)
+    {
+        stats->peak_length = length;
+    }
+}
+
+//------------------------------------------------------------------------|
+// Negated as unsigned, so that INT64_MIN has a magnitude too
+void chain_stats_spin(chain_stats_t * stats, int64_t offset)
+{
+    uint64_t count = offset < 0 ? 0 - (uint64_t) offset : (uint64_t) offset;
+
+    stats->spins += count;
+    GLOBAL_ADD(spins, count);
+}
+
+//------------------------------------------------------------------------|
+void chain_stats_sort(chain_stats_t * stats, uint64_t nsec)
+{
+    stats->sorts++;
+    stats->sort_nsec += nsec;
+    GLOBAL_ADD(sorts, 1);
+    GLOBAL_ADD(sort_nsec, nsec);
+}
+
+//------------------------------------------------------------------------|
+uint64_t chain_stats_clock(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+//------------------------------------------------------------------------|
+// Each counter is read atomically, though not all at the same instant
+void chain_stats_global(chain_stats_t * stats)
+{
+    stats->links_allocated = GLOBAL_LOAD(links_allocated);
+    stats->links_freed = GLOBAL_LOAD(links_freed);
+    stats->link_bytes = GLOBAL_LOAD(link_bytes);
+    stats->allocations = GLOBAL_LOAD(allocations);
+    stats->peak_length = GLOBAL_LOAD(peak_length);
+    stats->spins = GLOBAL_LOAD(spins);
+    stats->sorts = GLOBAL_LOAD(sorts);
+    stats->sort_nsec = GLOBAL_LOAD(sort_nsec);
+}
+
+#endif // #ifdef CHAIN_STATS_ENABLE
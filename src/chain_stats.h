@@ -0,0 +1,71 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include "chain.h"
+
+//------------------------------------------------------------------------|
+// Internal hooks through which chain implementations keep the counters
+// described in chain.h.  Each takes a pointer to the chain's own
+// chain_stats_t and also updates the global totals.  Without
+// CHAIN_STATS_ENABLE they are empty macros, so their arguments are never
+// evaluated and need not even exist.
+#ifndef CHAIN_STATS_ENABLE
+#define CHAIN_STATS_ALLOC(stats, links, bytes, blocks)
+#define CHAIN_STATS_FREE(stats, links, bytes, blocks)
+#define CHAIN_STATS_MOVE(from, to, bytes, blocks)
+#define CHAIN_STATS_LENGTH(stats, length)
+#define CHAIN_STATS_SPIN(stats, offset)
+#define CHAIN_STATS_SORT_BEGIN(start)
+#define CHAIN_STATS_SORT_END(stats, start)
+
+#else
+#define CHAIN_STATS_ALLOC(stats, links, bytes, blocks) \
+        chain_stats_alloc(stats, links, bytes, blocks)
+#define CHAIN_STATS_FREE(stats, links, bytes, blocks) \
+        chain_stats_free(stats, links, bytes, blocks)
+#define CHAIN_STATS_MOVE(from, to, bytes, blocks) \
+        chain_stats_move(from, to, bytes, blocks)
+#define CHAIN_STATS_LENGTH(stats, length) \
+        chain_stats_length(stats, length)
+#define CHAIN_STATS_SPIN(stats, offset) \
+        chain_stats_spin(stats, offset)
+#define CHAIN_STATS_SORT_BEGIN(start) \
+        uint64_t start = chain_stats_clock()
+#define CHAIN_STATS_SORT_END(stats, start) \
+        chain_stats_sort(stats, chain_stats_clock() - (start))
+
+//------------------------------------------------------------------------|
+void chain_stats_alloc(chain_stats_t * stats, size_t links, size_t bytes,
+                       size_t blocks);
+void chain_stats_free(chain_stats_t * stats, size_t links, size_t bytes,
+                      size_t blocks);
+void chain_stats_move(chain_stats_t * from, chain_stats_t * to,
+                      size_t bytes, size_t blocks);
+void chain_stats_length(chain_stats_t * stats, size_t length);
+void chain_stats_spin(chain_stats_t * stats, int64_t offset);
+void chain_stats_sort(chain_stats_t * stats, uint64_t nsec);
+uint64_t chain_stats_clock(void);
+
+#endif // #ifdef CHAIN_STATS_ENABLE
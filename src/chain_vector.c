@@ -0,0 +1,616 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// Vector chain: Same interface and cursor semantics as chain_pub, but the
+// payload pointers are kept in one contiguous, geometrically-growing
+// array.  The 'origin' is always index 0, and spin() wraps around just as
+// a chain does.  Appending (inserting while positioned at the last
+// element) is amortized O(1), as are random access and iteration.
+// Inserting or removing in the middle is O(n) because the tail must move.
+
+#include "chain.h"
+#include "chain_stats.h"
+#include "blammo.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------|
+// Capacity of the first array allocation, in elements
+#define VECTOR_MIN_CAP  8
+
+// Most elements an array can hold without its size in bytes overflowing
+#define VECTOR_MAX_CAP  (SIZE_MAX / sizeof(void *))
+
+//------------------------------------------------------------------------|
+// vector chain private implementation data
+typedef struct
+{
+    // The array of data payload pointers
+    void ** array;
+
+    // Number of elements in use
+    size_t length;
+
+    // Number of elements allocated
+    size_t capacity;
+
+    // Index of the current element
+    size_t index;
+
+    // The data destructor function for all elements.
+    // This can be NULL for static or unmanaged data
+    data_destroy_f data_destroy;
+
+    // Where all of this chain's memory comes from
+    allocator_t allocator;
+
+#ifdef CHAIN_STATS_ENABLE
+    // Memory and activity counters for this chain
+    chain_stats_t stats;
+#endif
+}
+chain_vector_priv_t;
+
+//------------------------------------------------------------------------|
+static inline void array_reset(chain_vector_priv_t * priv)
+{
+    priv->array = NULL;
+    priv->length = 0;
+    priv->capacity = 0;
+    priv->index = 0;
+}
+
+//------------------------------------------------------------------------|
+// Free the whole array without touching any payloads, and reset.  Only
+// 'freed' of the elements it held count as freed: the rest have moved on.
+static inline void array_release(chain_vector_priv_t * priv, size_t freed)
+{
+    CHAIN_STATS_FREE(&priv->stats, freed, priv->capacity * sizeof(void *),
+                     priv->array ? 1 : 0);
+    allocator_free(&priv->allocator, priv->array,
+                   priv->capacity * sizeof(void *));
+    array_reset(priv);
+}
+
+//------------------------------------------------------------------------|
+// Make room for at least 'count' elements in total, so that inserting up
+// to that many will not reallocate.  Growth is geometric.
+static bool array_reserve(chain_vector_priv_t * priv, size_t count)
+{
+    size_t capacity = priv->capacity ? priv->capacity : VECTOR_MIN_CAP;
+    void ** array = NULL;
+
+    if (count <= priv->capacity)
+    {
+        return true;
+    }
+
+    if (count > VECTOR_MAX_CAP)
+    {
+        BLAMMO(ERROR, "vector cannot hold %zu elements\n", count);
+        return false;
+    }
+
+    // grow geometrically so that repeated appends are amortized O(1),
+    // stopping at the limit rather than doubling past it.
+    while (capacity < count)
+    {
+        capacity = (capacity > VECTOR_MAX_CAP / 2) ? VECTOR_MAX_CAP :
+                   capacity * 2;
+    }
+
+    array = (void **) allocator_realloc(&priv->allocator, priv->array,
+                                        priv->capacity * sizeof(void *),
+                                        capacity * sizeof(void *));
+    if (NULL == array)
+    {
+        BLAMMO(ERROR, "realloc(%zu) failed\n", capacity * sizeof(void *));
+        return false;
+    }
+
+    CHAIN_STATS_ALLOC(&priv->stats, 0,
+                      (capacity - priv->capacity) * sizeof(void *),
+                      priv->array ? 0 : 1);
+
+    priv->array = array;
+    priv->capacity = capacity;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static chain_t * chain_vector_create_with(data_destroy_f data_destroy,
+                                          const allocator_t * allocator)
+{
+    allocator = allocator ? allocator : allocator_default();
+
+    // Allocate and initialize public interface
+    chain_t * chain = (chain_t *) allocator_alloc(allocator, sizeof(chain_t));
+    if (!chain)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(chain_t)) failed");
+        return NULL;
+    }
+
+    // bulk copy all function pointers and init opaque ptr
+    memcpy(chain, &chain_vector_pub, sizeof(chain_t));
+
+    // Allocate and initialize private implementation
+    chain->priv = allocator_alloc(allocator, sizeof(chain_vector_priv_t));
+    if (!chain->priv)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(chain_vector_priv_t)) failed");
+        allocator_free(allocator, chain, sizeof(chain_t));
+        return NULL;
+    }
+
+    memset(chain->priv, 0, sizeof(chain_vector_priv_t));
+    ((chain_vector_priv_t *) chain->priv)->data_destroy = data_destroy;
+    ((chain_vector_priv_t *) chain->priv)->allocator = *allocator;
+
+    return chain;
+}
+
+//------------------------------------------------------------------------|
+static chain_t * chain_vector_create(data_destroy_f data_destroy)
+{
+    return chain_vector_create_with(data_destroy, NULL);
+}
+
+//------------------------------------------------------------------------|
+static void chain_vector_destroy(void * chain_ptr)
+{
+    chain_t * chain = (chain_t *) chain_ptr;
+
+    // guard against accidental double-destroy or early-destroy
+    if (!chain || !chain->priv)
+    {
+        BLAMMO(WARNING, "attempt to early or double-destroy\n");
+        return;
+    }
+
+    // remove all elements and destroy their data
+    chain->clear(chain);
+
+    // the allocator is about to be wiped along with everything else
+    allocator_t allocator = ((chain_vector_priv_t *) chain->priv)->allocator;
+
+    // zero out and destroy the private data
+    memset(chain->priv, 0, sizeof(chain_vector_priv_t));
+    allocator_free(&allocator, chain->priv, sizeof(chain_vector_priv_t));
+
+    // zero out and destroy the public interface
+    memset(chain, 0, sizeof(chain_t));
+    allocator_free(&allocator, chain, sizeof(chain_t));
+}
+
+//------------------------------------------------------------------------|
+static void * chain_vector_data(chain_t * chain)
+{
+    chain_vector_priv_t * priv = (chain_vector_priv_t *) chain->priv;
+
+    if (priv->length == 0)
+    {
+        return NULL;
+    }
+
+    return priv->array[priv->index];
+}
+
+//------------------------------------------------------------------------|
+static inline size_t chain_vector_length(chain_t * chain)
+{
+    return ((chain_vector_priv_t *) chain->priv)->length;
+}
+
+//------------------------------------------------------------------------|
+static inline bool chain_vector_empty(chain_t * chain)
+{
+    return (0 == ((chain_vector_priv_t *) chain->priv)->length);
+}
+
+//------------------------------------------------------------------------|
+static inline bool chain_vector_origin(chain_t * chain)
+{
+    return (0 == ((chain_vector_priv_t *) chain->priv)->index);
+}
+
+//------------------------------------------------------------------------|
+static void chain_vector_clear(chain_t * chain)
+{
+    chain_vector_priv_t * priv = (chain_vector_priv_t *) chain->priv;
+    size_t index;
+
+    if (NULL != priv->data_destroy)
+    {
+        for (index = 0; index < priv->length; index++)
+        {
+            if (NULL != priv->array[index])
+            {
+                priv->data_destroy(priv->array[index]);
+            }
+        }
+    }
+
+    array_release(priv, priv->length);
+}
+
+//------------------------------------------------------------------------|
+static void chain_vector_insert(chain_t * chain, void * data)
+{
+    chain_vector_priv_t * priv = (chain_vector_priv_t *) chain->priv;
+    size_t index = priv->length ? priv->index + 1 : 0;
+
+    if (!array_reserve(priv, priv->length + 1))
+    {
+        return;
+    }
+
+    // open up a gap after the current element, unless appending
+    if (index < priv->length)
+    {
+        memmove(&priv->array[index + 1], &priv->array[index],
+                (priv->length - index) * sizeof(void *));
+    }
+
+    priv->array[index] = data;
+    priv->index = index;
+    priv->length++;
+    CHAIN_STATS_ALLOC(&priv->stats, 1, 0, 0);
+    CHAIN_STATS_LENGTH(&priv->stats, priv->length);
+}
+
+//------------------------------------------------------------------------|
+static void chain_vector_remove(chain_t * chain)
+{
+    chain_vector_priv_t * priv = (chain_vector_priv_t *) chain->priv;
+
+    if (priv->length == 0)
+    {
+        return;
+    }
+
+    if ((NULL != priv->array[priv->index]) && (NULL != priv->data_destroy))
+    {
+        priv->data_destroy(priv->array[priv->index]);
+    }
+
+    memmove(&priv->array[priv->index], &priv->array[priv->index + 1],
+            (priv->length - priv->index - 1) * sizeof(void *));
+    priv->length--;
+    CHAIN_STATS_FREE(&priv->stats, 1, 0, 0);
+
+    // move back to the previous element, wrapping around to the last
+    if (priv->index > 0)
+    {
+        priv->index--;
+    }
+    else
+    {
+        priv->index = priv->length ? priv->length - 1 : 0;
+    }
+}
+
+//------------------------------------------------------------------------|
+static inline void chain_vector_reset(chain_t * chain)
+{
+    ((chain_vector_priv_t *) chain->priv)->index = 0;
+}
+
+//------------------------------------------------------------------------|
+static bool chain_vector_spin(chain_t * chain, int64_t offset)
+{
+    chain_vector_priv_t * priv = (chain_vector_priv_t *) chain->priv;
+    int64_t length = (int64_t) priv->length;
+    int64_t index;
+
+    if (priv->length == 0)
+    {
+        return false;
+    }
+
+    // whole revolutions change nothing, and are not counted as stepped
+    offset %= length;
+    CHAIN_STATS_SPIN(&priv->stats, offset);
+
+    index = ((int64_t) priv->index + offset) % length;
+    priv->index = (size_t) (index < 0 ? index + length : index);
+
+    return (priv->index != 0);
+}
+
+//------------------------------------------------------------------------|
+static size_t chain_vector_trim(chain_t * chain)
+{
+    chain_vector_priv_t * priv = (chain_vector_priv_t *) chain->priv;
+    size_t kept = 0;
+    size_t index;
+    size_t trimmed;
+
+    // compact the surviving payloads toward the front in a single pass
+    for (index = 0; index < priv->length; index++)
+    {
+        if (NULL != priv->array[index])
+        {
+            priv->array[kept++] = priv->array[index];
+        }
+    }
+
+    trimmed = priv->length - kept;
+    priv->length = kept;
+    priv->index = 0;
+    CHAIN_STATS_FREE(&priv->stats, trimmed, 0, 0);
+    return trimmed;
+}
+
+//------------------------------------------------------------------------|
+static void chain_vector_sort(chain_t * chain, data_compare_f data_compare)
+{
+    chain_vector_priv_t * priv = (chain_vector_priv_t *) chain->priv;
+
+    if ((priv->length < 2) || (data_compare == NULL))
+    {
+        return;
+    }
+
+    // The payloads are already a contiguous array of pointers
+    CHAIN_STATS_SORT_BEGIN(start);
+    qsort(priv->array, priv->length, sizeof(void *), data_compare);
+    CHAIN_STATS_SORT_END(&priv->stats, start);
+    priv->index = 0;
+}
+
+//------------------------------------------------------------------------|
+static chain_t * chain_vector_copy(chain_t * chain, data_copy_f data_copy)
+{
+    chain_vector_priv_t * priv = (chain_vector_priv_t *) chain->priv;
+    chain_t * copy = chain_vector_create_with(priv->data_destroy,
+                                              &priv->allocator);
+    chain_vector_priv_t * copy_priv = NULL;
+    size_t index;
+
+    if (NULL == copy)
+    {
+        BLAMMO(ERROR, "chain_vector_create() copy failed\n");
+        return NULL;
+    }
+
+    copy_priv = (chain_vector_priv_t *) copy->priv;
+    if (!array_reserve(copy_priv, priv->length))
+    {
+        copy->destroy(copy);
+        return NULL;
+    }
+
+    // an empty array may still be NULL, which memcpy() must never see
+    if ((NULL == data_copy) && (priv->length > 0))
+    {
+        memcpy(copy_priv->array, priv->array, priv->length * sizeof(void *));
+    }
+    else if (NULL != data_copy)
+    {
+        for (index = 0; index < priv->length; index++)
+        {
+            copy_priv->array[index] = data_copy(priv->array[index]);
+        }
+    }
+
+    copy_priv->length = priv->length;
+    CHAIN_STATS_ALLOC(&copy_priv->stats, copy_priv->length, 0, 0);
+    CHAIN_STATS_LENGTH(&copy_priv->stats, copy_priv->length);
+    return copy;
+}
+
+//------------------------------------------------------------------------|
+static chain_t * chain_vector_split(chain_t * chain, size_t begin, size_t end)
+{
+    chain_vector_priv_t * priv = (chain_vector_priv_t *) chain->priv;
+    chain_t * seg = NULL;
+    chain_vector_priv_t * seg_priv = NULL;
+    size_t count = end - begin;
+
+    if ((begin > end) || (end > priv->length))
+    {
+        BLAMMO(ERROR, "invalid segment [%zu, %zu) of length %zu\n",
+               begin, end, priv->length);
+        return NULL;
+    }
+
+    seg = chain_vector_create_with(priv->data_destroy, &priv->allocator);
+    if (NULL == seg)
+    {
+        BLAMMO(ERROR, "chain_vector_create() seg failed\n");
+        return NULL;
+    }
+
+    seg_priv = (chain_vector_priv_t *) seg->priv;
+    if (!array_reserve(seg_priv, count))
+    {
+        seg->destroy(seg);
+        return NULL;
+    }
+
+    // move the segment out and close the gap it leaves behind, keeping
+    // NULL arrays of empty chains and segments away from memcpy()
+    if (count > 0)
+    {
+        memcpy(seg_priv->array, &priv->array[begin], count * sizeof(void *));
+    }
+
+    seg_priv->length = count;
+    CHAIN_STATS_LENGTH(&seg_priv->stats, seg_priv->length);
+
+    if ((count > 0) && (end < priv->length))
+    {
+        memmove(&priv->array[begin], &priv->array[end],
+                (priv->length - end) * sizeof(void *));
+    }
+
+    priv->length -= count;
+    priv->index = (begin < priv->length) ? begin : 0;
+
+    return seg;
+}
+
+//------------------------------------------------------------------------|
+static bool chain_vector_join(chain_t * head, chain_t * tail)
+{
+    chain_vector_priv_t * head_priv = (chain_vector_priv_t *) head->priv;
+    chain_vector_priv_t * tail_priv = NULL;
+
+    // The tail must also be a vector chain
+    if (tail->join != head->join)
+    {
+        BLAMMO(ERROR, "chain_vector_join() cannot join chains with "
+            "different link representations\n");
+        return false;
+    }
+
+    tail_priv = (chain_vector_priv_t *) tail->priv;
+
+    // Cannot join chains of dissimilar data types
+    if (head_priv->data_destroy != tail_priv->data_destroy)
+    {
+        BLAMMO(ERROR, "chain_vector_join() cannot join chains with "
+            "dissimilar data destructors %p and %p\n",
+            head_priv->data_destroy,
+            tail_priv->data_destroy);
+        return false;
+    }
+
+    // An array may change hands, so must be freed by its own allocator
+    if (!allocator_same(&head_priv->allocator, &tail_priv->allocator))
+    {
+        BLAMMO(ERROR, "chain_vector_join() cannot join chains with "
+            "different allocators\n");
+        return false;
+    }
+
+    // An empty head can take the tail's array wholesale
+    if (head_priv->length == 0)
+    {
+        array_release(head_priv, 0);
+        head_priv->array = tail_priv->array;
+        head_priv->length = tail_priv->length;
+        head_priv->capacity = tail_priv->capacity;
+        CHAIN_STATS_MOVE(&tail_priv->stats, &head_priv->stats,
+                         tail_priv->capacity * sizeof(void *),
+                         tail_priv->array ? 1 : 0);
+        CHAIN_STATS_LENGTH(&head_priv->stats, head_priv->length);
+        array_reset(tail_priv);
+        return true;
+    }
+
+    if (tail_priv->length == 0)
+    {
+        return true;
+    }
+
+    if (!array_reserve(head_priv, head_priv->length + tail_priv->length))
+    {
+        return false;
+    }
+
+    memcpy(&head_priv->array[head_priv->length], tail_priv->array,
+           tail_priv->length * sizeof(void *));
+    head_priv->length += tail_priv->length;
+    head_priv->index = 0;
+    CHAIN_STATS_LENGTH(&head_priv->stats, head_priv->length);
+
+    // the head has assumed ownership of all payloads
+    array_release(tail_priv, 0);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool chain_vector_reserve(chain_t * chain, size_t count)
+{
+    chain_vector_priv_t * priv = (chain_vector_priv_t *) chain->priv;
+
+    if (count > VECTOR_MAX_CAP - priv->length)
+    {
+        BLAMMO(ERROR, "vector cannot hold %zu more elements\n", count);
+        return false;
+    }
+
+    return array_reserve(priv, priv->length + count);
+}
+
+#ifdef CHAIN_STATS_ENABLE
+//------------------------------------------------------------------------|
+static void chain_vector_stats(chain_t * chain, chain_stats_t * stats)
+{
+    memcpy(stats, &((chain_vector_priv_t *) chain->priv)->stats,
+           sizeof(chain_stats_t));
+}
+#endif
+
+//------------------------------------------------------------------------|
+void * chain_vector_at(chain_t * chain, size_t index)
+{
+    chain_vector_priv_t * priv = (chain_vector_priv_t *) chain->priv;
+
+    // Only a vector chain has its payloads where an index can find them
+    if (chain->join != &chain_vector_join)
+    {
+        BLAMMO(ERROR, "chain_vector_at() called on a chain that is not "
+            "a vector chain\n");
+        return NULL;
+    }
+
+    if (index >= priv->length)
+    {
+        return NULL;
+    }
+
+    return priv->array[index];
+}
+
+//------------------------------------------------------------------------|
+const chain_t chain_vector_pub = {
+    &chain_vector_create,
+    &chain_vector_create_with,
+    &chain_vector_destroy,
+    &chain_vector_data,
+    &chain_vector_length,
+    &chain_vector_empty,
+    &chain_vector_origin,
+    &chain_vector_clear,
+    &chain_vector_insert,
+    &chain_vector_remove,
+    &chain_vector_reset,
+    &chain_vector_spin,
+    &chain_vector_trim,
+    &chain_vector_sort,
+    &chain_vector_copy,
+    &chain_vector_split,
+    &chain_vector_join,
+    &chain_vector_reserve,
+#ifdef CHAIN_STATS_ENABLE
+    &chain_vector_stats,
+#endif
+    NULL
+};
@@ -0,0 +1,755 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// The SIMD kernels follow the techniques described by Wojciech Muła and
+// Daniel Lemire in "Faster Base64 Encoding and Decoding Using AVX2
+// Instructions" (ACM TOW 2018).  Each kernel handles whole blocks from
+// the front of the input and returns how much it consumed, and the scalar
+// code finishes the rest.  A decode kernel also stops at the first block
+// with an invalid character, leaving the scalar code to report it.
+
+#include "codec.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CODEC_X86
+#include <immintrin.h>
+#endif
+
+//------------------------------------------------------------------------|
+static const char hexpairs[512] =
+    "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+static const char base64chars[2][64] = {
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+};
+
+// Values of each character, or -1 if it is not a digit
+static const int8_t hexvalues[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+// Values in the standard and URL alphabets, or -1 if not in them
+static const int8_t base64values[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+static const int8_t base64urlvalues[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, 63,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+//------------------------------------------------------------------------|
+// Kernel table, one entry per codec_simd_t level.  Scalar has none.
+typedef struct
+{
+    size_t (*hex_encode)(char * out, const uint8_t * in, size_t size);
+    size_t (*hex_decode)(uint8_t * out, const char * in, size_t size);
+    size_t (*base64_encode)(char * out, const uint8_t * in, size_t size,
+                            codec_base64_t alphabet);
+    size_t (*base64_decode)(uint8_t * out, const char * in, size_t size,
+                            codec_base64_t alphabet);
+}
+codec_kernels_t;
+
+// Level in use, or -1 until first use
+static int codec_level = -1;
+
+#if defined(CODEC_X86)
+//------------------------------------------------------------------------|
+// SSSE3 kernels
+__attribute__((target("ssse3")))
+static size_t hex_encode_ssse3(char * out, const uint8_t * in, size_t size)
+{
+    const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6',
+                                         '7', '8', '9', 'a', 'b', 'c', 'd',
+                                         'e', 'f');
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    size_t done = 0;
+
+    for (; size - done >= 16; done += 16)
+    {
+        __m128i data = _mm_loadu_si128((const __m128i *) (in + done));
+        __m128i high = _mm_shuffle_epi8(digits,
+                           _mm_and_si128(_mm_srli_epi16(data, 4), nibble));
+        __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(data, nibble));
+
+        _mm_storeu_si128((__m128i *) (out + 2 * done),
+                         _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128((__m128i *) (out + 2 * done + 16),
+                         _mm_unpackhi_epi8(high, low));
+    }
+
+    return done;
+}
+
+// Nibble values of 16 hex digits, with all bits of 'valid' set if every
+// one of them was a digit
+__attribute__((target("ssse3")))
+static inline __m128i hex_values_ssse3(__m128i text, __m128i * valid)
+{
+    __m128i digit = _mm_sub_epi8(text, _mm_set1_epi8('0'));
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(text, _mm_set1_epi8(0x20)),
+                                  _mm_set1_epi8('a'));
+    __m128i is_digit = _mm_cmpeq_epi8(
+        _mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    __m128i is_letter = _mm_cmpeq_epi8(
+        _mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+
+    *valid = _mm_and_si128(*valid, _mm_or_si128(is_digit, is_letter));
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+        _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3")))
+static size_t hex_decode_ssse3(uint8_t * out, const char * in, size_t size)
+{
+    // multiply-add pairs of nibbles into bytes: high * 16 + low
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    size_t done = 0;
+
+    for (; size - done >= 32; done += 32)
+    {
+        __m128i valid = _mm_set1_epi8(-1);
+        __m128i first = hex_values_ssse3(
+            _mm_loadu_si128((const __m128i *) (in + done)), &valid);
+        __m128i second = hex_values_ssse3(
+            _mm_loadu_si128((const __m128i *) (in + done + 16)), &valid);
+
+        if (_mm_movemask_epi8(valid) != 0xffff)
+        {
+            break;
+        }
+
+        _mm_storeu_si128((__m128i *) (out + done / 2),
+                         _mm_packus_epi16(_mm_maddubs_epi16(first, weights),
+                                          _mm_maddubs_epi16(second, weights)));
+    }
+
+    return done;
+}
+
+// Each 12 bytes read as 16 bytes make 16 characters, so the input must
+// have 4 bytes to spare
+__attribute__((target("ssse3")))
+static size_t base64_encode_ssse3(char * out, const uint8_t * in,
+                                  size_t size, codec_base64_t alphabet)
+{
+    const __m128i spread = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                         7, 6, 8, 7, 10, 9, 11, 10);
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, base64chars[alphabet][62] - 62,
+        base64chars[alphabet][63] - 63, 'A', 0, 0);
+    size_t done = 0;
+    char * next = out;
+
+    for (; size - done >= 16; done += 12, next += 16)
+    {
+        __m128i data = _mm_shuffle_epi8(
+            _mm_loadu_si128((const __m128i *) (in + done)), spread);
+
+        // split each 3 bytes into four 6-bit values, one per byte
+        __m128i high = _mm_mulhi_epu16(
+            _mm_and_si128(data, _mm_set1_epi32(0x0fc0fc00)),
+            _mm_set1_epi32(0x04000040));
+        __m128i low = _mm_mullo_epi16(
+            _mm_and_si128(data, _mm_set1_epi32(0x003f03f0)),
+            _mm_set1_epi32(0x01000010));
+        __m128i values = _mm_or_si128(high, low);
+
+        // map 0..25 to 13, 26..51 to 0, 52..61 to 1..10, 62 and 63 to 11
+        // and 12, then add the offset for that range
+        __m128i range = _mm_subs_epu8(values, _mm_set1_epi8(51));
+        range = _mm_or_si128(range, _mm_and_si128(
+            _mm_cmpgt_epi8(_mm_set1_epi8(26), values), _mm_set1_epi8(13)));
+
+        _mm_storeu_si128((__m128i *) next, _mm_add_epi8(values,
+                         _mm_shuffle_epi8(offsets, range)));
+    }
+
+    return done;
+}
+
+// 6-bit values of 16 characters, with all bits of 'valid' set if every
+// one of them was in the alphabet
+__attribute__((target("ssse3")))
+static inline __m128i base64_values_ssse3(__m128i text, __m128i * valid,
+                                          codec_base64_t alphabet)
+{
+    const char c62 = base64chars[alphabet][62];
+    const char c63 = base64chars[alphabet][63];
+
+    // bytes over 0x7f compare as negative and fall outside every range
+    __m128i upper = _mm_and_si128(
+        _mm_cmpgt_epi8(text, _mm_set1_epi8('A' - 1)),
+        _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), text));
+    __m128i lower = _mm_and_si128(
+        _mm_cmpgt_epi8(text, _mm_set1_epi8('a' - 1)),
+        _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), text));
+    __m128i digit = _mm_and_si128(
+        _mm_cmpgt_epi8(text, _mm_set1_epi8('0' - 1)),
+        _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), text));
+    __m128i is62 = _mm_cmpeq_epi8(text, _mm_set1_epi8(c62));
+    __m128i is63 = _mm_cmpeq_epi8(text, _mm_set1_epi8(c63));
+
+    __m128i shift = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')),
+                     _mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))),
+        _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(52 - '0')),
+            _mm_or_si128(_mm_and_si128(is62, _mm_set1_epi8(62 - c62)),
+                         _mm_and_si128(is63, _mm_set1_epi8(63 - c63)))));
+
+    *valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                          _mm_or_si128(digit, _mm_or_si128(is62, is63)));
+    return _mm_add_epi8(text, shift);
+}
+
+// Each 16 characters make 12 bytes written as 16, so this stops while
+// there are at least 8 characters, and so 6 bytes of output, still to go
+__attribute__((target("ssse3")))
+static size_t base64_decode_ssse3(uint8_t * out, const char * in,
+                                  size_t size, codec_base64_t alphabet)
+{
+    const __m128i gather = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                         14, 13, 12, -1, -1, -1, -1);
+    size_t done = 0;
+    uint8_t * next = out;
+
+    for (; size - done >= 24; done += 16, next += 12)
+    {
+        __m128i valid;
+        __m128i values = base64_values_ssse3(
+            _mm_loadu_si128((const __m128i *) (in + done)), &valid,
+            alphabet);
+
+        if (_mm_movemask_epi8(valid) != 0xffff)
+        {
+            break;
+        }
+
+        // pack pairs of 6-bit values into 12 bits, then pairs of those
+        // into 24, and gather the three bytes of each in order
+        values = _mm_madd_epi16(
+            _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)),
+            _mm_set1_epi32(0x00011000));
+
+        _mm_storeu_si128((__m128i *) next, _mm_shuffle_epi8(values, gather));
+    }
+
+    return done;
+}
+
+//------------------------------------------------------------------------|
+// AVX2 kernels.  Shuffles and packs work within each 128-bit lane, so
+// results are put back in order across lanes where needed.
+__attribute__((target("avx2")))
+static size_t hex_encode_avx2(char * out, const uint8_t * in, size_t size)
+{
+    const __m256i digits = _mm256_setr_epi8('0', '1', '2', '3', '4', '5',
+        '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f', '0', '1', '2', '3',
+        '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    size_t done = 0;
+
+    for (; size - done >= 32; done += 32)
+    {
+        __m256i data = _mm256_loadu_si256((const __m256i *) (in + done));
+        __m256i high = _mm256_shuffle_epi8(digits,
+                           _mm256_and_si256(_mm256_srli_epi16(data, 4),
+                                            nibble));
+        __m256i low = _mm256_shuffle_epi8(digits,
+                                          _mm256_and_si256(data, nibble));
+        __m256i first = _mm256_unpacklo_epi8(high, low);
+        __m256i second = _mm256_unpackhi_epi8(high, low);
+
+        _mm256_storeu_si256((__m256i *) (out + 2 * done),
+                            _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i *) (out + 2 * done + 32),
+                            _mm256_permute2x128_si256(first, second, 0x31));
+    }
+
+    return done;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i hex_values_avx2(__m256i text, __m256i * valid)
+{
+    __m256i digit = _mm256_sub_epi8(text, _mm256_set1_epi8('0'));
+    __m256i letter = _mm256_sub_epi8(
+        _mm256_or_si256(text, _mm256_set1_epi8(0x20)),
+        _mm256_set1_epi8('a'));
+    __m256i is_digit = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    __m256i is_letter = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+
+    *valid = _mm256_and_si256(*valid, _mm256_or_si256(is_digit, is_letter));
+    return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+        _mm256_and_si256(is_letter,
+                         _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2")))
+static size_t hex_decode_avx2(uint8_t * out, const char * in, size_t size)
+{
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    size_t done = 0;
+
+    for (; size - done >= 64; done += 64)
+    {
+        __m256i valid = _mm256_set1_epi8(-1);
+        __m256i first = hex_values_avx2(
+            _mm256_loadu_si256((const __m256i *) (in + done)), &valid);
+        __m256i second = hex_values_avx2(
+            _mm256_loadu_si256((const __m256i *) (in + done + 32)), &valid);
+
+        if (_mm256_movemask_epi8(valid) != -1)
+        {
+            break;
+        }
+
+        _mm256_storeu_si256((__m256i *) (out + done / 2),
+            _mm256_permute4x64_epi64(_mm256_packus_epi16(
+                _mm256_maddubs_epi16(first, weights),
+                _mm256_maddubs_epi16(second, weights)), 0xd8));
+    }
+
+    return done;
+}
+
+// Each lane takes 12 of 24 bytes, read as 16 from offsets 0 and 12, so
+// the input must have 4 bytes to spare
+__attribute__((target("avx2")))
+static size_t base64_encode_avx2(char * out, const uint8_t * in,
+                                 size_t size, codec_base64_t alphabet)
+{
+    const __m256i spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+        7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5, 4,
+        7, 6, 8, 7, 10, 9, 11, 10);
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, base64chars[alphabet][62] - 62,
+        base64chars[alphabet][63] - 63, 'A', 0, 0);
+    const __m256i lanes = _mm256_broadcastsi128_si256(offsets);
+    size_t done = 0;
+    char * next = out;
+
+    for (; size - done >= 28; done += 24, next += 32)
+    {
+        __m256i data = _mm256_inserti128_si256(_mm256_castsi128_si256(
+            _mm_loadu_si128((const __m128i *) (in + done))),
+            _mm_loadu_si128((const __m128i *) (in + done + 12)), 1);
+        data = _mm256_shuffle_epi8(data, spread);
+
+        __m256i high = _mm256_mulhi_epu16(
+            _mm256_and_si256(data, _mm256_set1_epi32(0x0fc0fc00)),
+            _mm256_set1_epi32(0x04000040));
+        __m256i low = _mm256_mullo_epi16(
+            _mm256_and_si256(data, _mm256_set1_epi32(0x003f03f0)),
+            _mm256_set1_epi32(0x01000010));
+        __m256i values = _mm256_or_si256(high, low);
+
+        __m256i range = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+        range = _mm256_or_si256(range, _mm256_and_si256(
+            _mm256_cmpgt_epi8(_mm256_set1_epi8(26), values),
+            _mm256_set1_epi8(13)));
+
+        _mm256_storeu_si256((__m256i *) next, _mm256_add_epi8(values,
+                            _mm256_shuffle_epi8(lanes, range)));
+    }
+
+    return done;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i base64_values_avx2(__m256i text, __m256i * valid,
+                                         codec_base64_t alphabet)
+{
+    const char c62 = base64chars[alphabet][62];
+    const char c63 = base64chars[alphabet][63];
+
+    __m256i upper = _mm256_and_si256(
+        _mm256_cmpgt_epi8(text, _mm256_set1_epi8('A' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), text));
+    __m256i lower = _mm256_and_si256(
+        _mm256_cmpgt_epi8(text, _mm256_set1_epi8('a' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), text));
+    __m256i digit = _mm256_and_si256(
+        _mm256_cmpgt_epi8(text, _mm256_set1_epi8('0' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), text));
+    __m256i is62 = _mm256_cmpeq_epi8(text, _mm256_set1_epi8(c62));
+    __m256i is63 = _mm256_cmpeq_epi8(text, _mm256_set1_epi8(c63));
+
+    __m256i shift = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-'A')),
+            _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a'))),
+        _mm256_or_si256(_mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')),
+            _mm256_or_si256(
+                _mm256_and_si256(is62, _mm256_set1_epi8(62 - c62)),
+                _mm256_and_si256(is63, _mm256_set1_epi8(63 - c63)))));
+
+    *valid = _mm256_or_si256(_mm256_or_si256(upper, lower),
+        _mm256_or_si256(digit, _mm256_or_si256(is62, is63)));
+    return _mm256_add_epi8(text, shift);
+}
+
+// Each 32 characters make 24 bytes written as 32, so this stops while
+// there are at least 16 characters, and so 12 bytes of output, still to go
+__attribute__((target("avx2")))
+static size_t base64_decode_avx2(uint8_t * out, const char * in,
+                                 size_t size, codec_base64_t alphabet)
+{
+    const __m256i gather = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+        14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8,
+        14, 13, 12, -1, -1, -1, -1);
+    const __m256i order = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    size_t done = 0;
+    uint8_t * next = out;
+
+    for (; size - done >= 48; done += 32, next += 24)
+    {
+        __m256i valid;
+        __m256i values = base64_values_avx2(
+            _mm256_loadu_si256((const __m256i *) (in + done)), &valid,
+            alphabet);
+
+        if (_mm256_movemask_epi8(valid) != -1)
+        {
+            break;
+        }
+
+        values = _mm256_madd_epi16(
+            _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)),
+            _mm256_set1_epi32(0x00011000));
+        values = _mm256_permutevar8x32_epi32(
+            _mm256_shuffle_epi8(values, gather), order);
+
+        _mm256_storeu_si256((__m256i *) next, values);
+    }
+
+    return done;
+}
+#endif
+
+static const codec_kernels_t codec_kernels[] = {
+    { NULL, NULL, NULL, NULL },
+#if defined(CODEC_X86)
+    {
+        hex_encode_ssse3, hex_decode_ssse3,
+        base64_encode_ssse3, base64_decode_ssse3
+    },
+    {
+        hex_encode_avx2, hex_decode_avx2,
+        base64_encode_avx2, base64_decode_avx2
+    },
+#endif
+};
+
+//------------------------------------------------------------------------|
+// Best level the CPU and operating system support
+static codec_simd_t codec_detect()
+{
+#if defined(CODEC_X86)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return CODEC_AVX2;
+    }
+
+    if (__builtin_cpu_supports("ssse3"))
+    {
+        return CODEC_SSSE3;
+    }
+#endif
+
+    return CODEC_SCALAR;
+}
+
+//------------------------------------------------------------------------|
+codec_simd_t codec_simd()
+{
+    int level = __atomic_load_n(&codec_level, __ATOMIC_RELAXED);
+
+    // racing first calls all detect the same thing
+    if (level < 0)
+    {
+        level = (int) codec_detect();
+        __atomic_store_n(&codec_level, level, __ATOMIC_RELAXED);
+    }
+
+    return (codec_simd_t) level;
+}
+
+//------------------------------------------------------------------------|
+codec_simd_t codec_simd_limit(codec_simd_t limit)
+{
+    codec_simd_t level = codec_detect();
+
+    if (limit < level)
+    {
+        level = limit;
+    }
+
+    __atomic_store_n(&codec_level, (int) level, __ATOMIC_RELAXED);
+    return level;
+}
+
+//------------------------------------------------------------------------|
+size_t codec_hex_encode(char * out, const uint8_t * in, size_t size)
+{
+    const codec_kernels_t * kernels = &codec_kernels[codec_simd()];
+    size_t i = 0;
+
+    if (kernels->hex_encode)
+    {
+        i = kernels->hex_encode(out, in, size);
+    }
+
+    for (; i < size; i++)
+    {
+        out[2 * i] = hexpairs[2 * in[i]];
+        out[2 * i + 1] = hexpairs[2 * in[i] + 1];
+    }
+
+    return 2 * size;
+}
+
+//------------------------------------------------------------------------|
+ssize_t codec_hex_decode(uint8_t * out, const char * in, size_t size)
+{
+    const codec_kernels_t * kernels = &codec_kernels[codec_simd()];
+    const uint8_t * text = (const uint8_t *) in;
+    size_t i = 0;
+    int high, low;
+
+    if (size % 2)
+    {
+        return -1;
+    }
+
+    if (kernels->hex_decode)
+    {
+        i = kernels->hex_decode(out, in, size);
+    }
+
+    for (; i < size; i += 2)
+    {
+        high = hexvalues[text[i]];
+        low = hexvalues[text[i + 1]];
+
+        if ((high | low) < 0)
+        {
+            return -1;
+        }
+
+        out[i / 2] = (uint8_t) (high << 4 | low);
+    }
+
+    return (ssize_t) (size / 2);
+}
+
+//------------------------------------------------------------------------|
+size_t codec_base64_encode(char * out, const uint8_t * in, size_t size,
+                           codec_base64_t alphabet)
+{
+    const codec_kernels_t * kernels = &codec_kernels[codec_simd()];
+    const char * chars = base64chars[alphabet];
+    size_t i = 0;
+    char * next = out;
+    uint32_t bits;
+
+    if (kernels->base64_encode)
+    {
+        i = kernels->base64_encode(out, in, size, alphabet);
+        next += i / 3 * 4;
+    }
+
+    for (; size - i >= 3; i += 3, next += 4)
+    {
+        bits = (uint32_t) in[i] << 16 | (uint32_t) in[i + 1] << 8 | in[i + 2];
+        next[0] = chars[bits >> 18];
+        next[1] = chars[(bits >> 12) & 0x3f];
+        next[2] = chars[(bits >> 6) & 0x3f];
+        next[3] = chars[bits & 0x3f];
+    }
+
+    if (i < size)
+    {
+        bits = (uint32_t) in[i] << 16;
+        if (size - i == 2)
+        {
+            bits |= (uint32_t) in[i + 1] << 8;
+        }
+
+        *next++ = chars[bits >> 18];
+        *next++ = chars[(bits >> 12) & 0x3f];
+        if (size - i == 2)
+        {
+            *next++ = chars[(bits >> 6) & 0x3f];
+        }
+
+        if (alphabet == CODEC_BASE64)
+        {
+            *next++ = '=';
+            if (size - i == 1)
+            {
+                *next++ = '=';
+            }
+        }
+    }
+
+    return (size_t) (next - out);
+}
+
+//------------------------------------------------------------------------|
+ssize_t codec_base64_decode(uint8_t * out, const char * in, size_t size,
+                            codec_base64_t alphabet)
+{
+    const codec_kernels_t * kernels = &codec_kernels[codec_simd()];
+    const int8_t * values = alphabet == CODEC_BASE64_URL ?
+                            base64urlvalues : base64values;
+    const uint8_t * text = (const uint8_t *) in;
+    uint8_t * next = out;
+    size_t i = 0, tail;
+    int a, b, c, d;
+    uint32_t bits;
+
+    // padding may only complete the last group of 4, and '=' anywhere
+    // else fails the table lookup below
+    if (size > 0 && size % 4 == 0 && in[size - 1] == '=')
+    {
+        size -= in[size - 2] == '=' ? 2 : 1;
+    }
+
+    tail = size % 4;
+    if (tail == 1)
+    {
+        return -1;
+    }
+
+    if (kernels->base64_decode)
+    {
+        i = kernels->base64_decode(out, in, size, alphabet);
+        next += i / 4 * 3;
+    }
+
+    for (; size - i >= 4; i += 4, next += 3)
+    {
+        a = values[text[i]];
+        b = values[text[i + 1]];
+        c = values[text[i + 2]];
+        d = values[text[i + 3]];
+
+        // any -1 sets the sign bit
+        if ((a | b | c | d) < 0)
+        {
+            return -1;
+        }
+
+        bits = (uint32_t) a << 18 | (uint32_t) b << 12 |
+               (uint32_t) c << 6 | (uint32_t) d;
+        next[0] = (uint8_t) (bits >> 16);
+        next[1] = (uint8_t) (bits >> 8);
+        next[2] = (uint8_t) bits;
+    }
+
+    if (tail)
+    {
+        a = values[text[i]];
+        b = values[text[i + 1]];
+        c = tail == 3 ? values[text[i + 2]] : 0;
+        bits = (uint32_t) a << 18 | (uint32_t) b << 12 | (uint32_t) c << 6;
+
+        // the unused low bits of the last character must be zero
+        if ((a | b | c) < 0 || (bits & (tail == 2 ? 0xffff : 0xff)))
+        {
+            return -1;
+        }
+
+        *next++ = (uint8_t) (bits >> 16);
+        if (tail == 3)
+        {
+            *next++ = (uint8_t) (bits >> 8);
+        }
+    }
+
+    return (ssize_t) (next - out);
+}
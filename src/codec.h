@@ -0,0 +1,89 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// CODEC: Hex and Base64 (RFC 4648) encoding and decoding.  Each has a
+// table-driven scalar implementation, and on x86 also SSSE3 and AVX2
+// kernels that are picked once at runtime from what the CPU supports, so
+// that one build runs everywhere.
+//
+// Encoders write into a caller-supplied buffer of at least the given
+// encoded size, do not terminate it, and return the length written.
+// Decoders validate all of their input, and return the number of bytes
+// written to a buffer of at least the given decoded size, or -1 if the
+// input was not well formed, in which case the buffer contents are
+// unspecified.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+//------------------------------------------------------------------------|
+// Output sizes for 'n' bytes or characters of input.  The decoded sizes
+// are exact for hex and an upper bound for Base64.
+#define CODEC_HEX_ENCODED(n)        (2 * (n))
+#define CODEC_HEX_DECODED(n)        ((n) / 2)
+#define CODEC_BASE64_ENCODED(n)     (((n) + 2) / 3 * 4)
+#define CODEC_BASE64_DECODED(n)     (((n) + 3) / 4 * 3)
+
+// Base64 alphabets.  The standard one uses '+' and '/' and pads the
+// output to a multiple of 4 with '='.  The URL and filename safe one uses
+// '-' and '_' and leaves the padding off.  Decoding accepts input with or
+// without padding for either alphabet, but no characters from the other.
+typedef enum
+{
+    CODEC_BASE64,
+    CODEC_BASE64_URL
+}
+codec_base64_t;
+
+// Instruction set levels, in increasing order
+typedef enum
+{
+    CODEC_SCALAR,
+    CODEC_SSSE3,
+    CODEC_AVX2
+}
+codec_simd_t;
+
+//------------------------------------------------------------------------|
+// Lower case hex encoding.  Decoding accepts either case, and an odd
+// number of digits is an error.
+size_t codec_hex_encode(char * out, const uint8_t * in, size_t size);
+ssize_t codec_hex_decode(uint8_t * out, const char * in, size_t size);
+
+// Base64 encoding in the given alphabet.  Decoding rejects characters
+// outside the alphabet, including whitespace, misplaced padding and
+// nonzero trailing bits, so that each value has only one valid encoding.
+size_t codec_base64_encode(char * out, const uint8_t * in, size_t size,
+                           codec_base64_t alphabet);
+ssize_t codec_base64_decode(uint8_t * out, const char * in, size_t size,
+                            codec_base64_t alphabet);
+
+//------------------------------------------------------------------------|
+// The level in use, which is the best the CPU supports unless it has been
+// limited.  Limiting is for tests and benchmarks, and returns the level
+// now in use, which may be lower than asked for.
+codec_simd_t codec_simd();
+codec_simd_t codec_simd_limit(codec_simd_t limit);
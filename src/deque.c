@@ -0,0 +1,465 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "deque.h"
+#include "blammo.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------|
+// Capacity of the first ring allocation, in payloads.  Must be a power
+// of two.
+#define DEQUE_MIN_CAP   8
+
+// Largest power of two capacity whose size in bytes can be represented
+#define DEQUE_MAX_CAP   ((SIZE_MAX / sizeof(void *)) / 2 + 1)
+
+//------------------------------------------------------------------------|
+// deque private implementation data
+typedef struct
+{
+    // The circular array of payload pointers
+    void ** ring;
+
+    // Ring capacity minus one.  Capacity is always a power of two so
+    // that wrapping an index is a single mask.
+    size_t mask;
+
+    // Index of the front payload within the ring
+    size_t head;
+
+    // Number of payloads in the deque
+    size_t length;
+
+    // Maximum number of payloads, or zero if unbounded
+    size_t bound;
+
+    // Whether pushing to a full bounded deque overwrites the opposite end
+    bool overwrite;
+
+    // The data destructor function for all payloads.
+    // This can be NULL for static or unmanaged data
+    data_destroy_f data_destroy;
+}
+deque_priv_t;
+
+//------------------------------------------------------------------------|
+static inline size_t deque_capacity(deque_priv_t * priv)
+{
+    return priv->ring ? priv->mask + 1 : 0;
+}
+
+//------------------------------------------------------------------------|
+static inline void deque_discard(deque_priv_t * priv, void * data)
+{
+    if ((NULL != data) && (NULL != priv->data_destroy))
+    {
+        priv->data_destroy(data);
+    }
+}
+
+//------------------------------------------------------------------------|
+// Copy 'count' ring entries starting at logical index 'index' out to a
+// linear array.  At most two runs are needed because of wrap-around.
+static void deque_copy_out(deque_priv_t * priv, size_t index,
+                           void ** data, size_t count)
+{
+    size_t start = (priv->head + index) & priv->mask;
+    size_t first = deque_capacity(priv) - start;
+
+    if (first > count)
+    {
+        first = count;
+    }
+
+    memcpy(data, &priv->ring[start], first * sizeof(void *));
+    memcpy(data + first, priv->ring, (count - first) * sizeof(void *));
+}
+
+//------------------------------------------------------------------------|
+// Copy 'count' entries from a linear array into the ring at logical
+// index 'index', which must already be within capacity.
+static void deque_copy_in(deque_priv_t * priv, size_t index,
+                          void * const * data, size_t count)
+{
+    size_t start = (priv->head + index) & priv->mask;
+    size_t first = deque_capacity(priv) - start;
+
+    if (first > count)
+    {
+        first = count;
+    }
+
+    memcpy(&priv->ring[start], data, first * sizeof(void *));
+    memcpy(priv->ring, data + first, (count - first) * sizeof(void *));
+}
+
+//------------------------------------------------------------------------|
+static deque_t * deque_create(data_destroy_f data_destroy, size_t bound,
+                              bool overwrite)
+{
+    // Allocate and initialize public interface
+    deque_t * deque = (deque_t *) malloc(sizeof(deque_t));
+    if (!deque)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(deque_t)) failed");
+        return NULL;
+    }
+
+    // bulk copy all function pointers and init opaque ptr
+    memcpy(deque, &deque_pub, sizeof(deque_t));
+
+    // Allocate and initialize private implementation
+    deque->priv = malloc(sizeof(deque_priv_t));
+    if (!deque->priv)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(deque_priv_t)) failed");
+        free(deque);
+        return NULL;
+    }
+
+    memset(deque->priv, 0, sizeof(deque_priv_t));
+    ((deque_priv_t *) deque->priv)->data_destroy = data_destroy;
+    ((deque_priv_t *) deque->priv)->bound = bound;
+    ((deque_priv_t *) deque->priv)->overwrite = overwrite;
+
+    return deque;
+}
+
+//------------------------------------------------------------------------|
+static void deque_destroy(void * deque_ptr)
+{
+    deque_t * deque = (deque_t *) deque_ptr;
+
+    // guard against accidental double-destroy or early-destroy
+    if (!deque || !deque->priv)
+    {
+        BLAMMO(WARNING, "attempt to early or double-destroy\n");
+        return;
+    }
+
+    deque->clear(deque);
+
+    // zero out and destroy the private data
+    memset(deque->priv, 0, sizeof(deque_priv_t));
+    free(deque->priv);
+
+    // zero out and destroy the public interface
+    memset(deque, 0, sizeof(deque_t));
+    free(deque);
+}
+
+//------------------------------------------------------------------------|
+static inline size_t deque_length(deque_t * deque)
+{
+    return ((deque_priv_t *) deque->priv)->length;
+}
+
+//------------------------------------------------------------------------|
+static inline bool deque_empty(deque_t * deque)
+{
+    return (0 == ((deque_priv_t *) deque->priv)->length);
+}
+
+//------------------------------------------------------------------------|
+static inline bool deque_full(deque_t * deque)
+{
+    deque_priv_t * priv = (deque_priv_t *) deque->priv;
+    return (priv->bound > 0) && (priv->length >= priv->bound);
+}
+
+//------------------------------------------------------------------------|
+static void deque_clear(deque_t * deque)
+{
+    deque_priv_t * priv = (deque_priv_t *) deque->priv;
+    size_t index;
+
+    if (NULL != priv->data_destroy)
+    {
+        for (index = 0; index < priv->length; index++)
+        {
+            deque_discard(priv, priv->ring[(priv->head + index) & priv->mask]);
+        }
+    }
+
+    free(priv->ring);
+    priv->ring = NULL;
+    priv->mask = 0;
+    priv->head = 0;
+    priv->length = 0;
+}
+
+//------------------------------------------------------------------------|
+static bool deque_reserve(deque_t * deque, size_t count)
+{
+    deque_priv_t * priv = (deque_priv_t *) deque->priv;
+    size_t capacity = DEQUE_MIN_CAP;
+    void ** ring = NULL;
+
+    // a bounded deque never needs more room than its bound
+    if ((priv->bound > 0) && (count > priv->bound))
+    {
+        count = priv->bound;
+    }
+
+    if (count <= deque_capacity(priv))
+    {
+        return true;
+    }
+
+    // the doubling below can then never overflow
+    if (count > DEQUE_MAX_CAP)
+    {
+        BLAMMO(ERROR, "deque cannot hold %zu payloads\n", count);
+        return false;
+    }
+
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+
+    // A fresh ring rather than realloc(), because the contents have to
+    // be un-wrapped to the start of the new ring anyway.
+    ring = (void **) malloc(capacity * sizeof(void *));
+    if (NULL == ring)
+    {
+        BLAMMO(ERROR, "malloc(%zu) failed\n", capacity * sizeof(void *));
+        return false;
+    }
+
+    if (priv->length > 0)
+    {
+        deque_copy_out(priv, 0, ring, priv->length);
+    }
+
+    free(priv->ring);
+    priv->ring = ring;
+    priv->mask = capacity - 1;
+    priv->head = 0;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// Make room for one more payload, either by growing or, for a full
+// bounded deque, by overwriting.  'back' is the end being pushed to.
+static bool deque_make_room(deque_t * deque, bool back)
+{
+    deque_priv_t * priv = (deque_priv_t *) deque->priv;
+
+    if (!deque_full(deque))
+    {
+        return deque_reserve(deque, priv->length + 1);
+    }
+
+    if (!priv->overwrite)
+    {
+        return false;
+    }
+
+    // drop the payload at the opposite end
+    if (back)
+    {
+        deque_discard(priv, deque->pop_front(deque));
+    }
+    else
+    {
+        deque_discard(priv, deque->pop_back(deque));
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool deque_push_back(deque_t * deque, void * data)
+{
+    deque_priv_t * priv = (deque_priv_t *) deque->priv;
+
+    if (!deque_make_room(deque, true))
+    {
+        return false;
+    }
+
+    priv->ring[(priv->head + priv->length) & priv->mask] = data;
+    priv->length++;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool deque_push_front(deque_t * deque, void * data)
+{
+    deque_priv_t * priv = (deque_priv_t *) deque->priv;
+
+    if (!deque_make_room(deque, false))
+    {
+        return false;
+    }
+
+    priv->head = (priv->head - 1) & priv->mask;
+    priv->ring[priv->head] = data;
+    priv->length++;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static void * deque_pop_back(deque_t * deque)
+{
+    deque_priv_t * priv = (deque_priv_t *) deque->priv;
+
+    if (priv->length == 0)
+    {
+        return NULL;
+    }
+
+    priv->length--;
+    return priv->ring[(priv->head + priv->length) & priv->mask];
+}
+
+//------------------------------------------------------------------------|
+static void * deque_pop_front(deque_t * deque)
+{
+    deque_priv_t * priv = (deque_priv_t *) deque->priv;
+    void * data = NULL;
+
+    if (priv->length == 0)
+    {
+        return NULL;
+    }
+
+    data = priv->ring[priv->head];
+    priv->head = (priv->head + 1) & priv->mask;
+    priv->length--;
+    return data;
+}
+
+//------------------------------------------------------------------------|
+static void * deque_at(deque_t * deque, size_t index)
+{
+    deque_priv_t * priv = (deque_priv_t *) deque->priv;
+
+    if (index >= priv->length)
+    {
+        return NULL;
+    }
+
+    return priv->ring[(priv->head + index) & priv->mask];
+}
+
+//------------------------------------------------------------------------|
+static void * deque_back(deque_t * deque)
+{
+    deque_priv_t * priv = (deque_priv_t *) deque->priv;
+    return priv->length ? deque_at(deque, priv->length - 1) : NULL;
+}
+
+//------------------------------------------------------------------------|
+static void * deque_front(deque_t * deque)
+{
+    return deque_at(deque, 0);
+}
+
+//------------------------------------------------------------------------|
+static size_t deque_push_back_span(deque_t * deque, void * const * data,
+                                   size_t count)
+{
+    deque_priv_t * priv = (deque_priv_t *) deque->priv;
+    size_t index;
+
+    // Overwriting may need to discard payloads one at a time, including
+    // some from this very span, so just let push_back() sort it out,
+    // stopping at the first that cannot be stored.
+    if ((priv->bound > 0) && priv->overwrite &&
+        (count > priv->bound - priv->length))
+    {
+        for (index = 0; index < count; index++)
+        {
+            if (!deque_push_back(deque, data[index]))
+            {
+                break;
+            }
+        }
+
+        return index;
+    }
+
+    if ((priv->bound > 0) && (count > priv->bound - priv->length))
+    {
+        count = priv->bound - priv->length;
+    }
+
+    if ((count == 0) || !deque_reserve(deque, priv->length + count))
+    {
+        return 0;
+    }
+
+    deque_copy_in(priv, priv->length, data, count);
+    priv->length += count;
+    return count;
+}
+
+//------------------------------------------------------------------------|
+static size_t deque_pop_front_span(deque_t * deque, void ** data,
+                                   size_t count)
+{
+    deque_priv_t * priv = (deque_priv_t *) deque->priv;
+
+    if (count > priv->length)
+    {
+        count = priv->length;
+    }
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    deque_copy_out(priv, 0, data, count);
+    priv->head = (priv->head + count) & priv->mask;
+    priv->length -= count;
+    return count;
+}
+
+//------------------------------------------------------------------------|
+const deque_t deque_pub = {
+    &deque_create,
+    &deque_destroy,
+    &deque_length,
+    &deque_empty,
+    &deque_full,
+    &deque_clear,
+    &deque_push_back,
+    &deque_push_front,
+    &deque_pop_back,
+    &deque_pop_front,
+    &deque_back,
+    &deque_front,
+    &deque_at,
+    &deque_push_back_span,
+    &deque_pop_front_span,
+    &deque_reserve,
+    NULL
+};
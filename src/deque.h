@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include "chain.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A double-ended queue of data payload pointers, kept in a power-of-two
+// circular array.  Pushing or popping at either end is amortized O(1)
+// with no per-element allocation, which makes this the container of choice
+// for FIFO and LIFO usage.
+//
+// Payloads are owned by the deque while they are in it, and are destroyed
+// by data_destroy on clear(), destroy(), or when overwritten.  Popping a
+// payload hands ownership back to the caller without destroying it.
+typedef struct deque_t
+{
+    // Factory function that creates a deque.  The destructor callback
+    // follows the same rules as for chain_t create().  If 'bound' is zero
+    // the deque grows as needed.  Otherwise it holds at most 'bound'
+    // payloads, and when full, pushes either fail or (if 'overwrite' is
+    // true) destroy and replace the payload at the opposite end, which
+    // for push_back() is the oldest.
+    struct deque_t * (*create)(data_destroy_f data_destroy, size_t bound,
+                               bool overwrite);
+
+    // Deque destructor function
+    void (*destroy)(void * deque);
+
+    // Get the deque's current length
+    size_t (*length)(struct deque_t * deque);
+
+    // Returns true if the deque is empty and false otherwise
+    bool (*empty)(struct deque_t * deque);
+
+    // Returns true if a bounded deque is at its bound.  Always false for
+    // an unbounded deque.
+    bool (*full)(struct deque_t * deque);
+
+    // Removes all payloads, destroying them, and releases the array
+    void (*clear)(struct deque_t * deque);
+
+    // Add a payload at the back or the front.  Returns false if the deque
+    // could not grow, or is bounded, full, and not overwriting.
+    bool (*push_back)(struct deque_t * deque, void * data);
+    bool (*push_front)(struct deque_t * deque, void * data);
+
+    // Remove and return the payload at the back or front, or NULL if the
+    // deque is empty.  The caller takes ownership of the payload.
+    void * (*pop_back)(struct deque_t * deque);
+    void * (*pop_front)(struct deque_t * deque);
+
+    // Peek at the payload at the back or front, or NULL if empty
+    void * (*back)(struct deque_t * deque);
+    void * (*front)(struct deque_t * deque);
+
+    // Peek at the payload at an index counted from the front, or NULL
+    // if out of range.
+    void * (*at)(struct deque_t * deque, size_t index);
+
+    // Push up to 'count' payloads from an array onto the back, in order,
+    // and return the number pushed.
+    size_t (*push_back_span)(struct deque_t * deque, void * const * data,
+                             size_t count);
+
+    // Pop up to 'count' payloads from the front into an array, in order,
+    // and return the number popped.  The caller takes ownership of them.
+    size_t (*pop_front_span)(struct deque_t * deque, void ** data,
+                             size_t count);
+
+    // Make room for at least 'count' payloads in total so that pushing up
+    // to that many will not reallocate.  Returns false on failure.
+    bool (*reserve)(struct deque_t * deque, size_t count);
+
+    // Private data
+    void * priv;
+}
+deque_t;
+
+//------------------------------------------------------------------------|
+// Public deque interface
+extern const deque_t deque_pub;
@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// The algorithm here follows wyhash (final version 4) by Wang Yi, which is
+// released into the public domain: https://github.com/wangyi-fudan/wyhash
+// It reads the input in native byte order, so hash values are not stable
+// across platforms of different endianness, which is fine for in-memory
+// containers.
+
+#include "hash.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+//------------------------------------------------------------------------|
+static const uint64_t secret[4] = {
+    0xa0761d6478bd642fULL,
+    0xe7037ed1a0b428dbULL,
+    0x8ebc6af09c88c6e3ULL,
+    0x589965cc75374cc3ULL
+};
+
+//------------------------------------------------------------------------|
+// 64x64 -> 128 bit multiply, folding the halves back into a and b
+static inline void mum(uint64_t * a, uint64_t * b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t) *a * *b;
+    *a = (uint64_t) r;
+    *b = (uint64_t) (r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32;
+    uint64_t la = (uint32_t) *a, lb = (uint32_t) *b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t mix(uint64_t a, uint64_t b)
+{
+    mum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t read64(const uint8_t * p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t read32(const uint8_t * p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// reads 1 to 3 bytes
+static inline uint64_t read3(const uint8_t * p, size_t k)
+{
+    return (((uint64_t) p[0]) << 16) | (((uint64_t) p[k >> 1]) << 8) | p[k - 1];
+}
+
+//------------------------------------------------------------------------|
+uint64_t hash_bytes(const void * data, size_t size, uint64_t seed)
+{
+    const uint8_t * p = (const uint8_t *) data;
+    uint64_t a, b;
+    size_t i = size;
+
+    seed ^= mix(seed ^ secret[0], secret[1]);
+
+    if (size <= 16)
+    {
+        if (size >= 4)
+        {
+            a = (read32(p) << 32) | read32(p + ((size >> 3) << 2));
+            b = (read32(p + size - 4) << 32) |
+                 read32(p + size - 4 - ((size >> 3) << 2));
+        }
+        else if (size > 0)
+        {
+            a = read3(p, size);
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        if (i > 48)
+        {
+            uint64_t see1 = seed, see2 = seed;
+
+            do
+            {
+                seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+                see1 = mix(read64(p + 16) ^ secret[2], read64(p + 24) ^ see1);
+                see2 = mix(read64(p + 32) ^ secret[3], read64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            }
+            while (i > 48);
+
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16)
+        {
+            seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    mum(&a, &b);
+    return mix(a ^ secret[0] ^ size, b ^ secret[1]);
+}
@@ -0,0 +1,673 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "hashmap.h"
+#include "hash.h"
+#include "blammo.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//------------------------------------------------------------------------|
+// Slots per probe group.  Groups are aligned, so no control bytes need to
+// be mirrored past the end of the table.
+#define GROUP_SIZE      16
+
+// Control byte values.  Full slots hold the low 7 bits of the key hash,
+// so only the special values have the high bit set.
+#define CTRL_EMPTY      ((int8_t) -128)     // 0b10000000
+#define CTRL_DELETED    ((int8_t) -2)       // 0b11111110
+
+// Keys up to this size are stored inline in the slot
+#define KEY_INLINE      sizeof(uint64_t)
+
+//------------------------------------------------------------------------|
+typedef struct
+{
+    // The key bytes, either inline or on the heap depending on size
+    union
+    {
+        uint8_t bytes[KEY_INLINE];
+        uint8_t * ptr;
+    }
+    key;
+
+    // Key size in bytes
+    size_t size;
+
+    // The value payload
+    void * value;
+}
+slot_t;
+
+// The most slots whose control bytes and slots fit in one allocation
+#define HASHMAP_MAX_CAP (SIZE_MAX / (1 + sizeof(slot_t)))
+
+// hash map private implementation data
+typedef struct
+{
+    // Control bytes, one per slot, followed in the same allocation by
+    // the slots themselves.
+    int8_t * ctrl;
+    slot_t * slots;
+
+    // Number of slots, always a multiple of GROUP_SIZE and a power of two
+    size_t capacity;
+
+    // Number of full slots
+    size_t length;
+
+    // Number of deleted slots (tombstones)
+    size_t deleted;
+
+    // The value destructor function for all entries.
+    // This can be NULL for static or unmanaged data
+    data_destroy_f data_destroy;
+}
+hashmap_priv_t;
+
+//------------------------------------------------------------------------|
+// Group scanning.  Each returns a bitmask with bit i set if slot i of the
+// group satisfies the condition.
+#if defined(__SSE2__)
+static inline uint32_t group_match(const int8_t * ctrl, int8_t h2)
+{
+    __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+    return (uint32_t) _mm_movemask_epi8(
+        _mm_cmpeq_epi8(group, _mm_set1_epi8(h2)));
+}
+
+// empty or deleted: these are exactly the control bytes with the sign bit
+static inline uint32_t group_available(const int8_t * ctrl)
+{
+    __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+    return (uint32_t) _mm_movemask_epi8(group);
+}
+#else
+static inline uint32_t group_match(const int8_t * ctrl, int8_t h2)
+{
+    uint32_t mask = 0;
+    int i;
+
+    for (i = 0; i < GROUP_SIZE; i++)
+    {
+        mask |= (uint32_t) (ctrl[i] == h2) << i;
+    }
+
+    return mask;
+}
+
+static inline uint32_t group_available(const int8_t * ctrl)
+{
+    uint32_t mask = 0;
+    int i;
+
+    for (i = 0; i < GROUP_SIZE; i++)
+    {
+        mask |= (uint32_t) (ctrl[i] < 0) << i;
+    }
+
+    return mask;
+}
+#endif
+
+static inline uint32_t group_empty(const int8_t * ctrl)
+{
+    return group_match(ctrl, CTRL_EMPTY);
+}
+
+//------------------------------------------------------------------------|
+static inline const uint8_t * slot_key(const slot_t * slot)
+{
+    return (slot->size <= KEY_INLINE) ? slot->key.bytes : slot->key.ptr;
+}
+
+static inline int8_t hash_h2(uint64_t hash)
+{
+    return (int8_t) (hash & 0x7F);
+}
+
+static inline size_t hash_h1(uint64_t hash)
+{
+    return (size_t) (hash >> 7);
+}
+
+// Maximum full + deleted slots before the table must grow: 7/8 load
+static inline size_t hashmap_limit(size_t capacity)
+{
+    return capacity - capacity / 8;
+}
+
+//------------------------------------------------------------------------|
+// Look up a key.  Returns the slot index, or capacity if not present.
+static size_t hashmap_lookup(hashmap_priv_t * priv, const void * key,
+                             size_t size, uint64_t hash)
+{
+    size_t groups = priv->capacity / GROUP_SIZE;
+    size_t group = hash_h1(hash) & (groups - 1);
+    size_t stride = 0;
+    const int8_t * ctrl;
+    uint32_t mask;
+    size_t index;
+    int8_t h2 = hash_h2(hash);
+
+    if (priv->capacity == 0)
+    {
+        return 0;
+    }
+
+    // triangular probing visits every group exactly once
+    while (stride < groups)
+    {
+        ctrl = priv->ctrl + group * GROUP_SIZE;
+
+        for (mask = group_match(ctrl, h2); mask; mask &= mask - 1)
+        {
+            index = group * GROUP_SIZE + __builtin_ctz(mask);
+            if ((priv->slots[index].size == size) &&
+                (memcmp(slot_key(&priv->slots[index]), key, size) == 0))
+            {
+                return index;
+            }
+        }
+
+        // An empty slot means the key was never placed beyond this group
+        if (group_empty(ctrl))
+        {
+            break;
+        }
+
+        group = (group + ++stride) & (groups - 1);
+    }
+
+    return priv->capacity;
+}
+
+//------------------------------------------------------------------------|
+// Find the first empty or deleted slot along the probe sequence for a
+// hash.  The table must have at least one available slot.
+static size_t hashmap_vacancy(hashmap_priv_t * priv, uint64_t hash)
+{
+    size_t groups = priv->capacity / GROUP_SIZE;
+    size_t group = hash_h1(hash) & (groups - 1);
+    size_t stride = 0;
+    uint32_t mask;
+
+    while (true)
+    {
+        mask = group_available(priv->ctrl + group * GROUP_SIZE);
+        if (mask)
+        {
+            return group * GROUP_SIZE + __builtin_ctz(mask);
+        }
+
+        group = (group + ++stride) & (groups - 1);
+    }
+}
+
+//------------------------------------------------------------------------|
+// Replace the table with an empty one of 'capacity' slots, and move all
+// full slots over.  Keys are moved, not copied.
+static bool hashmap_resize(hashmap_priv_t * priv, size_t capacity)
+{
+    int8_t * old_ctrl = priv->ctrl;
+    slot_t * old_slots = priv->slots;
+    size_t old_capacity = priv->capacity;
+    uint8_t * table = NULL;
+    size_t index, vacancy;
+    uint64_t hash;
+
+    if (capacity > HASHMAP_MAX_CAP)
+    {
+        BLAMMO(ERROR, "hashmap capacity %zu is too large\n", capacity);
+        return false;
+    }
+
+    table = (uint8_t *) malloc(capacity * (1 + sizeof(slot_t)));
+    if (NULL == table)
+    {
+        BLAMMO(ERROR, "malloc(%zu) failed\n", capacity * (1 + sizeof(slot_t)));
+        return false;
+    }
+
+    // capacity is a multiple of 16, so the slots stay aligned
+    priv->ctrl = (int8_t *) table;
+    priv->slots = (slot_t *) (table + capacity);
+    priv->capacity = capacity;
+    priv->deleted = 0;
+    memset(priv->ctrl, CTRL_EMPTY, capacity);
+
+    for (index = 0; index < old_capacity; index++)
+    {
+        if (old_ctrl[index] >= 0)
+        {
+            hash = hash_bytes(slot_key(&old_slots[index]),
+                              old_slots[index].size, HASH_SEED);
+            vacancy = hashmap_vacancy(priv, hash);
+            priv->ctrl[vacancy] = hash_h2(hash);
+            priv->slots[vacancy] = old_slots[index];
+        }
+    }
+
+    free(old_ctrl);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// Smallest valid capacity that holds 'count' entries under the load limit,
+// or 0 if there is none
+static size_t hashmap_capacity_for(size_t count)
+{
+    size_t capacity = GROUP_SIZE;
+
+    while (hashmap_limit(capacity) < count)
+    {
+        if (capacity > HASHMAP_MAX_CAP / 2)
+        {
+            BLAMMO(ERROR, "hashmap cannot hold %zu entries\n", count);
+            return 0;
+        }
+
+        capacity *= 2;
+    }
+
+    return capacity;
+}
+
+//------------------------------------------------------------------------|
+static hashmap_t * hashmap_create(data_destroy_f data_destroy)
+{
+    // Allocate and initialize public interface
+    hashmap_t * map = (hashmap_t *) malloc(sizeof(hashmap_t));
+    if (!map)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(hashmap_t)) failed");
+        return NULL;
+    }
+
+    // bulk copy all function pointers and init opaque ptr
+    memcpy(map, &hashmap_pub, sizeof(hashmap_t));
+
+    // Allocate and initialize private implementation
+    map->priv = malloc(sizeof(hashmap_priv_t));
+    if (!map->priv)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(hashmap_priv_t)) failed");
+        free(map);
+        return NULL;
+    }
+
+    memset(map->priv, 0, sizeof(hashmap_priv_t));
+    ((hashmap_priv_t *) map->priv)->data_destroy = data_destroy;
+
+    return map;
+}
+
+//------------------------------------------------------------------------|
+static void hashmap_destroy(void * map_ptr)
+{
+    hashmap_t * map = (hashmap_t *) map_ptr;
+
+    // guard against accidental double-destroy or early-destroy
+    if (!map || !map->priv)
+    {
+        BLAMMO(WARNING, "attempt to early or double-destroy\n");
+        return;
+    }
+
+    map->clear(map);
+
+    // zero out and destroy the private data
+    memset(map->priv, 0, sizeof(hashmap_priv_t));
+    free(map->priv);
+
+    // zero out and destroy the public interface
+    memset(map, 0, sizeof(hashmap_t));
+    free(map);
+}
+
+//------------------------------------------------------------------------|
+static inline size_t hashmap_length(hashmap_t * map)
+{
+    return ((hashmap_priv_t *) map->priv)->length;
+}
+
+//------------------------------------------------------------------------|
+static inline bool hashmap_empty(hashmap_t * map)
+{
+    return (0 == ((hashmap_priv_t *) map->priv)->length);
+}
+
+//------------------------------------------------------------------------|
+static void hashmap_clear(hashmap_t * map)
+{
+    hashmap_priv_t * priv = (hashmap_priv_t *) map->priv;
+    size_t index;
+
+    for (index = 0; index < priv->capacity; index++)
+    {
+        if (priv->ctrl[index] < 0)
+        {
+            continue;
+        }
+
+        if (priv->slots[index].size > KEY_INLINE)
+        {
+            free(priv->slots[index].key.ptr);
+        }
+
+        if ((NULL != priv->slots[index].value) && (NULL != priv->data_destroy))
+        {
+            priv->data_destroy(priv->slots[index].value);
+        }
+    }
+
+    free(priv->ctrl);
+    priv->ctrl = NULL;
+    priv->slots = NULL;
+    priv->capacity = 0;
+    priv->length = 0;
+    priv->deleted = 0;
+}
+
+//------------------------------------------------------------------------|
+static bool hashmap_insert(hashmap_t * map, const void * key, size_t size,
+                           void * value)
+{
+    hashmap_priv_t * priv = (hashmap_priv_t *) map->priv;
+    uint64_t hash = hash_bytes(key, size, HASH_SEED);
+    size_t index = hashmap_lookup(priv, key, size, hash);
+    slot_t * slot = NULL;
+    uint8_t * copy = NULL;
+
+    // replace the value of an existing key
+    if (index < priv->capacity)
+    {
+        slot = &priv->slots[index];
+        if ((NULL != slot->value) && (slot->value != value) &&
+            (NULL != priv->data_destroy))
+        {
+            priv->data_destroy(slot->value);
+        }
+
+        slot->value = value;
+        return true;
+    }
+
+    if (priv->length + priv->deleted >= hashmap_limit(priv->capacity))
+    {
+        // If it's mostly tombstones, rebuilding at the same size will do
+        if (priv->deleted > priv->length / 2 && priv->capacity > 0)
+        {
+            index = priv->capacity;
+        }
+        else
+        {
+            index = hashmap_capacity_for(priv->length + 1);
+            if (index <= priv->capacity &&
+                priv->capacity <= HASHMAP_MAX_CAP / 2)
+            {
+                index = priv->capacity * 2;
+            }
+        }
+
+        if (0 == index || !hashmap_resize(priv, index))
+        {
+            return false;
+        }
+    }
+
+    if (size > KEY_INLINE)
+    {
+        copy = (uint8_t *) malloc(size);
+        if (NULL == copy)
+        {
+            BLAMMO(ERROR, "malloc(%zu) failed\n", size);
+            return false;
+        }
+
+        memcpy(copy, key, size);
+    }
+
+    index = hashmap_vacancy(priv, hash);
+    if (priv->ctrl[index] == CTRL_DELETED)
+    {
+        priv->deleted--;
+    }
+
+    slot = &priv->slots[index];
+    if (NULL != copy)
+    {
+        slot->key.ptr = copy;
+    }
+    else
+    {
+        memcpy(slot->key.bytes, key, size);
+    }
+
+    slot->size = size;
+    slot->value = value;
+    priv->ctrl[index] = hash_h2(hash);
+    priv->length++;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static void * hashmap_find(hashmap_t * map, const void * key, size_t size)
+{
+    hashmap_priv_t * priv = (hashmap_priv_t *) map->priv;
+    size_t index = hashmap_lookup(priv, key, size,
+                                  hash_bytes(key, size, HASH_SEED));
+
+    return (index < priv->capacity) ? priv->slots[index].value : NULL;
+}
+
+//------------------------------------------------------------------------|
+static bool hashmap_contains(hashmap_t * map, const void * key, size_t size)
+{
+    hashmap_priv_t * priv = (hashmap_priv_t *) map->priv;
+    size_t index = hashmap_lookup(priv, key, size,
+                                  hash_bytes(key, size, HASH_SEED));
+
+    return (index < priv->capacity);
+}
+
+//------------------------------------------------------------------------|
+static bool hashmap_erase(hashmap_t * map, const void * key, size_t size)
+{
+    hashmap_priv_t * priv = (hashmap_priv_t *) map->priv;
+    size_t index = hashmap_lookup(priv, key, size,
+                                  hash_bytes(key, size, HASH_SEED));
+    slot_t * slot = NULL;
+
+    if (index >= priv->capacity)
+    {
+        return false;
+    }
+
+    slot = &priv->slots[index];
+    if (slot->size > KEY_INLINE)
+    {
+        free(slot->key.ptr);
+    }
+
+    if ((NULL != slot->value) && (NULL != priv->data_destroy))
+    {
+        priv->data_destroy(slot->value);
+    }
+
+    // If the group still has an empty slot then no probe sequence has
+    // ever continued past it, so this slot can go straight back to empty.
+    if (group_empty(priv->ctrl + (index & ~(size_t) (GROUP_SIZE - 1))))
+    {
+        priv->ctrl[index] = CTRL_EMPTY;
+    }
+    else
+    {
+        priv->ctrl[index] = CTRL_DELETED;
+        priv->deleted++;
+    }
+
+    priv->length--;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool hashmap_insert_u64(hashmap_t * map, uint64_t key, void * value)
+{
+    return hashmap_insert(map, &key, sizeof(key), value);
+}
+
+//------------------------------------------------------------------------|
+static void * hashmap_find_u64(hashmap_t * map, uint64_t key)
+{
+    return hashmap_find(map, &key, sizeof(key));
+}
+
+//------------------------------------------------------------------------|
+static bool hashmap_erase_u64(hashmap_t * map, uint64_t key)
+{
+    return hashmap_erase(map, &key, sizeof(key));
+}
+
+//------------------------------------------------------------------------|
+static bool hashmap_insert_bytes(hashmap_t * map, bytes_t * key, void * value)
+{
+    return hashmap_insert(map, key->data(key), key->size(key), value);
+}
+
+//------------------------------------------------------------------------|
+static void * hashmap_find_bytes(hashmap_t * map, bytes_t * key)
+{
+    return hashmap_find(map, key->data(key), key->size(key));
+}
+
+//------------------------------------------------------------------------|
+static bool hashmap_erase_bytes(hashmap_t * map, bytes_t * key)
+{
+    return hashmap_erase(map, key->data(key), key->size(key));
+}
+
+//------------------------------------------------------------------------|
+static bool hashmap_reserve(hashmap_t * map, size_t count)
+{
+    hashmap_priv_t * priv = (hashmap_priv_t *) map->priv;
+    size_t limit = hashmap_limit(priv->capacity);
+    size_t capacity = 0;
+
+    if (priv->deleted <= limit && count <= limit - priv->deleted)
+    {
+        return true;
+    }
+
+    capacity = hashmap_capacity_for(count);
+    return 0 != capacity && hashmap_resize(priv, capacity);
+}
+
+//------------------------------------------------------------------------|
+static bool hashmap_rehash(hashmap_t * map, size_t count)
+{
+    hashmap_priv_t * priv = (hashmap_priv_t *) map->priv;
+    size_t capacity;
+
+    if (count < priv->length)
+    {
+        count = priv->length;
+    }
+
+    if (count == 0)
+    {
+        map->clear(map);
+        return true;
+    }
+
+    capacity = hashmap_capacity_for(count);
+    return 0 != capacity && hashmap_resize(priv, capacity);
+}
+
+//------------------------------------------------------------------------|
+static bool hashmap_next(hashmap_t * map, size_t * cursor,
+                         const void ** key, size_t * size, void ** value)
+{
+    hashmap_priv_t * priv = (hashmap_priv_t *) map->priv;
+    size_t index = *cursor;
+
+    while ((index < priv->capacity) && (priv->ctrl[index] < 0))
+    {
+        index++;
+    }
+
+    if (index >= priv->capacity)
+    {
+        *cursor = index;
+        return false;
+    }
+
+    if (key)
+    {
+        *key = slot_key(&priv->slots[index]);
+    }
+
+    if (size)
+    {
+        *size = priv->slots[index].size;
+    }
+
+    if (value)
+    {
+        *value = priv->slots[index].value;
+    }
+
+    *cursor = index + 1;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+const hashmap_t hashmap_pub = {
+    &hashmap_create,
+    &hashmap_destroy,
+    &hashmap_length,
+    &hashmap_empty,
+    &hashmap_clear,
+    &hashmap_insert,
+    &hashmap_find,
+    &hashmap_contains,
+    &hashmap_erase,
+    &hashmap_insert_u64,
+    &hashmap_find_u64,
+    &hashmap_erase_u64,
+    &hashmap_insert_bytes,
+    &hashmap_find_bytes,
+    &hashmap_erase_bytes,
+    &hashmap_reserve,
+    &hashmap_rehash,
+    &hashmap_next,
+    NULL
+};
@@ -0,0 +1,115 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include "chain.h"
+#include "bytes.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// An unordered associative container mapping keys to data payloads, using
+// open addressing with a separate array of one-byte control codes per
+// slot (in the style of Swiss tables).  Each control byte holds 7 bits of
+// the key's hash, so a lookup compares a whole group of 16 slots at once
+// (with SSE2 where available) and only touches keys that very probably
+// match.
+//
+// Keys are arbitrary byte spans, copied into the map.  Keys of up to 8
+// bytes, including all uint64_t keys, are stored inline with no extra
+// allocation.  A uint64_t key is stored as its 8 native bytes, so it is
+// the same key as the equivalent 8 byte span.
+//
+// Values are owned by the map and destroyed by data_destroy when they are
+// replaced, erased, cleared, or the map is destroyed.
+typedef struct hashmap_t
+{
+    // Factory function that creates a hash map.  The destructor callback
+    // for values follows the same rules as for chain_t create().
+    struct hashmap_t * (*create)(data_destroy_f data_destroy);
+
+    // Hash map destructor function
+    void (*destroy)(void * map);
+
+    // Get the number of entries in the map
+    size_t (*length)(struct hashmap_t * map);
+
+    // Returns true if the map is empty and false otherwise
+    bool (*empty)(struct hashmap_t * map);
+
+    // Removes all entries, destroying their values, and releases the table
+    void (*clear)(struct hashmap_t * map);
+
+    // Insert or replace the value for a key.  A replaced value is
+    // destroyed.  Returns false on allocation failure.
+    bool (*insert)(struct hashmap_t * map, const void * key, size_t size,
+                   void * value);
+
+    // Find the value for a key, or NULL if not present
+    void * (*find)(struct hashmap_t * map, const void * key, size_t size);
+
+    // Returns true if the key is present, even if its value is NULL
+    bool (*contains)(struct hashmap_t * map, const void * key, size_t size);
+
+    // Remove a key and destroy its value.  Returns false if not present.
+    bool (*erase)(struct hashmap_t * map, const void * key, size_t size);
+
+    // Same as the above, for integer keys
+    bool (*insert_u64)(struct hashmap_t * map, uint64_t key, void * value);
+    void * (*find_u64)(struct hashmap_t * map, uint64_t key);
+    bool (*erase_u64)(struct hashmap_t * map, uint64_t key);
+
+    // Same as the above, keyed by the contents of a bytes object
+    bool (*insert_bytes)(struct hashmap_t * map, struct bytes_t * key,
+                         void * value);
+    void * (*find_bytes)(struct hashmap_t * map, struct bytes_t * key);
+    bool (*erase_bytes)(struct hashmap_t * map, struct bytes_t * key);
+
+    // Make room for at least 'count' entries in total so that inserting
+    // up to that many will not rehash.  Returns false on failure.
+    bool (*reserve)(struct hashmap_t * map, size_t count);
+
+    // Rebuild the table sized for at least 'count' entries (or the
+    // current number if larger), which also clears out the markers left
+    // by erased entries.  Passing 0 shrinks the table to fit.
+    bool (*rehash)(struct hashmap_t * map, size_t count);
+
+    // Iterate over all entries in no particular order.  Set *cursor to 0
+    // to start, and call repeatedly until it returns false.  Any of key,
+    // size and value may be NULL if not wanted.  The map must not be
+    // modified during iteration, except to change values in place.
+    bool (*next)(struct hashmap_t * map, size_t * cursor,
+                 const void ** key, size_t * size, void ** value);
+
+    // Private data
+    void * priv;
+}
+hashmap_t;
+
+//------------------------------------------------------------------------|
+// Public hash map interface
+extern const hashmap_t hashmap_pub;
@@ -0,0 +1,524 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "heap.h"
+#include "blammo.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------|
+// Capacity of the first array allocation, in payloads
+#define HEAP_MIN_CAP    16
+
+// Most entries whose arrays' sizes in bytes can be represented.  The
+// positions array is never the larger of the two.
+#define HEAP_MAX_CAP    (SIZE_MAX / sizeof(entry_t))
+
+//------------------------------------------------------------------------|
+// A heap entry pairs a payload with the handle that refers to it, so
+// that the handle's position can be kept up to date as entries move.
+typedef struct
+{
+    void * data;
+    heap_handle_t handle;
+}
+entry_t;
+
+// heap private implementation data
+typedef struct
+{
+    // The heap-ordered array of entries
+    entry_t * entries;
+
+    // Entry index of each handle.  For handles not in use this is instead
+    // the next handle on the free handle list.
+    size_t * positions;
+
+    // Number of entries in use
+    size_t length;
+
+    // Number of entries (and handles) allocated
+    size_t capacity;
+
+    // Number of handles that have ever been handed out
+    size_t handles;
+
+    // Head of the free handle list
+    heap_handle_t free;
+
+    // Children per node
+    size_t arity;
+
+    // The payload comparator and destructor
+    data_compare_f data_compare;
+    data_destroy_f data_destroy;
+}
+heap_priv_t;
+
+//------------------------------------------------------------------------|
+// Comparator calls follow the qsort() convention used by chain_t sort(),
+// which passes pointers to the payload pointers.
+static inline bool heap_less(heap_priv_t * priv, void * a, void * b)
+{
+    return priv->data_compare(&a, &b) < 0;
+}
+
+//------------------------------------------------------------------------|
+static inline void heap_place(heap_priv_t * priv, size_t index, entry_t entry)
+{
+    priv->entries[index] = entry;
+    priv->positions[entry.handle] = index;
+}
+
+//------------------------------------------------------------------------|
+// Move the entry at 'index' up toward the root until its parent is no
+// greater.  Entries are shifted down into the hole rather than swapped.
+static void heap_sift_up(heap_priv_t * priv, size_t index)
+{
+    entry_t entry = priv->entries[index];
+    size_t parent;
+
+    while (index > 0)
+    {
+        parent = (index - 1) / priv->arity;
+        if (!heap_less(priv, entry.data, priv->entries[parent].data))
+        {
+            break;
+        }
+
+        heap_place(priv, index, priv->entries[parent]);
+        index = parent;
+    }
+
+    heap_place(priv, index, entry);
+}
+
+//------------------------------------------------------------------------|
+// Move the entry at 'index' down until none of its children are less.
+static void heap_sift_down(heap_priv_t * priv, size_t index)
+{
+    entry_t entry = priv->entries[index];
+    size_t child, last, best;
+
+    while (true)
+    {
+        child = index * priv->arity + 1;
+        if (child >= priv->length)
+        {
+            break;
+        }
+
+        // find the least of this node's children
+        last = child + priv->arity;
+        last = (last < priv->length) ? last : priv->length;
+        for (best = child++; child < last; child++)
+        {
+            if (heap_less(priv, priv->entries[child].data,
+                                priv->entries[best].data))
+            {
+                best = child;
+            }
+        }
+
+        if (!heap_less(priv, priv->entries[best].data, entry.data))
+        {
+            break;
+        }
+
+        heap_place(priv, index, priv->entries[best]);
+        index = best;
+    }
+
+    heap_place(priv, index, entry);
+}
+
+//------------------------------------------------------------------------|
+static inline bool heap_valid(heap_priv_t * priv, heap_handle_t handle)
+{
+    size_t index;
+
+    if (handle >= priv->handles)
+    {
+        return false;
+    }
+
+    // a free handle's 'position' is really a link in the free list, and
+    // will not point back at an entry carrying the same handle.
+    index = priv->positions[handle];
+    return (index < priv->length) && (priv->entries[index].handle == handle);
+}
+
+//------------------------------------------------------------------------|
+static inline heap_handle_t heap_handle_alloc(heap_priv_t * priv)
+{
+    heap_handle_t handle = priv->free;
+
+    if (HEAP_HANDLE_NONE != handle)
+    {
+        priv->free = priv->positions[handle];
+        return handle;
+    }
+
+    return priv->handles++;
+}
+
+//------------------------------------------------------------------------|
+static inline void heap_handle_free(heap_priv_t * priv, heap_handle_t handle)
+{
+    priv->positions[handle] = priv->free;
+    priv->free = handle;
+}
+
+//------------------------------------------------------------------------|
+static heap_t * heap_create(data_destroy_f data_destroy,
+                            data_compare_f data_compare,
+                            size_t arity)
+{
+    heap_priv_t * priv = NULL;
+
+    if (NULL == data_compare)
+    {
+        BLAMMO(ERROR, "heap requires a data comparator\n");
+        return NULL;
+    }
+
+    // Allocate and initialize public interface
+    heap_t * heap = (heap_t *) malloc(sizeof(heap_t));
+    if (!heap)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(heap_t)) failed");
+        return NULL;
+    }
+
+    // bulk copy all function pointers and init opaque ptr
+    memcpy(heap, &heap_pub, sizeof(heap_t));
+
+    // Allocate and initialize private implementation
+    heap->priv = malloc(sizeof(heap_priv_t));
+    if (!heap->priv)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(heap_priv_t)) failed");
+        free(heap);
+        return NULL;
+    }
+
+    priv = (heap_priv_t *) heap->priv;
+    memset(priv, 0, sizeof(heap_priv_t));
+    priv->free = HEAP_HANDLE_NONE;
+    priv->arity = (arity < 2) ? 2 : arity;
+    priv->data_compare = data_compare;
+    priv->data_destroy = data_destroy;
+
+    return heap;
+}
+
+//------------------------------------------------------------------------|
+static void heap_destroy(void * heap_ptr)
+{
+    heap_t * heap = (heap_t *) heap_ptr;
+
+    // guard against accidental double-destroy or early-destroy
+    if (!heap || !heap->priv)
+    {
+        BLAMMO(WARNING, "attempt to early or double-destroy\n");
+        return;
+    }
+
+    heap->clear(heap);
+
+    // zero out and destroy the private data
+    memset(heap->priv, 0, sizeof(heap_priv_t));
+    free(heap->priv);
+
+    // zero out and destroy the public interface
+    memset(heap, 0, sizeof(heap_t));
+    free(heap);
+}
+
+//------------------------------------------------------------------------|
+static inline size_t heap_length(heap_t * heap)
+{
+    return ((heap_priv_t *) heap->priv)->length;
+}
+
+//------------------------------------------------------------------------|
+static inline bool heap_empty(heap_t * heap)
+{
+    return (0 == ((heap_priv_t *) heap->priv)->length);
+}
+
+//------------------------------------------------------------------------|
+static void heap_clear(heap_t * heap)
+{
+    heap_priv_t * priv = (heap_priv_t *) heap->priv;
+    size_t index;
+
+    if (NULL != priv->data_destroy)
+    {
+        for (index = 0; index < priv->length; index++)
+        {
+            if (NULL != priv->entries[index].data)
+            {
+                priv->data_destroy(priv->entries[index].data);
+            }
+        }
+    }
+
+    free(priv->entries);
+    free(priv->positions);
+    priv->entries = NULL;
+    priv->positions = NULL;
+    priv->length = 0;
+    priv->capacity = 0;
+    priv->handles = 0;
+    priv->free = HEAP_HANDLE_NONE;
+}
+
+//------------------------------------------------------------------------|
+static bool heap_reserve(heap_t * heap, size_t count)
+{
+    heap_priv_t * priv = (heap_priv_t *) heap->priv;
+    size_t capacity = priv->capacity ? priv->capacity : HEAP_MIN_CAP;
+    entry_t * entries = NULL;
+    size_t * positions = NULL;
+
+    if (count <= priv->capacity)
+    {
+        return true;
+    }
+
+    if (count > HEAP_MAX_CAP)
+    {
+        BLAMMO(ERROR, "heap cannot hold %zu entries\n", count);
+        return false;
+    }
+
+    // stop doubling at the limit rather than overflowing past it
+    while (capacity < count)
+    {
+        capacity = (capacity > HEAP_MAX_CAP / 2) ? HEAP_MAX_CAP :
+                   capacity * 2;
+    }
+
+    entries = (entry_t *) realloc(priv->entries, capacity * sizeof(entry_t));
+    if (NULL == entries)
+    {
+        BLAMMO(ERROR, "realloc(%zu) failed\n", capacity * sizeof(entry_t));
+        return false;
+    }
+
+    priv->entries = entries;
+
+    // There are never more handles in use than entries, and a handle is
+    // only newly minted when the free list is empty, so the handle count
+    // never exceeds capacity either.
+    positions = (size_t *) realloc(priv->positions, capacity * sizeof(size_t));
+    if (NULL == positions)
+    {
+        BLAMMO(ERROR, "realloc(%zu) failed\n", capacity * sizeof(size_t));
+        return false;
+    }
+
+    priv->positions = positions;
+    priv->capacity = capacity;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static heap_handle_t heap_push(heap_t * heap, void * data)
+{
+    heap_priv_t * priv = (heap_priv_t *) heap->priv;
+    entry_t entry;
+
+    if (!heap_reserve(heap, priv->length + 1))
+    {
+        return HEAP_HANDLE_NONE;
+    }
+
+    entry.data = data;
+    entry.handle = heap_handle_alloc(priv);
+    heap_place(priv, priv->length++, entry);
+    heap_sift_up(priv, priv->length - 1);
+
+    return entry.handle;
+}
+
+//------------------------------------------------------------------------|
+// Remove the entry at an index by moving the last entry into its place
+// and sifting that in whichever direction it needs to go.
+static void * heap_remove_at(heap_priv_t * priv, size_t index)
+{
+    entry_t entry = priv->entries[index];
+
+    heap_handle_free(priv, entry.handle);
+    priv->length--;
+
+    if (index < priv->length)
+    {
+        heap_place(priv, index, priv->entries[priv->length]);
+
+        if ((index > 0) && heap_less(priv, priv->entries[index].data,
+                     priv->entries[(index - 1) / priv->arity].data))
+        {
+            heap_sift_up(priv, index);
+        }
+        else
+        {
+            heap_sift_down(priv, index);
+        }
+    }
+
+    return entry.data;
+}
+
+//------------------------------------------------------------------------|
+static void * heap_pop(heap_t * heap)
+{
+    heap_priv_t * priv = (heap_priv_t *) heap->priv;
+
+    if (priv->length == 0)
+    {
+        return NULL;
+    }
+
+    return heap_remove_at(priv, 0);
+}
+
+//------------------------------------------------------------------------|
+static void * heap_top(heap_t * heap)
+{
+    heap_priv_t * priv = (heap_priv_t *) heap->priv;
+    return priv->length ? priv->entries[0].data : NULL;
+}
+
+//------------------------------------------------------------------------|
+static void * heap_data(heap_t * heap, heap_handle_t handle)
+{
+    heap_priv_t * priv = (heap_priv_t *) heap->priv;
+
+    if (!heap_valid(priv, handle))
+    {
+        return NULL;
+    }
+
+    return priv->entries[priv->positions[handle]].data;
+}
+
+//------------------------------------------------------------------------|
+static bool heap_update(heap_t * heap, heap_handle_t handle)
+{
+    heap_priv_t * priv = (heap_priv_t *) heap->priv;
+    size_t index;
+
+    if (!heap_valid(priv, handle))
+    {
+        BLAMMO(ERROR, "invalid heap handle %zu\n", handle);
+        return false;
+    }
+
+    // The key may have moved either way.  Sifting up is a no-op if it
+    // did not decrease, in which case try sifting down.
+    index = priv->positions[handle];
+    heap_sift_up(priv, index);
+    if (priv->positions[handle] == index)
+    {
+        heap_sift_down(priv, index);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static void * heap_erase(heap_t * heap, heap_handle_t handle)
+{
+    heap_priv_t * priv = (heap_priv_t *) heap->priv;
+
+    if (!heap_valid(priv, handle))
+    {
+        BLAMMO(ERROR, "invalid heap handle %zu\n", handle);
+        return NULL;
+    }
+
+    return heap_remove_at(priv, priv->positions[handle]);
+}
+
+//------------------------------------------------------------------------|
+static bool heap_heapify(heap_t * heap, chain_t * chain, data_copy_f data_copy)
+{
+    heap_priv_t * priv = (heap_priv_t *) heap->priv;
+    size_t count = chain->length(chain);
+    size_t index;
+    entry_t entry;
+
+    if (count == 0)
+    {
+        return true;
+    }
+
+    if (!heap_reserve(heap, priv->length + count))
+    {
+        return false;
+    }
+
+    // append everything without regard to order...
+    chain->reset(chain);
+    do
+    {
+        entry.data = chain->data(chain);
+        entry.data = data_copy ? data_copy(entry.data) : entry.data;
+        entry.handle = heap_handle_alloc(priv);
+        heap_place(priv, priv->length++, entry);
+    }
+    while (chain->spin(chain, 1));
+
+    // ...then restore heap order bottom-up (Floyd), which is O(n) overall
+    // compared to O(n log n) for pushing one at a time.
+    for (index = (priv->length - 1) / priv->arity + 1; index-- > 0; )
+    {
+        heap_sift_down(priv, index);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+const heap_t heap_pub = {
+    &heap_create,
+    &heap_destroy,
+    &heap_length,
+    &heap_empty,
+    &heap_clear,
+    &heap_push,
+    &heap_pop,
+    &heap_top,
+    &heap_data,
+    &heap_update,
+    &heap_erase,
+    &heap_heapify,
+    &heap_reserve,
+    NULL
+};
@@ -0,0 +1,115 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include "chain.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// Handle to a payload within a heap, returned by push().  A handle stays
+// valid until its payload leaves the heap, and may be reused after that.
+typedef size_t heap_handle_t;
+
+// Handle value returned when push() fails
+#define HEAP_HANDLE_NONE SIZE_MAX
+
+//------------------------------------------------------------------------|
+// A priority queue of data payload pointers, kept as an implicit d-ary
+// heap in a contiguous array.  The payload that compares lowest is always
+// on top, so for a max-heap simply invert the comparator.  push() and
+// pop() are O(log n), top() is O(1), and bulk loading is O(n).
+//
+// Payloads are owned by the heap while they are in it, and are destroyed
+// by data_destroy on clear() or destroy().  Popping or erasing a payload
+// hands ownership back to the caller without destroying it.
+typedef struct heap_t
+{
+    // Factory function that creates a heap.  The destructor callback
+    // follows the same rules as for chain_t create(), and the comparator
+    // has the same form as for chain_t sort().  'arity' is the number of
+    // children per node: 2 gives a binary heap, while 4 or 8 make the
+    // tree shallower and keep each node's children on one cache line,
+    // which usually pays off for large heaps.  0 or 1 mean 2.
+    struct heap_t * (*create)(data_destroy_f data_destroy,
+                              data_compare_f data_compare,
+                              size_t arity);
+
+    // Heap destructor function
+    void (*destroy)(void * heap);
+
+    // Get the number of payloads in the heap
+    size_t (*length)(struct heap_t * heap);
+
+    // Returns true if the heap is empty and false otherwise
+    bool (*empty)(struct heap_t * heap);
+
+    // Removes all payloads, destroying them, and releases all memory
+    void (*clear)(struct heap_t * heap);
+
+    // Add a payload and return its handle, or HEAP_HANDLE_NONE on failure
+    heap_handle_t (*push)(struct heap_t * heap, void * data);
+
+    // Remove and return the top (lowest) payload, or NULL if empty.
+    // The caller takes ownership of the payload.
+    void * (*pop)(struct heap_t * heap);
+
+    // Peek at the top (lowest) payload, or NULL if empty
+    void * (*top)(struct heap_t * heap);
+
+    // Get the payload for a handle, or NULL if the handle is not valid
+    void * (*data)(struct heap_t * heap, heap_handle_t handle);
+
+    // Restore heap order after the key of the payload for 'handle' has
+    // been changed in place.  This covers decrease-key as well as
+    // increase-key.  Returns false if the handle is not valid.
+    bool (*update)(struct heap_t * heap, heap_handle_t handle);
+
+    // Remove and return the payload for a handle, or NULL if the handle
+    // is not valid.  The caller takes ownership of the payload.
+    void * (*erase)(struct heap_t * heap, heap_handle_t handle);
+
+    // Add all payloads from a chain in O(n) total.  The data_copy
+    // function (if not NULL) is called for each payload, otherwise the
+    // heap and the chain share the payload pointers just as with chain_t
+    // copy(), and the caller must make sure only one of them owns them.
+    // The chain is left reset to its origin.  Returns false on failure.
+    bool (*heapify)(struct heap_t * heap, struct chain_t * chain,
+                    data_copy_f data_copy);
+
+    // Make room for at least 'count' payloads in total so that pushing up
+    // to that many will not reallocate.  Returns false on failure.
+    bool (*reserve)(struct heap_t * heap, size_t count);
+
+    // Private data
+    void * priv;
+}
+heap_t;
+
+//------------------------------------------------------------------------|
+// Public heap interface
+extern const heap_t heap_pub;
@@ -0,0 +1,223 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#define _POSIX_C_SOURCE 200809L  // write()
+
+#include "hexdump.h"
+#include "numconv.h"
+#include "blammo.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//------------------------------------------------------------------------|
+static const char hexpairs[512] =
+    "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+//------------------------------------------------------------------------|
+// Number of hex digits shown for an offset
+static inline size_t hexdump_digits(size_t offset)
+{
+    size_t digits = 4;
+
+    while (digits < 2 * sizeof(size_t) && (offset >> (digits * 4)) != 0)
+    {
+        digits += 2;
+    }
+
+    return digits;
+}
+
+//------------------------------------------------------------------------|
+size_t hexdump_length(size_t begin, size_t end)
+{
+    size_t length = 0;
+    size_t offset;
+
+    for (offset = begin; offset < end; offset += HEXDUMP_COLUMNS)
+    {
+        length += hexdump_digits(offset) + 2 + HEXDUMP_HEX_WIDTH + 1;
+    }
+
+    return length + (end - begin);
+}
+
+//------------------------------------------------------------------------|
+// The ASCII column for 'count' bytes
+static inline void hexdump_ascii(char * out, const uint8_t * data,
+                                 size_t count)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    // a full line at once: keep 0x20 to 0x7E, and '.' for the rest, which
+    // includes 0x80 and up since those compare as negative
+    if (count == HEXDUMP_COLUMNS)
+    {
+        __m128i bytes = _mm_loadu_si128((const __m128i *) data);
+        __m128i keep = _mm_and_si128(
+                           _mm_cmpgt_epi8(bytes, _mm_set1_epi8(0x1F)),
+                           _mm_cmplt_epi8(bytes, _mm_set1_epi8(0x7F)));
+        __m128i ascii = _mm_or_si128(
+                            _mm_and_si128(keep, bytes),
+                            _mm_andnot_si128(keep, _mm_set1_epi8('.')));
+        _mm_storeu_si128((__m128i *) out, ascii);
+        return;
+    }
+#endif
+
+    // Intentionally avoiding isprint() here
+    for (; i < count; i++)
+    {
+        out[i] = (data[i] >= ' ' && data[i] <= '~') ? (char) data[i] : '.';
+    }
+}
+
+//------------------------------------------------------------------------|
+// Format one line of up to 16 bytes, returning its length
+static inline size_t hexdump_line(char * out, const uint8_t * data,
+                                  size_t count, size_t offset)
+{
+    char * posn = out;
+    size_t i;
+
+    posn += numconv_hex(posn, offset, hexdump_digits(offset));
+    posn[0] = ' ';
+    posn[1] = ' ';
+    posn += 2;
+
+    char * hex = posn;
+    for (i = 0; i < count; i++)
+    {
+        memcpy(posn, hexpairs + 2 * data[i], 2);
+        posn[2] = ' ';
+        posn += 3;
+
+        if (i == 7)
+        {
+            *posn++ = ' ';
+        }
+    }
+
+    // the hex column is the same width on every line
+    memset(posn, ' ', HEXDUMP_HEX_WIDTH - (size_t) (posn - hex));
+    posn = hex + HEXDUMP_HEX_WIDTH;
+
+    hexdump_ascii(posn, data, count);
+    posn += count;
+    *posn++ = '\n';
+
+    return (size_t) (posn - out);
+}
+
+//------------------------------------------------------------------------|
+size_t hexdump_format(char * out, const void * data, size_t begin,
+                      size_t end)
+{
+    const uint8_t * bytes = (const uint8_t *) data;
+    char * posn = out;
+    size_t count;
+
+    while (begin < end)
+    {
+        count = end - begin < HEXDUMP_COLUMNS ? end - begin : HEXDUMP_COLUMNS;
+        posn += hexdump_line(posn, bytes + begin, count, begin);
+        begin += count;
+    }
+
+    return (size_t) (posn - out);
+}
+
+//------------------------------------------------------------------------|
+// Write all of a chunk, retrying short writes
+static bool hexdump_write(int fd, FILE * stream, const char * data,
+                          size_t size)
+{
+    ssize_t result;
+
+    if (NULL != stream)
+    {
+        return fwrite(data, 1, size, stream) == size;
+    }
+
+    while (size > 0)
+    {
+        result = write(fd, data, size);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            BLAMMO(ERROR, "write(%d) failed: %s\n", fd, strerror(errno));
+            return false;
+        }
+
+        data += result;
+        size -= (size_t) result;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+ssize_t hexdump_stream(const void * data, size_t begin, size_t end,
+                       int fd, FILE * stream)
+{
+    char chunk[HEXDUMP_CHUNK_MAX];
+    size_t step = HEXDUMP_CHUNK_LINES * HEXDUMP_COLUMNS;
+    size_t total = 0, stop, length;
+
+    while (begin < end)
+    {
+        stop = end - begin < step ? end : begin + step;
+        length = hexdump_format(chunk, data, begin, stop);
+
+        if (!hexdump_write(fd, stream, chunk, length))
+        {
+            return -1;
+        }
+
+        total += length;
+        begin = stop;
+    }
+
+    return (ssize_t) total;
+}
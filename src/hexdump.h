@@ -0,0 +1,68 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// HEXDUMP: Formatting of binary data as lines of hex and ASCII.  Each
+// line is an offset of at least 4 hex digits, more as needed in whole
+// bytes, two spaces, then 16 bytes in hex ("XX ") with an extra space
+// after each group of 8, padded to a fixed width on a short last line,
+// then the bytes as ASCII with '.' for anything unprintable:
+//
+// 0010  54 68 65 20 71 75 69 63  6B 20 62 72 6F 77 6E 20  The quick brown
+//
+// The offsets shown are those of [begin, end) within the data, so a range
+// of a larger buffer reads the same as that part of the whole dump.
+
+#pragma once
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------|
+#define HEXDUMP_COLUMNS     16
+#define HEXDUMP_HEX_WIDTH   (3 * HEXDUMP_COLUMNS + 2)
+
+// Longest possible line, with a 64-bit offset
+#define HEXDUMP_LINE_MAX    (2 * sizeof(size_t) + 2 + HEXDUMP_HEX_WIDTH + \
+                             HEXDUMP_COLUMNS + 1)
+
+// Lines formatted at a time when streaming, and the buffer that needs
+#define HEXDUMP_CHUNK_LINES 64
+#define HEXDUMP_CHUNK_MAX   (HEXDUMP_CHUNK_LINES * HEXDUMP_LINE_MAX)
+
+//------------------------------------------------------------------------|
+// Exact length of the dump of [begin, end)
+size_t hexdump_length(size_t begin, size_t end);
+
+// Format the dump of [begin, end) of the data into 'out', which must hold
+// hexdump_length() characters, and return the length.  Not terminated.
+size_t hexdump_format(char * out, const void * data, size_t begin,
+                      size_t end);
+
+// Format and write the dump of [begin, end) to a stream, or to a file
+// descriptor if 'stream' is NULL, HEXDUMP_CHUNK_LINES at a time so that
+// the whole dump is never held in memory.  Returns the number of
+// characters written, or -1 on error.
+ssize_t hexdump_stream(const void * data, size_t begin, size_t end,
+                       int fd, FILE * stream);
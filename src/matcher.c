@@ -0,0 +1,643 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "matcher.h"
+#include "blammo.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------|
+// State or list index meaning 'none'.  The root is always state 0.
+#define MATCHER_NIL         UINT32_MAX
+
+// Flag on a dense row entry whose target state has patterns to report
+#define MATCHER_REPORTS     0x80000000u
+
+// Edge counts up to this are searched linearly, and larger ones by
+// bisection
+#define EDGES_LINEAR        8
+
+// Initial number of trie nodes allocated while building
+#define TRIE_MIN_CAP        256
+
+//------------------------------------------------------------------------|
+// A trie node while building, with its children in a list sorted by byte
+typedef struct
+{
+    uint32_t child;
+    uint32_t sibling;
+    uint8_t byte;
+}
+trie_node_t;
+
+// A compiled state.  States are numbered in breadth-first order, so a
+// state's failure link always has a lower number than the state itself.
+typedef struct
+{
+    // Its edges, as a range of the edge arrays
+    uint32_t edges;
+    uint32_t count;
+
+    // Longest proper suffix that is also a state
+    uint32_t fail;
+
+    // First state in the chain from this one along 'dict' with any
+    // patterns ending at it, this one included, or NIL if no pattern ends
+    // here at all.  Checked after every byte.
+    uint32_t report;
+
+    // Longest proper suffix with patterns ending at it
+    uint32_t dict;
+
+    // Patterns ending exactly here, as a list in 'outputs'
+    uint32_t output;
+}
+state_t;
+
+// An entry in a state's list of patterns
+typedef struct
+{
+    uint32_t pattern;
+    uint32_t next;
+}
+output_t;
+
+// matcher private implementation data
+typedef struct
+{
+    state_t * states;
+    size_t count;
+
+    // Edge labels and targets, sorted by label within each state
+    uint8_t * labels;
+    uint32_t * targets;
+
+    output_t * outputs;
+
+    // Length of each pattern
+    size_t * sizes;
+    size_t length;
+
+    // Full transition rows for the first 'rows' states.  Targets with
+    // anything to report are flagged, so the state need not be looked at.
+    uint32_t * dense;
+    size_t rows;
+}
+matcher_priv_t;
+
+//------------------------------------------------------------------------|
+// Follow the trie edge out of a state on a byte, or NIL if there is none
+static inline uint32_t edge_find(const matcher_priv_t * priv,
+                                 const state_t * state, uint8_t byte)
+{
+    const uint8_t * labels = priv->labels + state->edges;
+    uint32_t low = 0, high = state->count, mid;
+
+    if (high <= EDGES_LINEAR)
+    {
+        for (; low < high && labels[low] < byte; low++);
+    }
+    else
+    {
+        while (low < high)
+        {
+            mid = (low + high) / 2;
+            if (labels[mid] < byte)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+    }
+
+    if (low < state->count && labels[low] == byte)
+    {
+        return priv->targets[state->edges + low];
+    }
+
+    return MATCHER_NIL;
+}
+
+//------------------------------------------------------------------------|
+// Add a pattern to the build trie, returning the state it ends at, or NIL
+// on allocation failure
+static uint32_t trie_insert(trie_node_t ** nodes, size_t * count,
+                            size_t * capacity, const uint8_t * data,
+                            size_t size)
+{
+    trie_node_t * grown = NULL;
+    uint32_t state = 0, prev, child, next;
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        // find the child, or the sibling it belongs after
+        prev = MATCHER_NIL;
+        for (child = (*nodes)[state].child;
+             child != MATCHER_NIL && (*nodes)[child].byte < data[i];
+             child = (*nodes)[child].sibling)
+        {
+            prev = child;
+        }
+
+        if (child != MATCHER_NIL && (*nodes)[child].byte == data[i])
+        {
+            state = child;
+            continue;
+        }
+
+        if (*count >= *capacity)
+        {
+            if (*capacity >= (size_t) MATCHER_NIL / 2)
+            {
+                BLAMMO(ERROR, "matcher exceeds %u states", MATCHER_NIL / 2);
+                return MATCHER_NIL;
+            }
+
+            grown = (trie_node_t *) realloc(*nodes, 2 * *capacity *
+                                            sizeof(trie_node_t));
+            if (!grown)
+            {
+                BLAMMO(ERROR, "realloc() of matcher trie failed");
+                return MATCHER_NIL;
+            }
+
+            *nodes = grown;
+            *capacity *= 2;
+        }
+
+        next = (uint32_t) (*count)++;
+        (*nodes)[next].child = MATCHER_NIL;
+        (*nodes)[next].sibling = child;
+        (*nodes)[next].byte = data[i];
+
+        if (prev == MATCHER_NIL)
+        {
+            (*nodes)[state].child = next;
+        }
+        else
+        {
+            (*nodes)[prev].sibling = next;
+        }
+
+        state = next;
+    }
+
+    return state;
+}
+
+//------------------------------------------------------------------------|
+// Number the trie nodes breadth first into compiled states with their
+// edges, filling in 'number' with the state for each node
+static bool matcher_number(matcher_priv_t * priv, const trie_node_t * nodes,
+                           size_t count, uint32_t * number)
+{
+    uint32_t * order = (uint32_t *) malloc(count * sizeof(uint32_t));
+    uint32_t node, child, edge = 0;
+    size_t head, tail = 1;
+
+    priv->states = (state_t *) calloc(count, sizeof(state_t));
+    priv->labels = (uint8_t *) malloc(count);
+    priv->targets = (uint32_t *) malloc(count * sizeof(uint32_t));
+    if (!order || !priv->states || !priv->labels || !priv->targets)
+    {
+        BLAMMO(ERROR, "malloc() of %zu matcher states failed", count);
+        free(order);
+        return false;
+    }
+
+    // 'order' doubles as the queue
+    priv->count = count;
+    order[0] = 0;
+    number[0] = 0;
+    for (head = 0; head < tail; head++)
+    {
+        node = order[head];
+        priv->states[head].edges = edge;
+        priv->states[head].output = MATCHER_NIL;
+
+        for (child = nodes[node].child; child != MATCHER_NIL;
+             child = nodes[child].sibling)
+        {
+            number[child] = (uint32_t) tail;
+            order[tail++] = child;
+            priv->labels[edge] = nodes[child].byte;
+            priv->targets[edge++] = number[child];
+        }
+
+        priv->states[head].count = edge - priv->states[head].edges;
+    }
+
+    free(order);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// Add the failure, dictionary and report links, in breadth-first order so
+// that each state's failure link is complete before its children need it
+static void matcher_link(matcher_priv_t * priv)
+{
+    state_t * states = priv->states;
+    uint32_t s, edge, child, fail, next;
+
+    states[0].fail = 0;
+    states[0].dict = MATCHER_NIL;
+    states[0].report = MATCHER_NIL;
+
+    for (s = 0; s < priv->count; s++)
+    {
+        for (edge = states[s].edges;
+             edge < states[s].edges + states[s].count; edge++)
+        {
+            child = priv->targets[edge];
+            next = MATCHER_NIL;
+
+            // the longest suffix of the parent that can take this byte
+            for (fail = states[s].fail; s != 0; fail = states[fail].fail)
+            {
+                next = edge_find(priv, &states[fail], priv->labels[edge]);
+                if (next != MATCHER_NIL || fail == 0)
+                {
+                    break;
+                }
+            }
+
+            fail = (next == MATCHER_NIL) ? 0 : next;
+            states[child].fail = fail;
+            states[child].dict = (states[fail].output != MATCHER_NIL) ?
+                                 fail : states[fail].dict;
+            states[child].report = (states[child].output != MATCHER_NIL) ?
+                                   child : states[child].dict;
+        }
+    }
+}
+
+//------------------------------------------------------------------------|
+// Fill in full transition rows for the shallowest states, taking each
+// missing edge from the failure state's row, which is already complete
+// since it has a lower number
+static bool matcher_densify(matcher_priv_t * priv)
+{
+    uint32_t s, next;
+    int b;
+
+    priv->rows = (priv->count < MATCHER_DENSE_STATES) ?
+                 priv->count : MATCHER_DENSE_STATES;
+    priv->dense = (uint32_t *) malloc(priv->rows * 256 * sizeof(uint32_t));
+    if (!priv->dense)
+    {
+        BLAMMO(ERROR, "malloc() of matcher DFA failed");
+        return false;
+    }
+
+    for (s = 0; s < priv->rows; s++)
+    {
+        for (b = 0; b < 256; b++)
+        {
+            next = edge_find(priv, &priv->states[s], (uint8_t) b);
+            if (next == MATCHER_NIL)
+            {
+                next = (s == 0) ? 0 :
+                       priv->dense[priv->states[s].fail * 256 + b];
+            }
+            else if (priv->states[next].report != MATCHER_NIL)
+            {
+                next |= MATCHER_REPORTS;
+            }
+
+            priv->dense[s * 256 + b] = next;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static void matcher_free(matcher_priv_t * priv)
+{
+    free(priv->states);
+    free(priv->labels);
+    free(priv->targets);
+    free(priv->outputs);
+    free(priv->sizes);
+    free(priv->dense);
+}
+
+//------------------------------------------------------------------------|
+// Build the trie from the patterns, and compile it
+static bool matcher_build(matcher_priv_t * priv, chain_t * patterns)
+{
+    size_t capacity = TRIE_MIN_CAP, count = 1, i;
+    trie_node_t * nodes = NULL;
+    uint32_t * ends = NULL, * number = NULL;
+    bytes_t * pattern;
+    bool result = false;
+
+    priv->length = patterns->length(patterns);
+    nodes = (trie_node_t *) malloc(capacity * sizeof(trie_node_t));
+    ends = (uint32_t *) malloc((priv->length + 1) * sizeof(uint32_t));
+    priv->sizes = (size_t *) calloc(priv->length + 1, sizeof(size_t));
+    priv->outputs = (output_t *) malloc((priv->length + 1) *
+                                        sizeof(output_t));
+    if (!nodes || !ends || !priv->sizes || !priv->outputs)
+    {
+        BLAMMO(ERROR, "malloc() for %zu matcher patterns failed",
+               priv->length);
+        goto cleanup;
+    }
+
+    nodes[0].child = MATCHER_NIL;
+    nodes[0].sibling = MATCHER_NIL;
+
+    patterns->reset(patterns);
+    for (i = 0; i < priv->length; i++)
+    {
+        pattern = (bytes_t *) patterns->data(patterns);
+        patterns->spin(patterns, 1);
+        ends[i] = MATCHER_NIL;
+
+        if (!pattern || pattern->empty(pattern))
+        {
+            continue;
+        }
+
+        ends[i] = trie_insert(&nodes, &count, &capacity,
+                              pattern->data(pattern), pattern->size(pattern));
+        if (ends[i] == MATCHER_NIL)
+        {
+            goto cleanup;
+        }
+
+        priv->sizes[i] = pattern->size(pattern);
+    }
+
+    number = (uint32_t *) malloc(count * sizeof(uint32_t));
+    if (!number || !matcher_number(priv, nodes, count, number))
+    {
+        goto cleanup;
+    }
+
+    // push in reverse, so each list comes out in pattern order
+    for (i = priv->length; i-- > 0; )
+    {
+        if (ends[i] != MATCHER_NIL)
+        {
+            priv->outputs[i].pattern = (uint32_t) i;
+            priv->outputs[i].next = priv->states[number[ends[i]]].output;
+            priv->states[number[ends[i]]].output = (uint32_t) i;
+        }
+    }
+
+    matcher_link(priv);
+    result = matcher_densify(priv);
+
+cleanup:
+    free(nodes);
+    free(ends);
+    free(number);
+    return result;
+}
+
+//------------------------------------------------------------------------|
+static matcher_t * matcher_create(chain_t * patterns)
+{
+    matcher_priv_t * priv = NULL;
+
+    if (!patterns)
+    {
+        BLAMMO(ERROR, "matcher patterns chain is NULL");
+        return NULL;
+    }
+
+    if (patterns->length(patterns) >= MATCHER_NIL)
+    {
+        BLAMMO(ERROR, "too many matcher patterns");
+        return NULL;
+    }
+
+    // Allocate and initialize public interface
+    matcher_t * matcher = (matcher_t *) malloc(sizeof(matcher_t));
+    if (!matcher)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(matcher_t)) failed");
+        return NULL;
+    }
+
+    // bulk copy all function pointers and init opaque ptr
+    memcpy(matcher, &matcher_pub, sizeof(matcher_t));
+
+    // Allocate and initialize private implementation
+    matcher->priv = calloc(1, sizeof(matcher_priv_t));
+    if (!matcher->priv)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(matcher_priv_t)) failed");
+        free(matcher);
+        return NULL;
+    }
+
+    priv = (matcher_priv_t *) matcher->priv;
+    if (!matcher_build(priv, patterns))
+    {
+        matcher_free(priv);
+        free(priv);
+        free(matcher);
+        return NULL;
+    }
+
+    BLAMMO(DEBUG, "matcher of %zu patterns has %zu states (%s)",
+           priv->length, priv->count,
+           (priv->rows == priv->count) ? "dense" : "sparse");
+    return matcher;
+}
+
+//------------------------------------------------------------------------|
+static void matcher_destroy(void * matcher_ptr)
+{
+    matcher_t * matcher = (matcher_t *) matcher_ptr;
+
+    // guard against accidental double-destroy or early-destroy
+    if (!matcher || !matcher->priv)
+    {
+        BLAMMO(WARNING, "attempt to early or double-destroy\n");
+        return;
+    }
+
+    matcher_free((matcher_priv_t *) matcher->priv);
+
+    // zero out and destroy the private data
+    memset(matcher->priv, 0, sizeof(matcher_priv_t));
+    free(matcher->priv);
+
+    // zero out and destroy the public interface
+    memset(matcher, 0, sizeof(matcher_t));
+    free(matcher);
+}
+
+//------------------------------------------------------------------------|
+static inline size_t matcher_length(matcher_t * matcher)
+{
+    return ((matcher_priv_t *) matcher->priv)->length;
+}
+
+//------------------------------------------------------------------------|
+static inline size_t matcher_states(matcher_t * matcher)
+{
+    return ((matcher_priv_t *) matcher->priv)->count;
+}
+
+//------------------------------------------------------------------------|
+static inline bool matcher_dense(matcher_t * matcher)
+{
+    matcher_priv_t * priv = (matcher_priv_t *) matcher->priv;
+    return priv->rows == priv->count;
+}
+
+//------------------------------------------------------------------------|
+// Report the patterns ending at a state after the byte at 'end'.  Returns
+// false if the callback asked to stop.
+static bool matcher_report(const matcher_priv_t * priv, uint32_t state,
+                           size_t end, size_t * count,
+                           matcher_match_f match, void * context)
+{
+    matcher_match_t found;
+    uint32_t output;
+
+    for (; state != MATCHER_NIL; state = priv->states[state].dict)
+    {
+        for (output = priv->states[state].output; output != MATCHER_NIL;
+             output = priv->outputs[output].next)
+        {
+            (*count)++;
+            if (match)
+            {
+                found.pattern = output;
+                found.size = priv->sizes[output];
+                found.offset = end + 1 - found.size;
+                if (!match(&found, context))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static size_t matcher_feed(matcher_t * matcher, matcher_stream_t * stream,
+                           const void * data, size_t size,
+                           matcher_match_f match, void * context)
+{
+    const matcher_priv_t * priv = (const matcher_priv_t *) matcher->priv;
+    const uint8_t * bytes = (const uint8_t *) data;
+    const state_t * states = priv->states;
+    uint32_t state = stream->state, next;
+    size_t count = 0, i;
+
+    for (i = 0; i < size; i++)
+    {
+        // beyond the dense rows, fall back along failure links until some
+        // state takes the byte or has a row
+        next = MATCHER_NIL;
+        while (state >= priv->rows &&
+               (next = edge_find(priv, &states[state], bytes[i])) ==
+               MATCHER_NIL)
+        {
+            state = states[state].fail;
+        }
+
+        if (state < priv->rows)
+        {
+            next = priv->dense[(size_t) state * 256 + bytes[i]];
+            state = next & ~MATCHER_REPORTS;
+            if (!(next & MATCHER_REPORTS))
+            {
+                continue;
+            }
+        }
+        else
+        {
+            state = next;
+            if (states[state].report == MATCHER_NIL)
+            {
+                continue;
+            }
+        }
+
+        if (!matcher_report(priv, states[state].report, stream->offset + i,
+                            &count, match, context))
+        {
+            i++;
+            break;
+        }
+    }
+
+    stream->state = state;
+    stream->offset += i;
+    return count;
+}
+
+//------------------------------------------------------------------------|
+static size_t matcher_scan(matcher_t * matcher, bytes_t * bytes,
+                           matcher_match_f match, void * context)
+{
+    matcher_stream_t stream = { 0, 0 };
+
+    return matcher_feed(matcher, &stream, bytes->data(bytes),
+                        bytes->size(bytes), match, context);
+}
+
+//------------------------------------------------------------------------|
+static bool matcher_stop(const matcher_match_t * match, void * context)
+{
+    (void) match;
+    (void) context;
+    return false;
+}
+
+//------------------------------------------------------------------------|
+static bool matcher_contains(matcher_t * matcher, bytes_t * bytes)
+{
+    return matcher_scan(matcher, bytes, matcher_stop, NULL) > 0;
+}
+
+//------------------------------------------------------------------------|
+const matcher_t matcher_pub = {
+    &matcher_create,
+    &matcher_destroy,
+    &matcher_length,
+    &matcher_states,
+    &matcher_dense,
+    &matcher_scan,
+    &matcher_feed,
+    &matcher_contains,
+    NULL
+};
@@ -0,0 +1,126 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include "chain.h"
+#include "bytes.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A multi-pattern matcher using the Aho-Corasick automaton.  It is
+// compiled once from a chain of bytes_t patterns, and then finds every
+// occurrence of every pattern, overlapping ones included, in a single
+// linear pass over the text no matter how many patterns there are.
+//
+// The first MATCHER_DENSE_STATES states, which are the shallowest, get a
+// full 256-entry transition row each, so that each input byte costs one
+// table lookup while there.  Automata no bigger than that are a pure
+// dense DFA.  Deeper states of larger ones keep only their trie edges,
+// sorted by byte, and follow failure links on a miss, which soon lead
+// back into the dense rows.  Memory then grows with the total pattern
+// length rather than with 256 times the number of states.
+//
+// A compiled matcher is never modified by scanning, so one may be shared
+// between threads.  Streaming state lives in a matcher_stream_t owned by
+// the caller.
+
+#define MATCHER_DENSE_STATES    2048
+
+// Where a stream has got to.  A zeroed one starts a new stream.
+typedef struct
+{
+    uint32_t state;
+    size_t offset;
+}
+matcher_stream_t;
+
+// One occurrence of a pattern
+typedef struct
+{
+    // Index of the pattern within the chain it was compiled from
+    size_t pattern;
+
+    // Offset of its first byte from the start of the text or stream,
+    // which may lie in an earlier chunk
+    size_t offset;
+
+    // Length of the pattern
+    size_t size;
+}
+matcher_match_t;
+
+// Callback for each match, in order of where the matches end, and for
+// matches ending at the same place, longest first.  Return false to stop
+// scanning.
+typedef bool (*matcher_match_f)(const matcher_match_t * match,
+                                void * context);
+
+typedef struct matcher_t
+{
+    // Factory function that compiles a matcher from a chain of bytes_t
+    // patterns, which are copied, so the chain remains the caller's.
+    // Empty or NULL patterns never match, but keep their index.  Returns
+    // NULL on allocation failure or if the automaton would be too big.
+    struct matcher_t * (*create)(chain_t * patterns);
+
+    // Matcher destructor function
+    void (*destroy)(void * matcher);
+
+    // Get the number of patterns, including any empty ones
+    size_t (*length)(struct matcher_t * matcher);
+
+    // Get the number of automaton states, and whether they all have dense
+    // rows
+    size_t (*states)(struct matcher_t * matcher);
+    bool (*dense)(struct matcher_t * matcher);
+
+    // Report every match in the whole of the data to the callback, which
+    // may be NULL just to count them.  Returns the number of matches
+    // reported, including the one that stopped the scan, if any.
+    size_t (*scan)(struct matcher_t * matcher, bytes_t * bytes,
+                   matcher_match_f match, void * context);
+
+    // Same as scan(), for the next chunk of a stream.  Matches that span
+    // chunk boundaries are found, with offsets from the start of the
+    // stream.
+    size_t (*feed)(struct matcher_t * matcher, matcher_stream_t * stream,
+                   const void * data, size_t size, matcher_match_f match,
+                   void * context);
+
+    // Returns true if any pattern occurs in the data, stopping at the
+    // first match
+    bool (*contains)(struct matcher_t * matcher, bytes_t * bytes);
+
+    // Private data
+    void * priv;
+}
+matcher_t;
+
+//------------------------------------------------------------------------|
+// Public matcher interface
+extern const matcher_t matcher_pub;
@@ -0,0 +1,684 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// The double conversion follows Grisu2 as described by Florian Loitsch in
+// "Printing Floating-Point Numbers Quickly and Accurately with Integers"
+// (PLDI 2010), in the form used by Milo Yip's dtoa and RapidJSON, which
+// are MIT licensed.
+
+#include "numconv.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+static const char digits2[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+static const char hexdigits[16] = {
+    '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'
+};
+
+static const uint64_t pow10[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL
+};
+
+//------------------------------------------------------------------------|
+// Number of decimal digits in a nonzero value
+static inline size_t count_digits(uint64_t value)
+{
+    size_t count = 1;
+
+    while (count < 20 && value >= pow10[count])
+    {
+        count++;
+    }
+
+    return count;
+}
+
+//------------------------------------------------------------------------|
+size_t numconv_u64(char * out, uint64_t value)
+{
+    size_t length = count_digits(value);
+    size_t posn = length;
+
+    // fill from the right, two digits at a time
+    while (value >= 100)
+    {
+        size_t pair = (size_t) (value % 100) * 2;
+        value /= 100;
+        out[--posn] = digits2[pair + 1];
+        out[--posn] = digits2[pair];
+    }
+
+    if (value >= 10)
+    {
+        out[--posn] = digits2[value * 2 + 1];
+        out[--posn] = digits2[value * 2];
+    }
+    else
+    {
+        out[--posn] = (char) ('0' + value);
+    }
+
+    return length;
+}
+
+//------------------------------------------------------------------------|
+size_t numconv_i64(char * out, int64_t value)
+{
+    if (value < 0)
+    {
+        // negate as unsigned, so that INT64_MIN works
+        out[0] = '-';
+        return 1 + numconv_u64(out + 1, (uint64_t) 0 - (uint64_t) value);
+    }
+
+    return numconv_u64(out, (uint64_t) value);
+}
+
+//------------------------------------------------------------------------|
+size_t numconv_hex(char * out, uint64_t value, size_t width)
+{
+    size_t length = 1;
+    size_t posn;
+
+    while (length < 16 && (value >> (length * 4)) != 0)
+    {
+        length++;
+    }
+
+    if (length < width)
+    {
+        length = width < NUMCONV_HEX_MAX ? width : NUMCONV_HEX_MAX;
+    }
+
+    for (posn = length; posn > 0; posn--)
+    {
+        out[posn - 1] = hexdigits[value & 0x0F];
+        value >>= 4;
+    }
+
+    return length;
+}
+
+//------------------------------------------------------------------------|
+// A floating point value f * 2^e with a 64-bit significand
+typedef struct
+{
+    uint64_t f;
+    int e;
+}
+diyfp_t;
+
+#define DP_SIGNIFICAND      52
+#define DP_EXPONENT_BIAS    (0x3FF + DP_SIGNIFICAND)
+#define DP_HIDDEN_BIT       0x0010000000000000ULL
+#define DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFULL
+#define DP_EXPONENT_MASK    0x7FF0000000000000ULL
+
+// Normalized significands and binary exponents of 10^-348 to 10^340 in
+// steps of 8, each rounded to nearest
+static const uint64_t cached_f[87] = {
+    0xFA8FD5A0081C0288ULL, 0xBAAEE17FA23EBF76ULL, 0x8B16FB203055AC76ULL,
+    0xCF42894A5DCE35EAULL, 0x9A6BB0AA55653B2DULL, 0xE61ACF033D1A45DFULL,
+    0xAB70FE17C79AC6CAULL, 0xFF77B1FCBEBCDC4FULL, 0xBE5691EF416BD60CULL,
+    0x8DD01FAD907FFC3CULL, 0xD3515C2831559A83ULL, 0x9D71AC8FADA6C9B5ULL,
+    0xEA9C227723EE8BCBULL, 0xAECC49914078536DULL, 0x823C12795DB6CE57ULL,
+    0xC21094364DFB5637ULL, 0x9096EA6F3848984FULL, 0xD77485CB25823AC7ULL,
+    0xA086CFCD97BF97F4ULL, 0xEF340A98172AACE5ULL, 0xB23867FB2A35B28EULL,
+    0x84C8D4DFD2C63F3BULL, 0xC5DD44271AD3CDBAULL, 0x936B9FCEBB25C996ULL,
+    0xDBAC6C247D62A584ULL, 0xA3AB66580D5FDAF6ULL, 0xF3E2F893DEC3F126ULL,
+    0xB5B5ADA8AAFF80B8ULL, 0x87625F056C7C4A8BULL, 0xC9BCFF6034C13053ULL,
+    0x964E858C91BA2655ULL, 0xDFF9772470297EBDULL, 0xA6DFBD9FB8E5B88FULL,
+    0xF8A95FCF88747D94ULL, 0xB94470938FA89BCFULL, 0x8A08F0F8BF0F156BULL,
+    0xCDB02555653131B6ULL, 0x993FE2C6D07B7FACULL, 0xE45C10C42A2B3B06ULL,
+    0xAA242499697392D3ULL, 0xFD87B5F28300CA0EULL, 0xBCE5086492111AEBULL,
+    0x8CBCCC096F5088CCULL, 0xD1B71758E219652CULL, 0x9C40000000000000ULL,
+    0xE8D4A51000000000ULL, 0xAD78EBC5AC620000ULL, 0x813F3978F8940984ULL,
+    0xC097CE7BC90715B3ULL, 0x8F7E32CE7BEA5C70ULL, 0xD5D238A4ABE98068ULL,
+    0x9F4F2726179A2245ULL, 0xED63A231D4C4FB27ULL, 0xB0DE65388CC8ADA8ULL,
+    0x83C7088E1AAB65DBULL, 0xC45D1DF942711D9AULL, 0x924D692CA61BE758ULL,
+    0xDA01EE641A708DEAULL, 0xA26DA3999AEF774AULL, 0xF209787BB47D6B85ULL,
+    0xB454E4A179DD1877ULL, 0x865B86925B9BC5C2ULL, 0xC83553C5C8965D3DULL,
+    0x952AB45CFA97A0B3ULL, 0xDE469FBD99A05FE3ULL, 0xA59BC234DB398C25ULL,
+    0xF6C69A72A3989F5CULL, 0xB7DCBF5354E9BECEULL, 0x88FCF317F22241E2ULL,
+    0xCC20CE9BD35C78A5ULL, 0x98165AF37B2153DFULL, 0xE2A0B5DC971F303AULL,
+    0xA8D9D1535CE3B396ULL, 0xFB9B7CD9A4A7443CULL, 0xBB764C4CA7A44410ULL,
+    0x8BAB8EEFB6409C1AULL, 0xD01FEF10A657842CULL, 0x9B10A4E5E9913129ULL,
+    0xE7109BFBA19C0C9DULL, 0xAC2820D9623BF429ULL, 0x80444B5E7AA7CF85ULL,
+    0xBF21E44003ACDD2DULL, 0x8E679C2F5E44FF8FULL, 0xD433179D9C8CB841ULL,
+    0x9E19DB92B4E31BA9ULL, 0xEB96BF6EBADF77D9ULL, 0xAF87023B9BF0EE6BULL,
+};
+
+static const int16_t cached_e[87] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,};
+
+//------------------------------------------------------------------------|
+static inline diyfp_t diyfp_from(double value)
+{
+    diyfp_t fp;
+    uint64_t bits;
+    int biased;
+
+    memcpy(&bits, &value, sizeof(bits));
+    biased = (int) ((bits & DP_EXPONENT_MASK) >> DP_SIGNIFICAND);
+    fp.f = bits & DP_SIGNIFICAND_MASK;
+
+    if (biased != 0)
+    {
+        fp.f += DP_HIDDEN_BIT;
+        fp.e = biased - DP_EXPONENT_BIAS;
+    }
+    else
+    {
+        fp.e = 1 - DP_EXPONENT_BIAS;
+    }
+
+    return fp;
+}
+
+// Product of the significands, rounded to the upper 64 bits
+static inline diyfp_t diyfp_mul(diyfp_t a, diyfp_t b)
+{
+    diyfp_t fp;
+#if defined(__SIZEOF_INT128__)
+    __uint128_t p = (__uint128_t) a.f * b.f;
+    fp.f = (uint64_t) (p >> 64) + (((uint64_t) p >> 63) & 1);
+#else
+    const uint64_t m32 = 0xFFFFFFFFULL;
+    uint64_t ah = a.f >> 32, al = a.f & m32;
+    uint64_t bh = b.f >> 32, bl = b.f & m32;
+    uint64_t hh = ah * bh, lh = al * bh, hl = ah * bl, ll = al * bl;
+    uint64_t mid = (ll >> 32) + (hl & m32) + (lh & m32) + (1ULL << 31);
+    fp.f = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+#endif
+    fp.e = a.e + b.e + 64;
+    return fp;
+}
+
+static inline diyfp_t diyfp_normalize(diyfp_t fp)
+{
+    int shift = __builtin_clzll(fp.f);
+    fp.f <<= shift;
+    fp.e -= shift;
+    return fp;
+}
+
+// The halfway points to the neighbouring doubles, sharing an exponent
+static inline void diyfp_boundaries(diyfp_t fp, diyfp_t * minus,
+                                    diyfp_t * plus)
+{
+    diyfp_t pl = { (fp.f << 1) + 1, fp.e - 1 };
+    diyfp_t mi;
+
+    pl = diyfp_normalize(pl);
+
+    // the gap below a power of two is half the gap above it
+    if (fp.f == DP_HIDDEN_BIT)
+    {
+        mi.f = (fp.f << 2) - 1;
+        mi.e = fp.e - 2;
+    }
+    else
+    {
+        mi.f = (fp.f << 1) - 1;
+        mi.e = fp.e - 1;
+    }
+
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+
+    *minus = mi;
+    *plus = pl;
+}
+
+// Get a cached power of ten c = 10^-k such that multiplying by it brings
+// binary exponent 'e' into the range Grisu needs
+static inline diyfp_t cached_power(int e, int * k)
+{
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int index = (int) dk;
+    diyfp_t fp;
+
+    if (dk - index > 0.0)
+    {
+        index++;
+    }
+
+    index = (index >> 3) + 1;
+    *k = -(-348 + index * 8);
+
+    fp.f = cached_f[index];
+    fp.e = cached_e[index];
+    return fp;
+}
+
+//------------------------------------------------------------------------|
+// Nudge the last digit down while that brings it closer to the true value
+// and stays within the rounding interval
+static inline void grisu_round(char * buffer, size_t length, uint64_t delta,
+                               uint64_t rest, uint64_t ten_kappa,
+                               uint64_t wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w ||
+            wp_w - rest > rest + ten_kappa - wp_w))
+    {
+        buffer[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+// Generate the digits of 'w' that are needed to identify it within
+// 'delta' of the upper boundary 'mp'
+static size_t grisu_digits(diyfp_t w, diyfp_t mp, uint64_t delta,
+                           char * buffer, int * k)
+{
+    const diyfp_t one = { 1ULL << -mp.e, mp.e };
+    const uint64_t wp_w = mp.f - w.f;
+    uint32_t p1 = (uint32_t) (mp.f >> -one.e);
+    uint64_t p2 = mp.f & (one.f - 1);
+    int kappa = (int) count_digits(p1);
+    size_t length = 0;
+    uint64_t rest;
+    uint32_t d;
+
+    // integral part
+    while (kappa > 0)
+    {
+        d = (uint32_t) (p1 / pow10[kappa - 1]);
+        p1 = (uint32_t) (p1 % pow10[kappa - 1]);
+
+        if (d || length)
+        {
+            buffer[length++] = (char) ('0' + d);
+        }
+
+        kappa--;
+        rest = ((uint64_t) p1 << -one.e) + p2;
+        if (rest <= delta)
+        {
+            *k += kappa;
+            grisu_round(buffer, length, delta, rest,
+                        pow10[kappa] << -one.e, wp_w);
+            return length;
+        }
+    }
+
+    // fractional part
+    for (;;)
+    {
+        p2 *= 10;
+        delta *= 10;
+        d = (uint32_t) (p2 >> -one.e);
+
+        if (d || length)
+        {
+            buffer[length++] = (char) ('0' + d);
+        }
+
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta)
+        {
+            *k += kappa;
+            grisu_round(buffer, length, delta, p2, one.f,
+                        wp_w * (-kappa < 20 ? pow10[-kappa] : 0));
+            return length;
+        }
+    }
+}
+
+// Shortest digits of a positive finite double, and exponent k such that
+// the value is digits * 10^k
+static size_t grisu2(double value, char * buffer, int * k)
+{
+    diyfp_t v = diyfp_from(value);
+    diyfp_t minus, plus, c, w, wp, wm;
+
+    diyfp_boundaries(v, &minus, &plus);
+    c = cached_power(plus.e, k);
+
+    w = diyfp_mul(diyfp_normalize(v), c);
+    wp = diyfp_mul(plus, c);
+    wm = diyfp_mul(minus, c);
+
+    // stay strictly inside the interval, allowing for rounding error
+    wm.f++;
+    wp.f--;
+
+    return grisu_digits(w, wp, wp.f - wm.f, buffer, k);
+}
+
+//------------------------------------------------------------------------|
+static inline size_t write_exponent(char * out, int k)
+{
+    size_t length = 0;
+
+    if (k < 0)
+    {
+        out[length++] = '-';
+        k = -k;
+    }
+
+    if (k >= 100)
+    {
+        out[length++] = (char) ('0' + k / 100);
+        k %= 100;
+        out[length++] = digits2[k * 2];
+        out[length++] = digits2[k * 2 + 1];
+    }
+    else if (k >= 10)
+    {
+        out[length++] = digits2[k * 2];
+        out[length++] = digits2[k * 2 + 1];
+    }
+    else
+    {
+        out[length++] = (char) ('0' + k);
+    }
+
+    return length;
+}
+
+// Lay out 'length' digits times 10^k, which are already in 'buffer'
+static size_t prettify(char * buffer, size_t length, int k)
+{
+    int kk = (int) length + k;
+    int i;
+
+    if (k >= 0 && kk <= 21)
+    {
+        // 1234e7 -> 12340000000.0
+        for (i = (int) length; i < kk; i++)
+        {
+            buffer[i] = '0';
+        }
+        buffer[kk] = '.';
+        buffer[kk + 1] = '0';
+        return (size_t) kk + 2;
+    }
+    else if (kk > 0 && kk <= 21)
+    {
+        // 1234e-2 -> 12.34
+        memmove(buffer + kk + 1, buffer + kk, length - (size_t) kk);
+        buffer[kk] = '.';
+        return length + 1;
+    }
+    else if (kk > -6 && kk <= 0)
+    {
+        // 1234e-6 -> 0.001234
+        size_t offset = (size_t) (2 - kk);
+        memmove(buffer + offset, buffer, length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        for (i = 2; i < (int) offset; i++)
+        {
+            buffer[i] = '0';
+        }
+        return length + offset;
+    }
+    else if (length == 1)
+    {
+        // 1e30
+        buffer[1] = 'e';
+        return 2 + write_exponent(buffer + 2, kk - 1);
+    }
+
+    // 1234e30 -> 1.234e33
+    memmove(buffer + 2, buffer + 1, length - 1);
+    buffer[1] = '.';
+    buffer[length + 1] = 'e';
+    return length + 2 + write_exponent(buffer + length + 2, kk - 1);
+}
+
+//------------------------------------------------------------------------|
+size_t numconv_double(char * out, double value)
+{
+    uint64_t bits;
+    size_t sign = 0, length;
+    int k = 0;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    if ((bits & DP_EXPONENT_MASK) == DP_EXPONENT_MASK)
+    {
+        if (bits & DP_SIGNIFICAND_MASK)
+        {
+            memcpy(out, "nan", 3);
+            return 3;
+        }
+
+        if (bits >> 63)
+        {
+            memcpy(out, "-inf", 4);
+            return 4;
+        }
+
+        memcpy(out, "inf", 3);
+        return 3;
+    }
+
+    if (bits >> 63)
+    {
+        out[sign++] = '-';
+        value = -value;
+    }
+
+    if (value == 0.0)
+    {
+        memcpy(out + sign, "0.0", 3);
+        return sign + 3;
+    }
+
+    length = grisu2(value, out + sign, &k);
+    return sign + prettify(out + sign, length, k);
+}
+
+//------------------------------------------------------------------------|
+size_t numconv_parse_u64(const char * in, size_t size, uint64_t * value)
+{
+    uint64_t result = 0;
+    size_t posn = 0;
+    unsigned digit;
+
+    while (posn < size && (digit = (unsigned) (in[posn] - '0')) < 10)
+    {
+        // only a 20th digit could overflow
+        if (posn >= 19 && result > (UINT64_MAX - digit) / 10)
+        {
+            return 0;
+        }
+
+        result = result * 10 + digit;
+        posn++;
+    }
+
+    if (posn > 0)
+    {
+        *value = result;
+    }
+
+    return posn;
+}
+
+//------------------------------------------------------------------------|
+// Powers of ten that are exact as doubles
+static const double exact10[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Longest text handed to strtod() without allocating
+#define PARSE_STACK     128
+
+size_t numconv_parse_double(const char * in, size_t size, double * value)
+{
+    uint64_t mantissa = 0;
+    size_t posn = 0, digits = 0, significant = 0;
+    int exponent = 0, scale = 0;
+    bool negative = false, exact = true;
+    unsigned digit;
+
+    if (posn < size && (in[posn] == '-' || in[posn] == '+'))
+    {
+        negative = (in[posn] == '-');
+        posn++;
+    }
+
+    // integer digits, keeping up to 19 significant ones
+    while (posn < size && (digit = (unsigned) (in[posn] - '0')) < 10)
+    {
+        if (significant < 19)
+        {
+            mantissa = mantissa * 10 + digit;
+            significant += (mantissa != 0);
+        }
+        else
+        {
+            exact = exact && (digit == 0);
+            scale++;
+        }
+        digits++;
+        posn++;
+    }
+
+    // fraction digits
+    if (posn < size && in[posn] == '.')
+    {
+        posn++;
+        while (posn < size && (digit = (unsigned) (in[posn] - '0')) < 10)
+        {
+            if (significant < 19)
+            {
+                mantissa = mantissa * 10 + digit;
+                significant += (mantissa != 0);
+                scale--;
+            }
+            else
+            {
+                exact = exact && (digit == 0);
+            }
+            digits++;
+            posn++;
+        }
+    }
+
+    if (digits == 0)
+    {
+        return 0;
+    }
+
+    // exponent, only if followed by at least one digit
+    if (posn < size && (in[posn] == 'e' || in[posn] == 'E'))
+    {
+        size_t mark = posn++;
+        bool minus = false;
+
+        if (posn < size && (in[posn] == '-' || in[posn] == '+'))
+        {
+            minus = (in[posn] == '-');
+            posn++;
+        }
+
+        if (posn < size && (unsigned) (in[posn] - '0') < 10)
+        {
+            while (posn < size && (digit = (unsigned) (in[posn] - '0')) < 10)
+            {
+                if (exponent < 100000)
+                {
+                    exponent = exponent * 10 + (int) digit;
+                }
+                posn++;
+            }
+            exponent = minus ? -exponent : exponent;
+        }
+        else
+        {
+            posn = mark;
+        }
+    }
+
+    // Clinger's fast path: both factors are exact, so one rounding gives
+    // the correctly rounded result
+    scale += exponent;
+    if (exact && mantissa <= (1ULL << 53) && scale >= -22 && scale <= 22)
+    {
+        double result = (double) mantissa;
+        result = scale < 0 ? result / exact10[-scale]
+                           : result * exact10[scale];
+        *value = negative ? -result : result;
+        return posn;
+    }
+
+    // Everything else goes to strtod(), on a terminated copy of exactly
+    // the text scanned
+    {
+        char stack[PARSE_STACK];
+        char * text = posn < PARSE_STACK ? stack : (char *) malloc(posn + 1);
+
+        if (!text)
+        {
+            return 0;
+        }
+
+        memcpy(text, in, posn);
+        text[posn] = '\0';
+        *value = strtod(text, NULL);
+
+        if (text != stack)
+        {
+            free(text);
+        }
+    }
+
+    return posn;
+}
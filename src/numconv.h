@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// NUMCONV: Conversion between numbers and their text form without the
+// printf/strtod machinery.  Integers are generated two digits at a time
+// from a lookup table, and doubles with Grisu2, which always produces
+// text that parses back to the exact same double, and in the vast
+// majority of cases the shortest such text.
+//
+// Output functions write into a caller-supplied buffer of at least the
+// given maximum size, do not terminate it, and return the length written.
+// Parse functions read at most 'size' characters, and return the number
+// consumed, or 0 if there was no number or it did not fit.  Output always
+// uses '.' whatever the C locale, but the strtod() fallback of
+// numconv_parse_double() follows it.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------|
+// Largest output of each conversion
+#define NUMCONV_U64_MAX     20
+#define NUMCONV_I64_MAX     20
+#define NUMCONV_HEX_MAX     16
+#define NUMCONV_DOUBLE_MAX  32
+
+//------------------------------------------------------------------------|
+// Decimal integers
+size_t numconv_u64(char * out, uint64_t value);
+size_t numconv_i64(char * out, int64_t value);
+
+// Upper case hexadecimal, zero-padded to at least 'width' digits (<= 16)
+size_t numconv_hex(char * out, uint64_t value, size_t width);
+
+// A double in the shortest form that round-trips: fixed notation such as
+// "0.001" or "120.0" for moderate magnitudes, and otherwise exponential
+// such as "1.5e-7" or "1e30".  Also "nan", "inf" and "-inf".
+size_t numconv_double(char * out, double value);
+
+//------------------------------------------------------------------------|
+// Unsigned decimal digits, with no sign or leading space
+size_t numconv_parse_u64(const char * in, size_t size, uint64_t * value);
+
+// A decimal floating point number with optional sign, fraction and
+// exponent, as in "-12.5e3".  Values that are exactly representable by
+// a double product or quotient of small integers are computed directly,
+// and the rest are handed to strtod().
+size_t numconv_parse_double(const char * in, size_t size, double * value);
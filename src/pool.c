@@ -0,0 +1,587 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#define _POSIX_C_SOURCE 200809L  // pthread mutexes
+
+#include "pool.h"
+#include "blammo.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+//------------------------------------------------------------------------|
+// Target size of a slab, and the fewest objects one may hold
+#define SLAB_BYTES      (64 * 1024)
+#define SLAB_MIN        (2 * POOL_BATCH)
+
+// Fill pattern for free objects, after their free list link
+#define POISON_BYTE     0xDD
+
+// Buckets in the table of live pools
+#define REGISTRY_SIZE   64
+
+//------------------------------------------------------------------------|
+// A slab of objects.  The objects follow the header, at POOL_ALIGN.
+typedef struct slab_t
+{
+    struct slab_t * next;
+}
+slab_t;
+
+#define SLAB_HEADER     ((sizeof(slab_t) + POOL_ALIGN - 1) & ~(POOL_ALIGN - 1))
+
+// A free object, linked through its first word
+typedef struct object_t
+{
+    struct object_t * next;
+}
+object_t;
+
+// One thread's cache of free objects for one pool, found by pool id
+typedef struct
+{
+    uint64_t id;
+    object_t * head;
+    size_t count;
+}
+pool_cache_t;
+
+// pool private implementation data
+typedef struct pool_priv_t
+{
+    // Unique for the life of the process, so that thread caches left
+    // over from a destroyed pool are never mistaken for this one's
+    uint64_t id;
+
+    // Rounded object size and the number of objects per slab
+    size_t size;
+    size_t per_slab;
+
+    // Guards everything below
+    pthread_mutex_t lock;
+
+    // All slabs, and the shared depot of free objects
+    slab_t * slabs;
+    object_t * depot;
+    pool_stats_t stats;
+
+    // The pool as an allocator, with itself as context
+    allocator_t allocator;
+
+    // Next live pool in the same registry bucket
+    struct pool_priv_t * next;
+}
+pool_priv_t;
+
+// Source of pool ids.  Zero marks an unused cache.
+static uint64_t pool_next_id = 1;
+
+// Live pools, hashed by id.  A cache only knows its pool by id, and the
+// pool may have been destroyed since, so objects are handed back through
+// here, with the registry lock held so that the pool cannot go away.
+static pthread_mutex_t pool_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pool_priv_t * pool_registry[REGISTRY_SIZE];
+
+// This thread's caches, direct-mapped by pool id
+static __thread pool_cache_t pool_caches[POOL_CACHES];
+
+// Empties a thread's caches when it exits, once it has used any
+static pthread_once_t pool_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t pool_key;
+static __thread bool pool_keyed = false;
+
+//------------------------------------------------------------------------|
+static void pool_register(pool_priv_t * priv)
+{
+    pool_priv_t ** bucket = &pool_registry[priv->id % REGISTRY_SIZE];
+
+    pthread_mutex_lock(&pool_registry_lock);
+    priv->next = *bucket;
+    *bucket = priv;
+    pthread_mutex_unlock(&pool_registry_lock);
+}
+
+static void pool_unregister(pool_priv_t * priv)
+{
+    pool_priv_t ** link = &pool_registry[priv->id % REGISTRY_SIZE];
+
+    pthread_mutex_lock(&pool_registry_lock);
+    while (*link != priv)
+    {
+        link = &(*link)->next;
+    }
+
+    *link = priv->next;
+    pthread_mutex_unlock(&pool_registry_lock);
+}
+
+//------------------------------------------------------------------------|
+// Hand everything in a cache back to the depot of the pool it belongs
+// to, if that pool still exists, and leave the cache unused
+static void pool_cache_return(pool_cache_t * cache)
+{
+    pool_priv_t * priv = NULL;
+    object_t * tail = NULL;
+
+    if (cache->head)
+    {
+        pthread_mutex_lock(&pool_registry_lock);
+
+        priv = pool_registry[cache->id % REGISTRY_SIZE];
+        while (priv && priv->id != cache->id)
+        {
+            priv = priv->next;
+        }
+
+        // a destroyed pool took the objects with its slabs, so they must
+        // not be touched
+        if (priv)
+        {
+            tail = cache->head;
+            while (tail->next)
+            {
+                tail = tail->next;
+            }
+
+            pthread_mutex_lock(&priv->lock);
+            tail->next = priv->depot;
+            priv->depot = cache->head;
+            priv->stats.depot += cache->count;
+            priv->stats.flushes++;
+            pthread_mutex_unlock(&priv->lock);
+        }
+
+        pthread_mutex_unlock(&pool_registry_lock);
+    }
+
+    cache->id = 0;
+    cache->head = NULL;
+    cache->count = 0;
+}
+
+// Thread exit, passed the thread's caches
+static void pool_key_destroy(void * caches)
+{
+    size_t i;
+
+    for (i = 0; i < POOL_CACHES; i++)
+    {
+        pool_cache_return(&((pool_cache_t *) caches)[i]);
+    }
+}
+
+static void pool_key_create(void)
+{
+    pthread_key_create(&pool_key, &pool_key_destroy);
+}
+
+//------------------------------------------------------------------------|
+// Get this thread's cache for a pool, taking over the slot if another
+// pool had it, after handing back whatever it held for that pool
+static inline pool_cache_t * pool_cache(pool_priv_t * priv)
+{
+    pool_cache_t * cache = &pool_caches[priv->id % POOL_CACHES];
+
+    if (cache->id != priv->id)
+    {
+        if (!pool_keyed)
+        {
+            pthread_once(&pool_key_once, &pool_key_create);
+            pthread_setspecific(pool_key, pool_caches);
+            pool_keyed = true;
+        }
+
+        pool_cache_return(cache);
+        cache->id = priv->id;
+    }
+
+    return cache;
+}
+
+//------------------------------------------------------------------------|
+#ifdef POOL_POISON_ENABLE
+static inline void pool_poison(pool_priv_t * priv, object_t * object)
+{
+    memset((uint8_t *) object + sizeof(object_t), POISON_BYTE,
+           priv->size - sizeof(object_t));
+}
+
+static inline void pool_check(pool_priv_t * priv, object_t * object)
+{
+    uint8_t * bytes = (uint8_t *) object;
+    size_t i;
+
+    for (i = sizeof(object_t); i < priv->size; i++)
+    {
+        if (bytes[i] != POISON_BYTE)
+        {
+            BLAMMO(ERROR, "pool object %p written at offset %zu after free\n",
+                   object, i);
+            break;
+        }
+    }
+}
+#else
+#define pool_poison(priv, object)
+#define pool_check(priv, object)
+#endif
+
+//------------------------------------------------------------------------|
+// Carve a new slab into the depot.  Called with the lock held.
+static bool pool_slab(pool_priv_t * priv)
+{
+    slab_t * slab = (slab_t *) malloc(SLAB_HEADER +
+                                      priv->per_slab * priv->size);
+    uint8_t * objects = (uint8_t *) slab + SLAB_HEADER;
+    object_t * object = NULL;
+    size_t i;
+
+    if (!slab)
+    {
+        BLAMMO(ERROR, "malloc() of pool slab failed\n");
+        return false;
+    }
+
+    slab->next = priv->slabs;
+    priv->slabs = slab;
+
+    // link in reverse so that objects are handed out in address order
+    for (i = priv->per_slab; i > 0; i--)
+    {
+        object = (object_t *) (objects + (i - 1) * priv->size);
+        pool_poison(priv, object);
+        object->next = priv->depot;
+        priv->depot = object;
+    }
+
+    priv->stats.slabs++;
+    priv->stats.objects += priv->per_slab;
+    priv->stats.depot += priv->per_slab;
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// Move a batch of objects from the depot into an empty thread cache
+static void pool_refill(pool_priv_t * priv, pool_cache_t * cache)
+{
+    object_t * tail = NULL;
+    size_t count = 1;
+
+    pthread_mutex_lock(&priv->lock);
+
+    if (!priv->depot && !pool_slab(priv))
+    {
+        pthread_mutex_unlock(&priv->lock);
+        return;
+    }
+
+    tail = priv->depot;
+    while (count < POOL_BATCH && tail->next)
+    {
+        tail = tail->next;
+        count++;
+    }
+
+    cache->head = priv->depot;
+    cache->count = count;
+    priv->depot = tail->next;
+    tail->next = NULL;
+
+    priv->stats.depot -= count;
+    priv->stats.refills++;
+
+    pthread_mutex_unlock(&priv->lock);
+}
+
+//------------------------------------------------------------------------|
+// Move a batch of objects from a full thread cache to the depot.  The
+// batch is cut off before taking the lock, so the splice is O(1).
+static void pool_flush(pool_priv_t * priv, pool_cache_t * cache)
+{
+    object_t * head = cache->head;
+    object_t * tail = head;
+    size_t count;
+
+    for (count = 1; count < POOL_BATCH; count++)
+    {
+        tail = tail->next;
+    }
+
+    cache->head = tail->next;
+    cache->count -= POOL_BATCH;
+
+    pthread_mutex_lock(&priv->lock);
+    tail->next = priv->depot;
+    priv->depot = head;
+    priv->stats.depot += POOL_BATCH;
+    priv->stats.flushes++;
+    pthread_mutex_unlock(&priv->lock);
+}
+
+//------------------------------------------------------------------------|
+static void * pool_alloc(pool_t * pool)
+{
+    pool_priv_t * priv = (pool_priv_t *) pool->priv;
+    pool_cache_t * cache = pool_cache(priv);
+    object_t * object = NULL;
+
+    if (!cache->head)
+    {
+        pool_refill(priv, cache);
+        if (!cache->head)
+        {
+            return NULL;
+        }
+    }
+
+    object = cache->head;
+    cache->head = object->next;
+    cache->count--;
+
+    pool_check(priv, object);
+    return object;
+}
+
+//------------------------------------------------------------------------|
+static void pool_free(pool_t * pool, void * ptr)
+{
+    pool_priv_t * priv = (pool_priv_t *) pool->priv;
+    pool_cache_t * cache = NULL;
+    object_t * object = (object_t *) ptr;
+
+    if (!object)
+    {
+        return;
+    }
+
+    cache = pool_cache(priv);
+    pool_poison(priv, object);
+    object->next = cache->head;
+    cache->head = object;
+
+    if (++cache->count >= 2 * POOL_BATCH)
+    {
+        pool_flush(priv, cache);
+    }
+}
+
+//------------------------------------------------------------------------|
+static inline size_t pool_object_size(pool_t * pool)
+{
+    return ((pool_priv_t *) pool->priv)->size;
+}
+
+//------------------------------------------------------------------------|
+static void pool_stats(pool_t * pool, pool_stats_t * stats)
+{
+    pool_priv_t * priv = (pool_priv_t *) pool->priv;
+
+    pthread_mutex_lock(&priv->lock);
+    memcpy(stats, &priv->stats, sizeof(pool_stats_t));
+    pthread_mutex_unlock(&priv->lock);
+}
+
+//------------------------------------------------------------------------|
+static const allocator_t * pool_allocator(pool_t * pool)
+{
+    return &((pool_priv_t *) pool->priv)->allocator;
+}
+
+//------------------------------------------------------------------------|
+// Blocks that fit in an object come from the pool, and all others from
+// libc.  The size given back on free tells which is which.
+static void * pool_allocator_alloc(void * context, size_t size)
+{
+    pool_t * pool = (pool_t *) context;
+
+    if (size <= pool_object_size(pool))
+    {
+        return pool_alloc(pool);
+    }
+
+    return malloc(size);
+}
+
+//------------------------------------------------------------------------|
+static void pool_allocator_free(void * context, void * ptr, size_t size)
+{
+    pool_t * pool = (pool_t *) context;
+
+    if (size <= pool_object_size(pool))
+    {
+        pool_free(pool, ptr);
+    }
+    else
+    {
+        free(ptr);
+    }
+}
+
+//------------------------------------------------------------------------|
+static void * pool_allocator_realloc(void * context, void * ptr,
+                                     size_t old_size, size_t size)
+{
+    pool_t * pool = (pool_t *) context;
+    size_t limit = pool_object_size(pool);
+    void * result = NULL;
+
+    if (!ptr)
+    {
+        return pool_allocator_alloc(context, size);
+    }
+
+    // staying within an object, or staying on the heap
+    if (old_size <= limit && size <= limit)
+    {
+        return ptr;
+    }
+
+    if (old_size > limit && size > limit)
+    {
+        return realloc(ptr, size);
+    }
+
+    // crossing between the two
+    result = pool_allocator_alloc(context, size);
+    if (result)
+    {
+        memcpy(result, ptr, old_size < size ? old_size : size);
+        pool_allocator_free(context, ptr, old_size);
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------|
+static pool_t * pool_create(size_t object_size)
+{
+    pool_priv_t * priv = NULL;
+
+    // Allocate and initialize public interface
+    pool_t * pool = (pool_t *) malloc(sizeof(pool_t));
+    if (!pool)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(pool_t)) failed");
+        return NULL;
+    }
+
+    // bulk copy all function pointers and init opaque ptr
+    memcpy(pool, &pool_pub, sizeof(pool_t));
+
+    // Allocate and initialize private implementation
+    pool->priv = malloc(sizeof(pool_priv_t));
+    if (!pool->priv)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(pool_priv_t)) failed");
+        free(pool);
+        return NULL;
+    }
+
+    priv = (pool_priv_t *) pool->priv;
+    memset(priv, 0, sizeof(pool_priv_t));
+
+    // room for the free list link, rounded up to keep objects aligned
+    if (object_size < sizeof(object_t))
+    {
+        object_size = sizeof(object_t);
+    }
+
+    priv->size = (object_size + POOL_ALIGN - 1) & ~(POOL_ALIGN - 1);
+    priv->per_slab = SLAB_BYTES / priv->size;
+    if (priv->per_slab < SLAB_MIN)
+    {
+        priv->per_slab = SLAB_MIN;
+    }
+
+    priv->id = __atomic_fetch_add(&pool_next_id, 1, __ATOMIC_RELAXED);
+    pthread_mutex_init(&priv->lock, NULL);
+    pool_register(priv);
+
+    priv->allocator.alloc = &pool_allocator_alloc;
+    priv->allocator.realloc = &pool_allocator_realloc;
+    priv->allocator.free = &pool_allocator_free;
+    priv->allocator.context = pool;
+
+    return pool;
+}
+
+//------------------------------------------------------------------------|
+static void pool_destroy(void * pool_ptr)
+{
+    pool_t * pool = (pool_t *) pool_ptr;
+    pool_priv_t * priv = NULL;
+    pool_cache_t * cache = NULL;
+    slab_t * slab = NULL;
+
+    // guard against accidental double-destroy or early-destroy
+    if (!pool || !pool->priv)
+    {
+        BLAMMO(WARNING, "attempt to early or double-destroy\n");
+        return;
+    }
+
+    priv = (pool_priv_t *) pool->priv;
+
+    // caches still holding objects for this pool will find it gone
+    pool_unregister(priv);
+    cache = &pool_caches[priv->id % POOL_CACHES];
+    if (cache->id == priv->id)
+    {
+        cache->id = 0;
+        cache->head = NULL;
+        cache->count = 0;
+    }
+
+    while (priv->slabs)
+    {
+        slab = priv->slabs;
+        priv->slabs = slab->next;
+        free(slab);
+    }
+
+    pthread_mutex_destroy(&priv->lock);
+
+    // zero out and destroy the private data
+    memset(pool->priv, 0, sizeof(pool_priv_t));
+    free(pool->priv);
+
+    // zero out and destroy the public interface
+    memset(pool, 0, sizeof(pool_t));
+    free(pool);
+}
+
+//------------------------------------------------------------------------|
+const pool_t pool_pub = {
+    &pool_create,
+    &pool_destroy,
+    &pool_object_size,
+    &pool_alloc,
+    &pool_free,
+    &pool_stats,
+    &pool_allocator,
+    NULL
+};
@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include "allocator.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A thread-safe pool of fixed-size objects.  Objects are carved from large
+// slabs and recycled through free lists threaded through the objects
+// themselves, so alloc and free are a pointer pop and push.
+//
+// Each thread keeps a small cache of free objects per pool.  Only when a
+// cache runs dry, or overflows, does the thread take the pool lock, and
+// then it moves a whole batch of objects between its cache and the shared
+// depot at once.  An object may be freed by a different thread than the
+// one that allocated it.
+//
+// A thread caches objects for up to POOL_CACHES pools at a time.  When a
+// cache's slot is taken over by another pool, or its thread exits, the
+// objects it held go back to the depot.
+// Destroying a pool releases all of its slabs at once, whether or not the
+// objects were freed, and must not race with its use by other threads.
+//
+// Building with POOL_POISON_ENABLE (or 'make POOL_POISON=1') fills freed
+// objects with a pattern, checked when they are next allocated, to catch
+// writes after free.
+//
+// The pool also presents itself as an allocator_t.  Blocks up to the
+// object size come from the pool and larger ones from malloc(), so whole
+// chains or bytes can be created on a pool sized for their headers with
+// create_with() and bytes_create_with().
+
+// Objects are aligned to, and sized in multiples of, this
+#define POOL_ALIGN      (2 * sizeof(void *))
+
+// Objects moved between a thread cache and the depot at once.  A cache
+// holds at most twice this many.
+#define POOL_BATCH      32
+
+// Number of pools a thread can cache objects for at once
+#define POOL_CACHES     16
+
+// Current totals.  'depot' counts free objects in the shared depot, which
+// excludes those held in thread caches.
+typedef struct
+{
+    size_t slabs;
+    size_t objects;
+    size_t depot;
+    uint64_t refills;
+    uint64_t flushes;
+}
+pool_stats_t;
+
+typedef struct pool_t
+{
+    // Factory function that creates a pool of objects of 'object_size'
+    // bytes.  No slabs are allocated until first use.
+    struct pool_t * (*create)(size_t object_size);
+
+    // Pool destructor function, releasing all slabs
+    void (*destroy)(void * pool);
+
+    // Get the object size, after rounding up to POOL_ALIGN
+    size_t (*object_size)(struct pool_t * pool);
+
+    // Allocate an object, or NULL on failure.  Contents are undefined.
+    void * (*alloc)(struct pool_t * pool);
+
+    // Return an object to the pool
+    void (*free)(struct pool_t * pool, void * object);
+
+    // Get the current totals
+    void (*stats)(struct pool_t * pool, pool_stats_t * stats);
+
+    // Get an allocator that allocates from this pool, valid for the
+    // lifetime of the pool
+    const allocator_t * (*allocator)(struct pool_t * pool);
+
+    // Private data
+    void * priv;
+}
+pool_t;
+
+//------------------------------------------------------------------------|
+// Public pool interface
+extern const pool_t pool_pub;
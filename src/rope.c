@@ -0,0 +1,897 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "rope.h"
+#include "bytes.h"
+#include "allocator.h"
+#include "blammo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+//------------------------------------------------------------------------|
+// The most freed nodes kept around for reuse, unless an edit has needed
+// more
+#define ROPE_SPARE_MAX  64
+
+// Immutable text, shared by every node with a slice of it
+typedef struct
+{
+    // Number of nodes referring to the leaf, changed atomically
+    size_t refs;
+
+    // Bytes of text, which are followed by a terminator
+    size_t size;
+    uint8_t data[];
+}
+leaf_t;
+
+#define LEAF_SIZE(size) (sizeof(leaf_t) + (size) + 1)
+
+// A chunk of the contents, and the root of the subtree of the chunks
+// around it
+typedef struct node_t
+{
+    struct node_t * left;
+    struct node_t * right;
+
+    // The chunk is 'length' bytes of the leaf, starting at 'offset'
+    leaf_t * leaf;
+    size_t offset;
+    size_t length;
+
+    // Bytes, nodes and levels in the subtree, this one included
+    size_t size;
+    size_t count;
+    size_t height;
+
+    // Number of parents and ropes referring to the node, changed
+    // atomically.  Only a node with one reference is ever changed.
+    size_t refs;
+}
+node_t;
+
+// rope private implementation data
+typedef struct
+{
+    node_t * root;
+
+    // Free nodes, linked through 'left', so that an edit can take all it
+    // needs up front and then cannot fail part way through
+    node_t * spare;
+    size_t spares;
+    size_t spare_max;
+
+    // State for the random choices that keep the tree balanced
+    uint64_t random;
+
+    // Where all of this rope's memory comes from
+    allocator_t allocator;
+}
+rope_priv_t;
+
+// The public interface and private data share one allocation
+typedef struct
+{
+    rope_t pub;
+    rope_priv_t priv;
+}
+rope_block_t;
+
+//------------------------------------------------------------------------|
+static inline size_t node_size(node_t * node)
+{
+    return node ? node->size : 0;
+}
+
+static inline size_t node_count(node_t * node)
+{
+    return node ? node->count : 0;
+}
+
+static inline size_t node_height(node_t * node)
+{
+    return node ? node->height : 0;
+}
+
+static inline const uint8_t * node_data(node_t * node)
+{
+    return node->leaf->data + node->offset;
+}
+
+// Recompute a node's totals from its children
+static inline void node_update(node_t * node)
+{
+    node->size = node_size(node->left) + node->length +
+                 node_size(node->right);
+    node->count = node_count(node->left) + 1 + node_count(node->right);
+    node->height = 1 + (node_height(node->left) > node_height(node->right) ?
+                        node_height(node->left) : node_height(node->right));
+}
+
+//------------------------------------------------------------------------|
+static leaf_t * leaf_create(rope_priv_t * priv, size_t size)
+{
+    leaf_t * leaf = (leaf_t *) allocator_alloc(&priv->allocator,
+                                               LEAF_SIZE(size));
+    if (!leaf)
+    {
+        BLAMMO(ERROR, "malloc(%zu) failed\n", LEAF_SIZE(size));
+        return NULL;
+    }
+
+    leaf->refs = 1;
+    leaf->size = size;
+    leaf->data[size] = 0;
+    return leaf;
+}
+
+static inline void leaf_release(rope_priv_t * priv, leaf_t * leaf)
+{
+    if (0 == __atomic_sub_fetch(&leaf->refs, 1, __ATOMIC_ACQ_REL))
+    {
+        allocator_free(&priv->allocator, leaf, LEAF_SIZE(leaf->size));
+    }
+}
+
+//------------------------------------------------------------------------|
+// Make sure there are at least 'count' spare nodes, and keep that many
+// when nodes are freed so that the next edit need not allocate them again
+static bool rope_reserve(rope_priv_t * priv, size_t count)
+{
+    node_t * node = NULL;
+
+    if (priv->spare_max < count)
+    {
+        priv->spare_max = count;
+    }
+
+    while (priv->spares < count)
+    {
+        node = (node_t *) allocator_alloc(&priv->allocator, sizeof(node_t));
+        if (!node)
+        {
+            BLAMMO(ERROR, "malloc(sizeof(node_t)) failed\n");
+            return false;
+        }
+
+        node->left = priv->spare;
+        priv->spare = node;
+        priv->spares++;
+    }
+
+    return true;
+}
+
+// A new node with one reference, taking over the caller's reference to
+// the leaf.  Only called once enough nodes have been reserved.
+static node_t * node_create(rope_priv_t * priv, leaf_t * leaf,
+                            size_t offset, size_t length)
+{
+    node_t * node = priv->spare;
+
+    priv->spare = node->left;
+    priv->spares--;
+
+    node->left = NULL;
+    node->right = NULL;
+    node->leaf = leaf;
+    node->offset = offset;
+    node->length = length;
+    node->refs = 1;
+    node_update(node);
+    return node;
+}
+
+static inline node_t * node_retain(node_t * node)
+{
+    if (node)
+    {
+        __atomic_add_fetch(&node->refs, 1, __ATOMIC_RELAXED);
+    }
+
+    return node;
+}
+
+// Drop a reference to a subtree, freeing whatever is no longer used
+static void node_release(rope_priv_t * priv, node_t * node)
+{
+    node_t * right = NULL;
+
+    // loop down the right, recursing only to the left
+    while (node && 0 == __atomic_sub_fetch(&node->refs, 1, __ATOMIC_ACQ_REL))
+    {
+        node_release(priv, node->left);
+        leaf_release(priv, node->leaf);
+        right = node->right;
+
+        if (priv->spares < priv->spare_max)
+        {
+            node->left = priv->spare;
+            priv->spare = node;
+            priv->spares++;
+        }
+        else
+        {
+            allocator_free(&priv->allocator, node, sizeof(node_t));
+        }
+
+        node = right;
+    }
+}
+
+// Get a node that may be changed: the node itself if the caller holds
+// the only reference, otherwise a copy that refers to the same children
+// and leaf, in which case the caller's reference to the original is given
+// up
+static node_t * node_own(rope_priv_t * priv, node_t * node)
+{
+    node_t * copy = NULL;
+
+    if (1 == __atomic_load_n(&node->refs, __ATOMIC_ACQUIRE))
+    {
+        return node;
+    }
+
+    copy = node_create(priv, node->leaf, node->offset, node->length);
+    __atomic_add_fetch(&copy->leaf->refs, 1, __ATOMIC_RELAXED);
+    copy->left = node_retain(node->left);
+    copy->right = node_retain(node->right);
+    node_update(copy);
+
+    node_release(priv, node);
+    return copy;
+}
+
+//------------------------------------------------------------------------|
+// Split a tree into the first 'offset' bytes and the rest, taking over the
+// caller's reference.  A chunk that straddles the cut becomes two slices
+// of the same leaf.  Needs at most h + 1 spare nodes, where h is the
+// height of the tree, and neither half is any taller.
+static void node_split(rope_priv_t * priv, node_t * node, size_t offset,
+                       node_t ** left, node_t ** right)
+{
+    node_t * tail = NULL;
+    size_t before, cut;
+
+    // cuts at either end leave the tree as it is, which keeps cuts at
+    // chunk boundaries from going any further down
+    if (!node || 0 == offset)
+    {
+        *left = NULL;
+        *right = node;
+        return;
+    }
+
+    if (offset >= node->size)
+    {
+        *left = node;
+        *right = NULL;
+        return;
+    }
+
+    node = node_own(priv, node);
+    before = node_size(node->left);
+
+    if (offset <= before)
+    {
+        node_split(priv, node->left, offset, left, &node->left);
+        node_update(node);
+        *right = node;
+    }
+    else if (offset >= before + node->length)
+    {
+        node_split(priv, node->right, offset - before - node->length,
+                   &node->right, right);
+        node_update(node);
+        *left = node;
+    }
+    else
+    {
+        cut = offset - before;
+        __atomic_add_fetch(&node->leaf->refs, 1, __ATOMIC_RELAXED);
+        tail = node_create(priv, node->leaf, node->offset + cut,
+                           node->length - cut);
+        tail->right = node->right;
+        node_update(tail);
+
+        node->length = cut;
+        node->right = NULL;
+        node_update(node);
+
+        *left = node;
+        *right = tail;
+    }
+}
+
+// Join two trees end to end, taking over the caller's references.  The
+// root is chosen at random, weighted by the number of nodes on each side,
+// which keeps the tree balanced whatever the order of edits.  Only the
+// facing edges are walked, so it needs at most as many spare nodes as the
+// two heights added together, and that is as tall as the result can be.
+static node_t * node_merge(rope_priv_t * priv, node_t * left,
+                           node_t * right)
+{
+    uint64_t x = priv->random;
+
+    if (!left || !right)
+    {
+        return left ? left : right;
+    }
+
+    // xorshift64
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    priv->random = x;
+
+    if (x % (left->count + right->count) < left->count)
+    {
+        left = node_own(priv, left);
+        left->right = node_merge(priv, left->right, right);
+        node_update(left);
+        return left;
+    }
+
+    right = node_own(priv, right);
+    right->left = node_merge(priv, left, right->left);
+    node_update(right);
+    return right;
+}
+
+//------------------------------------------------------------------------|
+static node_t * node_first(node_t * node)
+{
+    while (node->left)
+    {
+        node = node->left;
+    }
+
+    return node;
+}
+
+static node_t * node_last(node_t * node)
+{
+    while (node->right)
+    {
+        node = node->right;
+    }
+
+    return node;
+}
+
+//------------------------------------------------------------------------|
+// One node holding two adjacent chunks, without copying if they are
+// neighbouring slices of the same leaf.  NULL if memory ran out.
+static node_t * node_fuse(rope_priv_t * priv, node_t * first,
+                          node_t * second)
+{
+    leaf_t * leaf = first->leaf;
+    size_t length = first->length + second->length;
+
+    if (leaf == second->leaf && first->offset + first->length ==
+        second->offset)
+    {
+        __atomic_add_fetch(&leaf->refs, 1, __ATOMIC_RELAXED);
+        return node_create(priv, leaf, first->offset, length);
+    }
+
+    leaf = leaf_create(priv, length);
+    if (!leaf)
+    {
+        return NULL;
+    }
+
+    memcpy(leaf->data, node_data(first), first->length);
+    memcpy(leaf->data + first->length, node_data(second), second->length);
+    return node_create(priv, leaf, 0, length);
+}
+
+// node_merge(), also fusing the chunks either side of the join if they
+// are small enough together.  Needs at most node_join_spares() spare
+// nodes, and the result is at most one taller than the two heights added
+// together.
+static node_t * node_join(rope_priv_t * priv, node_t * left, node_t * right)
+{
+    node_t * last = NULL;
+    node_t * first = NULL;
+    node_t * fused = NULL;
+    node_t * drop = NULL;
+
+    if (!left || !right)
+    {
+        return left ? left : right;
+    }
+
+    last = node_last(left);
+    first = node_first(right);
+    if (last->length + first->length <= ROPE_CHUNK)
+    {
+        fused = node_fuse(priv, last, first);
+    }
+
+    if (!fused)
+    {
+        return node_merge(priv, left, right);
+    }
+
+    // cutting at chunk boundaries only goes down the edges
+    node_split(priv, left, left->size - last->length, &left, &drop);
+    node_release(priv, drop);
+    node_split(priv, right, first->length, &drop, &right);
+    node_release(priv, drop);
+
+    return node_merge(priv, node_merge(priv, left, fused), right);
+}
+
+// The fused chunk, both cuts, and both merges, the second of them onto a
+// tree up to one taller than 'left'
+static inline size_t node_join_spares(size_t left, size_t right)
+{
+    return 1 + (left + 1) + (right + 1) + (left + 1) + (left + 1 + right);
+}
+
+//------------------------------------------------------------------------|
+// Copy up to 'count' bytes from 'offset' in a subtree
+static size_t node_read(node_t * node, size_t offset, uint8_t * out,
+                        size_t count)
+{
+    size_t done = 0, before, take;
+
+    if (!node || 0 == count)
+    {
+        return 0;
+    }
+
+    before = node_size(node->left);
+    if (offset < before)
+    {
+        done = node_read(node->left, offset, out, count);
+        offset = before;
+    }
+
+    offset -= before;
+    if (done < count && offset < node->length)
+    {
+        take = node->length - offset;
+        take = take < count - done ? take : count - done;
+        memcpy(out + done, node_data(node) + offset, take);
+        done += take;
+    }
+
+    if (done < count)
+    {
+        offset = offset > node->length ? offset - node->length : 0;
+        done += node_read(node->right, offset, out + done, count - done);
+    }
+
+    return done;
+}
+
+// Visit each chunk of a subtree in order, until the callback says stop
+static bool node_each(node_t * node, rope_chunk_f chunk, void * context)
+{
+    for (; node; node = node->right)
+    {
+        if (!node_each(node->left, chunk, context) ||
+            !chunk(node_data(node), node->length, context))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// A one-node tree holding a copy of the data, or NULL if memory ran out
+static node_t * rope_build(rope_priv_t * priv, const void * data,
+                           size_t size)
+{
+    leaf_t * leaf = NULL;
+
+    if (!rope_reserve(priv, 1) || !(leaf = leaf_create(priv, size)))
+    {
+        return NULL;
+    }
+
+    memcpy(leaf->data, data, size);
+    return node_create(priv, leaf, 0, size);
+}
+
+//------------------------------------------------------------------------|
+static rope_t * rope_create_with(const void * data, size_t size,
+                                 const allocator_t * allocator)
+{
+    allocator = allocator ? allocator : allocator_default();
+
+    // Allocate public interface and private implementation together
+    rope_block_t * block = (rope_block_t *) allocator_alloc(
+                               allocator, sizeof(rope_block_t));
+    if (!block)
+    {
+        BLAMMO(ERROR, "malloc(sizeof(rope_block_t)) failed\n");
+        return NULL;
+    }
+
+    // bulk copy all function pointers and init opaque ptr
+    rope_t * rope = &block->pub;
+    memcpy(rope, &rope_pub, sizeof(rope_t));
+    rope->priv = &block->priv;
+
+    rope_priv_t * priv = (rope_priv_t *) rope->priv;
+    memset(priv, 0, sizeof(rope_priv_t));
+    priv->allocator = *allocator;
+    priv->random = 0x9E3779B97F4A7C15ULL;
+    priv->spare_max = ROPE_SPARE_MAX;
+
+    if (size > 0 && !(priv->root = rope_build(priv, data, size)))
+    {
+        rope->destroy(rope);
+        return NULL;
+    }
+
+    return rope;
+}
+
+//------------------------------------------------------------------------|
+static rope_t * rope_create(const void * data, size_t size)
+{
+    return rope_create_with(data, size, NULL);
+}
+
+//------------------------------------------------------------------------|
+static void rope_destroy(void * rope_ptr)
+{
+    rope_t * rope = (rope_t *) rope_ptr;
+    rope_priv_t * priv = NULL;
+    node_t * node = NULL;
+
+    // guard against accidental double-destroy or early-destroy
+    if (!rope || !rope->priv)
+    {
+        BLAMMO(WARNING, "attempt to early or double-destroy\n");
+        return;
+    }
+
+    priv = (rope_priv_t *) rope->priv;
+    node_release(priv, priv->root);
+
+    while ((node = priv->spare))
+    {
+        priv->spare = node->left;
+        allocator_free(&priv->allocator, node, sizeof(node_t));
+    }
+
+    // the allocator is about to be wiped along with everything else
+    allocator_t allocator = priv->allocator;
+
+    // zero out and destroy the public interface and private data
+    memset(rope_ptr, 0, sizeof(rope_block_t));
+    allocator_free(&allocator, rope_ptr, sizeof(rope_block_t));
+}
+
+//------------------------------------------------------------------------|
+static inline size_t rope_size(rope_t * rope)
+{
+    return node_size(((rope_priv_t *) rope->priv)->root);
+}
+
+//------------------------------------------------------------------------|
+static inline size_t rope_chunks(rope_t * rope)
+{
+    return node_count(((rope_priv_t *) rope->priv)->root);
+}
+
+//------------------------------------------------------------------------|
+static inline bool rope_empty(rope_t * rope)
+{
+    return NULL == ((rope_priv_t *) rope->priv)->root;
+}
+
+//------------------------------------------------------------------------|
+static bool rope_insert(rope_t * rope, size_t offset, const void * data,
+                        size_t size)
+{
+    rope_priv_t * priv = (rope_priv_t *) rope->priv;
+    size_t height = node_height(priv->root);
+    node_t * left = NULL;
+    node_t * right = NULL;
+    node_t * text = NULL;
+
+    if (offset > node_size(priv->root))
+    {
+        BLAMMO(ERROR, "rope insert offset %zu is past the end\n", offset);
+        return false;
+    }
+
+    if (0 == size)
+    {
+        return true;
+    }
+
+    // the text, the cut, joining the text on, and then joining the rest
+    // on to a tree up to two taller than either half
+    text = rope_build(priv, data, size);
+    if (!text || !rope_reserve(priv, height + 1 +
+                                     node_join_spares(height, 1) +
+                                     node_join_spares(height + 2, height)))
+    {
+        node_release(priv, text);
+        return false;
+    }
+
+    node_split(priv, priv->root, offset, &left, &right);
+    priv->root = node_join(priv, node_join(priv, left, text), right);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bool rope_append(rope_t * rope, const void * data, size_t size)
+{
+    return rope_insert(rope, rope_size(rope), data, size);
+}
+
+//------------------------------------------------------------------------|
+static size_t rope_erase(rope_t * rope, size_t offset, size_t count)
+{
+    rope_priv_t * priv = (rope_priv_t *) rope->priv;
+    size_t size = node_size(priv->root);
+    size_t height = node_height(priv->root);
+    node_t * left = NULL;
+    node_t * middle = NULL;
+    node_t * right = NULL;
+
+    if (offset >= size || 0 == count)
+    {
+        return 0;
+    }
+
+    count = count < size - offset ? count : size - offset;
+
+    // both cuts, and joining what is left either side of the gap
+    if (!rope_reserve(priv, 2 * (height + 1) +
+                            node_join_spares(height, height)))
+    {
+        return 0;
+    }
+
+    node_split(priv, priv->root, offset, &left, &right);
+    node_split(priv, right, count, &middle, &right);
+    node_release(priv, middle);
+    priv->root = node_join(priv, left, right);
+    return count;
+}
+
+//------------------------------------------------------------------------|
+static bool rope_concat(rope_t * rope, rope_t * tail)
+{
+    rope_priv_t * priv = (rope_priv_t *) rope->priv;
+    rope_priv_t * tail_priv = (rope_priv_t *) tail->priv;
+
+    // Shared nodes are freed by whichever rope lets go of them last
+    if (!allocator_same(&priv->allocator, &tail_priv->allocator))
+    {
+        BLAMMO(ERROR, "rope_concat() cannot join ropes with different "
+            "allocators\n");
+        return false;
+    }
+
+    // the nodes of either tree may be shared, including with each other
+    if (!rope_reserve(priv, node_join_spares(node_height(priv->root),
+                                             node_height(tail_priv->root))))
+    {
+        return false;
+    }
+
+    priv->root = node_join(priv, priv->root, node_retain(tail_priv->root));
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static rope_t * rope_substr(rope_t * rope, size_t begin, size_t end)
+{
+    rope_priv_t * priv = (rope_priv_t *) rope->priv;
+    size_t size = node_size(priv->root);
+    rope_priv_t * sub_priv = NULL;
+    rope_t * sub = NULL;
+    node_t * left = NULL;
+    node_t * middle = NULL;
+    node_t * right = NULL;
+
+    end = end < size ? end : size;
+    if (begin > end)
+    {
+        BLAMMO(ERROR, "rope substr begin %zu is past end %zu\n", begin, end);
+        return NULL;
+    }
+
+    sub = rope_create_with(NULL, 0, &priv->allocator);
+    if (!sub)
+    {
+        return NULL;
+    }
+
+    // both cuts copy their paths, since every node is shared with this
+    // rope, and the new rope keeps the spares it does not use
+    sub_priv = (rope_priv_t *) sub->priv;
+    if (!rope_reserve(sub_priv, 2 * (node_height(priv->root) + 1)))
+    {
+        sub->destroy(sub);
+        return NULL;
+    }
+
+    node_split(sub_priv, node_retain(priv->root), begin, &left, &right);
+    node_split(sub_priv, right, end - begin, &middle, &right);
+    node_release(sub_priv, left);
+    node_release(sub_priv, right);
+    sub_priv->root = middle;
+    return sub;
+}
+
+//------------------------------------------------------------------------|
+static uint8_t rope_at(rope_t * rope, size_t offset)
+{
+    node_t * node = ((rope_priv_t *) rope->priv)->root;
+    size_t before;
+
+    while (node)
+    {
+        before = node_size(node->left);
+
+        if (offset < before)
+        {
+            node = node->left;
+        }
+        else if (offset - before < node->length)
+        {
+            return node_data(node)[offset - before];
+        }
+        else
+        {
+            offset -= before + node->length;
+            node = node->right;
+        }
+    }
+
+    BLAMMO(ERROR, "rope offset is past the end\n");
+    return 0;
+}
+
+//------------------------------------------------------------------------|
+static size_t rope_read(rope_t * rope, void * data, size_t count,
+                        size_t offset)
+{
+    return node_read(((rope_priv_t *) rope->priv)->root, offset,
+                     (uint8_t *) data, count);
+}
+
+//------------------------------------------------------------------------|
+static bool rope_each(rope_t * rope, rope_chunk_f chunk, void * context)
+{
+    return node_each(((rope_priv_t *) rope->priv)->root, chunk, context);
+}
+
+//------------------------------------------------------------------------|
+// Replace the tree with a single node holding all of the contents, which
+// are then contiguous and terminated
+static node_t * rope_flatten(rope_priv_t * priv)
+{
+    node_t * root = priv->root;
+    leaf_t * leaf = NULL;
+
+    // already one chunk running to the end of its leaf
+    if (1 == root->count && root->offset + root->length == root->leaf->size)
+    {
+        return root;
+    }
+
+    if (!rope_reserve(priv, 1) || !(leaf = leaf_create(priv, root->size)))
+    {
+        return NULL;
+    }
+
+    node_read(root, 0, leaf->data, root->size);
+    priv->root = node_create(priv, leaf, 0, root->size);
+    node_release(priv, root);
+    return priv->root;
+}
+
+//------------------------------------------------------------------------|
+static const uint8_t * rope_data(rope_t * rope)
+{
+    rope_priv_t * priv = (rope_priv_t *) rope->priv;
+    node_t * root = NULL;
+
+    if (!priv->root)
+    {
+        return (const uint8_t *) "";
+    }
+
+    root = rope_flatten(priv);
+    return root ? node_data(root) : NULL;
+}
+
+//------------------------------------------------------------------------|
+static const char * rope_cstr(rope_t * rope)
+{
+    return (const char *) rope_data(rope);
+}
+
+//------------------------------------------------------------------------|
+// Append a chunk to a bytes_t
+static bool rope_gather(const uint8_t * data, size_t size, void * context)
+{
+    bytes_t * bytes = (bytes_t *) context;
+
+    bytes->append(bytes, data, size);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+static bytes_t * rope_to_bytes(rope_t * rope)
+{
+    rope_priv_t * priv = (rope_priv_t *) rope->priv;
+    bytes_t * bytes = bytes_create_with(NULL, 0, &priv->allocator);
+
+    if (!bytes)
+    {
+        return NULL;
+    }
+
+    // one allocation of the exact size, then straight copies
+    if (!bytes_reserve(bytes, node_size(priv->root)))
+    {
+        bytes->destroy(bytes);
+        return NULL;
+    }
+
+    node_each(priv->root, rope_gather, bytes);
+    return bytes;
+}
+
+//------------------------------------------------------------------------|
+const rope_t rope_pub = {
+    &rope_create,
+    &rope_create_with,
+    &rope_destroy,
+    &rope_size,
+    &rope_chunks,
+    &rope_empty,
+    &rope_insert,
+    &rope_append,
+    &rope_erase,
+    &rope_concat,
+    &rope_substr,
+    &rope_at,
+    &rope_read,
+    &rope_each,
+    &rope_data,
+    &rope_cstr,
+    &rope_to_bytes,
+    NULL
+};
@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#pragma once
+
+#include "allocator.h"
+#include "bytes.h"
+
+#include <sys/types.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// A rope: a byte string held as a balanced tree of chunks, for large
+// contents that are edited in the middle.  Insert, erase, concatenation
+// and substrings are O(log n) in the number of chunks, and never move
+// the rest of the contents, where bytes_t would move the whole tail.
+//
+// The tree is a randomized binary search tree ordered by position.  Each
+// node refers to a slice of an immutable, reference-counted leaf of text,
+// so cutting a chunk in two copies no text, and inserted data becomes one
+// leaf however long it is.  Nodes are shared between ropes by reference
+// count too, and copied before they are changed, so a substring or a
+// concatenation shares everything but the O(log n) nodes along the cuts.
+// Where an edit leaves two neighbouring chunks of no more than ROPE_CHUNK
+// bytes between them, they are fused into one, so that typing a byte at
+// a time does not leave a chunk per byte.
+//
+// data() and cstr() flatten the rope into a single leaf and chunk, so no
+// second copy is kept.  Flattening is O(n) once, after which these are
+// O(1) until the next edit.
+//
+// A rope object is not thread-safe, but ropes sharing nodes may be used
+// from different threads.  Ropes that share nodes must have been created
+// with the same allocator.
+
+#define ROPE_CHUNK  512
+
+// Callback for each chunk of the contents in order.  Return false to
+// stop.
+typedef bool (*rope_chunk_f)(const uint8_t * data, size_t size,
+                             void * context);
+
+typedef struct rope_t
+{
+    // Factory function that creates a rope holding a copy of 'size' bytes
+    // of data, which may be NULL if 'size' is 0
+    struct rope_t * (*create)(const void * data, size_t size);
+
+    // Same as create(), but all of the rope's memory comes from the given
+    // allocator.  NULL means the library default.
+    struct rope_t * (*create_with)(const void * data, size_t size,
+                                   const allocator_t * allocator);
+
+    // Rope destructor function
+    void (*destroy)(void * rope);
+
+    // Get the number of bytes, and the number of chunks they are in
+    size_t (*size)(struct rope_t * rope);
+    size_t (*chunks)(struct rope_t * rope);
+
+    // Returns true if the rope is empty and false otherwise
+    bool (*empty)(struct rope_t * rope);
+
+    // Insert data before 'offset', which may be the size to append.
+    // Returns false if the offset is past the end or memory could not be
+    // allocated, in which case the contents are unchanged.
+    bool (*insert)(struct rope_t * rope, size_t offset, const void * data,
+                   size_t size);
+
+    // Same as insert() at the end
+    bool (*append)(struct rope_t * rope, const void * data, size_t size);
+
+    // Remove up to 'count' bytes starting at 'offset'.  Returns the
+    // number removed.
+    size_t (*erase)(struct rope_t * rope, size_t offset, size_t count);
+
+    // Append the contents of another rope, which is left as it was, or
+    // of this one.  Returns false on allocation failure or if the ropes
+    // were created with different allocators.
+    bool (*concat)(struct rope_t * rope, struct rope_t * tail);
+
+    // A new rope with the bytes in [begin, end), sharing all but the
+    // nodes along the cuts.  'end' may be SIZE_MAX.  Returns NULL if
+    // 'begin' is past the end or on allocation failure.
+    struct rope_t * (*substr)(struct rope_t * rope, size_t begin,
+                              size_t end);
+
+    // Get the byte at 'offset', which must be less than the size
+    uint8_t (*at)(struct rope_t * rope, size_t offset);
+
+    // Copy up to 'count' bytes starting at 'offset' into 'data', and
+    // return the number copied
+    size_t (*read)(struct rope_t * rope, void * data, size_t count,
+                   size_t offset);
+
+    // Call 'chunk' with each chunk of the contents, in order, without
+    // flattening.  Returns false if the callback stopped early.
+    bool (*each)(struct rope_t * rope, rope_chunk_f chunk, void * context);
+
+    // Get the contents as a contiguous byte array, or terminated C
+    // string, flattening the rope first if needed.  Valid until the next
+    // edit or until the rope is destroyed.  Returns NULL if memory could
+    // not be allocated.
+    const uint8_t * (*data)(struct rope_t * rope);
+    const char * (*cstr)(struct rope_t * rope);
+
+    // A new bytes_t with a copy of the contents, without flattening
+    bytes_t * (*to_bytes)(struct rope_t * rope);
+
+    // Private data
+    void * priv;
+}
+rope_t;
+
+//------------------------------------------------------------------------|
+// Public rope interface
+extern const rope_t rope_pub;
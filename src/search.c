@@ -0,0 +1,502 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// The substring filter is the "generic SIMD" algorithm described by
+// Wojciech Muła, and the Two-Way fallback follows Crochemore and Perrin,
+// "Two-way string-matching" (JACM 1991), in the form used by musl's
+// memmem(), which is MIT licensed.
+
+#include "search.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//------------------------------------------------------------------------|
+// Largest set that find_any_of() compares directly against each block
+#define SEARCH_SET_DIRECT   8
+
+// The filter gives way to Two-Way once more than one position in every
+// SEARCH_SPARSE scanned, plus SEARCH_SLACK, has needed checking in full
+#define SEARCH_SPARSE       16
+#define SEARCH_SLACK        64
+
+//------------------------------------------------------------------------|
+// Two-Way search for a needle of at least 2 bytes
+static size_t twoway_find(const uint8_t * data, size_t size,
+                          const uint8_t * needle, size_t length)
+{
+    size_t bytes[256 / (8 * sizeof(size_t))] = { 0 };
+    size_t shift[256];
+    size_t i, ip, jp, k, p, ms, p0, mem, mem0, pos;
+
+    if (size < length)
+    {
+        return SEARCH_NONE;
+    }
+
+    // which bytes occur in the needle, and how far from the end each
+    // last does
+    for (i = 0; i < length; i++)
+    {
+        bytes[needle[i] / (8 * sizeof(size_t))] |=
+            (size_t) 1 << (needle[i] % (8 * sizeof(size_t)));
+        shift[needle[i]] = i + 1;
+    }
+
+    // maximal suffix under the byte order, with 'ip' starting at -1
+    ip = SIZE_MAX;
+    jp = 0;
+    k = p = 1;
+    while (jp + k < length)
+    {
+        if (needle[ip + k] == needle[jp + k])
+        {
+            if (k == p)
+            {
+                jp += p;
+                k = 1;
+            }
+            else
+            {
+                k++;
+            }
+        }
+        else if (needle[ip + k] > needle[jp + k])
+        {
+            jp += k;
+            k = 1;
+            p = jp - ip;
+        }
+        else
+        {
+            ip = jp++;
+            k = p = 1;
+        }
+    }
+    ms = ip;
+    p0 = p;
+
+    // and under the opposite order, keeping the longer of the two
+    ip = SIZE_MAX;
+    jp = 0;
+    k = p = 1;
+    while (jp + k < length)
+    {
+        if (needle[ip + k] == needle[jp + k])
+        {
+            if (k == p)
+            {
+                jp += p;
+                k = 1;
+            }
+            else
+            {
+                k++;
+            }
+        }
+        else if (needle[ip + k] < needle[jp + k])
+        {
+            jp += k;
+            k = 1;
+            p = jp - ip;
+        }
+        else
+        {
+            ip = jp++;
+            k = p = 1;
+        }
+    }
+
+    if (ip + 1 > ms + 1)
+    {
+        ms = ip;
+    }
+    else
+    {
+        p = p0;
+    }
+
+    // a periodic needle remembers how much of it is already known to
+    // match after a shift by its period
+    if (memcmp(needle, needle + p, ms + 1))
+    {
+        mem0 = 0;
+        p = (ms > length - ms - 1 ? ms : length - ms - 1) + 1;
+    }
+    else
+    {
+        mem0 = length - p;
+    }
+    mem = 0;
+
+    for (pos = 0; size - pos >= length; )
+    {
+        const uint8_t * window = data + pos;
+        uint8_t last = window[length - 1];
+
+        // skip by the last byte of the window first
+        if (!(bytes[last / (8 * sizeof(size_t))] &
+              ((size_t) 1 << (last % (8 * sizeof(size_t))))))
+        {
+            pos += length;
+            mem = 0;
+            continue;
+        }
+
+        k = length - shift[last];
+        if (k)
+        {
+            pos += k < mem ? mem : k;
+            mem = 0;
+            continue;
+        }
+
+        // right half, then left half
+        for (k = (ms + 1 > mem ? ms + 1 : mem);
+             k < length && needle[k] == window[k]; k++);
+        if (k < length)
+        {
+            pos += k - ms;
+            mem = 0;
+            continue;
+        }
+
+        for (k = ms + 1; k > mem && needle[k - 1] == window[k - 1]; k--);
+        if (k <= mem)
+        {
+            return pos;
+        }
+
+        pos += p;
+        mem = mem0;
+    }
+
+    return SEARCH_NONE;
+}
+
+#if defined(__SSE2__)
+//------------------------------------------------------------------------|
+// Bit i set if the first, middle and last bytes of the needle all match
+// for position i of the 16 starting at 'block'
+static inline uint32_t find_mask(const uint8_t * block, size_t middle,
+                                 size_t length, __m128i first,
+                                 __m128i centre, __m128i last)
+{
+    return (uint32_t) _mm_movemask_epi8(_mm_and_si128(_mm_and_si128(
+        _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *) block)),
+        _mm_cmpeq_epi8(centre, _mm_loadu_si128(
+            (const __m128i *) (block + middle)))),
+        _mm_cmpeq_epi8(last, _mm_loadu_si128(
+            (const __m128i *) (block + length - 1)))));
+}
+#endif
+
+//------------------------------------------------------------------------|
+size_t search_byte(const void * data, size_t size, uint8_t byte)
+{
+    const uint8_t * found = (const uint8_t *) memchr(data, byte, size);
+    return found ? (size_t) (found - (const uint8_t *) data) : SEARCH_NONE;
+}
+
+//------------------------------------------------------------------------|
+size_t search_last_byte(const void * data, size_t size, uint8_t byte)
+{
+    const uint8_t * bytes = (const uint8_t *) data;
+    size_t end = size;
+
+#if defined(__SSE2__)
+    const __m128i match = _mm_set1_epi8((char) byte);
+    uint32_t mask;
+
+    for (; end >= 16; end -= 16)
+    {
+        mask = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(match,
+                   _mm_loadu_si128((const __m128i *) (bytes + end - 16))));
+        if (mask)
+        {
+            return end - 16 + 31 - (size_t) __builtin_clz(mask);
+        }
+    }
+#endif
+
+    while (end--)
+    {
+        if (bytes[end] == byte)
+        {
+            return end;
+        }
+    }
+
+    return SEARCH_NONE;
+}
+
+//------------------------------------------------------------------------|
+size_t search_any_of(const void * data, size_t size, const void * set,
+                     size_t count)
+{
+    const uint8_t * bytes = (const uint8_t *) data;
+    const uint8_t * members = (const uint8_t *) set;
+    size_t table[256 / (8 * sizeof(size_t))] = { 0 };
+    size_t i = 0, j;
+
+    if (count == 0)
+    {
+        return SEARCH_NONE;
+    }
+
+    if (count == 1)
+    {
+        return search_byte(data, size, members[0]);
+    }
+
+#if defined(__SSE2__)
+    if (count <= SEARCH_SET_DIRECT)
+    {
+        __m128i matches[SEARCH_SET_DIRECT];
+        __m128i block, hits;
+        uint32_t mask;
+
+        for (j = 0; j < count; j++)
+        {
+            matches[j] = _mm_set1_epi8((char) members[j]);
+        }
+
+        for (; size - i >= 16; i += 16)
+        {
+            block = _mm_loadu_si128((const __m128i *) (bytes + i));
+            hits = _mm_cmpeq_epi8(block, matches[0]);
+            for (j = 1; j < count; j++)
+            {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, matches[j]));
+            }
+
+            mask = (uint32_t) _mm_movemask_epi8(hits);
+            if (mask)
+            {
+                return i + (size_t) __builtin_ctz(mask);
+            }
+        }
+    }
+#endif
+
+    // a bit per byte value for larger sets and the tail
+    for (j = 0; j < count; j++)
+    {
+        table[members[j] / (8 * sizeof(size_t))] |=
+            (size_t) 1 << (members[j] % (8 * sizeof(size_t)));
+    }
+
+    for (; i < size; i++)
+    {
+        if (table[bytes[i] / (8 * sizeof(size_t))] &
+            ((size_t) 1 << (bytes[i] % (8 * sizeof(size_t)))))
+        {
+            return i;
+        }
+    }
+
+    return SEARCH_NONE;
+}
+
+//------------------------------------------------------------------------|
+size_t search_find(const void * data, size_t size, const void * needle,
+                   size_t length)
+{
+    const uint8_t * bytes = (const uint8_t *) data;
+    const uint8_t * pattern = (const uint8_t *) needle;
+    size_t i = 0, found;
+
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    if (length == 1)
+    {
+        return search_byte(data, size, pattern[0]);
+    }
+
+    if (size < length)
+    {
+        return SEARCH_NONE;
+    }
+
+#if defined(__SSE2__)
+    {
+        const size_t middle = length / 2;
+        const __m128i first = _mm_set1_epi8((char) pattern[0]);
+        const __m128i centre = _mm_set1_epi8((char) pattern[middle]);
+        const __m128i last = _mm_set1_epi8((char) pattern[length - 1]);
+        size_t candidates = 0, bit;
+        uint32_t mask;
+
+        // candidate positions i..i+31, where the last byte of the needle
+        // would be at i+length-1..i+length+30, in two halves
+        for (; size - length + 1 - i >= 32; i += 32)
+        {
+            mask = find_mask(bytes + i, middle, length, first, centre, last) |
+                   find_mask(bytes + i + 16, middle, length, first, centre,
+                             last) << 16;
+
+            while (mask)
+            {
+                bit = (size_t) __builtin_ctz(mask);
+                if (memcmp(bytes + i + bit + 1, pattern + 1, length - 2) == 0)
+                {
+                    return i + bit;
+                }
+
+                mask &= mask - 1;
+                candidates++;
+            }
+
+            if (candidates > i / SEARCH_SPARSE + SEARCH_SLACK)
+            {
+                break;
+            }
+        }
+    }
+#endif
+
+    found = twoway_find(bytes + i, size - i, pattern, length);
+    return found == SEARCH_NONE ? found : i + found;
+}
+
+//------------------------------------------------------------------------|
+size_t search_rfind(const void * data, size_t size, const void * needle,
+                    size_t length)
+{
+    const uint8_t * bytes = (const uint8_t *) data;
+    const uint8_t * pattern = (const uint8_t *) needle;
+    size_t end;
+
+    if (length == 0)
+    {
+        return size;
+    }
+
+    if (length == 1)
+    {
+        return search_last_byte(data, size, pattern[0]);
+    }
+
+    if (size < length)
+    {
+        return SEARCH_NONE;
+    }
+
+    // one past the last candidate position still to check
+    end = size - length + 1;
+
+#if defined(__SSE2__)
+    {
+        const __m128i first = _mm_set1_epi8((char) pattern[0]);
+        const __m128i last = _mm_set1_epi8((char) pattern[length - 1]);
+        size_t bit;
+        uint32_t mask;
+
+        for (; end >= 16; end -= 16)
+        {
+            mask = (uint32_t) _mm_movemask_epi8(_mm_and_si128(
+                _mm_cmpeq_epi8(first, _mm_loadu_si128(
+                    (const __m128i *) (bytes + end - 16))),
+                _mm_cmpeq_epi8(last, _mm_loadu_si128(
+                    (const __m128i *) (bytes + end - 16 + length - 1)))));
+
+            while (mask)
+            {
+                bit = 31 - (size_t) __builtin_clz(mask);
+                if (memcmp(bytes + end - 16 + bit + 1, pattern + 1,
+                           length - 2) == 0)
+                {
+                    return end - 16 + bit;
+                }
+
+                mask &= ~((uint32_t) 1 << bit);
+            }
+        }
+    }
+#endif
+
+    while (end--)
+    {
+        if (bytes[end] == pattern[0] &&
+            memcmp(bytes + end + 1, pattern + 1, length - 1) == 0)
+        {
+            return end;
+        }
+    }
+
+    return SEARCH_NONE;
+}
+
+//------------------------------------------------------------------------|
+size_t search_count(const void * data, size_t size, const void * needle,
+                    size_t length)
+{
+    const uint8_t * bytes = (const uint8_t *) data;
+    size_t count = 0, i = 0, found;
+
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    if (length == 1)
+    {
+        uint8_t byte = *(const uint8_t *) needle;
+
+#if defined(__SSE2__)
+        const __m128i match = _mm_set1_epi8((char) byte);
+
+        for (; size - i >= 16; i += 16)
+        {
+            count += (size_t) __builtin_popcount((uint32_t) _mm_movemask_epi8(
+                _mm_cmpeq_epi8(match,
+                    _mm_loadu_si128((const __m128i *) (bytes + i)))));
+        }
+#endif
+
+        for (; i < size; i++)
+        {
+            count += bytes[i] == byte;
+        }
+
+        return count;
+    }
+
+    while ((found = search_find(bytes + i, size - i, needle, length)) !=
+           SEARCH_NONE)
+    {
+        count++;
+        i += found + length;
+    }
+
+    return count;
+}
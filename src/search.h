@@ -0,0 +1,63 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// SEARCH: Byte and substring search over arbitrary binary data, which
+// unlike the str*() functions does not stop at a NUL.  Each function
+// returns the offset of what it found from the start of the data, or
+// SEARCH_NONE.
+//
+// Single bytes go through memchr(), which the C library already
+// vectorizes, or a 16-byte SSE2 scan.  Substrings are found by comparing
+// the first and last byte of the needle against 16 positions at once and
+// only checking the rest where both match.  If a needle and haystack
+// produce too many false candidates for that to pay off, find falls back
+// to the Two-Way algorithm, which is linear in the worst case.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------|
+#define SEARCH_NONE     SIZE_MAX
+
+//------------------------------------------------------------------------|
+// First and last occurrence of a byte
+size_t search_byte(const void * data, size_t size, uint8_t byte);
+size_t search_last_byte(const void * data, size_t size, uint8_t byte);
+
+// First occurrence of any of the 'count' bytes in 'set'
+size_t search_any_of(const void * data, size_t size, const void * set,
+                     size_t count);
+
+// First and last occurrence of a needle.  An empty needle is found at 0
+// and at 'size' respectively.
+size_t search_find(const void * data, size_t size, const void * needle,
+                   size_t length);
+size_t search_rfind(const void * data, size_t size, const void * needle,
+                    size_t length);
+
+// Number of non-overlapping occurrences of a needle, counting from the
+// front.  An empty needle counts 0.
+size_t search_count(const void * data, size_t size, const void * needle,
+                    size_t length);
@@ -0,0 +1,313 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "split.h"
+#include "view.h"
+#include "chain.h"
+#include "search.h"
+#include "blammo.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+//------------------------------------------------------------------------|
+// True if a delimiter starts at 'offset'
+static inline bool split_match(split_t * split, size_t offset)
+{
+    const uint8_t * data = split->input.data + offset;
+    const uint8_t * delim = (const uint8_t *) split->spec.delim;
+
+    switch (split->spec.mode)
+    {
+    case SPLIT_BYTE:
+        return data[0] == delim[0];
+
+    case SPLIT_STRING:
+        return split->input.size - offset >= split->width &&
+               0 == memcmp(data, delim, split->width);
+
+    default:
+        return (split->members[data[0] >> 3] >> (data[0] & 7)) & 1;
+    }
+}
+
+// Past any run of delimiters at 'offset', when merging them
+static inline size_t split_skip(split_t * split, size_t offset)
+{
+    if (!split->spec.merge || 0 == split->width)
+    {
+        return offset;
+    }
+
+    while (offset < split->input.size && split_match(split, offset))
+    {
+        offset += split->width;
+    }
+
+    return offset;
+}
+
+// The first delimiter at or after 'from', quoted or not, or SEARCH_NONE.
+// The answer stands for any 'from' up to the delimiter it found.
+static size_t split_delimiter(split_t * split, size_t from)
+{
+    const uint8_t * data = split->input.data + from;
+    size_t size = split->input.size - from;
+    size_t found;
+
+    if (split->delim_from <= from && split->delim_at >= from)
+    {
+        return split->delim_at;
+    }
+
+    switch (split->spec.mode)
+    {
+    case SPLIT_BYTE:
+        found = search_byte(data, size, *(const uint8_t *) split->spec.delim);
+        break;
+
+    case SPLIT_STRING:
+        found = search_find(data, size, split->spec.delim, split->width);
+        break;
+
+    default:
+        found = search_any_of(data, size, split->spec.delim,
+                              split->spec.length);
+        break;
+    }
+
+    split->delim_from = from;
+    split->delim_at = found == SEARCH_NONE ? found : from + found;
+    return split->delim_at;
+}
+
+// Same as split_delimiter(), for the quote byte
+static size_t split_quote(split_t * split, size_t from)
+{
+    size_t found;
+
+    if (split->quote_from <= from && split->quote_at >= from)
+    {
+        return split->quote_at;
+    }
+
+    found = search_byte(split->input.data + from, split->input.size - from,
+                        split->spec.quote);
+
+    split->quote_from = from;
+    split->quote_at = found == SEARCH_NONE ? found : from + found;
+    return split->quote_at;
+}
+
+// The first delimiter at or after 'from' outside of quotes, or SEARCH_NONE
+static size_t split_scan(split_t * split, size_t from)
+{
+    size_t at, open, close;
+
+    if (0 == split->width)
+    {
+        return SEARCH_NONE;
+    }
+
+    while (true)
+    {
+        at = split_delimiter(split, from);
+        if (0 == split->spec.quote)
+        {
+            return at;
+        }
+
+        // a quote opened before the delimiter hides everything up to its
+        // closing quote, and an unclosed one hides the rest of the input
+        open = split_quote(split, from);
+        if (open >= at)
+        {
+            return at;
+        }
+
+        close = split_quote(split, open + 1);
+        if (SEARCH_NONE == close)
+        {
+            return SEARCH_NONE;
+        }
+
+        from = close + 1;
+    }
+}
+
+//------------------------------------------------------------------------|
+void split_begin(split_t * split, view_t input, const split_spec_t * spec)
+{
+    const uint8_t * delim = (const uint8_t *) spec->delim;
+    size_t i;
+
+    memset(split, 0, sizeof(split_t));
+    split->spec = *spec;
+    split->input = input;
+    split->delim_from = SIZE_MAX;
+    split->quote_from = SIZE_MAX;
+
+    if (NULL != delim && spec->length > 0)
+    {
+        split->width = spec->mode == SPLIT_STRING ? spec->length : 1;
+    }
+
+    if (spec->mode == SPLIT_CLASS)
+    {
+        for (i = 0; i < spec->length; i++)
+        {
+            split->members[delim[i] >> 3] |= (uint8_t) (1 << (delim[i] & 7));
+        }
+    }
+
+    split->offset = split_skip(split, 0);
+}
+
+//------------------------------------------------------------------------|
+bool split_next(split_t * split, view_t * token)
+{
+    size_t begin = split->offset;
+    size_t at = SEARCH_NONE;
+
+    if (split->done)
+    {
+        return false;
+    }
+
+    if (0 == split->spec.limit || split->splits < split->spec.limit)
+    {
+        at = split_scan(split, begin);
+    }
+
+    // the last token is the rest of the input, unless merging left none
+    if (SEARCH_NONE == at)
+    {
+        split->done = true;
+        if (split->spec.merge && begin == split->input.size)
+        {
+            return false;
+        }
+
+        *token = view_slice(split->input, begin, SIZE_MAX);
+        return true;
+    }
+
+    *token = view_slice(split->input, begin, at);
+    split->splits++;
+    split->offset = split_skip(split, at + split->width);
+    return true;
+}
+
+//------------------------------------------------------------------------|
+// split_chain() payloads.  All of the tokens from one call share a single
+// block, which goes with the last of them.  The view comes first, so a
+// payload may be used as a view_t pointer.
+typedef struct split_block_t split_block_t;
+
+typedef struct
+{
+    view_t view;
+    split_block_t * block;
+}
+split_token_t;
+
+struct split_block_t
+{
+    size_t refs;
+    split_token_t tokens[];
+};
+
+static void split_token_release(void * payload)
+{
+    split_block_t * block = ((split_token_t *) payload)->block;
+
+    if (--block->refs == 0)
+    {
+        free(block);
+    }
+}
+
+//------------------------------------------------------------------------|
+chain_t * split_chain(view_t input, const split_spec_t * spec)
+{
+    chain_t * chain = chain_compact_pub.create(split_token_release);
+    split_block_t * block = NULL;
+    size_t count = 0, index;
+    split_t split;
+    view_t token;
+
+    if (!chain)
+    {
+        BLAMMO(ERROR, "chain_compact_pub.create() failed\n");
+        return NULL;
+    }
+
+    // Count first, so that the tokens and the links each take one
+    // allocation of exactly the right size
+    split_begin(&split, input, spec);
+    while (split_next(&split, &token))
+    {
+        count++;
+    }
+
+    if (0 == count)
+    {
+        return chain;
+    }
+
+    block = (split_block_t *) malloc(sizeof(split_block_t) +
+                                     count * sizeof(split_token_t));
+    if (!block || !chain->reserve(chain, count))
+    {
+        BLAMMO(ERROR, "allocating %zu tokens failed\n", count);
+        free(block);
+        chain->destroy(chain);
+        return NULL;
+    }
+
+    block->refs = count;
+    split_begin(&split, input, spec);
+    for (index = 0; index < count && split_next(&split, &token); index++)
+    {
+        block->tokens[index].view = token;
+        block->tokens[index].block = block;
+        chain->insert(chain, &block->tokens[index]);
+    }
+
+    return chain;
+}
+
+//------------------------------------------------------------------------|
+view_t split_unquote(view_t token, uint8_t quote)
+{
+    if (token.size < 2 || token.data[0] != quote ||
+        token.data[token.size - 1] != quote)
+    {
+        return token;
+    }
+
+    return view_slice(token, 1, token.size - 1);
+}
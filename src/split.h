@@ -0,0 +1,130 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// SPLIT: Zero-copy tokenizing of binary data by delimiters.  Tokens are
+// views into the input, so nothing is copied, and iterating with
+// split_begin() and split_next() allocates nothing at all.  split_chain()
+// collects the same tokens into a chain for code that wants a container.
+//
+// Delimiters are found with the search.h primitives: memchr() for a
+// single byte, the SSE2 substring filter for a multi-byte sequence, and
+// the SSE2 set scan for a character class.  Results are remembered, so
+// that skipping over a quoted section never searches the same bytes
+// twice.
+//
+// A quoted section runs from a quote byte to the next one, and delimiters
+// inside it do not split.  Doubled quotes, as in CSV, just close and
+// reopen a section.  Tokens keep their quotes, since removing them would
+// take a copy; see split_unquote().  An unterminated quote runs to the
+// end of the input.
+
+#pragma once
+
+#include "view.h"
+#include "chain.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// ASCII whitespace, for use as a character class
+#define SPLIT_WHITESPACE    " \t\n\v\f\r"
+
+//------------------------------------------------------------------------|
+typedef enum
+{
+    // The single byte delim[0]
+    SPLIT_BYTE,
+
+    // The whole multi-byte sequence in 'delim'
+    SPLIT_STRING,
+
+    // Any one of the bytes in 'delim', such as SPLIT_WHITESPACE
+    SPLIT_CLASS
+}
+split_mode_t;
+
+// How to split.  'delim' must outlive any iteration using it.  An empty
+// delimiter never matches, so the whole input is one token.
+typedef struct
+{
+    split_mode_t mode;
+    const void * delim;
+    size_t length;
+
+    // The quote byte, or 0 for no quote handling
+    uint8_t quote;
+
+    // The most splits to make, after which the rest of the input is the
+    // last token, or 0 for no limit.  At most 'limit' + 1 tokens result.
+    size_t limit;
+
+    // Treat a run of delimiters as one, and skip any at the start and
+    // end, so no empty tokens result.  Otherwise "a,,b" gives an empty
+    // token between the delimiters, and "" gives one empty token.
+    bool merge;
+}
+split_spec_t;
+
+// Iteration state, normally on the stack
+typedef struct
+{
+    split_spec_t spec;
+    view_t input;
+
+    // Start of the next token, and splits made so far
+    size_t offset;
+    size_t splits;
+    bool done;
+
+    // Bytes taken up by one delimiter, 0 if it can never match
+    size_t width;
+
+    // The last delimiter and quote found, and where each search began
+    size_t delim_at;
+    size_t delim_from;
+    size_t quote_at;
+    size_t quote_from;
+
+    // Class membership, one bit per byte value
+    uint8_t members[32];
+}
+split_t;
+
+//------------------------------------------------------------------------|
+// Start splitting 'input', then call split_next() for each token in
+// turn until it returns false
+void split_begin(split_t * split, view_t input, const split_spec_t * spec);
+bool split_next(split_t * split, view_t * token);
+
+// All of the tokens, as view_t payloads of a new compact chain that frees
+// them.  The payloads are allocated together in one block, and the links
+// in one arena, however many tokens there are.  Returns NULL on
+// allocation failure.  The views point into the input, and are only valid
+// as long as it is.
+chain_t * split_chain(view_t input, const split_spec_t * spec);
+
+// A token without its surrounding quotes, if it starts and ends with one.
+// Doubled quotes within it are left as they are.
+view_t split_unquote(view_t token, uint8_t quote);
@@ -0,0 +1,285 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "view.h"
+#include "bytes.h"
+#include "search.h"
+#include "hash.h"
+#include "numconv.h"
+#include "hexdump.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+//------------------------------------------------------------------------|
+// Where empty views point, so that the data is never NULL
+static const uint8_t view_empty[1] = { 0 };
+
+// Whitespace as trimmed by view_trim(), intentionally avoiding isspace()
+static inline bool view_space(uint8_t c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Translate a search result back to an offset into the whole view
+static inline size_t view_found(size_t offset, size_t found)
+{
+    return found == SEARCH_NONE ? found : offset + found;
+}
+
+//------------------------------------------------------------------------|
+view_t view_of(const void * data, size_t size)
+{
+    view_t view = { view_empty, 0 };
+
+    if (NULL != data && size > 0)
+    {
+        view.data = (const uint8_t *) data;
+        view.size = size;
+    }
+
+    return view;
+}
+
+//------------------------------------------------------------------------|
+view_t view_cstr(const char * text)
+{
+    return view_of(text, text ? strlen(text) : 0);
+}
+
+//------------------------------------------------------------------------|
+view_t view_bytes(bytes_t * bytes)
+{
+    return view_of(bytes->data(bytes), bytes->size(bytes));
+}
+
+//------------------------------------------------------------------------|
+view_t view_slice(view_t view, size_t begin, size_t end)
+{
+    end = end < view.size ? end : view.size;
+
+    if (begin >= end)
+    {
+        return view_of(NULL, 0);
+    }
+
+    return view_of(view.data + begin, end - begin);
+}
+
+//------------------------------------------------------------------------|
+view_t view_trim(view_t view)
+{
+    size_t begin = 0, end = view.size;
+
+    while (begin < end && view_space(view.data[begin]))
+    {
+        begin++;
+    }
+
+    while (end > begin && view_space(view.data[end - 1]))
+    {
+        end--;
+    }
+
+    return view_slice(view, begin, end);
+}
+
+//------------------------------------------------------------------------|
+bytes_t * view_copy(view_t view)
+{
+    return bytes_pub.create(view.data, view.size);
+}
+
+//------------------------------------------------------------------------|
+int view_compare(view_t a, view_t b)
+{
+    size_t common = a.size < b.size ? a.size : b.size;
+    int result = common ? memcmp(a.data, b.data, common) : 0;
+
+    if (result != 0 || a.size == b.size)
+    {
+        return result;
+    }
+
+    return a.size < b.size ? -1 : 1;
+}
+
+//------------------------------------------------------------------------|
+bool view_equal(view_t a, view_t b)
+{
+    return a.size == b.size &&
+           (a.data == b.data || 0 == memcmp(a.data, b.data, a.size));
+}
+
+//------------------------------------------------------------------------|
+bool view_starts_with(view_t view, const void * prefix, size_t size)
+{
+    return size <= view.size &&
+           (0 == size || 0 == memcmp(view.data, prefix, size));
+}
+
+//------------------------------------------------------------------------|
+bool view_ends_with(view_t view, const void * suffix, size_t size)
+{
+    return size <= view.size &&
+           (0 == size ||
+            0 == memcmp(view.data + view.size - size, suffix, size));
+}
+
+//------------------------------------------------------------------------|
+size_t view_find_byte(view_t view, size_t offset, uint8_t byte)
+{
+    if (offset >= view.size)
+    {
+        return SEARCH_NONE;
+    }
+
+    return view_found(offset, search_byte(view.data + offset,
+                                          view.size - offset, byte));
+}
+
+//------------------------------------------------------------------------|
+size_t view_find_any_of(view_t view, size_t offset, const void * set,
+                        size_t count)
+{
+    if (offset >= view.size)
+    {
+        return SEARCH_NONE;
+    }
+
+    return view_found(offset, search_any_of(view.data + offset,
+                                            view.size - offset,
+                                            set, count));
+}
+
+//------------------------------------------------------------------------|
+size_t view_find(view_t view, size_t offset, const void * needle,
+                 size_t size)
+{
+    if (offset > view.size)
+    {
+        return SEARCH_NONE;
+    }
+
+    return view_found(offset, search_find(view.data + offset,
+                                          view.size - offset,
+                                          needle, size));
+}
+
+//------------------------------------------------------------------------|
+size_t view_rfind(view_t view, size_t offset, const void * needle,
+                  size_t size)
+{
+    size_t end = view.size;
+
+    // only matches starting at or before 'offset' fit in the window
+    if (offset < view.size && view.size - offset > size)
+    {
+        end = offset + size;
+    }
+
+    return search_rfind(view.data, end, needle, size);
+}
+
+//------------------------------------------------------------------------|
+size_t view_count(view_t view, size_t offset, const void * needle,
+                  size_t size)
+{
+    if (offset > view.size)
+    {
+        return 0;
+    }
+
+    return search_count(view.data + offset, view.size - offset,
+                        needle, size);
+}
+
+//------------------------------------------------------------------------|
+uint64_t view_hash(view_t view)
+{
+    return hash_bytes(view.data, view.size, HASH_SEED);
+}
+
+//------------------------------------------------------------------------|
+size_t view_parse_u64(view_t view, size_t offset, uint64_t * value)
+{
+    if (offset >= view.size)
+    {
+        return 0;
+    }
+
+    return numconv_parse_u64((const char *) view.data + offset,
+                             view.size - offset, value);
+}
+
+//------------------------------------------------------------------------|
+size_t view_parse_double(view_t view, size_t offset, double * value)
+{
+    if (offset >= view.size)
+    {
+        return 0;
+    }
+
+    return numconv_parse_double((const char *) view.data + offset,
+                                view.size - offset, value);
+}
+
+//------------------------------------------------------------------------|
+bool view_hexdump(view_t view, bytes_t * out)
+{
+    char chunk[HEXDUMP_CHUNK_MAX];
+    size_t step = HEXDUMP_CHUNK_LINES * HEXDUMP_COLUMNS;
+    size_t begin = 0, stop, length;
+
+    // reserve for the whole dump up front, so the appends cannot fail
+    length = hexdump_length(0, view.size);
+    if (!bytes_reserve(out, out->size(out) + length))
+    {
+        return false;
+    }
+
+    while (begin < view.size)
+    {
+        stop = view.size - begin < step ? view.size : begin + step;
+        length = hexdump_format(chunk, view.data, begin, stop);
+        out->append(out, chunk, length);
+        begin = stop;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------|
+ssize_t view_hexdump_fd(view_t view, int fd)
+{
+    return hexdump_stream(view.data, 0, view.size, fd, NULL);
+}
+
+//------------------------------------------------------------------------|
+ssize_t view_hexdump_file(view_t view, FILE * stream)
+{
+    return hexdump_stream(view.data, 0, view.size, -1, stream);
+}
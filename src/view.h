@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+// VIEW: A non-owning, read-only window onto bytes held elsewhere, either
+// in a bytes_t or in raw memory.  A view is just a pointer and a length,
+// passed and returned by value, so taking one, slicing one and trimming
+// one never allocate.  It carries the read-only half of the bytes_t API:
+// comparison, search, hashing, number parsing and hexdump.
+//
+// A view does not keep its bytes alive.  One taken of a bytes_t is only
+// valid until that object is next modified or destroyed, since either may
+// move or free its data.  Use view_copy() to keep the contents.
+//
+// Offsets taken and returned by the functions below are relative to the
+// start of the view, and searches return SEARCH_NONE for no match.
+
+#pragma once
+
+#include "search.h"
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// Declared here rather than included, so that bytes.h can use views
+struct bytes_t;
+
+typedef struct
+{
+    const uint8_t * data;
+    size_t size;
+}
+view_t;
+
+//------------------------------------------------------------------------|
+// A view of 'size' bytes of raw memory, of a C string without its
+// terminator, and of the whole of a bytes_t
+view_t view_of(const void * data, size_t size);
+view_t view_cstr(const char * text);
+view_t view_bytes(struct bytes_t * bytes);
+
+// The part of a view in [begin, end), clamped to the view, so 'end' may
+// be SIZE_MAX.  An empty range gives an empty view.
+view_t view_slice(view_t view, size_t begin, size_t end);
+
+// The view without leading and trailing ASCII whitespace
+view_t view_trim(view_t view);
+
+// A new bytes_t holding a copy of the contents, or NULL on failure
+struct bytes_t * view_copy(view_t view);
+
+//------------------------------------------------------------------------|
+// Byte-wise comparison in memcmp() order, with a view that is a prefix of
+// the other ordered first.  Returns <0, 0 or >0.
+int view_compare(view_t a, view_t b);
+bool view_equal(view_t a, view_t b);
+
+bool view_starts_with(view_t view, const void * prefix, size_t size);
+bool view_ends_with(view_t view, const void * suffix, size_t size);
+
+//------------------------------------------------------------------------|
+// Same as the bytes_t methods of the same names.  See search.h.
+size_t view_find_byte(view_t view, size_t offset, uint8_t byte);
+size_t view_find_any_of(view_t view, size_t offset, const void * set,
+                        size_t count);
+size_t view_find(view_t view, size_t offset, const void * needle,
+                 size_t size);
+size_t view_rfind(view_t view, size_t offset, const void * needle,
+                  size_t size);
+size_t view_count(view_t view, size_t offset, const void * needle,
+                  size_t size);
+
+// Hash of the contents with the library's default seed, so equal views
+// hash equally wherever their bytes live
+uint64_t view_hash(view_t view);
+
+// Same as the bytes_t methods of the same names.  See numconv.h.
+size_t view_parse_u64(view_t view, size_t offset, uint64_t * value);
+size_t view_parse_double(view_t view, size_t offset, double * value);
+
+//------------------------------------------------------------------------|
+// Append a hexdump of the view to 'out', with offsets relative to the
+// start of the view.  Returns false if memory could not be allocated.
+bool view_hexdump(view_t view, struct bytes_t * out);
+
+// Write the hexdump straight to a file descriptor or stream.  Returns the
+// number of characters written, or -1 on error.  See hexdump.h.
+ssize_t view_hexdump_fd(view_t view, int fd);
+ssize_t view_hexdump_file(view_t view, FILE * stream);
@@ -0,0 +1,204 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "allocator.h"
+#include "chain.h"
+#include "bytes.h"
+#include "mut.h"
+#include "fixture.h"
+
+#include <string.h>
+
+//------------------------------------------------------------------------|
+// A counting allocator that also checks the sizes it is given back, by
+// keeping each block's size in a header in front of it.
+typedef struct
+{
+    size_t blocks;
+    size_t bytes;
+    size_t mismatches;
+}
+counter_t;
+
+#define HEADER  (2 * sizeof(size_t))
+
+static void * counter_alloc(void * context, size_t size)
+{
+    counter_t * counter = (counter_t *) context;
+    size_t * block = (size_t *) malloc(HEADER + size);
+
+    block[0] = size;
+    counter->blocks++;
+    counter->bytes += size;
+    return (uint8_t *) block + HEADER;
+}
+
+static void counter_free(void * context, void * ptr, size_t size)
+{
+    counter_t * counter = (counter_t *) context;
+    size_t * block = (size_t *) ((uint8_t *) ptr - HEADER);
+
+    counter->mismatches += (block[0] != size);
+    counter->blocks--;
+    counter->bytes -= size;
+    free(block);
+}
+
+static void * counter_realloc(void * context, void * ptr, size_t old_size,
+                              size_t size)
+{
+    void * result = counter_alloc(context, size);
+
+    if (NULL != ptr)
+    {
+        memcpy(result, ptr, old_size < size ? old_size : size);
+        counter_free(context, ptr, old_size);
+    }
+
+    return result;
+}
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_allocator.log");
+    BLAMMO(INFO, "allocator tests...");
+
+    (void) fixture_report;
+
+TEST_BEGIN("libc default")
+    CHECK(allocator_same(allocator_default(), &allocator_libc));
+
+    void * ptr = allocator_alloc(&allocator_libc, 16);
+    CHECK(ptr != NULL);
+    ptr = allocator_realloc(&allocator_libc, ptr, 16, 64);
+    CHECK(ptr != NULL);
+    allocator_free(&allocator_libc, ptr, 64);
+    allocator_free(&allocator_libc, NULL, 0);
+TEST_END
+
+TEST_BEGIN("chains")
+    const chain_t * pubs[] = { &chain_pub, &chain_compact_pub };
+    counter_t counter = { 0, 0, 0 };
+    allocator_t allocator = {
+        counter_alloc, counter_realloc, counter_free, &counter
+    };
+    size_t i, n;
+
+    for (n = 0; n < 2; n++)
+    {
+        chain_t * chain = pubs[n]->create_with(NULL, &allocator);
+        CHECK(chain != NULL);
+        CHECK(counter.blocks == 2);
+
+        for (i = 1; i <= 100; i++)
+        {
+            chain->insert(chain, (void *) i);
+        }
+
+        chain->remove(chain);
+        CHECK(counter.blocks > 2);
+
+        // copies and segments come from the same allocator
+        chain_t * copy = chain->copy(chain, NULL);
+        chain_t * seg = chain->split(chain, 10, 20);
+        CHECK(copy->length(copy) == 99);
+        CHECK(seg->length(seg) == 10);
+        CHECK(chain->join(chain, seg));
+
+        // but chains on different allocators cannot be joined
+        chain_t * other = pubs[n]->create(NULL);
+        other->insert(other, (void *) 1);
+        CHECK(!chain->join(chain, other));
+        other->destroy(other);
+
+        seg->destroy(seg);
+        copy->destroy(copy);
+        chain->destroy(chain);
+        CHECK(counter.blocks == 0);
+        CHECK(counter.bytes == 0);
+        CHECK(counter.mismatches == 0);
+    }
+TEST_END
+
+TEST_BEGIN("bytes")
+    counter_t counter = { 0, 0, 0 };
+    allocator_t allocator = {
+        counter_alloc, counter_realloc, counter_free, &counter
+    };
+
+    // the object, its private data and short contents are one block
+    bytes_t * bytes = bytes_create_with("hello", 5, &allocator);
+    CHECK(bytes != NULL);
+    CHECK(counter.blocks == 1);
+
+    bytes->append(bytes, " world", 6);
+    CHECK(!strcmp(bytes->cstr(bytes), "hello world"));
+    CHECK(bytes->hexdump(bytes) != NULL);
+    CHECK(counter.blocks > 1);
+
+    bytes->clear(bytes);
+    bytes->assign(bytes, "again", 5);
+    CHECK(counter.blocks == 1);
+
+    // only contents too long to keep inline take a block of their own
+    bytes->resize(bytes, 100);
+    CHECK(counter.blocks == 2);
+    bytes->resize(bytes, 5);
+    bytes_shrink_to_fit(bytes);
+    CHECK(counter.blocks == 1);
+
+    bytes->destroy(bytes);
+    CHECK(counter.blocks == 0);
+    CHECK(counter.bytes == 0);
+    CHECK(counter.mismatches == 0);
+TEST_END
+
+TEST_BEGIN("set default")
+    counter_t counter = { 0, 0, 0 };
+    allocator_t allocator = {
+        counter_alloc, counter_realloc, counter_free, &counter
+    };
+
+    allocator_set_default(&allocator);
+    CHECK(allocator_same(allocator_default(), &allocator));
+
+    chain_t * chain = chain_pub.create(NULL);
+    bytes_t * bytes = bytes_pub.create("x", 1);
+    CHECK(counter.blocks == 3);
+
+    // restoring libc does not affect objects that already exist
+    allocator_set_default(NULL);
+    CHECK(allocator_same(allocator_default(), &allocator_libc));
+
+    chain->insert(chain, NULL);
+    CHECK(counter.blocks == 4);
+
+    chain->destroy(chain);
+    bytes->destroy(bytes);
+    CHECK(counter.blocks == 0);
+    CHECK(counter.mismatches == 0);
+TEST_END
+
+TESTSUITE_END
@@ -0,0 +1,263 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#define _POSIX_C_SOURCE 200809L  // fileno()
+
+#include "blammo.h"
+#include "archive.h"
+#include "chain.h"
+#include "bytes.h"
+#include "mut.h"
+#include "fixture.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Encode pointer values as their decimal text, for variable-size records
+static bool encode_value(const void * data, bytes_t * out)
+{
+    char text[32];
+    int length = snprintf(text, sizeof(text), "%zu", (size_t) (uintptr_t) data);
+    out->append(out, text, (size_t) length);
+    return true;
+}
+
+static void * decode_value(const void * data, size_t size)
+{
+    char text[32];
+    memcpy(text, data, size);
+    text[size] = '\0';
+    return (void *) (uintptr_t) strtoul(text, NULL, 10);
+}
+
+// Same as decode_value(), but failing on the record "130"
+static void * decode_until_130(const void * data, size_t size)
+{
+    return (3 == size && !memcmp(data, "130", 3)) ? NULL :
+           decode_value(data, size);
+}
+
+// Little-endian field writer, for hand-damaging archives
+static void poke(uint8_t * p, uint64_t value, size_t width)
+{
+    size_t i;
+
+    for (i = 0; i < width; i++)
+    {
+        p[i] = (uint8_t) (value >> (8 * i));
+    }
+}
+
+// Fill a chain with the values 1 through 'count'
+static chain_t * make_chain(const chain_t * pub, size_t count)
+{
+    chain_t * chain = pub->create(NULL);
+    size_t value;
+
+    for (value = 1; value <= count; value++)
+    {
+        chain->insert(chain, (void *) (uintptr_t) value);
+    }
+
+    return chain;
+}
+
+// Check that a chain holds the values 1 through 'count' in order
+static bool check_chain(chain_t * chain, size_t count)
+{
+    size_t value;
+
+    if (chain->length(chain) != count)
+    {
+        return false;
+    }
+
+    chain->reset(chain);
+    for (value = 1; value <= count; value++)
+    {
+        if (chain->data(chain) != (void *) (uintptr_t) value)
+        {
+            return false;
+        }
+
+        chain->spin(chain, 1);
+    }
+
+    return true;
+}
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_archive.log");
+    BLAMMO(INFO, "archive tests...");
+
+    (void) fixture_report;
+
+TEST_BEGIN("round trip through bytes")
+    size_t counts[] = { 0, 1, 63, 64, 65, 1000 };
+    size_t i;
+
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        chain_t * chain = make_chain(&chain_pub, counts[i]);
+        chain_t * loaded = chain_compact_pub.create(NULL);
+        bytes_t * out = bytes_pub.create("", 0);
+        archive_t * archive = NULL;
+
+        CHECK(archive_write_bytes(chain, encode_value, out));
+        archive = archive_pub.create(out->data(out), out->size(out));
+        CHECK(archive != NULL);
+        CHECK(archive->length(archive) == counts[i]);
+
+        CHECK(archive->load(archive, loaded, decode_value));
+        CHECK(check_chain(loaded, counts[i]));
+
+        archive->destroy(archive);
+        loaded->destroy(loaded);
+        chain->destroy(chain);
+        out->destroy(out);
+    }
+TEST_END
+
+TEST_BEGIN("random access")
+    chain_t * chain = make_chain(&chain_pub, 500);
+    bytes_t * out = bytes_pub.create("", 0);
+    archive_t * archive = NULL;
+    const char * record = NULL;
+    size_t size = 0;
+
+    CHECK(archive_write_bytes(chain, encode_value, out));
+    archive = archive_pub.create(out->data(out), out->size(out));
+    CHECK(archive != NULL);
+
+    record = (const char *) archive->record(archive, 0, &size);
+    CHECK((size == 1) && !memcmp(record, "1", 1));
+    record = (const char *) archive->record(archive, 129, &size);
+    CHECK((size == 3) && !memcmp(record, "130", 3));
+    record = (const char *) archive->record(archive, 499, &size);
+    CHECK((size == 3) && !memcmp(record, "500", 3));
+    CHECK(archive->record(archive, 500, &size) == NULL);
+
+    // zero-copy load points the chain into the archive itself
+    chain_t * view = chain_compact_pub.create(NULL);
+    CHECK(archive->load(archive, view, NULL));
+    CHECK(view->length(view) == 500);
+    view->reset(view);
+    view->spin(view, 129);
+    CHECK(view->data(view) == archive->record(archive, 129, NULL));
+    view->destroy(view);
+
+    // a failed decode fails the load, after what was decoded before it
+    chain_t * loaded = chain_pub.create(NULL);
+    CHECK(!archive->load(archive, loaded, decode_until_130));
+    CHECK(loaded->length(loaded) == 129);
+    loaded->destroy(loaded);
+
+    archive->destroy(archive);
+    chain->destroy(chain);
+    out->destroy(out);
+TEST_END
+
+TEST_BEGIN("damaged archives")
+    chain_t * chain = make_chain(&chain_pub, 100);
+    bytes_t * out = bytes_pub.create("", 0);
+    uint8_t * copy = NULL;
+    size_t size;
+
+    CHECK(archive_write_bytes(chain, encode_value, out));
+    size = out->size(out);
+    copy = (uint8_t *) malloc(size);
+    memcpy(copy, out->data(out), size);
+
+    // truncated, or with bad magic
+    CHECK(archive_pub.create(copy, size - 1) == NULL);
+    CHECK(archive_pub.create(copy, 10) == NULL);
+    copy[0] = 'X';
+    CHECK(archive_pub.create(copy, size) == NULL);
+    copy[0] = out->data(out)[0];
+
+    // a record end pointing past its block opens, but fails to read
+    archive_t * archive = archive_pub.create(copy, size);
+    CHECK(archive != NULL);
+    copy[20 + 8] = 0xff;
+    copy[20 + 9] = 0xff;
+    CHECK(archive->record(archive, 0, NULL) == NULL);
+
+    chain_t * loaded = chain_pub.create(NULL);
+    CHECK(!archive->load(archive, loaded, decode_value));
+    loaded->destroy(loaded);
+    archive->destroy(archive);
+
+    // far more blocks than fit, with an index table offset that agrees
+    // with them once the subtraction wraps around
+    poke(copy + 8, 1, 4);
+    poke(copy + 12, 0x10000000, 8);
+    poke(copy + size - 16, (uint64_t) size - 16 - 0x10000000ULL * 8, 8);
+    poke(copy + size - 8, 0x10000000, 4);
+    CHECK(archive_pub.create(copy, size) == NULL);
+
+    chain->destroy(chain);
+    out->destroy(out);
+    free(copy);
+TEST_END
+
+TEST_BEGIN("bytes payloads through a mapped file")
+    chain_t * chain = chain_pub.create(bytes_pub.destroy);
+    chain_t * loaded = chain_compact_pub.create(bytes_pub.destroy);
+    const char * words[] = { "alpha", "", "gamma", "delta epsilon" };
+    archive_t * archive = NULL;
+    bytes_t * bytes = NULL;
+    FILE * file = tmpfile();
+    size_t i;
+
+    CHECK(file != NULL);
+
+    for (i = 0; i < 4; i++)
+    {
+        chain->insert(chain, bytes_pub.create(words[i], strlen(words[i])));
+    }
+
+    CHECK(archive_write_fd(chain, archive_encode_bytes, fileno(file)));
+    archive = archive_pub.map(fileno(file));
+    fclose(file);
+    CHECK(archive != NULL);
+    CHECK(archive->length(archive) == 4);
+
+    CHECK(archive->load(archive, loaded, archive_decode_bytes));
+    loaded->reset(loaded);
+    for (i = 0; i < 4; i++)
+    {
+        bytes = (bytes_t *) loaded->data(loaded);
+        CHECK(bytes->size(bytes) == strlen(words[i]));
+        CHECK(!bytes->size(bytes) ||
+              !memcmp(bytes->data(bytes), words[i], strlen(words[i])));
+        loaded->spin(loaded, 1);
+    }
+
+    archive->destroy(archive);
+    loaded->destroy(loaded);
+    chain->destroy(chain);
+TEST_END
+
+TESTSUITE_END
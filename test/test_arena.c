@@ -0,0 +1,245 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "arena.h"
+#include "chain.h"
+#include "bytes.h"
+#include "mut.h"
+#include "fixture.h"
+
+#include <string.h>
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_arena.log");
+    BLAMMO(INFO, "arena tests...");
+
+    (void) fixture_report;
+
+TEST_BEGIN("alloc")
+    arena_t * arena = arena_pub.create(256);
+    arena_stats_t stats;
+    uint8_t * ptrs[64];
+    size_t i;
+
+    CHECK(arena != NULL);
+    arena->stats(arena, &stats);
+    CHECK(stats.chunks == 0);
+    CHECK(stats.used == 0);
+
+    for (i = 0; i < 64; i++)
+    {
+        ptrs[i] = (uint8_t *) arena->alloc(arena, i + 1);
+        CHECK(ptrs[i] != NULL);
+        CHECK(((uintptr_t) ptrs[i] & (ARENA_ALIGN - 1)) == 0);
+        memset(ptrs[i], (int) i, i + 1);
+    }
+
+    // nothing was overwritten by a later allocation
+    for (i = 0; i < 64; i++)
+    {
+        CHECK(ptrs[i][0] == i && ptrs[i][i] == i);
+    }
+
+    arena->stats(arena, &stats);
+    CHECK(stats.allocations == 64);
+    CHECK(stats.chunks > 1);
+    CHECK(stats.used >= 64 * 65 / 2);
+    CHECK(stats.peak == stats.used);
+
+    uint8_t * big = (uint8_t *) arena->alloc_aligned(arena, 4096, 4096);
+    CHECK(big != NULL);
+    CHECK(((uintptr_t) big & 4095) == 0);
+    memset(big, 0xAA, 4096);
+
+    CHECK(arena->alloc_aligned(arena, 8, 3) == NULL);
+
+    char * str = (char *) arena->dup(arena, "hello", 6);
+    CHECK(!strcmp(str, "hello"));
+
+    arena->destroy(arena);
+TEST_END
+
+TEST_BEGIN("mark and rewind")
+    arena_t * arena = arena_pub.create(128);
+    arena_stats_t stats;
+    arena_marker_t marker;
+    size_t i, used;
+
+    arena->alloc(arena, 40);
+    marker = arena->mark(arena);
+    arena->stats(arena, &stats);
+    used = stats.used;
+
+    void * first = arena->alloc(arena, 24);
+    for (i = 0; i < 20; i++)
+    {
+        arena->alloc(arena, 50);
+    }
+
+    arena->rewind(arena, marker);
+    arena->stats(arena, &stats);
+    CHECK(stats.used == used);
+    CHECK(stats.peak > used);
+
+    // the same space is handed out again
+    CHECK(arena->alloc(arena, 24) == first);
+
+    // and the spare chunks are reused rather than allocated again
+    size_t chunks = stats.chunks;
+    for (i = 0; i < 20; i++)
+    {
+        arena->alloc(arena, 50);
+    }
+    arena->stats(arena, &stats);
+    CHECK(stats.chunks == chunks);
+
+    arena->destroy(arena);
+TEST_END
+
+TEST_BEGIN("reset and trim")
+    arena_t * arena = arena_pub.create(128);
+    arena_stats_t stats;
+    size_t i;
+
+    for (i = 0; i < 10; i++)
+    {
+        arena->alloc(arena, 100);
+    }
+
+    void * huge = arena->alloc(arena, 10000);
+    CHECK(huge != NULL);
+
+    arena->stats(arena, &stats);
+    CHECK(stats.chunks == 11);
+    CHECK(stats.capacity >= 10 * 128 + 10000);
+
+    arena->reset(arena);
+    arena->stats(arena, &stats);
+    CHECK(stats.used == 0);
+    CHECK(stats.chunks == 11);
+    CHECK(stats.resets == 1);
+
+    arena->alloc(arena, 16);
+    arena->trim(arena);
+    arena->stats(arena, &stats);
+    CHECK(stats.chunks == 1);
+    CHECK(stats.capacity == 128);
+
+    arena->reset(arena);
+    arena->trim(arena);
+    arena->stats(arena, &stats);
+    CHECK(stats.chunks == 0);
+    CHECK(stats.capacity == 0);
+
+    // still usable after being trimmed to nothing
+    CHECK(arena->alloc(arena, 16) != NULL);
+
+    arena->destroy(arena);
+TEST_END
+
+TEST_BEGIN("allocator")
+    arena_t * arena = arena_pub.create(1024);
+    const allocator_t * allocator = arena->allocator(arena);
+    arena_stats_t stats;
+
+    uint8_t * a = (uint8_t *) allocator_alloc(allocator, 16);
+    memset(a, 1, 16);
+
+    // the most recent block grows in place
+    uint8_t * b = (uint8_t *) allocator_realloc(allocator, a, 16, 64);
+    CHECK(b == a);
+
+    // others move, keeping their contents
+    uint8_t * c = (uint8_t *) allocator_alloc(allocator, 8);
+    uint8_t * d = (uint8_t *) allocator_realloc(allocator, b, 64, 128);
+    CHECK(d != b);
+    CHECK(d[0] == 1 && d[15] == 1);
+
+    // and only the most recent block is given back on free
+    arena->stats(arena, &stats);
+    size_t used = stats.used;
+    allocator_free(allocator, c, 8);
+    arena->stats(arena, &stats);
+    CHECK(stats.used == used);
+    allocator_free(allocator, d, 128);
+    arena->stats(arena, &stats);
+    CHECK(stats.used == used - 128);
+
+    arena->destroy(arena);
+TEST_END
+
+TEST_BEGIN("request scope")
+    arena_t * arena = arena_pub.create(0);
+    const allocator_t * allocator = arena->allocator(arena);
+    arena_stats_t stats;
+    size_t round, i, j, chunks = 0;
+
+    for (round = 0; round < 3; round++)
+    {
+        // many objects, none of them destroyed individually
+        for (i = 0; i < 20; i++)
+        {
+            chain_t * chain = chain_pub.create_with(NULL, allocator);
+            chain_t * compact = chain_compact_pub.create_with(NULL,
+                                                              allocator);
+            bytes_t * bytes = bytes_create_with("request", 7, allocator);
+            CHECK(chain && compact && bytes);
+
+            for (j = 1; j <= 50; j++)
+            {
+                chain->insert(chain, (void *) j);
+                compact->insert(compact, (void *) j);
+                bytes->append(bytes, "!", 1);
+            }
+
+            CHECK(chain->length(chain) == 50);
+            CHECK(compact->length(compact) == 50);
+            CHECK(bytes->size(bytes) == 57);
+
+            chain_t * copy = chain->copy(chain, NULL);
+            CHECK(copy->length(copy) == 50);
+        }
+
+        arena->stats(arena, &stats);
+        CHECK(stats.used > 0);
+        if (round == 0)
+        {
+            chunks = stats.chunks;
+        }
+
+        arena->reset(arena);
+    }
+
+    // later rounds ran entirely in the chunks of the first
+    arena->stats(arena, &stats);
+    CHECK(stats.chunks == chunks);
+    CHECK(stats.resets == 3);
+    CHECK(stats.used == 0);
+
+    arena->destroy(arena);
+TEST_END
+
+TESTSUITE_END
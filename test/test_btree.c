@@ -0,0 +1,321 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "btree.h"
+#include "chain.h"
+#include "prng.h"
+#include "mut.h"
+#include "fixture.h"
+
+#include <string.h>
+
+// Compare pointer values directly, qsort() style
+static int compare_value(const void * a, const void * b)
+{
+    uintptr_t aval = (uintptr_t) *(void **) a;
+    uintptr_t bval = (uintptr_t) *(void **) b;
+    return (aval > bval) - (aval < bval);
+}
+
+// Walk the whole tree in order checking strict order and the count
+static bool check_order(btree_t * tree)
+{
+    uintptr_t prev = 0, value;
+    size_t count = 0;
+
+    if (!tree->reset(tree))
+    {
+        return tree->empty(tree);
+    }
+
+    do
+    {
+        value = (uintptr_t) tree->data(tree);
+        if ((count > 0) && (value <= prev))
+        {
+            return false;
+        }
+
+        prev = value;
+        count++;
+    }
+    while (tree->next(tree));
+
+    return (count == tree->length(tree));
+}
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_btree.log");
+    BLAMMO(INFO, "btree tests...");
+
+    (void) fixture_report;
+
+TEST_BEGIN("create")
+    btree_t * tree = btree_pub.create(NULL, compare_value);
+    CHECK(tree != NULL);
+    CHECK(tree->priv != NULL);
+    CHECK(tree->empty(tree));
+    CHECK(tree->length(tree) == 0);
+    CHECK(!tree->reset(tree));
+    CHECK(tree->data(tree) == NULL);
+    CHECK(tree->find(tree, (void *) 1) == NULL);
+    CHECK(!tree->erase(tree, (void *) 1));
+    tree->destroy(tree);
+
+    // a comparator is required
+    CHECK(btree_pub.create(NULL, NULL) == NULL);
+TEST_END
+
+TEST_BEGIN("insert/find random")
+    btree_t * tree = btree_pub.create(NULL, compare_value);
+    uintptr_t value;
+    size_t i, unique = 0;
+
+    prng_seed(31);
+
+    for (i = 0; i < 20000; i++)
+    {
+        value = (uintptr_t) (prng_next() % 10000) + 1;
+        if (!tree->find(tree, (void *) value))
+        {
+            unique++;
+        }
+
+        CHECK(tree->insert(tree, (void *) value));
+        CHECK(tree->find(tree, (void *) value) == (void *) value);
+    }
+
+    CHECK(tree->length(tree) == unique);
+    CHECK(check_order(tree));
+    tree->destroy(tree);
+TEST_END
+
+TEST_BEGIN("insert replace")
+    btree_t * tree = btree_pub.create(payload_destroy, payload_compare);
+    payload_t * a = NULL;
+    payload_t * b = NULL;
+    int i;
+
+    fixture_reset();
+
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        payload_create(i);
+    }
+
+    // two distinct payloads with equal keys
+    a = fixture_payload(3);
+    b = fixture_payload(9);
+    b->id = 3;
+
+    for (i = 0; i < FIXTURE_PAYLOADS - 1; i++)
+    {
+        CHECK(tree->insert(tree, fixture_payload(i)));
+    }
+
+    CHECK(tree->length(tree) == FIXTURE_PAYLOADS - 1);
+    CHECK(tree->find(tree, a) == a);
+
+    CHECK(tree->insert(tree, b));
+    CHECK(tree->length(tree) == FIXTURE_PAYLOADS - 1);
+    CHECK(a->is_destroyed);
+    CHECK(tree->find(tree, a) == b);
+    CHECK(!b->is_destroyed);
+
+    tree->destroy(tree);
+    CHECK(b->is_destroyed);
+    CHECK(fixture_payload(0)->is_destroyed);
+TEST_END
+
+TEST_BEGIN("erase")
+    btree_t * tree = btree_pub.create(NULL, compare_value);
+    uintptr_t value;
+    size_t i;
+
+    for (value = 1; value <= 5000; value++)
+    {
+        CHECK(tree->insert(tree, (void *) value));
+    }
+
+    // erase every odd value, in a scrambled order
+    prng_seed(7);
+    for (i = 0; i < 20000; i++)
+    {
+        value = (uintptr_t) (prng_next() % 5000) + 1;
+        if (value & 1)
+        {
+            tree->erase(tree, (void *) value);
+        }
+    }
+
+    for (value = 1; value <= 5000; value += 2)
+    {
+        tree->erase(tree, (void *) value);
+    }
+
+    CHECK(tree->length(tree) == 2500);
+    CHECK(check_order(tree));
+    CHECK(tree->find(tree, (void *) 1) == NULL);
+    CHECK(tree->find(tree, (void *) 2) == (void *) 2);
+    CHECK(!tree->erase(tree, (void *) 3));
+
+    // erase the rest from both ends toward the middle
+    for (i = 0; i < 1250; i++)
+    {
+        CHECK(tree->erase(tree, (void *) (uintptr_t) (2 + 2 * i)));
+        CHECK(tree->erase(tree, (void *) (uintptr_t) (5000 - 2 * i)));
+    }
+
+    CHECK(tree->empty(tree));
+    CHECK(!tree->reset(tree));
+
+    // and it still works afterward
+    CHECK(tree->insert(tree, (void *) 42));
+    CHECK(tree->find(tree, (void *) 42) == (void *) 42);
+    tree->destroy(tree);
+TEST_END
+
+TEST_BEGIN("lower/upper range scan")
+    btree_t * tree = btree_pub.create(NULL, compare_value);
+    uintptr_t value;
+    size_t count;
+
+    // multiples of 10 from 10 to 10000
+    for (value = 10; value <= 10000; value += 10)
+    {
+        tree->insert(tree, (void *) value);
+    }
+
+    CHECK(tree->lower(tree, (void *) 500));
+    CHECK(tree->data(tree) == (void *) 500);
+    CHECK(tree->upper(tree, (void *) 500));
+    CHECK(tree->data(tree) == (void *) 510);
+    CHECK(tree->lower(tree, (void *) 501));
+    CHECK(tree->data(tree) == (void *) 510);
+    CHECK(tree->lower(tree, (void *) 1));
+    CHECK(tree->data(tree) == (void *) 10);
+    CHECK(!tree->lower(tree, (void *) 10001));
+    CHECK(tree->data(tree) == NULL);
+    CHECK(!tree->upper(tree, (void *) 10000));
+
+    // count the payloads in [2005, 7005)
+    count = 0;
+    for (tree->lower(tree, (void *) 2005);
+         tree->data(tree) && ((uintptr_t) tree->data(tree) < 7005);
+         tree->next(tree))
+    {
+        count++;
+    }
+
+    CHECK(count == 500);
+    tree->destroy(tree);
+TEST_END
+
+TEST_BEGIN("next/prev")
+    btree_t * tree = btree_pub.create(NULL, compare_value);
+    uintptr_t value;
+
+    for (value = 1; value <= 1000; value++)
+    {
+        tree->insert(tree, (void *) value);
+    }
+
+    // walk backward from the last payload
+    CHECK(tree->lower(tree, (void *) 1000));
+    value = 1000;
+    while (tree->prev(tree))
+    {
+        value--;
+        CHECK(tree->data(tree) == (void *) value);
+    }
+
+    CHECK(value == 1);
+    CHECK(tree->data(tree) == NULL);
+    CHECK(!tree->next(tree));
+
+    // step back and forth across leaf boundaries
+    CHECK(tree->lower(tree, (void *) 500));
+    for (value = 0; value < 100; value++)
+    {
+        CHECK(tree->next(tree));
+    }
+
+    for (value = 0; value < 100; value++)
+    {
+        CHECK(tree->prev(tree));
+    }
+
+    CHECK(tree->data(tree) == (void *) 500);
+    tree->destroy(tree);
+TEST_END
+
+TEST_BEGIN("load")
+    btree_t * tree = btree_pub.create(NULL, compare_value);
+    chain_t * chain = chain_pub.create(NULL);
+    uintptr_t value;
+    size_t length;
+
+    // an empty chain loads nothing
+    CHECK(tree->load(tree, chain, NULL));
+    CHECK(tree->empty(tree));
+
+    for (length = 1; length <= 3000; length = length * 3 + 1)
+    {
+        chain->clear(chain);
+        tree->clear(tree);
+
+        for (value = 1; value <= length; value++)
+        {
+            chain->insert(chain, (void *) (value * 2));
+        }
+
+        CHECK(tree->load(tree, chain, NULL));
+        CHECK(tree->length(tree) == length);
+        CHECK(check_order(tree));
+        CHECK(tree->find(tree, (void *) (length * 2)) == (void *) (length * 2));
+        CHECK(tree->find(tree, (void *) 3) == NULL);
+
+        // a loaded tree takes inserts and erases like any other
+        CHECK(tree->insert(tree, (void *) 3));
+        CHECK(tree->erase(tree, (void *) 2));
+        CHECK(tree->length(tree) == length);
+        CHECK(check_order(tree));
+    }
+
+    // refused while not empty
+    CHECK(!tree->load(tree, chain, NULL));
+
+    // refused when not strictly sorted
+    tree->clear(tree);
+    chain->insert(chain, (void *) 1);
+    CHECK(!tree->load(tree, chain, NULL));
+    CHECK(tree->empty(tree));
+
+    chain->destroy(chain);
+    tree->destroy(tree);
+TEST_END
+
+TESTSUITE_END
@@ -21,6 +21,8 @@
 // SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //------------------------------------------------------------------------|
 
+#define _POSIX_C_SOURCE 200809L  // fileno(), pthreads
+
 #include "blammo.h"
 #include "bytes.h"
 #include "prng.h"
@@ -28,6 +30,40 @@
 
 #include <string.h>
 #include <limits.h>
+#include <pthread.h>
+
+#define THREADS     4
+#define ROUNDS      2000
+
+// Copy a shared object over and over, writing to some of the copies,
+// and count any that do not hold what they should
+static void * copier(void * arg)
+{
+    bytes_t * shared = (bytes_t *) arg;
+    size_t size = shared->size(shared);
+    size_t errors = 0, i;
+    bytes_t * copy;
+
+    for (i = 0; i < ROUNDS; i++)
+    {
+        copy = shared->copy(shared);
+        if (copy->data(copy) != shared->data(shared))
+        {
+            errors++;
+        }
+
+        if (i % 3 == 0)
+        {
+            copy->append(copy, "!", 1);
+            errors += copy->data(copy)[size] != '!';
+        }
+
+        errors += memcmp(copy->data(copy), shared->data(shared), size) != 0;
+        copy->destroy(copy);
+    }
+
+    return (void *) errors;
+}
 
 TESTSUITE_BEGIN
 
@@ -57,6 +93,10 @@ TEST_BEGIN("create/size/empty")
     CHECK(!bytes->empty(bytes));
     CHECK(bytes->size(bytes) == 64);
     bytes->destroy(bytes);
+
+    // every object carries a copy of the interface, which must not grow
+    // past the 18 original operations and the private pointer
+    CHECK(sizeof(bytes_t) <= 19 * sizeof(void *));
 TEST_END
 
 TEST_BEGIN("destroy")
@@ -176,6 +216,448 @@ TEST_BEGIN("append")
 
 TEST_END
 
+TEST_BEGIN("capacity")
+    bytes_t * bytes = bytes_pub.create("abc", 3);
+    size_t i, reallocs = 0, capacity = bytes_capacity(bytes);
+    const uint8_t * data = NULL;
+
+    CHECK(capacity >= 3);
+
+    // appending one byte at a time reallocates only logarithmically often
+    for (i = 0; i < 4096; i++)
+    {
+        bytes->append(bytes, "x", 1);
+        if (bytes_capacity(bytes) != capacity)
+        {
+            capacity = bytes_capacity(bytes);
+            reallocs++;
+        }
+        CHECK(bytes_capacity(bytes) >= bytes->size(bytes));
+    }
+    CHECK(bytes->size(bytes) == 4099);
+    CHECK(reallocs <= 12);
+    CHECK(bytes->cstr(bytes)[4099] == '\0');
+
+    // shrinking keeps the capacity, and growing back zeroes
+    bytes->resize(bytes, 3);
+    CHECK(bytes_capacity(bytes) == capacity);
+    CHECK(strcmp(bytes->cstr(bytes), "abc") == 0);
+    bytes->resize(bytes, 5);
+    CHECK(memcmp(bytes->data(bytes), "abc\0\0", 6) == 0);
+
+    // short contents move back inline
+    bytes_shrink_to_fit(bytes);
+    CHECK(bytes_capacity(bytes) < capacity);
+    CHECK(bytes->size(bytes) == 5);
+    CHECK(memcmp(bytes->data(bytes), "abc\0\0", 6) == 0);
+
+    // nothing moves while appending within a reservation
+    CHECK(bytes_reserve(bytes, 1000));
+    CHECK(bytes_capacity(bytes) == 1000);
+    CHECK(bytes->size(bytes) == 5);
+    data = bytes->data(bytes);
+    for (i = 5; i < 1000; i++)
+    {
+        bytes->append(bytes, "y", 1);
+    }
+    CHECK(bytes->data(bytes) == data);
+    CHECK(bytes_reserve(bytes, 10));
+    CHECK(bytes_capacity(bytes) == 1000);
+
+    // sizes whose storage cannot be represented are refused untouched
+    CHECK(!bytes_reserve(bytes, SIZE_MAX - 8));
+    CHECK(!bytes_reserve(bytes, SIZE_MAX));
+    bytes->resize(bytes, SIZE_MAX - 8);
+    bytes->append(bytes, "z", SIZE_MAX);
+    CHECK(bytes->size(bytes) == 1000);
+    CHECK(bytes_capacity(bytes) == 1000);
+    CHECK(bytes->data(bytes) == data);
+
+    bytes->resize(bytes, 40);
+    bytes_shrink_to_fit(bytes);
+    CHECK(bytes_capacity(bytes) == 40);
+
+    bytes->clear(bytes);
+    CHECK(bytes_capacity(bytes) < 40);
+    CHECK(strcmp(bytes->cstr(bytes), "") == 0);
+    bytes->destroy(bytes);
+TEST_END
+
+TEST_BEGIN("appendf")
+    bytes_t * bytes = bytes_pub.create("id=", 3);
+    size_t i, capacity;
+
+    CHECK(bytes_appendf(bytes, "%d", 42) == 2);
+    CHECK(strcmp(bytes->cstr(bytes), "id=42") == 0);
+
+    CHECK(bytes_appendf(bytes, " name=%s", "fox") == 9);
+    CHECK(strcmp(bytes->cstr(bytes), "id=42 name=fox") == 0);
+    CHECK(bytes->size(bytes) == 14);
+
+    // long output spills past the inline buffer intact
+    for (i = 0; i < 100; i++)
+    {
+        CHECK(bytes_appendf(bytes, ",%03zu", i) == 4);
+    }
+    CHECK(bytes->size(bytes) == 414);
+    CHECK(strncmp(bytes->cstr(bytes), "id=42 name=fox,000,001", 22) == 0);
+    CHECK(strcmp(bytes->cstr(bytes) + 410, ",099") == 0);
+
+    // format replaces, and neither call gives capacity back
+    capacity = bytes_capacity(bytes);
+    CHECK(bytes->format(bytes, "%s", "x") == 1);
+    CHECK(strcmp(bytes->cstr(bytes), "x") == 0);
+    CHECK(bytes_capacity(bytes) == capacity);
+    CHECK(bytes_appendf(bytes, "%s", "") == 0);
+    CHECK(strcmp(bytes->cstr(bytes), "x") == 0);
+
+    bytes->destroy(bytes);
+TEST_END
+
+TEST_BEGIN("numbers")
+    bytes_t * bytes = bytes_pub.create("n=", 2);
+    uint64_t value = 0;
+    double real = 0.0;
+    size_t used;
+
+    bytes_append_u64(bytes, 18446744073709551615ULL);
+    bytes->append(bytes, " ", 1);
+    bytes_append_i64(bytes, -42);
+    bytes->append(bytes, " 0x", 3);
+    bytes_append_hex(bytes, 0xCAFE, 8);
+    bytes->append(bytes, " ", 1);
+    bytes_append_double(bytes, 0.1);
+    CHECK(strcmp(bytes->cstr(bytes),
+                 "n=18446744073709551615 -42 0x0000CAFE 0.1") == 0);
+
+    CHECK(bytes_parse_u64(bytes, 2, &value) == 20);
+    CHECK(value == 18446744073709551615ULL);
+    CHECK(bytes_parse_u64(bytes, 0, &value) == 0);
+
+    used = bytes_parse_double(bytes, 23, &real);
+    CHECK(used == 3 && real == -42.0);
+    used = bytes_parse_double(bytes, bytes->size(bytes) - 3, &real);
+    CHECK(used == 3 && real == 0.1);
+    CHECK(bytes_parse_double(bytes, bytes->size(bytes), &real) == 0);
+
+    bytes->destroy(bytes);
+TEST_END
+
+TEST_BEGIN("small")
+    const char * str = "The quick brown fox jumped over the lazy dog.";
+    bytes_t * bytes = bytes_pub.create("short", 5);
+    const uint8_t * data = bytes->data(bytes);
+    size_t i;
+
+    // short contents live inside the object itself
+    CHECK((uintptr_t) data > (uintptr_t) bytes->priv);
+    CHECK((uintptr_t) data < (uintptr_t) bytes->priv + 128);
+
+    // and spill to the heap transparently as they grow
+    bytes->assign(bytes, str, strlen(str));
+    CHECK(bytes->data(bytes) != data);
+    CHECK(strcmp(bytes->cstr(bytes), str) == 0);
+
+    for (i = 0; i < 100; i++)
+    {
+        bytes->append(bytes, str, strlen(str));
+    }
+    CHECK(bytes->size(bytes) == 101 * strlen(str));
+    CHECK(memcmp(bytes->data(bytes) + 100 * strlen(str), str,
+                 strlen(str)) == 0);
+
+    bytes->resize(bytes, 5);
+    bytes_shrink_to_fit(bytes);
+    CHECK(bytes->data(bytes) == data);
+    CHECK(strcmp(bytes->cstr(bytes), "The q") == 0);
+
+    bytes->destroy(bytes);
+TEST_END
+
+TEST_BEGIN("format/capacity")
+    bytes_t * bytes = bytes_pub.create(NULL, 0);
+    size_t capacity;
+
+    CHECK(bytes->format(bytes, "%s-%d", "abc", 12345) == 9);
+    CHECK(strcmp(bytes->cstr(bytes), "abc-12345") == 0);
+    CHECK(bytes->size(bytes) == 9);
+
+    CHECK(bytes->format(bytes, "%040d", 12345) == 40);
+    CHECK(bytes->size(bytes) == 40);
+    CHECK(bytes_capacity(bytes) >= 40);
+    capacity = bytes_capacity(bytes);
+
+    // a shorter result reuses the buffer
+    CHECK(bytes->format(bytes, "%d", 7) == 1);
+    CHECK(strcmp(bytes->cstr(bytes), "7") == 0);
+    CHECK(bytes->size(bytes) == 1);
+    CHECK(bytes_capacity(bytes) == capacity);
+
+    // and one exactly filling it is not truncated
+    CHECK(bytes->format(bytes, "%0*d", (int) capacity, 1) ==
+          (ssize_t) capacity);
+    CHECK(bytes->cstr(bytes)[capacity - 1] == '1');
+    CHECK(bytes->size(bytes) == capacity);
+    CHECK(bytes_capacity(bytes) == capacity);
+
+    bytes->destroy(bytes);
+TEST_END
+
+TEST_BEGIN("hexdump/layout")
+    bytes_t * bytes = bytes_pub.create("The quick brown fox", 19);
+    char expect[256];
+
+    snprintf(expect, sizeof(expect), "%s%s%-50s%s",
+             "0000  54 68 65 20 71 75 69 63  6B 20 62 72 6F 77 6E 20  ",
+             "The quick brown \n0010  ", "66 6F 78", "fox\n");
+    CHECK(strcmp(bytes->hexdump(bytes), expect) == 0);
+
+    // a sub-range keeps its offsets
+    snprintf(expect, sizeof(expect), "0010  %-50s%s", "66 6F 78", "fox\n");
+    CHECK(strcmp(bytes_hexdump_range(bytes, 16, SIZE_MAX), expect) == 0);
+    snprintf(expect, sizeof(expect), "0001  %-50s%s", "68 65", "he\n");
+    CHECK(strcmp(bytes_hexdump_range(bytes, 1, 3), expect) == 0);
+    CHECK(strcmp(bytes_hexdump_range(bytes, 30, 40), "") == 0);
+
+    // unprintable bytes, with a line of exactly 8
+    bytes->assign(bytes, "\x00\x1F\x7F\x80\xFF ~A", 8);
+    snprintf(expect, sizeof(expect), "0000  %-50s%s",
+             "00 1F 7F 80 FF 20 7E 41", ".....\x20~A\n");
+    CHECK(strcmp(bytes->hexdump(bytes), expect) == 0);
+
+    bytes->clear(bytes);
+    CHECK(strcmp(bytes->hexdump(bytes), "") == 0);
+    bytes->destroy(bytes);
+TEST_END
+
+TEST_BEGIN("hexdump/large")
+    bytes_t * bytes = bytes_pub.create(NULL, 0x10010);
+    const char * dump = NULL;
+    char * text = NULL;
+    FILE * stream = NULL;
+    size_t length;
+
+    prng_seed(0xDEADBEEFCAFEBABEULL);
+    prng_fill((uint8_t *) bytes->data(bytes), bytes->size(bytes));
+
+    dump = bytes->hexdump(bytes);
+    length = strlen(dump);
+    CHECK(length == 0x1000 * 73 + 75);
+    CHECK(strncmp(dump + 0x1000 * 73, "010000  ", 8) == 0);
+
+    // streamed output is identical, across many chunks
+    stream = tmpfile();
+    CHECK(stream != NULL);
+    CHECK(bytes_hexdump_file(bytes, 0, SIZE_MAX, stream) ==
+          (ssize_t) length);
+    rewind(stream);
+    text = (char *) malloc(length + 1);
+    CHECK(fread(text, 1, length + 1, stream) == length);
+    CHECK(memcmp(text, dump, length) == 0);
+    fclose(stream);
+
+    stream = tmpfile();
+    CHECK(bytes_hexdump_fd(bytes, 16, 48, fileno(stream)) == 2 * 73);
+    rewind(stream);
+    CHECK(fread(text, 1, length, stream) == 2 * 73);
+    CHECK(memcmp(text, dump + 73, 2 * 73) == 0);
+    fclose(stream);
+
+    free(text);
+    bytes->destroy(bytes);
+TEST_END
+
+TEST_BEGIN("codec")
+    bytes_t * data = bytes_pub.create("\x00\xffhello", 7);
+    bytes_t * text = bytes_pub.create("hex:", 4);
+    bytes_t * back = bytes_pub.create(NULL, 0);
+
+    // encoding appends to whatever is there
+    CHECK(bytes_to_hex(data, text));
+    CHECK(strcmp(text->cstr(text), "hex:00ff68656c6c6f") == 0);
+    CHECK(bytes_to_hex(data, data) == false);
+
+    text->assign(text, "00ff68656c6c6f", 14);
+    CHECK(bytes_from_hex(text, back));
+    CHECK(back->size(back) == 7);
+    CHECK(memcmp(back->data(back), "\x00\xffhello", 7) == 0);
+
+    // bad text leaves the output alone
+    text->assign(text, "00fg", 4);
+    CHECK(bytes_from_hex(text, back) == false);
+    CHECK(back->size(back) == 7);
+    CHECK(back->cstr(back)[7] == '\0');
+
+    text->clear(text);
+    CHECK(bytes_to_base64(data, text, CODEC_BASE64));
+    CHECK(strcmp(text->cstr(text), "AP9oZWxsbw==") == 0);
+    text->clear(text);
+    CHECK(bytes_to_base64(data, text, CODEC_BASE64_URL));
+    CHECK(strcmp(text->cstr(text), "AP9oZWxsbw") == 0);
+
+    back->clear(back);
+    CHECK(bytes_from_base64(text, back, CODEC_BASE64_URL));
+    CHECK(back->size(back) == 7);
+    CHECK(memcmp(back->data(back), "\x00\xffhello", 7) == 0);
+    CHECK(bytes_from_base64(text, back, CODEC_BASE64_URL));
+    CHECK(back->size(back) == 14);
+
+    text->assign(text, "AP9o!WxsbQ", 10);
+    CHECK(bytes_from_base64(text, back, CODEC_BASE64) == false);
+    CHECK(back->size(back) == 14);
+
+    data->destroy(data);
+    text->destroy(text);
+    back->destroy(back);
+TEST_END
+
+TEST_BEGIN("search")
+    bytes_t * bytes = bytes_pub.create("key=1\0key=22\0key=333\0", 21);
+
+    // strstr() on cstr() would stop at the first NUL
+    CHECK(bytes_find(bytes, 0, "key=333", 7) == 13);
+    CHECK(bytes_find(bytes, 1, "key=", 4) == 6);
+    CHECK(bytes_find(bytes, 21, "key=", 4) == SEARCH_NONE);
+    CHECK(bytes_find(bytes, 99, "key=", 4) == SEARCH_NONE);
+    CHECK(bytes_rfind(bytes, SIZE_MAX, "key=", 4) == 13);
+    CHECK(bytes_rfind(bytes, 12, "key=", 4) == 6);
+    CHECK(bytes_rfind(bytes, 5, "key=", 4) == 0);
+    CHECK(bytes_rfind(bytes, 5, "=22", 3) == SEARCH_NONE);
+
+    CHECK(bytes_find_byte(bytes, 0, '\0') == 5);
+    CHECK(bytes_find_byte(bytes, 6, '\0') == 12);
+    CHECK(bytes_find_byte(bytes, 21, '\0') == SEARCH_NONE);
+    CHECK(bytes_find_any_of(bytes, 0, "23", 2) == 10);
+    CHECK(bytes_find_any_of(bytes, 12, "23", 2) == 17);
+
+    CHECK(bytes_count(bytes, 0, "key=", 4) == 3);
+    CHECK(bytes_count(bytes, 1, "key=", 4) == 2);
+    CHECK(bytes_count(bytes, 0, "\0", 1) == 3);
+
+    bytes->destroy(bytes);
+TEST_END
+
+TEST_BEGIN("copy/shared")
+    char text[100];
+    bytes_t * bytes = NULL;
+    bytes_t * copy = NULL;
+    bytes_t * again = NULL;
+
+    memset(text, 'x', sizeof(text));
+    bytes = bytes_pub.create(text, sizeof(text));
+
+    // storage is shared until one side writes
+    copy = bytes->copy(bytes);
+    CHECK(copy != NULL);
+    CHECK(copy->data(copy) == bytes->data(bytes));
+    CHECK(copy->size(copy) == 100);
+    again = copy->copy(copy);
+    CHECK(again->data(again) == bytes->data(bytes));
+
+    copy->append(copy, "yz", 2);
+    CHECK(copy->data(copy) != bytes->data(bytes));
+    CHECK(copy->size(copy) == 102);
+    CHECK(strcmp(copy->cstr(copy) + 100, "yz") == 0);
+    CHECK(bytes->size(bytes) == 100);
+    CHECK(bytes->cstr(bytes)[100] == 0);
+    CHECK(again->data(again) == bytes->data(bytes));
+
+    // every kind of write separates the writer, and leaves the others
+    bytes->assign(bytes, text, 100);
+    CHECK(bytes->data(bytes) != again->data(again));
+    again->destroy(again);
+    again = bytes->copy(bytes);
+    bytes->format(bytes, "%s", "short");
+    CHECK(strcmp(bytes->cstr(bytes), "short") == 0);
+    CHECK(again->size(again) == 100);
+    CHECK(memcmp(again->data(again), text, 100) == 0);
+    bytes->destroy(bytes);
+
+    // the last one left writes in place
+    const uint8_t * data = again->data(again);
+    again->resize(again, 50);
+    CHECK(again->data(again) == data);
+
+    // inline contents are copied
+    bytes = bytes_pub.create("small", 5);
+    copy->destroy(copy);
+    copy = bytes->copy(bytes);
+    CHECK(copy->data(copy) != bytes->data(bytes));
+    CHECK(strcmp(copy->cstr(copy), "small") == 0);
+
+    copy->destroy(copy);
+    again->destroy(again);
+    bytes->destroy(bytes);
+TEST_END
+
+TEST_BEGIN("split/shared")
+    const char * text = "The quick brown fox jumps over the lazy dog, "
+                        "and then sits down for a rest in the sun.";
+    bytes_t * bytes = bytes_pub.create(text, strlen(text));
+    bytes_t * seg = NULL;
+    bytes_t * tail = NULL;
+
+    // a long segment shares the storage, part way in
+    seg = bytes->split(bytes, 4, 44);
+    CHECK(seg != NULL);
+    CHECK(seg->size(seg) == 40);
+    CHECK(seg->data(seg) == bytes->data(bytes) + 4);
+    CHECK(bytes_find(seg, 0, "fox", 3) == 12);
+
+    // it only takes a copy for cstr() since the data goes on past it
+    CHECK(strcmp(seg->cstr(seg),
+                 "quick brown fox jumps over the lazy dog,") == 0);
+    CHECK(seg->data(seg) != bytes->data(bytes) + 4);
+
+    // the tail is already terminated
+    tail = bytes->split(bytes, 10, SIZE_MAX);
+    CHECK(tail->data(tail) == bytes->data(bytes) + 10);
+    CHECK(strcmp(tail->cstr(tail), text + 10) == 0);
+    CHECK(tail->data(tail) == bytes->data(bytes) + 10);
+
+    // outliving the original, and writing
+    bytes->destroy(bytes);
+    tail->append(tail, "!", 1);
+    CHECK(tail->size(tail) == strlen(text) - 9);
+    CHECK(strncmp(tail->cstr(tail), text + 10, strlen(text) - 10) == 0);
+    tail->destroy(tail);
+    seg->destroy(seg);
+
+    // short segments are copied inline, and bad ranges refused
+    bytes = bytes_pub.create(text, strlen(text));
+    seg = bytes->split(bytes, 4, 9);
+    CHECK(strcmp(seg->cstr(seg), "quick") == 0);
+    CHECK(seg->data(seg) != bytes->data(bytes) + 4);
+    CHECK(bytes->split(bytes, 200, 300) == NULL);
+    CHECK(bytes->split(bytes, 9, 4) == NULL);
+
+    seg->destroy(seg);
+    bytes->destroy(bytes);
+TEST_END
+
+TEST_BEGIN("copy/threads")
+    bytes_t * bytes = bytes_pub.create(NULL, 4096);
+    pthread_t threads[THREADS];
+    void * errors = NULL;
+    size_t i;
+
+    prng_seed(0xC0FFEE);
+    prng_fill((uint8_t *) bytes->data(bytes), bytes->size(bytes));
+
+    for (i = 0; i < THREADS; i++)
+    {
+        CHECK(pthread_create(&threads[i], NULL, copier, bytes) == 0);
+    }
+
+    for (i = 0; i < THREADS; i++)
+    {
+        pthread_join(threads[i], &errors);
+        CHECK(errors == NULL);
+    }
+
+    bytes->destroy(bytes);
+TEST_END
+
 TEST_BEGIN("read")
     const char * str = "abc123";
     size_t len = strlen(str);
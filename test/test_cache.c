@@ -0,0 +1,252 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "cache.h"
+#include "bytes.h"
+#include "mut.h"
+#include "fixture.h"
+
+#include <string.h>
+
+// Weigh integer payloads by their own value
+static size_t weigh_value(const void * data)
+{
+    return (size_t) (uintptr_t) data;
+}
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_cache.log");
+    BLAMMO(INFO, "cache tests...");
+
+    (void) fixture_report;
+
+TEST_BEGIN("create")
+    cache_t * cache = cache_pub.create(NULL, CACHE_LRU, 4, NULL);
+    cache_stats_t stats;
+
+    CHECK(cache != NULL);
+    CHECK(cache->priv != NULL);
+    CHECK(cache->empty(cache));
+    CHECK(cache->length(cache) == 0);
+    CHECK(cache->weight(cache) == 0);
+    CHECK(cache->capacity(cache) == 4);
+    CHECK(cache->get_u64(cache, 1) == NULL);
+    CHECK(!cache->erase_u64(cache, 1));
+
+    cache->stats(cache, &stats);
+    CHECK(stats.misses == 1);
+    CHECK(stats.hits == 0);
+    cache->destroy(cache);
+
+    // zero capacity is refused
+    CHECK(cache_pub.create(NULL, CACHE_LRU, 0, NULL) == NULL);
+TEST_END
+
+TEST_BEGIN("LRU eviction")
+    cache_t * cache = cache_pub.create(payload_destroy, CACHE_LRU, 3, NULL);
+    cache_stats_t stats;
+    int i;
+
+    fixture_reset();
+
+    for (i = 0; i < 5; i++)
+    {
+        payload_create(i);
+    }
+
+    CHECK(cache->put_u64(cache, 0, fixture_payload(0)));
+    CHECK(cache->put_u64(cache, 1, fixture_payload(1)));
+    CHECK(cache->put_u64(cache, 2, fixture_payload(2)));
+
+    // touch 0 so that 1 is now least recently used
+    CHECK(cache->get_u64(cache, 0) == fixture_payload(0));
+    CHECK(cache->put_u64(cache, 3, fixture_payload(3)));
+
+    CHECK(cache->length(cache) == 3);
+    CHECK(fixture_payload(1)->is_destroyed);
+    CHECK(cache->get_u64(cache, 1) == NULL);
+    CHECK(cache->get_u64(cache, 0) == fixture_payload(0));
+
+    // peek does not refresh 2, so it goes next
+    CHECK(cache->peek(cache, &(uint64_t){2}, sizeof(uint64_t)) ==
+          fixture_payload(2));
+    CHECK(cache->put_u64(cache, 4, fixture_payload(4)));
+    CHECK(fixture_payload(2)->is_destroyed);
+    CHECK(!fixture_payload(3)->is_destroyed);
+
+    cache->stats(cache, &stats);
+    CHECK(stats.hits == 2);
+    CHECK(stats.misses == 1);
+    CHECK(stats.inserts == 5);
+    CHECK(stats.evictions == 2);
+
+    cache->reset_stats(cache);
+    cache->stats(cache, &stats);
+    CHECK(stats.hits + stats.misses + stats.inserts + stats.evictions == 0);
+
+    cache->destroy(cache);
+    CHECK(fixture_payload(0)->is_destroyed);
+    CHECK(fixture_payload(3)->is_destroyed);
+    CHECK(fixture_payload(4)->is_destroyed);
+TEST_END
+
+TEST_BEGIN("CLOCK and SIEVE eviction")
+    cache_policy_t policy;
+    uint64_t key;
+
+    for (policy = CACHE_CLOCK; policy <= CACHE_SIEVE; policy++)
+    {
+        cache_t * cache = cache_pub.create(NULL, policy, 4, NULL);
+
+        for (key = 1; key <= 4; key++)
+        {
+            CHECK(cache->put_u64(cache, key, (void *) (uintptr_t) key));
+        }
+
+        // keys 1 and 3 are used, so 2 and then 4 are evicted first
+        CHECK(cache->get_u64(cache, 1) == (void *) 1);
+        CHECK(cache->get_u64(cache, 3) == (void *) 3);
+
+        CHECK(cache->put_u64(cache, 5, (void *) 5));
+        CHECK(cache->peek(cache, &(uint64_t){2}, sizeof(uint64_t)) == NULL);
+        CHECK(cache->put_u64(cache, 6, (void *) 6));
+        CHECK(cache->peek(cache, &(uint64_t){4}, sizeof(uint64_t)) == NULL);
+
+        CHECK(cache->length(cache) == 4);
+        CHECK(cache->get_u64(cache, 1) == (void *) 1);
+        CHECK(cache->get_u64(cache, 3) == (void *) 3);
+        CHECK(cache->get_u64(cache, 5) == (void *) 5);
+        CHECK(cache->get_u64(cache, 6) == (void *) 6);
+
+        // A long run of one-hit keys.  CLOCK cycles everything out, but
+        // SIEVE keeps the older entries behind its hand and only churns
+        // through the new arrivals.
+        for (key = 100; key < 1000; key++)
+        {
+            CHECK(cache->put_u64(cache, key, (void *) (uintptr_t) key));
+            CHECK(cache->length(cache) <= 4);
+        }
+
+        CHECK(cache->get_u64(cache, 999) == (void *) 999);
+        if (policy == CACHE_CLOCK)
+        {
+            CHECK(cache->get_u64(cache, 1) == NULL);
+        }
+        else
+        {
+            CHECK(cache->get_u64(cache, 1) == (void *) 1);
+            CHECK(cache->get_u64(cache, 3) == (void *) 3);
+        }
+        cache->destroy(cache);
+    }
+TEST_END
+
+TEST_BEGIN("replace and erase")
+    cache_t * cache = cache_pub.create(payload_destroy, CACHE_SIEVE, 8, NULL);
+    const char * key = "a key longer than eight bytes";
+    int i;
+
+    fixture_reset();
+
+    for (i = 0; i < 3; i++)
+    {
+        payload_create(i);
+    }
+
+    CHECK(cache->put(cache, key, strlen(key), fixture_payload(0)));
+    CHECK(cache->put(cache, "k", 1, fixture_payload(1)));
+    CHECK(cache->put(cache, key, strlen(key), fixture_payload(2)));
+
+    CHECK(cache->length(cache) == 2);
+    CHECK(fixture_payload(0)->is_destroyed);
+    CHECK(cache->get(cache, key, strlen(key)) == fixture_payload(2));
+
+    CHECK(cache->erase(cache, "k", 1));
+    CHECK(fixture_payload(1)->is_destroyed);
+    CHECK(!cache->erase(cache, "k", 1));
+    CHECK(cache->length(cache) == 1);
+
+    cache->clear(cache);
+    CHECK(cache->empty(cache));
+    CHECK(fixture_payload(2)->is_destroyed);
+    cache->destroy(cache);
+TEST_END
+
+TEST_BEGIN("weighted capacity")
+    cache_t * cache = cache_pub.create(NULL, CACHE_LRU, 100, weigh_value);
+    uint64_t key;
+
+    for (key = 1; key <= 4; key++)
+    {
+        CHECK(cache->put_u64(cache, key, (void *) 20));
+    }
+
+    CHECK(cache->weight(cache) == 80);
+
+    // 50 more needs two of the oldest to go
+    CHECK(cache->put_u64(cache, 5, (void *) 50));
+    CHECK(cache->length(cache) == 3);
+    CHECK(cache->weight(cache) == 90);
+    CHECK(cache->get_u64(cache, 2) == NULL);
+    CHECK(cache->get_u64(cache, 3) == (void *) 20);
+
+    // growing an entry in place evicts others but never itself
+    CHECK(cache->put_u64(cache, 3, (void *) 90));
+    CHECK(cache->length(cache) == 1);
+    CHECK(cache->weight(cache) == 90);
+    CHECK(cache->get_u64(cache, 3) == (void *) 90);
+
+    // too heavy to ever fit
+    CHECK(!cache->put_u64(cache, 6, (void *) 101));
+    CHECK(cache->length(cache) == 1);
+
+    // shrinking evicts down to the new capacity
+    CHECK(cache->resize(cache, 50) == 1);
+    CHECK(cache->empty(cache));
+    CHECK(cache->weight(cache) == 0);
+    cache->destroy(cache);
+TEST_END
+
+TEST_BEGIN("bytes payloads")
+    cache_t * cache = cache_pub.create(bytes_pub.destroy, CACHE_CLOCK, 16,
+                                       cache_weigh_bytes);
+    bytes_t * bytes = NULL;
+    uint64_t key;
+
+    for (key = 0; key < 10; key++)
+    {
+        bytes = bytes_pub.create("abcd", 4);
+        CHECK(cache->put_u64(cache, key, bytes));
+        CHECK(cache->weight(cache) <= 16);
+    }
+
+    CHECK(cache->length(cache) == 4);
+    CHECK(cache->weight(cache) == 16);
+    CHECK(cache->get_u64(cache, 9) == bytes);
+    cache->destroy(cache);
+TEST_END
+
+TESTSUITE_END
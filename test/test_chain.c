@@ -29,6 +29,16 @@
 #include <string.h>
 #include <limits.h>
 
+#ifdef CHAIN_STATS_ENABLE
+// Compare pointer values directly, qsort() style
+static int compare_value(const void * a, const void * b)
+{
+    uintptr_t aval = (uintptr_t) *(void **) a;
+    uintptr_t bval = (uintptr_t) *(void **) b;
+    return (aval > bval) - (aval < bval);
+}
+#endif
+
 TESTSUITE_BEGIN
 
     // Simple test of the blammo logger
@@ -42,7 +52,7 @@ TESTSUITE_BEGIN
     (void) fixture_payload;
 
 TEST_BEGIN("create")
-    chain_t * chain = chain_create(NULL);
+    chain_t * chain = chain_pub.create(NULL);
     CHECK(chain != NULL);
     CHECK(chain->priv != NULL);
     CHECK(chain->empty(chain));
@@ -53,7 +63,7 @@ TEST_END
 
 TEST_BEGIN("insert (heap primitive)")
     int i;
-    chain_t * chain = chain_create(free);
+    chain_t * chain = chain_pub.create(free);
     CHECK(chain != NULL);
     CHECK(chain->priv != NULL);
     CHECK(chain->length(chain) == 0);
@@ -86,7 +96,7 @@ TEST_END
 
 TEST_BEGIN("insert (pointer value / static primitive)")
     size_t i;
-    chain_t * chain = chain_create(NULL);
+    chain_t * chain = chain_pub.create(NULL);
     CHECK(chain != NULL);
     CHECK(chain->length(chain) == 0);
 
@@ -116,7 +126,7 @@ TEST_BEGIN("insert (pointer value / static primitive)")
 TEST_END
 
 TEST_BEGIN("reset")
-    chain_t * chain = chain_create(NULL);
+    chain_t * chain = chain_pub.create(NULL);
     chain->insert(chain, (void *) 1);
     chain->insert(chain, (void *) 2);
     chain->insert(chain, (void *) 3);
@@ -133,7 +143,7 @@ TEST_BEGIN("reset")
 TEST_END
 
 TEST_BEGIN("seek (forward/rewind)")
-    chain_t * chain = chain_create(NULL);
+    chain_t * chain = chain_pub.create(NULL);
     chain->insert(chain, (void *) 1);
     chain->insert(chain, (void *) 2);
     chain->insert(chain, (void *) 3);
@@ -164,7 +174,7 @@ TEST_BEGIN("seek (forward/rewind)")
 TEST_END
 
 TEST_BEGIN("remove")
-    chain_t * chain = chain_create(NULL);
+    chain_t * chain = chain_pub.create(NULL);
 
     // Attempting to remove from empty chain
     chain->remove(chain);
@@ -190,7 +200,7 @@ TEST_BEGIN("remove")
 TEST_END
 
 TEST_BEGIN("clear")
-    chain_t * chain = chain_create(NULL);
+    chain_t * chain = chain_pub.create(NULL);
     chain->insert(chain, (void *) 1);
     chain->insert(chain, (void *) 2);
     chain->insert(chain, (void *) 3);
@@ -214,7 +224,7 @@ TEST_BEGIN("clear")
 TEST_END
 
 TEST_BEGIN("trim")
-    chain_t * chain = chain_create(NULL);
+    chain_t * chain = chain_pub.create(NULL);
     CHECK(chain != NULL);
     CHECK(chain->length(chain) == 0);
 
@@ -248,7 +258,7 @@ TEST_BEGIN("sort")
     int i = 0;
     const size_t ids[] =        { 11, 77, 97, 22, 88, 99, 33, 55, 44, 66 };
     const size_t ids_sorted[] = { 11, 22, 33, 44, 55, 66, 77, 88, 97, 99 };
-    chain_t * chain = chain_create(payload_destroy);
+    chain_t * chain = chain_pub.create(payload_destroy);
 
     fixture_reset();
     //fixture_report();
@@ -277,7 +287,7 @@ TEST_END
 TEST_BEGIN("destroy")
     int i = 0;
     payload_t * p = NULL;
-    chain_t * chain = chain_create(payload_destroy);
+    chain_t * chain = chain_pub.create(payload_destroy);
 
     fixture_reset();
 
@@ -303,7 +313,7 @@ TEST_END
 TEST_BEGIN("copy")
     int i = 0;
     payload_t * p = NULL;
-    chain_t * chain = chain_create(payload_destroy);
+    chain_t * chain = chain_pub.create(payload_destroy);
 
     fixture_reset();
 
@@ -353,7 +363,7 @@ TEST_END
 
 TEST_BEGIN("split")
     size_t i;
-    chain_t * chain = chain_create(NULL);
+    chain_t * chain = chain_pub.create(NULL);
     CHECK(chain != NULL);
     CHECK(chain->length(chain) == 0);
 
@@ -393,8 +403,8 @@ TEST_END
 
 TEST_BEGIN("join")
     size_t i;
-    chain_t * achain = chain_create(NULL);
-    chain_t * bchain = chain_create(NULL);
+    chain_t * achain = chain_pub.create(NULL);
+    chain_t * bchain = chain_pub.create(NULL);
     CHECK(achain != NULL);
     CHECK(bchain != NULL);
     CHECK(achain->length(achain) == 0);
@@ -450,4 +460,258 @@ TEST_BEGIN("join")
     achain->destroy(achain);
 TEST_END
 
+TEST_BEGIN("compact insert/spin/remove")
+    size_t i;
+    chain_t * chain = chain_compact_pub.create(NULL);
+    CHECK(chain != NULL);
+    CHECK(chain->priv != NULL);
+    CHECK(chain->empty(chain));
+    CHECK(chain->origin(chain));
+    CHECK(chain->length(chain) == 0);
+
+    // enough links to force the arena to grow a few times
+    for (i = 1; i <= 100; i++)
+    {
+        chain->insert(chain, (void *) i);
+        CHECK(chain->length(chain) == i);
+        CHECK(chain->data(chain) == (void *) i);
+    }
+
+    chain->reset(chain);
+    CHECK(chain->origin(chain));
+    CHECK(chain->data(chain) == (void *) 1);
+
+    chain->spin(chain, 2);
+    CHECK(chain->data(chain) == (void *) 3);
+    chain->spin(chain, -3);
+    CHECK(chain->data(chain) == (void *) 100);
+    chain->spin(chain, 201);
+    CHECK(chain->origin(chain));
+
+    // removing the origin re-designates the next link as origin
+    chain->remove(chain);
+    CHECK(chain->length(chain) == 99);
+    CHECK(chain->data(chain) == (void *) 100);
+    chain->reset(chain);
+    CHECK(chain->data(chain) == (void *) 2);
+
+    // freed slots are reused
+    chain->insert(chain, (void *) 1000);
+    CHECK(chain->length(chain) == 100);
+    chain->spin(chain, -1);
+    CHECK(chain->data(chain) == (void *) 2);
+    chain->spin(chain, 2);
+    CHECK(chain->data(chain) == (void *) 3);
+
+    chain->clear(chain);
+    CHECK(chain->empty(chain));
+    CHECK(chain->length(chain) == 0);
+    chain->destroy(chain);
+TEST_END
+
+TEST_BEGIN("compact trim/sort/destroy")
+    int i = 0;
+    const size_t ids[] =        { 11, 77, 97, 22, 88, 99, 33, 55, 44, 66 };
+    const size_t ids_sorted[] = { 11, 22, 33, 44, 55, 66, 77, 88, 97, 99 };
+    chain_t * chain = chain_compact_pub.create(payload_destroy);
+    payload_t * p = NULL;
+
+    fixture_reset();
+
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        chain->insert(chain, NULL);
+        chain->insert(chain, payload_create(ids[i]));
+    }
+    chain->insert(chain, NULL);
+
+    CHECK(chain->trim(chain) == FIXTURE_PAYLOADS + 1);
+    CHECK(chain->length(chain) == FIXTURE_PAYLOADS);
+
+    chain->sort(chain, payload_compare);
+    chain->reset(chain);
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        p = (payload_t *) chain->data(chain);
+        CHECK(p->id == ids_sorted[i]);
+        CHECK(p->is_destroyed == false);
+        chain->spin(chain, 1);
+    }
+
+    chain->destroy(chain);
+
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        CHECK(fixture_payload(i)->is_destroyed == true);
+    }
+TEST_END
+
+TEST_BEGIN("compact copy/split/join")
+    size_t i;
+    chain_t * chain = chain_compact_pub.create(NULL);
+    chain_t * other = chain_pub.create(NULL);
+
+    for (i = 1; i <= 7; i++)
+    {
+        chain->insert(chain, (void *) i);
+    }
+
+    chain_t * mycopy = chain->copy(chain, NULL);
+    CHECK(mycopy != NULL);
+    CHECK(mycopy->length(mycopy) == 7);
+    mycopy->reset(mycopy);
+    for (i = 1; i <= 7; i++)
+    {
+        CHECK(mycopy->data(mycopy) == (void *) i);
+        mycopy->spin(mycopy, 1);
+    }
+    mycopy->destroy(mycopy);
+
+    chain_t * segment = chain->split(chain, 4, 7);
+    CHECK(segment != NULL);
+    CHECK(segment->length(segment) == 3);
+    CHECK(chain->length(chain) == 4);
+
+    chain->reset(chain);
+    segment->reset(segment);
+    for (i = 1; i <= 5; i++)
+    {
+        CHECK(chain->data(chain) == (void *)
+            ((i - 1) % chain->length(chain) + 1));
+        CHECK(segment->data(segment) == (void *)
+            ((i - 1) % segment->length(segment) + 5));
+        chain->spin(chain, 1);
+        segment->spin(segment, 1);
+    }
+
+    // out of range segments are refused
+    CHECK(chain->split(chain, 3, 9) == NULL);
+
+    // cannot mix link representations
+    CHECK(!chain->join(chain, other));
+    CHECK(!other->join(other, chain));
+    CHECK(other->empty(other));
+
+    CHECK(chain->join(chain, segment));
+    CHECK(chain->length(chain) == 7);
+    CHECK(segment->empty(segment));
+
+    chain->reset(chain);
+    for (i = 1; i <= 7; i++)
+    {
+        CHECK(chain->data(chain) == (void *) i);
+        chain->spin(chain, 1);
+    }
+
+    // joining into an empty head takes the tail wholesale
+    CHECK(segment->join(segment, chain));
+    CHECK(segment->length(segment) == 7);
+    CHECK(chain->empty(chain));
+    CHECK(segment->data(segment) == (void *) 1);
+
+    chain->destroy(chain);
+    segment->destroy(segment);
+    other->destroy(other);
+TEST_END
+
+TEST_BEGIN("reserve")
+    const chain_t * pubs[] = { &chain_pub, &chain_compact_pub,
+                               &chain_vector_pub };
+    size_t i, n;
+
+    for (n = 0; n < 3; n++)
+    {
+        chain_t * chain = pubs[n]->create(NULL);
+
+        CHECK(chain->reserve(chain, 1000));
+        CHECK(chain->empty(chain));
+
+        for (i = 1; i <= 1000; i++)
+        {
+            chain->insert(chain, (void *) i);
+        }
+
+        CHECK(chain->length(chain) == 1000);
+        CHECK(chain->reserve(chain, 0));
+
+        // the linked chain reserves nothing, but the others must refuse
+        // counts that would wrap past what they can hold
+        CHECK(0 == n || !chain->reserve(chain, SIZE_MAX));
+        CHECK(chain->length(chain) == 1000);
+        chain->destroy(chain);
+    }
+TEST_END
+
+#ifdef CHAIN_STATS_ENABLE
+TEST_BEGIN("stats")
+    const chain_t * pubs[] = { &chain_pub, &chain_compact_pub,
+                               &chain_vector_pub };
+    chain_stats_t before, after, stats;
+    size_t i, n;
+
+    for (n = 0; n < 3; n++)
+    {
+        chain_stats_global(&before);
+        chain_t * chain = pubs[n]->create(NULL);
+
+        for (i = 1; i <= 100; i++)
+        {
+            chain->insert(chain, (void *) i);
+        }
+
+        chain->reset(chain);
+        chain->spin(chain, 10);
+        chain->remove(chain);
+        chain->sort(chain, compare_value);
+
+        chain->stats(chain, &stats);
+        CHECK(stats.links_allocated == 100);
+        CHECK(stats.links_freed == 1);
+        CHECK(stats.peak_length == 100);
+        CHECK(stats.link_bytes >= 99 * 2 * sizeof(uint32_t));
+        CHECK(stats.allocations > 0);
+        CHECK(stats.spins >= 10);
+        CHECK(stats.sorts == 1);
+
+        // a segment takes its share of the memory with it
+        chain_t * seg = chain->split(chain, 0, 50);
+        CHECK(seg != NULL);
+        chain->join(chain, seg);
+        seg->destroy(seg);
+
+        // moving links around allocates no new ones
+        chain->stats(chain, &stats);
+        CHECK(stats.links_allocated == 100);
+        CHECK(chain->length(chain) == 99);
+
+        // an empty tail with nothing allocated has nothing to hand over
+        chain_t * empty = pubs[n]->create(NULL);
+        chain_t * none = pubs[n]->create(NULL);
+        CHECK(empty->join(empty, none));
+        none->stats(none, &stats);
+        CHECK(stats.allocations == 0);
+        CHECK(stats.link_bytes == 0);
+        none->destroy(none);
+        empty->destroy(empty);
+
+        // the others skip whole revolutions, so can take any offset
+        if (n > 0)
+        {
+            chain->spin(chain, INT64_MIN);
+            chain->stats(chain, &stats);
+            CHECK(stats.spins < 200);
+        }
+
+        chain->destroy(chain);
+        chain_stats_global(&after);
+        CHECK(after.links_allocated - before.links_allocated ==
+              after.links_freed - before.links_freed);
+        CHECK(after.link_bytes == before.link_bytes);
+        CHECK(after.allocations == before.allocations);
+        CHECK(after.peak_length >= 100);
+        CHECK(after.sorts == before.sorts + 1);
+    }
+TEST_END
+#endif
+
 TESTSUITE_END
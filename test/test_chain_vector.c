@@ -0,0 +1,354 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "chain.h"
+#include "mut.h"
+#include "fixture.h"
+
+#include <string.h>
+#include <limits.h>
+
+//------------------------------------------------------------------------|
+// Counts live bytes and calls to realloc, checking the sizes handed back
+typedef struct
+{
+    size_t bytes;
+    size_t reallocs;
+}
+tally_t;
+
+static void * tally_alloc(void * context, size_t size)
+{
+    ((tally_t *) context)->bytes += size;
+    return malloc(size);
+}
+
+static void * tally_realloc(void * context, void * ptr, size_t old_size,
+                            size_t size)
+{
+    tally_t * tally = (tally_t *) context;
+    void * fresh = realloc(ptr, size);
+
+    if (fresh)
+    {
+        tally->bytes += size - old_size;
+        tally->reallocs++;
+    }
+
+    return fresh;
+}
+
+static void tally_free(void * context, void * ptr, size_t size)
+{
+    ((tally_t *) context)->bytes -= size;
+    free(ptr);
+}
+
+//------------------------------------------------------------------------|
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_chain_vector.log");
+    BLAMMO(INFO, "vector tests...");
+
+    // because these aren't always used, some warning eaters:
+    (void) fixture_reset;
+    (void) fixture_report;
+    (void) fixture_payload;
+
+TEST_BEGIN("create")
+    chain_t * vector = chain_vector_pub.create(NULL);
+    CHECK(vector != NULL);
+    CHECK(vector->priv != NULL);
+    CHECK(vector->empty(vector));
+    CHECK(vector->origin(vector));
+    CHECK(vector->length(vector) == 0);
+    CHECK(vector->data(vector) == NULL);
+
+    // sizes that cannot be allocated are refused rather than looping
+    CHECK(!vector->reserve(vector, SIZE_MAX));
+    CHECK(!vector->reserve(vector, SIZE_MAX / sizeof(void *) + 1));
+    CHECK(vector->empty(vector));
+    vector->destroy(vector);
+TEST_END
+
+TEST_BEGIN("insert (heap primitive)")
+    int i;
+    chain_t * vector = chain_vector_pub.create(free);
+    CHECK(vector != NULL);
+
+    for (i = 1; i <= 100; i++)
+    {
+        vector->insert(vector, malloc(sizeof(int)));
+        CHECK(!vector->empty(vector));
+        CHECK(vector->length(vector) == i);
+        CHECK(vector->origin(vector) == (i == 1));
+        CHECK(vector->data(vector) != NULL);
+        *(int *)vector->data(vector) = i;
+    }
+
+    CHECK(*(int *)chain_vector_at(vector, 41) == 42);
+    CHECK(chain_vector_at(vector, 100) == NULL);
+    vector->destroy(vector);
+TEST_END
+
+TEST_BEGIN("insert (middle)")
+    chain_t * vector = chain_vector_pub.create(NULL);
+    vector->insert(vector, (void *) 1);
+    vector->insert(vector, (void *) 3);
+    vector->reset(vector);
+    vector->insert(vector, (void *) 2);
+    CHECK(vector->data(vector) == (void *) 2);
+    CHECK(chain_vector_at(vector, 0) == (void *) 1);
+    CHECK(chain_vector_at(vector, 1) == (void *) 2);
+    CHECK(chain_vector_at(vector, 2) == (void *) 3);
+    vector->destroy(vector);
+TEST_END
+
+TEST_BEGIN("seek (forward/rewind)")
+    chain_t * vector = chain_vector_pub.create(NULL);
+    vector->insert(vector, (void *) 1);
+    vector->insert(vector, (void *) 2);
+    vector->insert(vector, (void *) 3);
+    vector->reset(vector);
+
+    CHECK(vector->spin(vector, 2));
+    CHECK(vector->data(vector) == (void *) 3);
+    CHECK(vector->spin(vector, -1));
+    CHECK(vector->data(vector) == (void *) 2);
+
+    // wraps around just like a chain
+    CHECK(!vector->spin(vector, 2));
+    CHECK(vector->origin(vector));
+    CHECK(vector->data(vector) == (void *) 1);
+    vector->spin(vector, -2);
+    CHECK(vector->data(vector) == (void *) 2);
+    vector->spin(vector, -301);
+    CHECK(vector->data(vector) == (void *) 1);
+    vector->destroy(vector);
+TEST_END
+
+TEST_BEGIN("remove")
+    chain_t * vector = chain_vector_pub.create(NULL);
+
+    // Attempting to remove from empty vector
+    vector->remove(vector);
+
+    vector->insert(vector, (void *) 1);
+    vector->insert(vector, (void *) 2);
+    vector->insert(vector, (void *) 3);
+    vector->reset(vector);
+    vector->spin(vector, 1);
+
+    vector->remove(vector);
+    CHECK(vector->data(vector) == (void *) 1);
+    CHECK(vector->length(vector) == 2);
+
+    // removing the origin moves back to the last element
+    vector->remove(vector);
+    CHECK(vector->length(vector) == 1);
+    CHECK(vector->data(vector) == (void *) 3);
+    vector->remove(vector);
+    CHECK(vector->empty(vector));
+    vector->destroy(vector);
+TEST_END
+
+TEST_BEGIN("trim")
+    size_t i;
+    chain_t * vector = chain_vector_pub.create(NULL);
+    CHECK(vector->trim(vector) == 0);
+
+    for (i = 0; i < 102; i++)
+    {
+        vector->insert(vector, (i % 3 == 0) ? (void *) i : NULL);
+    }
+
+    // note that (void *) 0 is also NULL
+    CHECK(vector->trim(vector) == 69);
+    CHECK(vector->length(vector) == 33);
+    vector->spin(vector, 32);
+    CHECK((size_t) vector->data(vector) == 99);
+    vector->destroy(vector);
+TEST_END
+
+TEST_BEGIN("sort/destroy")
+    int i = 0;
+    const size_t ids[] =        { 11, 77, 97, 22, 88, 99, 33, 55, 44, 66 };
+    const size_t ids_sorted[] = { 11, 22, 33, 44, 55, 66, 77, 88, 97, 99 };
+    chain_t * vector = chain_vector_pub.create(payload_destroy);
+    payload_t * p = NULL;
+
+    fixture_reset();
+
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        vector->insert(vector, payload_create(ids[i]));
+    }
+
+    vector->sort(vector, payload_compare);
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        p = (payload_t *) vector->data(vector);
+        CHECK(p->id == ids_sorted[i]);
+        CHECK(p->is_destroyed == false);
+        vector->spin(vector, 1);
+    }
+
+    vector->destroy(vector);
+
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        CHECK(fixture_payload(i)->is_destroyed == true);
+    }
+TEST_END
+
+TEST_BEGIN("copy")
+    int i = 0;
+    chain_t * vector = chain_vector_pub.create(payload_destroy);
+    payload_t * optr, * cptr;
+
+    fixture_reset();
+
+    for (i = 0; i < FIXTURE_PAYLOADS / 2; i++)
+    {
+        vector->insert(vector, payload_create(i * 2));
+    }
+
+    chain_t * mycopy = vector->copy(vector, payload_copy);
+    CHECK(mycopy != NULL);
+    CHECK(mycopy->length(mycopy) == FIXTURE_PAYLOADS / 2);
+
+    for (i = 0; i < FIXTURE_PAYLOADS / 2; i++)
+    {
+        optr = (payload_t *) chain_vector_at(vector, i);
+        cptr = (payload_t *) chain_vector_at(mycopy, i);
+        CHECK(optr != cptr);
+        CHECK(optr->id == cptr->id);
+    }
+
+    vector->destroy(vector);
+    mycopy->destroy(mycopy);
+
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        CHECK(fixture_payload(i)->is_destroyed == true);
+    }
+TEST_END
+
+TEST_BEGIN("split/join")
+    size_t i;
+    chain_t * avector = chain_vector_pub.create(NULL);
+    chain_t * other = chain_vector_pub.create(free);
+
+    for (i = 1; i <= 7; i++)
+    {
+        avector->insert(avector, (void *) i);
+    }
+
+    chain_t * bvector = avector->split(avector, 4, 7);
+    CHECK(bvector != NULL);
+    CHECK(bvector->length(bvector) == 3);
+    CHECK(avector->length(avector) == 4);
+    CHECK(chain_vector_at(bvector, 0) == (void *) 5);
+    CHECK(chain_vector_at(avector, 3) == (void *) 4);
+    CHECK(avector->split(avector, 2, 5) == NULL);
+
+    // dissimilar data types
+    CHECK(!avector->join(avector, other));
+
+    CHECK(avector->join(avector, bvector));
+    CHECK(avector->length(avector) == 7);
+    CHECK(bvector->empty(bvector));
+    for (i = 1; i <= 7; i++)
+    {
+        CHECK(avector->data(avector) == (void *) i);
+        avector->spin(avector, 1);
+    }
+
+    CHECK(bvector->join(bvector, avector));
+    CHECK(bvector->length(bvector) == 7);
+    CHECK(avector->empty(avector));
+
+    // empty segments and copies of an empty vector
+    chain_t * empty = bvector->split(bvector, 7, 7);
+    CHECK(empty != NULL);
+    CHECK(empty->empty(empty));
+    CHECK(bvector->length(bvector) == 7);
+    empty->destroy(empty);
+
+    empty = avector->split(avector, 0, 0);
+    CHECK(empty != NULL);
+    CHECK(empty->empty(empty));
+    empty->destroy(empty);
+
+    empty = avector->copy(avector, NULL);
+    CHECK(empty != NULL);
+    CHECK(empty->empty(empty));
+    empty->destroy(empty);
+
+    avector->destroy(avector);
+    bvector->destroy(bvector);
+    other->destroy(other);
+TEST_END
+
+TEST_BEGIN("create_with/reserve")
+    tally_t tally = { 0, 0 };
+    allocator_t allocator = { tally_alloc, tally_realloc, tally_free,
+                              &tally };
+    chain_t * vector = chain_vector_pub.create_with(NULL, &allocator);
+    chain_t * other = chain_pub.create(NULL);
+    size_t i, reallocs;
+
+    CHECK(vector != NULL);
+    for (i = 1; i <= 100; i++)
+    {
+        vector->insert(vector, (void *) i);
+    }
+
+    // room for that many more, as with any other chain
+    CHECK(vector->reserve(vector, 300));
+    reallocs = tally.reallocs;
+    for (i = 101; i <= 400; i++)
+    {
+        vector->insert(vector, (void *) i);
+    }
+
+    CHECK(tally.reallocs == reallocs);
+    CHECK(chain_vector_at(vector, 399) == (void *) 400);
+    CHECK(!vector->reserve(vector, SIZE_MAX - 100));
+
+    // other kinds of chain neither join nor index
+    other->insert(other, (void *) 1);
+    CHECK(!vector->join(vector, other));
+    CHECK(!other->join(other, vector));
+    CHECK(chain_vector_at(other, 0) == NULL);
+    CHECK(vector->length(vector) == 400);
+    CHECK(other->length(other) == 1);
+
+    other->destroy(other);
+    vector->destroy(vector);
+    CHECK(tally.bytes == 0);
+TEST_END
+
+TESTSUITE_END
@@ -0,0 +1,221 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "codec.h"
+#include "prng.h"
+#include "mut.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+#define LEVELS_MAX_SIZE     300
+
+//------------------------------------------------------------------------|
+// Encode and check the text, then decode it and check that the data
+// comes back, all through buffers of exactly the documented sizes
+static bool hex_is(const void * data, size_t size, const char * expect)
+{
+    char * text = (char *) malloc(CODEC_HEX_ENCODED(size) + 1);
+    uint8_t * back = (uint8_t *) malloc(CODEC_HEX_DECODED(strlen(expect)) + 1);
+    size_t length = codec_hex_encode(text, (const uint8_t *) data, size);
+    bool result = length == strlen(expect) &&
+                  memcmp(text, expect, length) == 0 &&
+                  codec_hex_decode(back, text, length) == (ssize_t) size &&
+                  memcmp(back, data, size) == 0;
+
+    free(text);
+    free(back);
+    return result;
+}
+
+static bool base64_is(const char * data, codec_base64_t alphabet,
+                      const char * expect)
+{
+    size_t size = strlen(data);
+    char * text = (char *) malloc(CODEC_BASE64_ENCODED(size) + 1);
+    uint8_t * back = (uint8_t *) malloc(
+        CODEC_BASE64_DECODED(strlen(expect)) + 1);
+    size_t length = codec_base64_encode(text, (const uint8_t *) data, size,
+                                        alphabet);
+    bool result = length == strlen(expect) &&
+                  memcmp(text, expect, length) == 0 &&
+                  codec_base64_decode(back, text, length, alphabet) ==
+                  (ssize_t) size && memcmp(back, data, size) == 0;
+
+    free(text);
+    free(back);
+    return result;
+}
+
+static ssize_t base64_decoded(const char * text, codec_base64_t alphabet)
+{
+    uint8_t back[64];
+    return codec_base64_decode(back, text, strlen(text), alphabet);
+}
+
+//------------------------------------------------------------------------|
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_codec.log");
+    BLAMMO(INFO, "codec tests...");
+
+TEST_BEGIN("hex")
+    const uint8_t data[] = { 0x00, 0x01, 0x7f, 0x80, 0xab, 0xff };
+    uint8_t back[8];
+
+    CHECK(hex_is(data, 0, ""));
+    CHECK(hex_is(data, 1, "00"));
+    CHECK(hex_is(data, sizeof(data), "00017f80abff"));
+    CHECK(hex_is("foobar", 6, "666f6f626172"));
+
+    // either case decodes, an odd length or a non-digit does not
+    CHECK(codec_hex_decode(back, "DeadBEEF", 8) == 4);
+    CHECK(memcmp(back, "\xde\xad\xbe\xef", 4) == 0);
+    CHECK(codec_hex_decode(back, "abc", 3) == -1);
+    CHECK(codec_hex_decode(back, "0g", 2) == -1);
+    CHECK(codec_hex_decode(back, "0 ", 2) == -1);
+    CHECK(codec_hex_decode(back, "\xb0\x30", 2) == -1);
+TEST_END
+
+TEST_BEGIN("base64")
+    // RFC 4648 section 10
+    CHECK(base64_is("", CODEC_BASE64, ""));
+    CHECK(base64_is("f", CODEC_BASE64, "Zg=="));
+    CHECK(base64_is("fo", CODEC_BASE64, "Zm8="));
+    CHECK(base64_is("foo", CODEC_BASE64, "Zm9v"));
+    CHECK(base64_is("foob", CODEC_BASE64, "Zm9vYg=="));
+    CHECK(base64_is("fooba", CODEC_BASE64, "Zm9vYmE="));
+    CHECK(base64_is("foobar", CODEC_BASE64, "Zm9vYmFy"));
+
+    // the URL alphabet leaves off the padding
+    CHECK(base64_is("f", CODEC_BASE64_URL, "Zg"));
+    CHECK(base64_is("fooba", CODEC_BASE64_URL, "Zm9vYmE"));
+    CHECK(base64_is("\xfb\xff\xbf", CODEC_BASE64, "+/+/"));
+    CHECK(base64_is("\xfb\xff\xbf", CODEC_BASE64_URL, "-_-_"));
+
+    // but either decodes with or without it
+    CHECK(base64_decoded("Zg", CODEC_BASE64) == 1);
+    CHECK(base64_decoded("Zm8", CODEC_BASE64) == 2);
+    CHECK(base64_decoded("Zg==", CODEC_BASE64_URL) == 1);
+    CHECK(base64_decoded("Zm8=", CODEC_BASE64_URL) == 2);
+TEST_END
+
+TEST_BEGIN("base64 invalid")
+    // characters outside the alphabet, including the other alphabet's
+    CHECK(base64_decoded("Zm9v YmFy", CODEC_BASE64) == -1);
+    CHECK(base64_decoded("Zm9v\nYmFy", CODEC_BASE64) == -1);
+    CHECK(base64_decoded("-_-_", CODEC_BASE64) == -1);
+    CHECK(base64_decoded("+/+/", CODEC_BASE64_URL) == -1);
+    CHECK(base64_decoded("Zm9\xc3", CODEC_BASE64) == -1);
+
+    // impossible lengths, and padding other than at the very end
+    CHECK(base64_decoded("Z", CODEC_BASE64) == -1);
+    CHECK(base64_decoded("Zm9vY", CODEC_BASE64) == -1);
+    CHECK(base64_decoded("Z===", CODEC_BASE64) == -1);
+    CHECK(base64_decoded("====", CODEC_BASE64) == -1);
+    CHECK(base64_decoded("Zg=", CODEC_BASE64) == -1);
+    CHECK(base64_decoded("Zg==Zg==", CODEC_BASE64) == -1);
+    CHECK(base64_decoded("Zm=v", CODEC_BASE64) == -1);
+
+    // unused bits must be zero, so "Zh==" is not another "f"
+    CHECK(base64_decoded("Zh==", CODEC_BASE64) == -1);
+    CHECK(base64_decoded("Zm9=", CODEC_BASE64) == -1);
+TEST_END
+
+TEST_BEGIN("levels")
+    // every level must agree with the scalar code for every length, and
+    // catch a bad character wherever it lands relative to the blocks
+    uint8_t * data = (uint8_t *) malloc(LEVELS_MAX_SIZE);
+    char * expect = (char *) malloc(CODEC_HEX_ENCODED(LEVELS_MAX_SIZE));
+    char * text = (char *) malloc(CODEC_HEX_ENCODED(LEVELS_MAX_SIZE));
+    uint8_t * back;
+    codec_simd_t best = codec_simd(), level;
+    codec_base64_t alphabet;
+    size_t size, length, i;
+
+    BLAMMO(INFO, "best SIMD level is %d", (int) best);
+    prng_seed(0xC0DEC);
+
+    for (level = CODEC_SCALAR; level <= best; level++)
+    {
+        CHECK(codec_simd_limit(level) == level);
+        CHECK(codec_simd() == level);
+
+        for (size = 0; size <= LEVELS_MAX_SIZE; size++)
+        {
+            prng_fill(data, size);
+            back = (uint8_t *) malloc(size + 1);
+
+            codec_simd_limit(CODEC_SCALAR);
+            length = codec_hex_encode(expect, data, size);
+            codec_simd_limit(level);
+            CHECK(codec_hex_encode(text, data, size) == length);
+            CHECK(memcmp(text, expect, length) == 0);
+            CHECK(codec_hex_decode(back, text, length) == (ssize_t) size);
+            CHECK(memcmp(back, data, size) == 0);
+
+            for (i = 0; i < length; i += 7)
+            {
+                text[i] = 'x';
+                CHECK(codec_hex_decode(back, text, length) == -1);
+                text[i] = expect[i];
+            }
+
+            for (alphabet = CODEC_BASE64; alphabet <= CODEC_BASE64_URL;
+                 alphabet++)
+            {
+                codec_simd_limit(CODEC_SCALAR);
+                length = codec_base64_encode(expect, data, size, alphabet);
+                codec_simd_limit(level);
+                CHECK(codec_base64_encode(text, data, size, alphabet) ==
+                      length);
+                CHECK(memcmp(text, expect, length) == 0);
+                CHECK(codec_base64_decode(back, text, length, alphabet) ==
+                      (ssize_t) size);
+                CHECK(memcmp(back, data, size) == 0);
+
+                for (i = 0; i < length; i += 5)
+                {
+                    text[i] = '*';
+                    CHECK(codec_base64_decode(back, text, length,
+                                              alphabet) == -1);
+                    text[i] = expect[i];
+                }
+            }
+
+            free(back);
+        }
+    }
+
+    CHECK(codec_simd_limit(CODEC_AVX2) == best);
+    free(data);
+    free(expect);
+    free(text);
+TEST_END
+
+TESTSUITE_END
@@ -0,0 +1,191 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "deque.h"
+#include "mut.h"
+#include "fixture.h"
+
+#include <string.h>
+#include <limits.h>
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_deque.log");
+    BLAMMO(INFO, "deque tests...");
+
+    (void) fixture_report;
+
+TEST_BEGIN("create")
+    deque_t * deque = deque_pub.create(NULL, 0, false);
+    CHECK(deque != NULL);
+    CHECK(deque->priv != NULL);
+    CHECK(deque->empty(deque));
+    CHECK(!deque->full(deque));
+    CHECK(deque->length(deque) == 0);
+    CHECK(deque->front(deque) == NULL);
+    CHECK(deque->back(deque) == NULL);
+    CHECK(deque->pop_front(deque) == NULL);
+    CHECK(deque->pop_back(deque) == NULL);
+    deque->destroy(deque);
+TEST_END
+
+TEST_BEGIN("fifo (wrap and grow)")
+    size_t i, next = 1, expect = 1;
+    deque_t * deque = deque_pub.create(NULL, 0, false);
+
+    // interleave pushes and pops so the ring wraps while it grows
+    for (i = 0; i < 1000; i++)
+    {
+        CHECK(deque->push_back(deque, (void *) next++));
+        CHECK(deque->push_back(deque, (void *) next++));
+        CHECK(deque->pop_front(deque) == (void *) expect++);
+    }
+
+    CHECK(deque->length(deque) == 1000);
+    CHECK(deque->front(deque) == (void *) expect);
+    CHECK(deque->back(deque) == (void *) (next - 1));
+    CHECK(deque->at(deque, 999) == (void *) (next - 1));
+    CHECK(deque->at(deque, 1000) == NULL);
+
+    while (!deque->empty(deque))
+    {
+        CHECK(deque->pop_front(deque) == (void *) expect++);
+    }
+
+    CHECK(expect == next);
+    deque->destroy(deque);
+TEST_END
+
+TEST_BEGIN("push/pop both ends")
+    deque_t * deque = deque_pub.create(NULL, 0, false);
+    deque->push_back(deque, (void *) 2);
+    deque->push_front(deque, (void *) 1);
+    deque->push_back(deque, (void *) 3);
+    deque->push_front(deque, (void *) 0);
+
+    CHECK(deque->length(deque) == 4);
+    CHECK(deque->at(deque, 0) == (void *) 0);
+    CHECK(deque->at(deque, 3) == (void *) 3);
+    CHECK(deque->pop_back(deque) == (void *) 3);
+    CHECK(deque->pop_front(deque) == (void *) 0);
+    CHECK(deque->pop_back(deque) == (void *) 2);
+    CHECK(deque->pop_back(deque) == (void *) 1);
+    CHECK(deque->empty(deque));
+    deque->destroy(deque);
+TEST_END
+
+TEST_BEGIN("bounded")
+    deque_t * deque = deque_pub.create(NULL, 3, false);
+    CHECK(deque->push_back(deque, (void *) 1));
+    CHECK(deque->push_back(deque, (void *) 2));
+    CHECK(deque->push_front(deque, (void *) 3));
+    CHECK(deque->full(deque));
+    CHECK(!deque->push_back(deque, (void *) 4));
+    CHECK(!deque->push_front(deque, (void *) 4));
+    CHECK(deque->length(deque) == 3);
+    deque->destroy(deque);
+TEST_END
+
+TEST_BEGIN("bounded overwrite")
+    int i;
+    payload_t * p = NULL;
+    deque_t * deque = deque_pub.create(payload_destroy, 4, true);
+
+    fixture_reset();
+
+    // create them all up front, because the fixture recycles the most
+    // recently created payload once it is destroyed.
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        payload_create(i);
+    }
+
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        CHECK(deque->push_back(deque, fixture_payload(i)));
+        CHECK(deque->length(deque) == ((i < 4) ? i + 1 : 4));
+    }
+
+    // the oldest payloads were overwritten and destroyed
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        p = fixture_payload(i);
+        CHECK(p->is_destroyed == (i < FIXTURE_PAYLOADS - 4));
+    }
+
+    CHECK(((payload_t *) deque->front(deque))->id == FIXTURE_PAYLOADS - 4);
+
+    // popped payloads belong to the caller and are not destroyed
+    p = (payload_t *) deque->pop_back(deque);
+    CHECK(p->id == FIXTURE_PAYLOADS - 1);
+    deque->destroy(deque);
+    CHECK(p->is_destroyed == false);
+    CHECK(fixture_payload(FIXTURE_PAYLOADS - 2)->is_destroyed == true);
+TEST_END
+
+TEST_BEGIN("spans")
+    size_t i;
+    void * in[100];
+    void * out[100];
+    deque_t * deque = deque_pub.create(NULL, 0, false);
+
+    for (i = 0; i < 100; i++)
+    {
+        in[i] = (void *) (i + 1);
+    }
+
+    // offset the head so spans wrap around the ring
+    for (i = 0; i < 5; i++)
+    {
+        deque->push_back(deque, (void *) 0);
+        deque->pop_front(deque);
+    }
+
+    CHECK(deque->reserve(deque, 16));
+    CHECK(!deque->reserve(deque, SIZE_MAX));
+    CHECK(deque->push_back_span(deque, in, 12) == 12);
+    CHECK(deque->pop_front_span(deque, out, 5) == 5);
+    CHECK(memcmp(out, in, 5 * sizeof(void *)) == 0);
+    CHECK(deque->push_back_span(deque, in + 12, 88) == 88);
+    CHECK(deque->length(deque) == 95);
+    CHECK(deque->pop_front_span(deque, out, 100) == 95);
+    CHECK(memcmp(out, in + 5, 95 * sizeof(void *)) == 0);
+    CHECK(deque->empty(deque));
+    deque->destroy(deque);
+
+    // bounded spans stop at the bound unless overwriting
+    deque = deque_pub.create(NULL, 10, false);
+    CHECK(deque->push_back_span(deque, in, 100) == 10);
+    CHECK(deque->back(deque) == (void *) 10);
+    deque->destroy(deque);
+
+    deque = deque_pub.create(NULL, 10, true);
+    CHECK(deque->push_back_span(deque, in, 100) == 100);
+    CHECK(deque->length(deque) == 10);
+    CHECK(deque->front(deque) == (void *) 91);
+    deque->destroy(deque);
+TEST_END
+
+TESTSUITE_END
@@ -0,0 +1,208 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "hashmap.h"
+#include "bytes.h"
+#include "mut.h"
+#include "fixture.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_hashmap.log");
+    BLAMMO(INFO, "hashmap tests...");
+
+    (void) fixture_report;
+
+TEST_BEGIN("create")
+    hashmap_t * map = hashmap_pub.create(NULL);
+    CHECK(map != NULL);
+    CHECK(map->priv != NULL);
+    CHECK(map->empty(map));
+    CHECK(map->length(map) == 0);
+    CHECK(map->find(map, "nope", 4) == NULL);
+    CHECK(!map->contains(map, "nope", 4));
+    CHECK(!map->erase(map, "nope", 4));
+    map->destroy(map);
+TEST_END
+
+TEST_BEGIN("u64 keys")
+    uint64_t i;
+    hashmap_t * map = hashmap_pub.create(NULL);
+
+    for (i = 0; i < 10000; i++)
+    {
+        CHECK(map->insert_u64(map, i * 7919, (void *) (uintptr_t) (i + 1)));
+    }
+
+    CHECK(map->length(map) == 10000);
+
+    for (i = 0; i < 10000; i++)
+    {
+        CHECK(map->find_u64(map, i * 7919) == (void *) (uintptr_t) (i + 1));
+    }
+
+    CHECK(map->find_u64(map, 7) == NULL);
+
+    // erase every other key, then make sure the rest are still found
+    for (i = 0; i < 10000; i += 2)
+    {
+        CHECK(map->erase_u64(map, i * 7919));
+    }
+
+    CHECK(map->length(map) == 5000);
+    for (i = 0; i < 10000; i++)
+    {
+        CHECK(map->find_u64(map, i * 7919) ==
+              ((i & 1) ? (void *) (uintptr_t) (i + 1) : NULL));
+    }
+
+    // replacing keeps the length
+    CHECK(map->insert_u64(map, 7919, (void *) 42));
+    CHECK(map->length(map) == 5000);
+    CHECK(map->find_u64(map, 7919) == (void *) 42);
+
+    // u64 keys are the same as their native 8 byte spans
+    i = 7919;
+    CHECK(map->find(map, &i, sizeof(i)) == (void *) 42);
+
+    map->destroy(map);
+TEST_END
+
+TEST_BEGIN("span and bytes keys")
+    int i;
+    char key[64];
+    hashmap_t * map = hashmap_pub.create(NULL);
+    bytes_t * bytes = bytes_pub.create("key number 17 is somewhat long", 30);
+
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf(key, sizeof(key), "key number %d is somewhat long", i);
+        CHECK(map->insert(map, key, strlen(key), (void *) (uintptr_t) (i + 1)));
+    }
+
+    // a zero length key is valid too
+    CHECK(map->insert(map, "", 0, (void *) 5000));
+    CHECK(map->contains(map, "", 0));
+    CHECK(map->find(map, "", 0) == (void *) 5000);
+
+    // a NULL value is still a present key
+    CHECK(map->insert(map, "null", 4, NULL));
+    CHECK(map->contains(map, "null", 4));
+    CHECK(map->length(map) == 1002);
+
+    CHECK(map->find_bytes(map, bytes) == (void *) 18);
+    CHECK(map->erase_bytes(map, bytes));
+    CHECK(map->find_bytes(map, bytes) == NULL);
+    CHECK(map->insert_bytes(map, bytes, (void *) 17));
+    CHECK(map->find(map, "key number 17 is somewhat long", 30) == (void *) 17);
+
+    // prefixes and extensions of keys are different keys
+    CHECK(map->find(map, "key number 17 is somewhat lon", 29) == NULL);
+    CHECK(map->find(map, "key number 17 is somewhat long!", 31) == NULL);
+
+    bytes->destroy(bytes);
+    map->destroy(map);
+TEST_END
+
+TEST_BEGIN("value ownership")
+    int i;
+    hashmap_t * map = hashmap_pub.create(payload_destroy);
+
+    fixture_reset();
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        payload_create(i);
+    }
+
+    for (i = 0; i < FIXTURE_PAYLOADS - 1; i++)
+    {
+        map->insert_u64(map, i, fixture_payload(i));
+    }
+
+    // replacing destroys the old value, erasing destroys the value
+    map->insert_u64(map, 0, fixture_payload(FIXTURE_PAYLOADS - 1));
+    CHECK(fixture_payload(0)->is_destroyed == true);
+    CHECK(map->erase_u64(map, 1));
+    CHECK(fixture_payload(1)->is_destroyed == true);
+    CHECK(fixture_payload(2)->is_destroyed == false);
+
+    map->destroy(map);
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        CHECK(fixture_payload(i)->is_destroyed == true);
+    }
+TEST_END
+
+TEST_BEGIN("reserve/rehash/next")
+    uint64_t i, sum = 0;
+    size_t cursor = 0, size = 0, count = 0;
+    const void * key = NULL;
+    void * value = NULL;
+    hashmap_t * map = hashmap_pub.create(NULL);
+
+    // counts no table could hold are refused
+    CHECK(!map->reserve(map, SIZE_MAX / 2));
+    CHECK(!map->reserve(map, SIZE_MAX));
+    CHECK(!map->rehash(map, SIZE_MAX));
+    CHECK(map->empty(map));
+
+    CHECK(map->reserve(map, 1000));
+    for (i = 1; i <= 1000; i++)
+    {
+        map->insert_u64(map, i, (void *) (uintptr_t) i);
+    }
+
+    for (i = 1; i <= 900; i++)
+    {
+        map->erase_u64(map, i);
+    }
+
+    CHECK(map->rehash(map, 0));
+    CHECK(map->length(map) == 100);
+
+    while (map->next(map, &cursor, &key, &size, &value))
+    {
+        CHECK(size == sizeof(uint64_t));
+        CHECK(*(const uint64_t *) key == (uint64_t) (uintptr_t) value);
+        sum += (uintptr_t) value;
+        count++;
+    }
+
+    CHECK(count == 100);
+    CHECK(sum == (901 + 1000) * 50);
+    CHECK(!map->next(map, &cursor, NULL, NULL, NULL));
+
+    map->clear(map);
+    CHECK(map->empty(map));
+    cursor = 0;
+    CHECK(!map->next(map, &cursor, NULL, NULL, NULL));
+    map->destroy(map);
+TEST_END
+
+TESTSUITE_END
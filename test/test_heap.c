@@ -0,0 +1,170 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "heap.h"
+#include "chain.h"
+#include "prng.h"
+#include "mut.h"
+#include "fixture.h"
+
+#include <string.h>
+#include <limits.h>
+
+// Compare pointer values directly, qsort() style
+static int compare_value(const void * a, const void * b)
+{
+    uintptr_t aval = (uintptr_t) *(void **) a;
+    uintptr_t bval = (uintptr_t) *(void **) b;
+    return (aval > bval) - (aval < bval);
+}
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_heap.log");
+    BLAMMO(INFO, "heap tests...");
+
+    (void) fixture_report;
+
+TEST_BEGIN("create")
+    heap_t * heap = heap_pub.create(NULL, compare_value, 0);
+    CHECK(heap != NULL);
+    CHECK(heap->priv != NULL);
+    CHECK(heap->empty(heap));
+    CHECK(heap->length(heap) == 0);
+    CHECK(heap->top(heap) == NULL);
+    CHECK(heap->pop(heap) == NULL);
+    CHECK(!heap->reserve(heap, SIZE_MAX));
+    heap->destroy(heap);
+
+    // a comparator is required
+    CHECK(heap_pub.create(NULL, NULL, 2) == NULL);
+TEST_END
+
+TEST_BEGIN("push/pop order")
+    size_t arity, i;
+    uintptr_t value, prev;
+
+    for (arity = 2; arity <= 8; arity += 2)
+    {
+        heap_t * heap = heap_pub.create(NULL, compare_value, arity);
+        prng_seed(arity);
+
+        for (i = 0; i < 1000; i++)
+        {
+            value = (uintptr_t) (prng_next() % 500) + 1;
+            CHECK(heap->push(heap, (void *) value) != HEAP_HANDLE_NONE);
+        }
+
+        CHECK(heap->length(heap) == 1000);
+
+        prev = 0;
+        while (!heap->empty(heap))
+        {
+            value = (uintptr_t) heap->pop(heap);
+            CHECK(value >= prev);
+            prev = value;
+        }
+
+        heap->destroy(heap);
+    }
+TEST_END
+
+TEST_BEGIN("handles (update/erase)")
+    int i;
+    heap_handle_t handles[FIXTURE_PAYLOADS];
+    heap_t * heap = heap_pub.create(payload_destroy, payload_compare, 3);
+    payload_t * p = NULL;
+
+    fixture_reset();
+
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        handles[i] = heap->push(heap, payload_create(100 + i));
+        CHECK(handles[i] != HEAP_HANDLE_NONE);
+    }
+
+    CHECK(((payload_t *) heap->top(heap))->id == 100);
+    CHECK(((payload_t *) heap->data(heap, handles[7]))->id == 107);
+
+    // decrease-key: move 107 to the top
+    p = (payload_t *) heap->data(heap, handles[7]);
+    p->id = 1;
+    CHECK(heap->update(heap, handles[7]));
+    CHECK(heap->top(heap) == p);
+
+    // increase-key: move it back to the bottom
+    p->id = 1000;
+    CHECK(heap->update(heap, handles[7]));
+    CHECK(((payload_t *) heap->top(heap))->id == 100);
+
+    // erase from the middle hands the payload back undestroyed
+    p = (payload_t *) heap->erase(heap, handles[4]);
+    CHECK(p->id == 104);
+    CHECK(heap->length(heap) == FIXTURE_PAYLOADS - 1);
+    CHECK(heap->data(heap, handles[4]) == NULL);
+    CHECK(heap->erase(heap, handles[4]) == NULL);
+    CHECK(!heap->update(heap, handles[4]));
+
+    p = (payload_t *) heap->pop(heap);
+    CHECK(p->id == 100);
+    CHECK(p->is_destroyed == false);
+
+    // remaining payloads are destroyed with the heap
+    heap->destroy(heap);
+    for (i = 0; i < FIXTURE_PAYLOADS; i++)
+    {
+        CHECK(fixture_payload(i)->is_destroyed == ((i != 0) && (i != 4)));
+    }
+TEST_END
+
+TEST_BEGIN("heapify")
+    size_t i;
+    uintptr_t value, prev = 0;
+    chain_t * chain = chain_pub.create(NULL);
+    heap_t * heap = heap_pub.create(NULL, compare_value, 4);
+
+    prng_seed(0xDEADBEEFCAFEBABEULL);
+    for (i = 0; i < 777; i++)
+    {
+        chain->insert(chain, (void *) (uintptr_t) (prng_next() % 1000 + 1));
+    }
+
+    heap->push(heap, (void *) 500);
+    CHECK(heap->heapify(heap, chain, NULL));
+    CHECK(heap->length(heap) == 778);
+    CHECK(chain->length(chain) == 777);
+
+    while (!heap->empty(heap))
+    {
+        value = (uintptr_t) heap->pop(heap);
+        CHECK(value >= prev);
+        prev = value;
+    }
+
+    chain->destroy(chain);
+    heap->destroy(heap);
+TEST_END
+
+TESTSUITE_END
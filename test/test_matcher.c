@@ -0,0 +1,310 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "matcher.h"
+#include "chain.h"
+#include "bytes.h"
+#include "prng.h"
+#include "mut.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+#define FOUND_MAX       100000
+
+// Matches collected by the callback, stopping after 'limit' if nonzero
+typedef struct
+{
+    matcher_match_t matches[FOUND_MAX];
+    size_t count;
+    size_t limit;
+}
+found_t;
+
+static bool collect(const matcher_match_t * match, void * context)
+{
+    found_t * found = (found_t *) context;
+
+    if (found->count < FOUND_MAX)
+    {
+        found->matches[found->count++] = *match;
+    }
+
+    return found->limit == 0 || found->count < found->limit;
+}
+
+static chain_t * make_patterns(const char ** words, size_t count)
+{
+    chain_t * patterns = chain_pub.create(bytes_pub.destroy);
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        patterns->insert(patterns, bytes_pub.create(words[i],
+                                                    strlen(words[i])));
+    }
+
+    return patterns;
+}
+
+static bool match_is(const matcher_match_t * match, size_t pattern,
+                     size_t offset, size_t size)
+{
+    return match->pattern == pattern && match->offset == offset &&
+           match->size == size;
+}
+
+// Every occurrence the slow way, in the order the matcher reports them:
+// by end, then longest first, then by pattern index
+static size_t naive_matches(chain_t * patterns, const uint8_t * text,
+                            size_t size, found_t * found)
+{
+    size_t count = patterns->length(patterns), longest = 0;
+    bytes_t ** list = (bytes_t **) malloc(count * sizeof(bytes_t *));
+    size_t * sizes = (size_t *) malloc(count * sizeof(size_t));
+    size_t end, length, i;
+
+    patterns->reset(patterns);
+    for (i = 0; i < count; i++, patterns->spin(patterns, 1))
+    {
+        list[i] = (bytes_t *) patterns->data(patterns);
+        sizes[i] = list[i]->size(list[i]);
+        if (sizes[i] > longest)
+        {
+            longest = sizes[i];
+        }
+    }
+
+    found->count = 0;
+    for (end = 0; end < size; end++)
+    {
+        for (length = longest; length > 0; length--)
+        {
+            for (i = 0; i < count && length <= end + 1; i++)
+            {
+                if (sizes[i] == length &&
+                    memcmp(text + end + 1 - length, list[i]->data(list[i]),
+                           length) == 0)
+                {
+                    found->matches[found->count].pattern = i;
+                    found->matches[found->count].offset = end + 1 - length;
+                    found->matches[found->count++].size = length;
+                }
+            }
+        }
+    }
+
+    free(list);
+    free(sizes);
+    return found->count;
+}
+
+static bool found_equal(const found_t * a, const found_t * b)
+{
+    size_t i;
+
+    if (a->count != b->count)
+    {
+        BLAMMO(ERROR, "%zu matches instead of %zu", a->count, b->count);
+        return false;
+    }
+
+    for (i = 0; i < a->count; i++)
+    {
+        if (!match_is(&a->matches[i], b->matches[i].pattern,
+                      b->matches[i].offset, b->matches[i].size))
+        {
+            BLAMMO(ERROR, "match %zu differs", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static found_t found;
+static found_t expect;
+
+//------------------------------------------------------------------------|
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_matcher.log");
+    BLAMMO(INFO, "matcher tests...");
+
+TEST_BEGIN("basic")
+    const char * words[] = { "he", "she", "his", "hers" };
+    chain_t * patterns = make_patterns(words, 4);
+    matcher_t * matcher = matcher_pub.create(patterns);
+    bytes_t * text = bytes_pub.create("ushers", 6);
+
+    CHECK(matcher != NULL);
+    CHECK(matcher->length(matcher) == 4);
+    CHECK(matcher->dense(matcher));
+
+    // overlapping matches, longest first where they end together
+    memset(&found, 0, sizeof(found));
+    CHECK(matcher->scan(matcher, text, collect, &found) == 3);
+    CHECK(found.count == 3);
+    CHECK(match_is(&found.matches[0], 1, 1, 3));
+    CHECK(match_is(&found.matches[1], 0, 2, 2));
+    CHECK(match_is(&found.matches[2], 3, 2, 4));
+    CHECK(matcher->scan(matcher, text, NULL, NULL) == 3);
+
+    CHECK(matcher->contains(matcher, text));
+    text->assign(text, "this", 4);
+    CHECK(matcher->contains(matcher, text));
+    text->assign(text, "hash", 4);
+    CHECK(matcher->contains(matcher, text) == false);
+    CHECK(matcher->scan(matcher, text, NULL, NULL) == 0);
+
+    matcher->destroy(matcher);
+    patterns->destroy(patterns);
+    text->destroy(text);
+TEST_END
+
+TEST_BEGIN("edge cases")
+    const char * words[] = { "a", "", "aa", "a", "b\0c" };
+    chain_t * patterns = make_patterns(words, 4);
+    matcher_t * matcher = NULL;
+    bytes_t * text = bytes_pub.create("aaab\0c", 6);
+
+    // binary patterns, with NUL inside
+    patterns->insert(patterns, bytes_pub.create("b\0c", 3));
+    matcher = matcher_pub.create(patterns);
+    CHECK(matcher != NULL);
+    CHECK(matcher->length(matcher) == 5);
+
+    // duplicates each report, and the empty pattern never does
+    memset(&found, 0, sizeof(found));
+    CHECK(matcher->scan(matcher, text, collect, &found) == 9);
+    CHECK(match_is(&found.matches[0], 0, 0, 1));
+    CHECK(match_is(&found.matches[1], 3, 0, 1));
+    CHECK(match_is(&found.matches[2], 2, 0, 2));
+    CHECK(match_is(&found.matches[8], 4, 3, 3));
+
+    // stopping early still counts the match that stopped it
+    memset(&found, 0, sizeof(found));
+    found.limit = 4;
+    CHECK(matcher->scan(matcher, text, collect, &found) == 4);
+    CHECK(found.count == 4);
+    matcher->destroy(matcher);
+
+    // nothing to match at all
+    patterns->clear(patterns);
+    matcher = matcher_pub.create(patterns);
+    CHECK(matcher != NULL);
+    CHECK(matcher->states(matcher) == 1);
+    CHECK(matcher->scan(matcher, text, NULL, NULL) == 0);
+
+    matcher->destroy(matcher);
+    patterns->destroy(patterns);
+    text->destroy(text);
+TEST_END
+
+TEST_BEGIN("random")
+    // a small set compiles dense and a large one sparse, and both must
+    // find exactly what the naive search does
+    size_t sets[] = { 12, 3000 };
+    uint8_t text[2000], word[16];
+    chain_t * patterns = NULL;
+    matcher_t * matcher = NULL;
+    bytes_t * bytes = NULL;
+    size_t set, i, j, length;
+
+    prng_seed(0xAC0C0A);
+    for (set = 0; set < 2; set++)
+    {
+        patterns = chain_pub.create(bytes_pub.destroy);
+        for (i = 0; i < sets[set]; i++)
+        {
+            // short patterns in the large set would match everywhere
+            length = set ? 3 + prng_next() % 8 : 1 + prng_next() % 10;
+            for (j = 0; j < length; j++)
+            {
+                word[j] = (uint8_t) ('a' + prng_next() % 6);
+            }
+            patterns->insert(patterns, bytes_pub.create(word, length));
+        }
+
+        for (i = 0; i < sizeof(text); i++)
+        {
+            text[i] = (uint8_t) ('a' + prng_next() % 6);
+        }
+
+        matcher = matcher_pub.create(patterns);
+        CHECK(matcher != NULL);
+        CHECK(matcher->dense(matcher) == (set == 0));
+        bytes = bytes_pub.create(text, sizeof(text));
+
+        naive_matches(patterns, text, sizeof(text), &expect);
+        memset(&found, 0, sizeof(found));
+        CHECK(matcher->scan(matcher, bytes, collect, &found) == expect.count);
+        CHECK(found_equal(&found, &expect));
+        BLAMMO(INFO, "%zu patterns, %zu states, %zu matches", sets[set],
+               matcher->states(matcher), found.count);
+
+        bytes->destroy(bytes);
+        matcher->destroy(matcher);
+        patterns->destroy(patterns);
+    }
+TEST_END
+
+TEST_BEGIN("streaming")
+    // matches spanning chunks are found, at stream offsets
+    const char * words[] = { "needle", "haystack", "stack", "e" };
+    chain_t * patterns = make_patterns(words, 4);
+    matcher_t * matcher = matcher_pub.create(patterns);
+    const char * text = "a haystack with a needle in the haystack";
+    size_t size = strlen(text), offset, chunk;
+    matcher_stream_t stream;
+    bytes_t * bytes = bytes_pub.create(text, size);
+
+    memset(&expect, 0, sizeof(expect));
+    CHECK(matcher->scan(matcher, bytes, collect, &expect) == 9);
+
+    for (chunk = 1; chunk <= size; chunk++)
+    {
+        memset(&stream, 0, sizeof(stream));
+        memset(&found, 0, sizeof(found));
+
+        for (offset = 0; offset < size; offset += chunk)
+        {
+            matcher->feed(matcher, &stream, text + offset,
+                          offset + chunk > size ? size - offset : chunk,
+                          collect, &found);
+        }
+
+        CHECK(found_equal(&found, &expect));
+    }
+
+    matcher->destroy(matcher);
+    patterns->destroy(patterns);
+    bytes->destroy(bytes);
+TEST_END
+
+TESTSUITE_END
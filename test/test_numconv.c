@@ -0,0 +1,219 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "numconv.h"
+#include "prng.h"
+#include "mut.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// Convert a double and check that the text parses back to the same bits,
+// both through strtod() and numconv_parse_double()
+static bool roundtrip(double value)
+{
+    char text[NUMCONV_DOUBLE_MAX + 1];
+    size_t length = numconv_double(text, value);
+    double back = 0.0;
+
+    text[length] = '\0';
+    back = strtod(text, NULL);
+    if (memcmp(&value, &back, sizeof(double)))
+    {
+        BLAMMO(ERROR, "%s does not round-trip through strtod()\n", text);
+        return false;
+    }
+
+    if (numconv_parse_double(text, length, &back) != length ||
+        memcmp(&value, &back, sizeof(double)))
+    {
+        BLAMMO(ERROR, "%s does not round-trip by itself\n", text);
+        return false;
+    }
+
+    return true;
+}
+
+static bool double_is(double value, const char * expect)
+{
+    char text[NUMCONV_DOUBLE_MAX + 1];
+    size_t length = numconv_double(text, value);
+
+    text[length] = '\0';
+    return strcmp(text, expect) == 0;
+}
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_numconv.log");
+    BLAMMO(INFO, "numconv tests...");
+
+TEST_BEGIN("integers")
+    char text[NUMCONV_U64_MAX + 1];
+    char expect[32];
+    uint64_t value, back;
+    size_t i, length;
+
+    length = numconv_u64(text, 0);
+    CHECK(length == 1 && text[0] == '0');
+
+    length = numconv_u64(text, UINT64_MAX);
+    text[length] = '\0';
+    CHECK(strcmp(text, "18446744073709551615") == 0);
+
+    length = numconv_i64(text, INT64_MIN);
+    text[length] = '\0';
+    CHECK(strcmp(text, "-9223372036854775808") == 0);
+
+    prng_seed(0xC0FFEE);
+    for (i = 0; i < 100000; i++)
+    {
+        value = prng_next() >> (prng_next() % 64);
+
+        length = numconv_u64(text, value);
+        text[length] = '\0';
+        snprintf(expect, sizeof(expect), "%llu", (unsigned long long) value);
+        CHECK(strcmp(text, expect) == 0);
+        CHECK(numconv_parse_u64(text, length, &back) == length);
+        CHECK(back == value);
+
+        length = numconv_i64(text, (int64_t) value);
+        text[length] = '\0';
+        snprintf(expect, sizeof(expect), "%lld", (long long) value);
+        CHECK(strcmp(text, expect) == 0);
+    }
+TEST_END
+
+TEST_BEGIN("hex")
+    char text[NUMCONV_HEX_MAX + 1];
+    size_t length;
+
+    length = numconv_hex(text, 0, 0);
+    CHECK(length == 1 && text[0] == '0');
+
+    length = numconv_hex(text, 0xBEEF, 8);
+    text[length] = '\0';
+    CHECK(strcmp(text, "0000BEEF") == 0);
+
+    length = numconv_hex(text, UINT64_MAX, 4);
+    text[length] = '\0';
+    CHECK(strcmp(text, "FFFFFFFFFFFFFFFF") == 0);
+
+    CHECK(numconv_hex(text, 1, 99) == NUMCONV_HEX_MAX);
+TEST_END
+
+TEST_BEGIN("parse u64")
+    uint64_t value = 7;
+
+    CHECK(numconv_parse_u64("123abc", 6, &value) == 3 && value == 123);
+    CHECK(numconv_parse_u64("12345", 2, &value) == 2 && value == 12);
+    CHECK(numconv_parse_u64("18446744073709551615", 20, &value) == 20);
+    CHECK(value == UINT64_MAX);
+
+    // nothing there, or too big, leaves the value alone
+    value = 7;
+    CHECK(numconv_parse_u64("x1", 2, &value) == 0);
+    CHECK(numconv_parse_u64("-1", 2, &value) == 0);
+    CHECK(numconv_parse_u64("18446744073709551616", 20, &value) == 0);
+    CHECK(value == 7);
+TEST_END
+
+TEST_BEGIN("double format")
+    CHECK(double_is(0.0, "0.0"));
+    CHECK(double_is(-0.0, "-0.0"));
+    CHECK(double_is(1.0, "1.0"));
+    CHECK(double_is(100.0, "100.0"));
+    CHECK(double_is(-2.5, "-2.5"));
+    CHECK(double_is(0.1, "0.1"));
+    CHECK(double_is(123.456, "123.456"));
+    CHECK(double_is(0.000001, "0.000001"));
+    CHECK(double_is(1e-7, "1e-7"));
+    CHECK(double_is(3.14159e-5, "0.0000314159"));
+    CHECK(double_is(1e21, "1e21"));
+    CHECK(double_is(1.5e300, "1.5e300"));
+    CHECK(double_is(5e-324, "5e-324"));
+    CHECK(double_is(1.7976931348623157e308, "1.7976931348623157e308"));
+    CHECK(double_is(1.0 / 0.0, "inf"));
+    CHECK(double_is(-1.0 / 0.0, "-inf"));
+    CHECK(double_is(0.0 / 0.0, "nan"));
+TEST_END
+
+TEST_BEGIN("double roundtrip")
+    uint64_t bits;
+    double value;
+    size_t i;
+
+    prng_seed(0xD0B1E);
+    for (i = 0; i < 200000; i++)
+    {
+        // random bit patterns cover every exponent, and short decimals
+        // the cases people actually write
+        bits = prng_next();
+        memcpy(&value, &bits, sizeof(value));
+        if (i % 2)
+        {
+            value = (double) (bits % 1000000) / 1000.0;
+        }
+
+        if (value == value && value - value == 0.0)
+        {
+            CHECK(roundtrip(value));
+        }
+    }
+
+    CHECK(roundtrip(2.2250738585072014e-308));
+    CHECK(roundtrip(2.2250738585072009e-308));
+    CHECK(roundtrip(9007199254740993.0));
+TEST_END
+
+TEST_BEGIN("parse double")
+    double value = 7.0;
+
+    CHECK(numconv_parse_double("-12.5e3,", 8, &value) == 7);
+    CHECK(value == -12500.0);
+    CHECK(numconv_parse_double(".5", 2, &value) == 2 && value == 0.5);
+    CHECK(numconv_parse_double("+5.", 3, &value) == 3 && value == 5.0);
+
+    // a dangling exponent is not part of the number
+    CHECK(numconv_parse_double("7e+x", 4, &value) == 1 && value == 7.0);
+
+    // the span bounds the number, not the terminator
+    CHECK(numconv_parse_double("1234", 2, &value) == 2 && value == 12.0);
+
+    // slow path
+    CHECK(numconv_parse_double("12345678901234567890123", 23, &value) == 23);
+    CHECK(value == 12345678901234567890123.0);
+    CHECK(numconv_parse_double("1e-400", 6, &value) == 6 && value == 0.0);
+
+    value = 7.0;
+    CHECK(numconv_parse_double("-", 1, &value) == 0);
+    CHECK(numconv_parse_double(".e3", 3, &value) == 0);
+    CHECK(value == 7.0);
+TEST_END
+
+TESTSUITE_END
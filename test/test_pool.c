@@ -0,0 +1,423 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#define _POSIX_C_SOURCE 200809L  // pthreads
+
+#include "blammo.h"
+#include "pool.h"
+#include "chain.h"
+#include "bytes.h"
+#include "mut.h"
+#include "fixture.h"
+
+#include <string.h>
+#include <pthread.h>
+
+//------------------------------------------------------------------------|
+#define THREADS         4
+#define ROUNDS          200
+#define LIVE            100
+
+// Each thread repeatedly allocates a run of objects, stamps them, checks
+// that no other thread was handed the same ones, and frees them.
+typedef struct
+{
+    pool_t * pool;
+    size_t id;
+    size_t errors;
+}
+worker_t;
+
+static void * worker(void * arg)
+{
+    worker_t * work = (worker_t *) arg;
+    uint64_t * objects[LIVE];
+    size_t round, i;
+
+    for (round = 0; round < ROUNDS; round++)
+    {
+        for (i = 0; i < LIVE; i++)
+        {
+            objects[i] = (uint64_t *) work->pool->alloc(work->pool);
+            if (!objects[i])
+            {
+                work->errors++;
+                return NULL;
+            }
+            objects[i][0] = work->id;
+            objects[i][1] = i;
+        }
+
+        for (i = 0; i < LIVE; i++)
+        {
+            work->errors += (objects[i][0] != work->id);
+            work->errors += (objects[i][1] != i);
+            work->pool->free(work->pool, objects[i]);
+        }
+    }
+
+    return NULL;
+}
+
+// Frees a set of objects allocated by another thread
+typedef struct
+{
+    pool_t * pool;
+    void ** objects;
+    size_t count;
+}
+handoff_t;
+
+static void * releaser(void * arg)
+{
+    handoff_t * handoff = (handoff_t *) arg;
+    size_t i;
+
+    for (i = 0; i < handoff->count; i++)
+    {
+        handoff->pool->free(handoff->pool, handoff->objects[i]);
+    }
+
+    return NULL;
+}
+
+// Caches objects from one pool, waits for it to be destroyed, then uses
+// another pool sharing the same cache slot and exits
+typedef struct
+{
+    pool_t * gone;
+    pool_t * next;
+    pthread_barrier_t * barrier;
+    size_t errors;
+}
+outlive_t;
+
+static void * outliver(void * arg)
+{
+    outlive_t * outlive = (outlive_t *) arg;
+    void * object = outlive->gone->alloc(outlive->gone);
+
+    outlive->errors += (object == NULL);
+    outlive->gone->free(outlive->gone, object);
+
+    pthread_barrier_wait(outlive->barrier);
+    pthread_barrier_wait(outlive->barrier);
+
+    object = outlive->next->alloc(outlive->next);
+    outlive->errors += (object == NULL);
+    outlive->next->free(outlive->next, object);
+    return NULL;
+}
+
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_pool.log");
+    BLAMMO(INFO, "pool tests...");
+
+    (void) fixture_report;
+
+TEST_BEGIN("alloc and free")
+    pool_t * pool = pool_pub.create(20);
+    pool_stats_t stats;
+    void * objects[3 * POOL_BATCH];
+    size_t i;
+
+    CHECK(pool != NULL);
+    CHECK(pool->object_size(pool) >= 20);
+    CHECK(pool->object_size(pool) % POOL_ALIGN == 0);
+
+    pool->stats(pool, &stats);
+    CHECK(stats.slabs == 0);
+
+    for (i = 0; i < 3 * POOL_BATCH; i++)
+    {
+        objects[i] = pool->alloc(pool);
+        CHECK(objects[i] != NULL);
+        CHECK(((uintptr_t) objects[i] & (POOL_ALIGN - 1)) == 0);
+        memset(objects[i], (int) i, pool->object_size(pool));
+    }
+
+    pool->stats(pool, &stats);
+    CHECK(stats.slabs == 1);
+    CHECK(stats.refills == 3);
+    CHECK(stats.depot == stats.objects - 3 * POOL_BATCH);
+
+    // freed objects are recycled, most recent first
+    pool->free(pool, objects[5]);
+    CHECK(pool->alloc(pool) == objects[5]);
+
+    // a full cache flushes a batch back to the depot
+    for (i = 0; i < 3 * POOL_BATCH; i++)
+    {
+        pool->free(pool, objects[i]);
+    }
+
+    pool->stats(pool, &stats);
+    CHECK(stats.flushes == 2);
+    CHECK(stats.depot == stats.objects - POOL_BATCH);
+
+    pool->free(pool, NULL);
+    pool->destroy(pool);
+TEST_END
+
+TEST_BEGIN("threads")
+    pool_t * pool = pool_pub.create(2 * sizeof(uint64_t));
+    pthread_t threads[THREADS];
+    worker_t work[THREADS];
+    pool_stats_t stats;
+    size_t i;
+
+    for (i = 0; i < THREADS; i++)
+    {
+        work[i].pool = pool;
+        work[i].id = i;
+        work[i].errors = 0;
+        CHECK(pthread_create(&threads[i], NULL, worker, &work[i]) == 0);
+    }
+
+    for (i = 0; i < THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        CHECK(work[i].errors == 0);
+    }
+
+    pool->stats(pool, &stats);
+    CHECK(stats.refills > 0);
+    CHECK(stats.flushes > 0);
+
+    // the exited threads handed back what they still cached
+    CHECK(stats.depot == stats.objects);
+
+    pool->destroy(pool);
+TEST_END
+
+TEST_BEGIN("cross-thread free")
+    pool_t * pool = pool_pub.create(64);
+    void * objects[10 * POOL_BATCH];
+    handoff_t handoff = { pool, objects, 10 * POOL_BATCH };
+    pthread_t thread;
+    pool_stats_t stats;
+    size_t i;
+
+    for (i = 0; i < 10 * POOL_BATCH; i++)
+    {
+        objects[i] = pool->alloc(pool);
+        CHECK(objects[i] != NULL);
+    }
+
+    CHECK(pthread_create(&thread, NULL, releaser, &handoff) == 0);
+    pthread_join(thread, NULL);
+
+    // the releasing thread flushed them back for this one to reuse
+    pool->stats(pool, &stats);
+    CHECK(stats.flushes >= 8);
+
+    for (i = 0; i < 10 * POOL_BATCH; i++)
+    {
+        CHECK(pool->alloc(pool) != NULL);
+    }
+
+    pool->stats(pool, &stats);
+    CHECK(stats.slabs == 1);
+
+    pool->destroy(pool);
+TEST_END
+
+TEST_BEGIN("many pools")
+    pool_t * pools[POOL_CACHES + 4];
+    void * objects[POOL_CACHES + 4];
+    size_t i;
+
+    // more pools than cache slots still all work
+    for (i = 0; i < POOL_CACHES + 4; i++)
+    {
+        pools[i] = pool_pub.create(16 * (i + 1));
+        objects[i] = pools[i]->alloc(pools[i]);
+        CHECK(objects[i] != NULL);
+    }
+
+    for (i = 0; i < POOL_CACHES + 4; i++)
+    {
+        pools[i]->free(pools[i], objects[i]);
+        CHECK(pools[i]->alloc(pools[i]) != NULL);
+        pools[i]->destroy(pools[i]);
+    }
+
+    // a new pool is not confused by caches left behind by old ones
+    pool_t * pool = pool_pub.create(16);
+    void * object = pool->alloc(pool);
+    CHECK(object != NULL);
+    pool->free(pool, object);
+    pool->destroy(pool);
+TEST_END
+
+TEST_BEGIN("shared cache slot")
+    pool_t * first = pool_pub.create(64);
+    pool_t * others[POOL_CACHES - 1];
+    pool_t * second = NULL;
+    pool_stats_t stats;
+    void * object = NULL;
+    size_t i;
+
+    // ids are handed out in order, so these two share a cache slot
+    for (i = 0; i < POOL_CACHES - 1; i++)
+    {
+        others[i] = pool_pub.create(64);
+    }
+
+    second = pool_pub.create(64);
+
+    // each switch hands the other pool's cached objects back to it, so
+    // neither ever needs a second slab
+    for (i = 0; i < 1000; i++)
+    {
+        object = first->alloc(first);
+        CHECK(object != NULL);
+        first->free(first, object);
+
+        object = second->alloc(second);
+        CHECK(object != NULL);
+        second->free(second, object);
+    }
+
+    first->stats(first, &stats);
+    CHECK(stats.slabs == 1);
+    CHECK(stats.depot == stats.objects);
+
+    second->stats(second, &stats);
+    CHECK(stats.slabs == 1);
+    CHECK(stats.depot + POOL_BATCH == stats.objects);
+
+    // a slot left by a destroyed pool is taken over without touching it
+    second->destroy(second);
+    CHECK(first->alloc(first) != NULL);
+
+    for (i = 0; i < POOL_CACHES - 1; i++)
+    {
+        others[i]->destroy(others[i]);
+    }
+
+    first->destroy(first);
+TEST_END
+
+TEST_BEGIN("pool destroyed before thread exit")
+    pool_t * gone = pool_pub.create(64);
+    pool_t * others[POOL_CACHES - 1];
+    pool_t * next = NULL;
+    pthread_barrier_t barrier;
+    outlive_t outlive;
+    pthread_t thread;
+    pool_stats_t stats;
+    size_t i;
+
+    for (i = 0; i < POOL_CACHES - 1; i++)
+    {
+        others[i] = pool_pub.create(64);
+    }
+
+    next = pool_pub.create(64);
+
+    CHECK(pthread_barrier_init(&barrier, NULL, 2) == 0);
+    outlive.gone = gone;
+    outlive.next = next;
+    outlive.barrier = &barrier;
+    outlive.errors = 0;
+    CHECK(pthread_create(&thread, NULL, outliver, &outlive) == 0);
+
+    // the thread's cache still holds objects from the destroyed pool when
+    // another pool takes its slot, and again when the thread exits
+    pthread_barrier_wait(&barrier);
+    gone->destroy(gone);
+    pthread_barrier_wait(&barrier);
+    pthread_join(thread, NULL);
+    pthread_barrier_destroy(&barrier);
+    CHECK(outlive.errors == 0);
+
+    next->stats(next, &stats);
+    CHECK(stats.depot == stats.objects);
+
+    for (i = 0; i < POOL_CACHES - 1; i++)
+    {
+        others[i]->destroy(others[i]);
+    }
+
+    next->destroy(next);
+TEST_END
+
+TEST_BEGIN("allocator")
+    pool_t * pool = pool_pub.create(256);
+    const allocator_t * allocator = pool->allocator(pool);
+    pool_stats_t stats;
+    size_t round, i;
+
+    for (round = 0; round < 10; round++)
+    {
+        chain_t * chain = chain_pub.create_with(NULL, allocator);
+        bytes_t * bytes = bytes_create_with("pooled", 6, allocator);
+        CHECK(chain && bytes);
+
+        for (i = 1; i <= 100; i++)
+        {
+            chain->insert(chain, (void *) i);
+        }
+
+        // growing past the object size moves to the heap and back
+        for (i = 0; i < 100; i++)
+        {
+            bytes->append(bytes, "0123456789", 10);
+        }
+        CHECK(bytes->size(bytes) == 1006);
+        CHECK(!memcmp(bytes->cstr(bytes), "pooled0123", 10));
+        bytes->assign(bytes, "short", 5);
+        CHECK(!strcmp(bytes->cstr(bytes), "short"));
+
+        chain->destroy(chain);
+        bytes->destroy(bytes);
+    }
+
+    // everything went back, and a single slab was enough
+    pool->stats(pool, &stats);
+    CHECK(stats.slabs == 1);
+
+    pool->destroy(pool);
+TEST_END
+
+#ifdef POOL_POISON_ENABLE
+TEST_BEGIN("poison")
+    pool_t * pool = pool_pub.create(64);
+    uint8_t * object = (uint8_t *) pool->alloc(pool);
+    size_t i;
+
+    // a free object is filled after its link
+    pool->free(pool, object);
+    for (i = sizeof(void *); i < 64; i++)
+    {
+        CHECK(object[i] == 0xDD);
+    }
+
+    pool->destroy(pool);
+TEST_END
+#endif
+
+TESTSUITE_END
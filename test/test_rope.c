@@ -0,0 +1,440 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "rope.h"
+#include "bytes.h"
+#include "prng.h"
+#include "mut.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// An allocator that keeps count of what is outstanding, and checks that
+// every block is freed with the size it was allocated with.  It fails
+// once 'budget' more allocations have been made.
+typedef struct
+{
+    size_t bytes;
+    size_t blocks;
+    size_t budget;
+}
+tally_t;
+
+static void * tally_alloc(void * context, size_t size)
+{
+    tally_t * tally = (tally_t *) context;
+    size_t * block = NULL;
+
+    if (0 == tally->budget)
+    {
+        return NULL;
+    }
+
+    tally->budget -= tally->budget != SIZE_MAX;
+    block = (size_t *) malloc(sizeof(size_t) + size);
+
+    if (block)
+    {
+        *block = size;
+        tally->bytes += size;
+        tally->blocks++;
+    }
+
+    return block ? block + 1 : NULL;
+}
+
+static void tally_free(void * context, void * ptr, size_t size)
+{
+    tally_t * tally = (tally_t *) context;
+    size_t * block = (size_t *) ptr - 1;
+
+    // a mismatch leaves the tally unbalanced
+    tally->bytes -= *block == size ? size : 0;
+    tally->blocks--;
+    free(block);
+}
+
+static void * tally_realloc(void * context, void * ptr, size_t old_size,
+                            size_t size)
+{
+    void * fresh = tally_alloc(context, size);
+
+    if (fresh && ptr)
+    {
+        memcpy(fresh, ptr, old_size < size ? old_size : size);
+        tally_free(context, ptr, old_size);
+    }
+
+    return fresh;
+}
+
+// Check the whole contents every way they can be read
+static bool matches(rope_t * rope, const uint8_t * model, size_t size)
+{
+    static uint8_t out[32768];
+    bytes_t * bytes = NULL;
+    bool same = false;
+
+    if (rope->size(rope) != size || size > sizeof(out))
+    {
+        return false;
+    }
+
+    same = rope->read(rope, out, size, 0) == size &&
+           memcmp(out, model, size) == 0;
+
+    bytes = rope->to_bytes(rope);
+    same = same && bytes->size(bytes) == size &&
+           memcmp(bytes->data(bytes), model, size) == 0;
+    bytes->destroy(bytes);
+
+    return same && (size == 0 || rope->at(rope, size - 1) == model[size - 1]);
+}
+
+// Count chunks and bytes seen by each()
+static bool tally_chunk(const uint8_t * data, size_t size, void * context)
+{
+    size_t * seen = (size_t *) context;
+
+    seen[0]++;
+    seen[1] += size;
+    return seen[0] < 3;
+}
+
+//------------------------------------------------------------------------|
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_rope.log");
+
+TEST_BEGIN("edits")
+    rope_t * rope = rope_pub.create("hello world", 11);
+    char out[32] = { 0 };
+
+    CHECK(rope != NULL);
+    CHECK(rope->size(rope) == 11);
+    CHECK(!rope->empty(rope));
+    CHECK(rope->chunks(rope) == 1);
+
+    CHECK(rope->insert(rope, 5, ",", 1));
+    CHECK(rope->insert(rope, 0, ">> ", 3));
+    CHECK(rope->append(rope, "!", 1));
+    CHECK(rope->insert(rope, 10, "big ", 4));
+    CHECK(!rope->insert(rope, 100, "x", 1));
+    CHECK(rope->insert(rope, 3, "", 0));
+    CHECK(strcmp(rope->cstr(rope), ">> hello, big world!") == 0);
+    CHECK(rope->at(rope, 3) == 'h');
+
+    CHECK(rope->erase(rope, 0, 3) == 3);
+    CHECK(rope->erase(rope, 5, 5) == 5);
+    CHECK(rope->erase(rope, 11, 100) == 1);
+    CHECK(rope->erase(rope, 11, 1) == 0);
+    CHECK(strcmp(rope->cstr(rope), "hello world") == 0);
+
+    CHECK(rope->read(rope, out, 5, 6) == 5);
+    CHECK(strcmp(out, "world") == 0);
+    CHECK(rope->read(rope, out, 10, 8) == 3);
+    CHECK(rope->read(rope, out, 10, 11) == 0);
+
+    CHECK(rope->erase(rope, 0, SIZE_MAX) == 11);
+    CHECK(rope->empty(rope));
+    CHECK(strcmp(rope->cstr(rope), "") == 0);
+
+    rope->destroy(rope);
+TEST_END
+
+TEST_BEGIN("chunks")
+    uint8_t text[3 * ROPE_CHUNK];
+    rope_t * rope = rope_pub.create(NULL, 0);
+    size_t seen[2] = { 0, 0 };
+    const uint8_t * flat = NULL;
+    size_t i;
+
+    // typing a byte at a time fills chunks rather than making one each
+    for (i = 0; i < sizeof(text); i++)
+    {
+        text[i] = (uint8_t) ('a' + i % 26);
+        CHECK(rope->insert(rope, i, text + i, 1));
+    }
+
+    CHECK(rope->chunks(rope) <= 3);
+    CHECK(matches(rope, text, sizeof(text)));
+
+    // a long insert is one chunk, and splitting it copies nothing
+    CHECK(rope->insert(rope, 10, text, sizeof(text)));
+    CHECK(rope->insert(rope, 10 + ROPE_CHUNK, "|", 1));
+    CHECK(rope->chunks(rope) <= 7);
+    CHECK(rope->size(rope) == 2 * sizeof(text) + 1);
+
+    CHECK(!rope->each(rope, tally_chunk, seen));
+    CHECK(seen[0] == 3);
+
+    // flattening leaves one chunk, which stays put until the next edit
+    flat = rope->data(rope);
+    CHECK(flat != NULL);
+    CHECK(rope->chunks(rope) == 1);
+    CHECK(rope->data(rope) == flat);
+    CHECK(flat[10 + ROPE_CHUNK] == '|');
+    CHECK(memcmp(flat + 10, text, ROPE_CHUNK) == 0);
+    CHECK(rope->cstr(rope)[rope->size(rope)] == 0);
+
+    CHECK(rope->erase(rope, 10 + ROPE_CHUNK, 1) == 1);
+    CHECK(rope->chunks(rope) == 2);
+    CHECK(rope->erase(rope, 10, sizeof(text)) == sizeof(text));
+    CHECK(matches(rope, text, sizeof(text)));
+
+    rope->destroy(rope);
+TEST_END
+
+TEST_BEGIN("substr/concat")
+    tally_t tally = { 0, 0, SIZE_MAX };
+    allocator_t allocator = { tally_alloc, tally_realloc, tally_free,
+                              &tally };
+    rope_t * rope = rope_pub.create_with("The quick brown fox", 19,
+                                         &allocator);
+    rope_t * sub = NULL;
+    rope_t * other = rope_pub.create("!", 1);
+
+    CHECK(rope->insert(rope, 4, "very ", 5));
+    sub = rope->substr(rope, 4, 14);
+    CHECK(sub != NULL);
+    CHECK(strcmp(sub->cstr(sub), "very quick") == 0);
+    CHECK(rope->substr(rope, 30, 40) == NULL);
+
+    // the two are independent from here on
+    CHECK(sub->erase(sub, 0, 5) == 5);
+    CHECK(rope->insert(rope, 0, "> ", 2));
+    CHECK(strcmp(sub->cstr(sub), "quick") == 0);
+    CHECK(strcmp(rope->cstr(rope), "> The very quick brown fox") == 0);
+
+    CHECK(rope->concat(rope, sub));
+    CHECK(rope->concat(rope, rope));
+    CHECK(strcmp(rope->cstr(rope), "> The very quick brown foxquick"
+                                   "> The very quick brown foxquick") == 0);
+    CHECK(strcmp(sub->cstr(sub), "quick") == 0);
+    CHECK(!rope->concat(rope, other));
+
+    sub->destroy(sub);
+    rope->destroy(rope);
+    other->destroy(other);
+
+    // everything went back with the size it came out with
+    CHECK(tally.blocks == 0);
+    CHECK(tally.bytes == 0);
+TEST_END
+
+TEST_BEGIN("random")
+    static uint8_t model[8192];
+    static uint8_t text[600];
+    rope_t * rope = rope_pub.create(NULL, 0);
+    rope_t * sub = NULL;
+    size_t size = 0, round, offset, count, end;
+    bool agree = true;
+
+    prng_seed(0x20BE);
+    prng_fill(text, sizeof(text));
+
+    for (round = 0; round < 20000 && agree; round++)
+    {
+        offset = size ? prng_next() % (size + 1) : 0;
+
+        switch (prng_next() % 5)
+        {
+        case 0:
+        case 1:
+            // mostly short inserts, with the odd long one
+            count = prng_next() % 8 ? 1 + prng_next() % 4 :
+                    prng_next() % (sizeof(text) - 64);
+            if (size + count > sizeof(model))
+            {
+                break;
+            }
+
+            agree = rope->insert(rope, offset, text + round % 64, count);
+            memmove(model + offset + count, model + offset, size - offset);
+            memcpy(model + offset, text + round % 64, count);
+            size += count;
+            break;
+
+        case 2:
+        case 3:
+            count = prng_next() % 6 ? 1 + prng_next() % 4 :
+                    prng_next() % 200;
+            count = rope->erase(rope, offset, count);
+            memmove(model + offset, model + offset + count,
+                    size - offset - count);
+            size -= count;
+            break;
+
+        default:
+            // replace with a shared piece of itself, or double up on one
+            end = offset + prng_next() % (size - offset + 1);
+            sub = rope->substr(rope, offset, end);
+            agree = sub != NULL;
+
+            if (agree && size + (end - offset) <= sizeof(model))
+            {
+                agree = rope->concat(rope, sub);
+                memcpy(model + size, model + offset, end - offset);
+                size += end - offset;
+            }
+            else if (agree)
+            {
+                rope->destroy(rope);
+                rope = sub;
+                sub = NULL;
+                memmove(model, model + offset, end - offset);
+                size = end - offset;
+            }
+
+            if (sub)
+            {
+                sub->destroy(sub);
+            }
+            break;
+        }
+
+        if (round % 97 == 0)
+        {
+            agree = agree && matches(rope, model, size);
+        }
+
+        if (round % 1001 == 0)
+        {
+            agree = agree && rope->data(rope) != NULL &&
+                    memcmp(rope->data(rope), model, size) == 0;
+        }
+    }
+
+    CHECK(agree);
+    CHECK(matches(rope, model, size));
+
+    rope->destroy(rope);
+TEST_END
+
+TEST_BEGIN("shared edits")
+    static uint8_t models[4][32768];
+    static uint8_t text[1024];
+    tally_t tally = { 0, 0, SIZE_MAX };
+    allocator_t allocator = { tally_alloc, tally_realloc, tally_free,
+                              &tally };
+    size_t sizes[4] = { 0, 0, 0, 0 };
+    rope_t * ropes[4];
+    rope_t * sub = NULL;
+    size_t round, i, j, offset, count, end;
+    bool agree = true;
+
+    prng_seed(0x20);
+    prng_fill(text, sizeof(text));
+    for (i = 0; i < 4; i++)
+    {
+        ropes[i] = rope_pub.create_with(NULL, 0, &allocator);
+        CHECK(ropes[i] != NULL);
+    }
+
+    // Ropes trade pieces with substr() and concat(), so most edits land on
+    // shared nodes.  Some are given too little memory to finish, and must
+    // then leave the rope as it was.
+    for (round = 0; round < 20000 && agree; round++)
+    {
+        i = prng_next() % 4;
+        j = prng_next() % 4;
+        offset = sizes[i] ? prng_next() % (sizes[i] + 1) : 0;
+        tally.budget = prng_next() % 4 ? SIZE_MAX : prng_next() % 8;
+
+        switch (prng_next() % 5)
+        {
+        case 0:
+            count = 1 + prng_next() % 400;
+            if (sizes[i] + count > sizeof(models[i]))
+            {
+                break;
+            }
+
+            if (ropes[i]->insert(ropes[i], offset, text + round % 600,
+                                  count))
+            {
+                memmove(models[i] + offset + count, models[i] + offset,
+                        sizes[i] - offset);
+                memcpy(models[i] + offset, text + round % 600, count);
+                sizes[i] += count;
+            }
+            break;
+
+        case 1:
+            count = ropes[i]->erase(ropes[i], offset, 1 + prng_next() % 40);
+            memmove(models[i] + offset, models[i] + offset + count,
+                    sizes[i] - offset - count);
+            sizes[i] -= count;
+            break;
+
+        case 2:
+            end = offset + prng_next() % (sizes[i] - offset + 1);
+            sub = ropes[i]->substr(ropes[i], offset, end);
+            if (sub)
+            {
+                ropes[j]->destroy(ropes[j]);
+                ropes[j] = sub;
+                memmove(models[j], models[i] + offset, end - offset);
+                sizes[j] = end - offset;
+            }
+            break;
+
+        case 3:
+            if (ropes[i]->data(ropes[i]) && sizes[i] > 0)
+            {
+                agree = memcmp(ropes[i]->data(ropes[i]), models[i],
+                               sizes[i]) == 0;
+            }
+            break;
+
+        default:
+            if (sizes[i] + sizes[j] <= sizeof(models[i]) &&
+                ropes[i]->concat(ropes[i], ropes[j]))
+            {
+                memcpy(models[i] + sizes[i], models[j], sizes[j]);
+                sizes[i] += sizes[j];
+            }
+            break;
+        }
+
+        tally.budget = SIZE_MAX;
+        agree = matches(ropes[i], models[i], sizes[i]) &&
+                matches(ropes[j], models[j], sizes[j]);
+    }
+
+    CHECK(agree);
+    for (i = 0; i < 4; i++)
+    {
+        ropes[i]->destroy(ropes[i]);
+    }
+
+    CHECK(tally.blocks == 0);
+    CHECK(tally.bytes == 0);
+TEST_END
+
+TESTSUITE_END
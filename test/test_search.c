@@ -0,0 +1,222 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "search.h"
+#include "prng.h"
+#include "mut.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+// Straightforward versions to check against
+static size_t naive_find(const uint8_t * data, size_t size,
+                         const uint8_t * needle, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i + length <= size; i++)
+    {
+        if (memcmp(data + i, needle, length) == 0)
+        {
+            return i;
+        }
+    }
+
+    return SEARCH_NONE;
+}
+
+static size_t naive_rfind(const uint8_t * data, size_t size,
+                          const uint8_t * needle, size_t length)
+{
+    size_t i;
+
+    for (i = size - length + 1; size >= length && i--; )
+    {
+        if (memcmp(data + i, needle, length) == 0)
+        {
+            return i;
+        }
+    }
+
+    return SEARCH_NONE;
+}
+
+static size_t naive_any_of(const uint8_t * data, size_t size,
+                           const uint8_t * set, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        if (memchr(set, data[i], count))
+        {
+            return i;
+        }
+    }
+
+    return SEARCH_NONE;
+}
+
+// Fill with bytes from a small alphabet, so that needles taken from it
+// match often and partially match far more often
+static void fill_small(uint8_t * data, size_t size, unsigned alphabet)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        data[i] = (uint8_t) ('a' + prng_next() % alphabet);
+    }
+}
+
+//------------------------------------------------------------------------|
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_search.log");
+    BLAMMO(INFO, "search tests...");
+
+TEST_BEGIN("bytes")
+    const char data[] = "ab\0cd\0ef-abcdefghijklmnopqrstuvwxyz\0";
+    size_t size = sizeof(data) - 1;
+
+    // NULs are ordinary bytes
+    CHECK(search_byte(data, size, '\0') == 2);
+    CHECK(search_last_byte(data, size, '\0') == size - 1);
+    CHECK(search_byte(data, size, 'z') == size - 2);
+    CHECK(search_last_byte(data, size, 'a') == 9);
+    CHECK(search_byte(data, size, '!') == SEARCH_NONE);
+    CHECK(search_last_byte(data, size, '!') == SEARCH_NONE);
+    CHECK(search_last_byte(data, 0, 'a') == SEARCH_NONE);
+
+    CHECK(search_any_of(data, size, "-", 1) == 8);
+    CHECK(search_any_of(data, size, "zy-", 3) == 8);
+    CHECK(search_any_of(data + 9, size - 9, "zyx", 3) == 23);
+    CHECK(search_any_of(data + 9, size - 9, "0123456789zyx", 13) == 23);
+    CHECK(search_any_of(data, size, "!?", 2) == SEARCH_NONE);
+    CHECK(search_any_of(data, size, "", 0) == SEARCH_NONE);
+
+    CHECK(search_count(data, size, "\0", 1) == 3);
+    CHECK(search_count(data, size, "", 0) == 0);
+TEST_END
+
+TEST_BEGIN("substrings")
+    const char data[] = "abc\0abcabc\0abcabcabc, the quick brown fox";
+    size_t size = sizeof(data) - 1;
+
+    CHECK(search_find(data, size, "abc\0", 4) == 0);
+    CHECK(search_find(data, size, "\0abcabc\0", 8) == 3);
+    CHECK(search_find(data, size, "fox", 3) == size - 3);
+    CHECK(search_find(data, size, "brown foxes", 11) == SEARCH_NONE);
+    CHECK(search_find(data, size, "", 0) == 0);
+    CHECK(search_find("ab", 2, "abc", 3) == SEARCH_NONE);
+
+    CHECK(search_rfind(data, size, "abc", 3) == 17);
+    CHECK(search_rfind(data, size, "abc\0", 4) == 7);
+    CHECK(search_rfind(data, size, "the", 3) == 22);
+    CHECK(search_rfind(data, size, "", 0) == size);
+    CHECK(search_rfind(data, size, "xyz", 3) == SEARCH_NONE);
+
+    // non-overlapping, counting from the front
+    CHECK(search_count(data, size, "abc", 3) == 6);
+    CHECK(search_count("aaaaa", 5, "aa", 2) == 2);
+TEST_END
+
+TEST_BEGIN("random")
+    uint8_t * data = (uint8_t *) malloc(1024);
+    uint8_t needle[40];
+    size_t trial, size, length, at, i, count;
+    unsigned alphabet;
+
+    prng_seed(0x5EA8C4);
+    for (trial = 0; trial < 20000; trial++)
+    {
+        size = prng_next() % 1024;
+        length = 1 + prng_next() % 40;
+        alphabet = 1 + prng_next() % 4;
+        fill_small(data, size, alphabet);
+
+        // mostly needles that occur, some that may not
+        if (size >= length && trial % 4)
+        {
+            at = prng_next() % (size - length + 1);
+            memcpy(needle, data + at, length);
+        }
+        else
+        {
+            fill_small(needle, length, alphabet);
+        }
+
+        CHECK(search_find(data, size, needle, length) ==
+              naive_find(data, size, needle, length));
+        CHECK(search_rfind(data, size, needle, length) ==
+              naive_rfind(data, size, needle, length));
+
+        CHECK(search_last_byte(data, size, needle[0]) ==
+              naive_rfind(data, size, needle, 1));
+        CHECK(search_any_of(data, size, needle, length) ==
+              naive_any_of(data, size, needle, length));
+
+        for (i = 0, count = 0;
+             (at = naive_find(data + i, size - i, needle, length)) !=
+             SEARCH_NONE; i += at + length)
+        {
+            count++;
+        }
+        CHECK(search_count(data, size, needle, length) == count);
+    }
+
+    free(data);
+TEST_END
+
+TEST_BEGIN("worst case")
+    // a needle like "aaa...ab" against "aaa..." makes every position a
+    // candidate for the filter, which must hand over to Two-Way
+    size_t size = 1 << 20;
+    uint8_t * data = (uint8_t *) malloc(size);
+    uint8_t needle[1000];
+
+    memset(data, 'a', size);
+    memset(needle, 'a', sizeof(needle));
+    needle[sizeof(needle) - 1] = 'b';
+    CHECK(search_find(data, size, needle, sizeof(needle)) == SEARCH_NONE);
+
+    data[size - 1] = 'b';
+    CHECK(search_find(data, size, needle, sizeof(needle)) ==
+          size - sizeof(needle));
+
+    needle[sizeof(needle) - 1] = 'a';
+    needle[0] = 'b';
+    data[size - 1] = 'a';
+    data[size / 2] = 'b';
+    CHECK(search_find(data, size, needle, sizeof(needle)) == size / 2);
+    CHECK(search_count(data, size, needle, sizeof(needle)) == 1);
+
+    free(data);
+TEST_END
+
+TESTSUITE_END
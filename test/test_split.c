@@ -0,0 +1,340 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "split.h"
+#include "view.h"
+#include "bytes.h"
+#include "prng.h"
+#include "mut.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+#define TOKENS_MAX  1024
+
+// Split 'text' and gather the tokens as C strings, joined by '|' so each
+// case can be checked in one comparison.  Returns the token count.
+static size_t gather(const char * text, const split_spec_t * spec,
+                     char * out)
+{
+    split_t split;
+    view_t token;
+    size_t count = 0;
+
+    out[0] = 0;
+    split_begin(&split, view_cstr(text), spec);
+    while (split_next(&split, &token))
+    {
+        if (count++ > 0)
+        {
+            strcat(out, "|");
+        }
+
+        strncat(out, (const char *) token.data, token.size);
+    }
+
+    return count;
+}
+
+// Straightforward splitting to check against, a byte at a time.  Records
+// the start and end of each token and returns the count.
+static size_t naive_split(const uint8_t * data, size_t size,
+                          const split_spec_t * spec, size_t * begins,
+                          size_t * ends)
+{
+    const uint8_t * delim = (const uint8_t * ) spec->delim;
+    size_t width = spec->mode == SPLIT_STRING ? spec->length : 1;
+    size_t count = 0, splits = 0, begin = 0, i = 0;
+    bool quoted = false;
+
+    #define NAIVE_MATCH(at) \
+        (spec->mode == SPLIT_STRING ? \
+            (size - (at) >= width && !memcmp(data + (at), delim, width)) : \
+         spec->mode == SPLIT_BYTE ? data[at] == delim[0] : \
+            memchr(delim, data[at], spec->length) != NULL)
+
+    while (spec->merge && i < size && NAIVE_MATCH(i))
+    {
+        i += width;
+    }
+
+    begin = i;
+    while (i < size && (0 == spec->limit || splits < spec->limit))
+    {
+        if (spec->quote && data[i] == spec->quote)
+        {
+            quoted = !quoted;
+            i++;
+        }
+        else if (!quoted && NAIVE_MATCH(i))
+        {
+            begins[count] = begin;
+            ends[count++] = i;
+            splits++;
+
+            i += width;
+            while (spec->merge && i < size && NAIVE_MATCH(i))
+            {
+                i += width;
+            }
+
+            begin = i;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    if (!spec->merge || begin < size)
+    {
+        begins[count] = begin;
+        ends[count++] = size;
+    }
+
+    return count;
+}
+
+//------------------------------------------------------------------------|
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_split.log");
+
+TEST_BEGIN("byte")
+    split_spec_t spec = { SPLIT_BYTE, ",", 1, 0, 0, false };
+    char out[256];
+
+    CHECK(gather("a,b,,c,", &spec, out) == 5);
+    CHECK(strcmp(out, "a|b||c|") == 0);
+    CHECK(gather("", &spec, out) == 1);
+    CHECK(strcmp(out, "") == 0);
+    CHECK(gather("abc", &spec, out) == 1);
+    CHECK(strcmp(out, "abc") == 0);
+
+    // at most 'limit' splits, with the rest as the last token
+    spec.limit = 2;
+    CHECK(gather("a,b,,c,", &spec, out) == 3);
+    CHECK(strcmp(out, "a|b|,c,") == 0);
+
+    // runs of delimiters count once, and leave no empty tokens
+    spec.limit = 0;
+    spec.merge = true;
+    CHECK(gather(",,a,b,,c,", &spec, out) == 3);
+    CHECK(strcmp(out, "a|b|c") == 0);
+    CHECK(gather(",,,", &spec, out) == 0);
+    CHECK(gather("", &spec, out) == 0);
+
+    spec.limit = 1;
+    CHECK(gather(",,a,,b,c,", &spec, out) == 2);
+    CHECK(strcmp(out, "a|b,c,") == 0);
+    CHECK(gather("a,,", &spec, out) == 1);
+
+    // tokens point into the input
+    const char text[] = "key=value";
+    split_t split;
+    view_t token;
+    spec.delim = "=";
+    spec.limit = 0;
+    split_begin(&split, view_cstr(text), &spec);
+    CHECK(split_next(&split, &token));
+    CHECK(token.data == (const uint8_t *) text && token.size == 3);
+    CHECK(split_next(&split, &token));
+    CHECK(token.data == (const uint8_t *) text + 4 && token.size == 5);
+    CHECK(!split_next(&split, &token));
+    CHECK(!split_next(&split, &token));
+TEST_END
+
+TEST_BEGIN("string and class")
+    split_spec_t spec = { SPLIT_STRING, "::", 2, 0, 0, false };
+    char out[256];
+
+    CHECK(gather("a::b:c::", &spec, out) == 3);
+    CHECK(strcmp(out, "a|b:c|") == 0);
+    CHECK(gather("::::", &spec, out) == 3);
+    CHECK(gather(":::", &spec, out) == 2);
+    CHECK(strcmp(out, "|:") == 0);
+
+    spec.merge = true;
+    CHECK(gather("::a::::b:::", &spec, out) == 3);
+    CHECK(strcmp(out, "a|b|:") == 0);
+
+    // an empty delimiter never matches
+    spec.length = 0;
+    CHECK(gather("a::b", &spec, out) == 1);
+    CHECK(strcmp(out, "a::b") == 0);
+
+    spec.mode = SPLIT_CLASS;
+    spec.delim = SPLIT_WHITESPACE;
+    spec.length = strlen(SPLIT_WHITESPACE);
+    CHECK(gather("  one\ttwo \r\n three \n", &spec, out) == 3);
+    CHECK(strcmp(out, "one|two|three") == 0);
+
+    spec.limit = 1;
+    CHECK(gather("  one\ttwo \r\n three \n", &spec, out) == 2);
+    CHECK(strcmp(out, "one|two \r\n three \n") == 0);
+
+    spec.delim = ",;";
+    spec.length = 2;
+    spec.limit = 0;
+    spec.merge = false;
+    CHECK(gather("a;b,c;;d", &spec, out) == 5);
+    CHECK(strcmp(out, "a|b|c||d") == 0);
+TEST_END
+
+TEST_BEGIN("quotes")
+    split_spec_t spec = { SPLIT_BYTE, ",", 1, '"', 0, false };
+    char out[256];
+    split_t split;
+    view_t token;
+
+    CHECK(gather("a,\"b,c\",d", &spec, out) == 3);
+    CHECK(strcmp(out, "a|\"b,c\"|d") == 0);
+    CHECK(gather("\"x\"\"y,\",z", &spec, out) == 2);
+    CHECK(strcmp(out, "\"x\"\"y,\"|z") == 0);
+    CHECK(gather("a\"b,c\"d,e", &spec, out) == 2);
+    CHECK(strcmp(out, "a\"b,c\"d|e") == 0);
+
+    // an unclosed quote runs to the end
+    CHECK(gather("a,\"b,c", &spec, out) == 2);
+    CHECK(strcmp(out, "a|\"b,c") == 0);
+
+    spec.mode = SPLIT_STRING;
+    spec.delim = ", ";
+    spec.length = 2;
+    CHECK(gather("\"one, two\", three, \", \"", &spec, out) == 3);
+    CHECK(strcmp(out, "\"one, two\"|three|\", \"") == 0);
+
+    split_begin(&split, view_cstr("\"a,b\""), &spec);
+    CHECK(split_next(&split, &token));
+    token = split_unquote(token, '"');
+    CHECK(view_equal(token, view_cstr("a,b")));
+    CHECK(view_equal(split_unquote(view_cstr("\"a"), '"'), view_cstr("\"a")));
+    CHECK(split_unquote(view_cstr("\"\""), '"').size == 0);
+TEST_END
+
+TEST_BEGIN("random")
+    const char * delims[] = { ",", ",;", ",;", ",,", "a," };
+    const split_mode_t modes[] = { SPLIT_BYTE, SPLIT_CLASS, SPLIT_STRING,
+                                   SPLIT_STRING, SPLIT_STRING };
+    size_t begins[TOKENS_MAX], ends[TOKENS_MAX];
+    uint8_t data[600];
+    split_spec_t spec;
+    split_t split;
+    view_t token;
+    size_t round, size, count, i, found;
+    bool agree = true;
+
+    prng_seed(0x5B117);
+    for (round = 0; round < 4000 && agree; round++)
+    {
+        i = round % 5;
+        memset(&spec, 0, sizeof(spec));
+        spec.mode = modes[i];
+        spec.delim = delims[i];
+        spec.length = strlen(delims[i]);
+        spec.quote = (round / 5) % 2 ? '"' : 0;
+        spec.merge = (round / 10) % 2;
+        spec.limit = (round / 20) % 3 ? 0 : prng_next() % 8;
+
+        // a small alphabet, so that delimiters and quotes are common
+        size = prng_next() % sizeof(data);
+        for (i = 0; i < size; i++)
+        {
+            data[i] = "ab,,;\"aab"[prng_next() % 9];
+        }
+
+        count = naive_split(data, size, &spec, begins, ends);
+
+        found = 0;
+        split_begin(&split, view_of(data, size), &spec);
+        while (split_next(&split, &token))
+        {
+            if (found >= count || token.size != ends[found] - begins[found] ||
+                (token.size > 0 && token.data != data + begins[found]))
+            {
+                agree = false;
+                break;
+            }
+
+            found++;
+        }
+
+        agree = agree && found == count;
+    }
+
+    CHECK(agree);
+TEST_END
+
+TEST_BEGIN("chain")
+    split_spec_t spec = { SPLIT_CLASS, SPLIT_WHITESPACE, 6, 0, 0, true };
+    bytes_t * bytes = bytes_pub.create(" GET /index.html  HTTP/1.1\r\n", 28);
+    const char * expect[] = { "GET", "/index.html", "HTTP/1.1" };
+    chain_t * chain = bytes_tokenize(bytes, &spec);
+    view_t * token = NULL;
+    size_t i;
+
+    CHECK(chain != NULL);
+    CHECK(chain->length(chain) == 3);
+
+    chain->reset(chain);
+    for (i = 0; i < chain->length(chain); i++)
+    {
+        token = (view_t *) chain->data(chain);
+        CHECK(view_equal(*token, view_cstr(expect[i])));
+        CHECK(token->data >= bytes->data(bytes));
+        CHECK(token->data < bytes->data(bytes) + bytes->size(bytes));
+        chain->spin(chain, 1);
+    }
+
+    // tokens share storage, which outlives removing some and moving the
+    // rest into another chain of tokens
+    chain_t * more = split_chain(view_cstr("a b c d"), &spec);
+    CHECK(more != NULL);
+    CHECK(more->length(more) == 4);
+    more->remove(more);
+    CHECK(chain->join(chain, more));
+    more->destroy(more);
+    chain->reset(chain);
+    chain->remove(chain);
+    CHECK(chain->length(chain) == 5);
+    chain->reset(chain);
+    chain->spin(chain, 4);
+    CHECK(view_equal(*(view_t *) chain->data(chain), view_cstr("c")));
+
+    chain->destroy(chain);
+
+    // nothing to split still gives a chain
+    chain = split_chain(view_cstr(" \n"), &spec);
+    CHECK(chain != NULL);
+    CHECK(chain->length(chain) == 0);
+
+    chain->destroy(chain);
+    bytes->destroy(bytes);
+TEST_END
+
+TESTSUITE_END
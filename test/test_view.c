@@ -0,0 +1,188 @@
+//------------------------------------------------------------------------|
+// Copyright (c) 2018-2020 by Raymond M. Foulk IV (rfoulk@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//------------------------------------------------------------------------|
+
+#include "blammo.h"
+#include "view.h"
+#include "bytes.h"
+#include "mut.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//------------------------------------------------------------------------|
+TESTSUITE_BEGIN
+
+    BLAMMO_LEVEL(INFO);
+    BLAMMO_FILE("test_view.log");
+
+TEST_BEGIN("construct")
+    bytes_t * bytes = bytes_pub.create("  key = 42\0tail ", 16);
+    view_t view = view_bytes(bytes);
+    view_t part;
+
+    // a view points into the object's own data, with no copy
+    CHECK(view.data == bytes->data(bytes));
+    CHECK(view.size == 16);
+
+    part = view_slice(view, 2, 5);
+    CHECK(part.data == view.data + 2);
+    CHECK(part.size == 3);
+    CHECK(memcmp(part.data, "key", 3) == 0);
+
+    // ranges are clamped, and empty ones are still valid views
+    CHECK(view_slice(view, 11, SIZE_MAX).size == 5);
+    CHECK(view_slice(view, 20, 30).size == 0);
+    CHECK(view_slice(view, 5, 2).size == 0);
+    CHECK(view_slice(view, 5, 2).data != NULL);
+    CHECK(view_of(NULL, 0).data != NULL);
+    CHECK(view_cstr(NULL).size == 0);
+    CHECK(view_cstr("abc").size == 3);
+
+    // trimming stops at the embedded NUL, which is not whitespace
+    part = view_trim(view);
+    CHECK(part.data == view.data + 2);
+    CHECK(part.size == 13);
+    CHECK(view_trim(view_cstr(" \t\r\n ")).size == 0);
+    CHECK(view_equal(view_trim(view_cstr("\tx y\n")), view_cstr("x y")));
+
+    bytes_t * copy = view_copy(view_slice(view, 2, 10));
+    CHECK(copy != NULL);
+    CHECK(strcmp(copy->cstr(copy), "key = 42") == 0);
+    CHECK(copy->data(copy) != view.data + 2);
+
+    copy->destroy(copy);
+    bytes->destroy(bytes);
+TEST_END
+
+TEST_BEGIN("compare")
+    view_t abc = view_cstr("abc");
+    view_t abd = view_cstr("abd");
+    view_t ab = view_cstr("ab");
+    view_t empty = view_of(NULL, 0);
+    char other[] = "abc";
+
+    CHECK(view_compare(abc, abc) == 0);
+    CHECK(view_compare(abc, abd) < 0);
+    CHECK(view_compare(abd, abc) > 0);
+    CHECK(view_compare(ab, abc) < 0);
+    CHECK(view_compare(abc, ab) > 0);
+    CHECK(view_compare(empty, ab) < 0);
+    CHECK(view_compare(empty, view_cstr("")) == 0);
+
+    // bytes past 0x7F order above ASCII, as with memcmp()
+    CHECK(view_compare(view_cstr("\x80"), view_cstr("\x7F")) > 0);
+
+    // equal contents are equal, and hash equally, wherever they live
+    CHECK(view_equal(abc, view_of(other, 3)));
+    CHECK(!view_equal(abc, abd));
+    CHECK(!view_equal(abc, ab));
+    CHECK(view_hash(abc) == view_hash(view_of(other, 3)));
+    CHECK(view_hash(abc) != view_hash(abd));
+
+    CHECK(view_starts_with(abc, "ab", 2));
+    CHECK(view_starts_with(abc, "", 0));
+    CHECK(!view_starts_with(ab, "abc", 3));
+    CHECK(view_ends_with(abc, "bc", 2));
+    CHECK(!view_ends_with(abc, "ab", 2));
+    CHECK(view_ends_with(empty, "", 0));
+TEST_END
+
+TEST_BEGIN("search")
+    const char data[] = "xx-ab\0ab,cd;ab-yy";
+    view_t all = view_of(data, sizeof(data) - 1);
+    view_t view = view_slice(all, 3, 15);
+
+    // offsets are relative to the view, and nothing outside it is seen
+    CHECK(view_find_byte(view, 0, 0) == 2);
+    CHECK(view_find_byte(view, 0, 'x') == SEARCH_NONE);
+    CHECK(view_find_byte(view, 0, '-') == 11);
+    CHECK(view_find_any_of(view, 0, ",;", 2) == 5);
+    CHECK(view_find_any_of(view, 6, ",;", 2) == 8);
+    CHECK(view_find(view, 0, "ab", 2) == 0);
+    CHECK(view_find(view, 1, "ab", 2) == 3);
+    CHECK(view_find(view, 0, "-y", 2) == SEARCH_NONE);
+    CHECK(view_find(view, 12, "", 0) == 12);
+    CHECK(view_find(view, 13, "", 0) == SEARCH_NONE);
+    CHECK(view_rfind(view, SIZE_MAX, "ab", 2) == 9);
+    CHECK(view_rfind(view, 8, "ab", 2) == 3);
+    CHECK(view_rfind(view, 2, "ab", 2) == 0);
+    CHECK(view_count(view, 0, "ab", 2) == 3);
+    CHECK(view_count(view, 1, "ab", 2) == 2);
+TEST_END
+
+TEST_BEGIN("parse")
+    const char data[] = "width=640;ratio=1.25x";
+    view_t view = view_cstr(data);
+    uint64_t u = 7;
+    double d = 0.0;
+
+    CHECK(view_parse_u64(view, 6, &u) == 3);
+    CHECK(u == 640);
+
+    // parsing stops at the end of the view, not at the end of the data
+    CHECK(view_parse_u64(view_slice(view, 6, 8), 0, &u) == 2);
+    CHECK(u == 64);
+    CHECK(view_parse_u64(view, 0, &u) == 0);
+    CHECK(view_parse_u64(view, 100, &u) == 0);
+    CHECK(u == 64);
+
+    CHECK(view_parse_double(view, 16, &d) == 4);
+    CHECK(d == 1.25);
+    CHECK(view_parse_double(view_slice(view, 16, 19), 0, &d) == 3);
+    CHECK(d == 1.2);
+TEST_END
+
+TEST_BEGIN("hexdump")
+    uint8_t data[40];
+    bytes_t * whole = NULL;
+    bytes_t * out = bytes_pub.create("", 0);
+    size_t i;
+
+    for (i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (uint8_t) ('0' + i);
+    }
+
+    // matches the bytes_t dump, with offsets from the start of the view
+    whole = bytes_pub.create(data, sizeof(data));
+    CHECK(view_hexdump(view_of(data, sizeof(data)), out));
+    CHECK(strcmp(out->cstr(out), whole->hexdump(whole)) == 0);
+
+    out->clear(out);
+    CHECK(view_hexdump(view_of(data + 20, 3), out));
+    CHECK(strcmp(out->cstr(out),
+                 "0000  44 45 46                                    "
+                 "      DEF\n") == 0);
+
+    // appends, and an empty view adds nothing
+    CHECK(view_hexdump(view_of(NULL, 0), out));
+    CHECK(out->size(out) == 60);
+    CHECK(view_hexdump_file(view_of(NULL, 0), stdout) == 0);
+
+    whole->destroy(whole);
+    out->destroy(out);
+TEST_END
+
+TESTSUITE_END